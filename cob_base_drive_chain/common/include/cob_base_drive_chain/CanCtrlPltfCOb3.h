@@ -64,11 +64,18 @@
 // Headers provided by other cob-packages
 #include <cob_canopen_motor/CanDriveItf.h>
 #include <cob_canopen_motor/CanDriveHarmonica.h>
+#include <cob_canopen_motor/CanDrive402.h>
+#include <cob_canopen_motor/DriveParamSet.h>
+#include <cob_canopen_motor/VelEstimator.h>
+#include <cob_base_drive_chain/DriveSupervisor.h>
 #include <cob_generic_can/CanItf.h>
+#include <cob_generic_can/CanItfStats.h>
 
 // Headers provided by cob-packages which should be avoided/removed
 #include <cob_utilities/IniFile.h>
 #include <cob_utilities/Mutex.h>
+#include <cob_utilities/SeqLock.h>
+#include <cob_utilities/TimeStamp.h>
 
 // remove (not supported)
 //#include "stdafx.h"
@@ -114,6 +121,44 @@ public:
 		CANNODE_WHEEL4STEERMOTOR
 	};
 
+	/**
+	 * Maximum number of motors (one drive and one steer motor per wheel).
+	 */
+	static const int c_iMaxNumMotors = 8;
+
+
+	//--------------------------------- Platform state
+
+	/**
+	 * State of one motor, see PltfState.
+	 */
+	struct DriveState
+	{
+		double dPosGearRad;
+		double dVelGearRadS;
+		double dTorqueNm;
+		int iStatus;
+		int iTempCel;
+	};
+
+	/**
+	 * State of all motors of one SYNC cycle.
+	 */
+	struct PltfState
+	{
+		/// number of the SYNC cycle (complete and incomplete ones), see getNumPosVelCycles()
+		unsigned long iCycle;
+		/// reception time of the last PDO of the cycle in seconds (CAN timestamp if the interface provides one)
+		double dTimeS;
+		/// bit i is set if the PDO1 of motor i arrived in this cycle,
+		/// the state of the other motors is the one of the last cycle they answered
+		unsigned int iMotorsReceived;
+		/// true if the PDO1 of all motors arrived in this cycle
+		bool bComplete;
+		/// indexed by MotorCANNode
+		DriveState Drive[c_iMaxNumMotors];
+	};
+
 
 	//--------------------------------- Commands for all nodes on the bus
 
@@ -124,6 +169,14 @@ public:
 	 */
 	bool initPltf();
 
+	/**
+	 * Reads the configuration and attaches the drives to the given CAN interface,
+	 * but neither starts the CANopen network nor initializes the drives.
+	 * Meant for evaluating recorded CAN traces (CanItfReplay) offline.
+	 * @param pCanItf CAN interface to use instead of [TypeCan] Can. The object takes ownership of it.
+	 */
+	void initPltfPassive(CanItf* pCanItf);
+
 	/**
 	 * Reinitializes the nodes on the bus.
 	 * The function might be neccessary after an emergency stop or an hardware failure to reinit drives.
@@ -132,6 +185,8 @@ public:
 
 	/**
 	 * Signs an error of the platform.
+	 * The drives are supervised by a thread of their own (see DriveSupervisor), started by initPltf(),
+	 * so this function only reads a flag and may be called in every cycle of the control loop.
 	 * @return true if there is an error.
 	 */
 	bool isPltfError();
@@ -152,6 +207,40 @@ public:
 	 */
 	int evalCanBuffer();
 
+	/**
+	 * Evaluates the can-buffer like evalCanBuffer(), but waits for messages until
+	 * the position and velocity (PDO1) of all drives of a SYNC cycle have arrived.
+	 * The lock is released every c_iWaitSliceUs, so commands can be sent meanwhile.
+	 * A cycle ends incomplete when the next SYNC is sent (flushCmdBatch()), a drive answers twice
+	 * or it is not completed within [TypeCan] PosVelCycleTimeoutUs, see PltfState::iMotorsReceived.
+	 * @param iTimeoutUs maximum time to wait
+	 * @return true if a SYNC cycle was completed since the previous call
+	 */
+	bool waitForPosVelCycle(int iTimeoutUs);
+
+	/**
+	 * Number of SYNC cycles for which the position and velocity of all drives were received.
+	 */
+	unsigned long getNumPosVelCycles() { return m_iNumPosVelCycles; }
+
+	/**
+	 * Number of SYNC cycles that ended before the position and velocity of all drives were received.
+	 */
+	unsigned long getNumIncompletePosVelCycles() { return m_iNumIncompletePosVelCycles; }
+
+	/**
+	 * Evaluates the can-buffer until the queued SDO transfers of all motors are finished.
+	 * Each motor has one SDO transfer in progress at a time, the motors proceed in parallel.
+	 * @param dTimeoutS maximum time to wait
+	 * @return true if no SDO transfer is pending anymore
+	 */
+	bool waitForSDOs(double dTimeoutS);
+
+	/**
+	 * Number of received messages which could not be assigned to any motor.
+	 */
+	unsigned long getNumUnknownCanMsgs() { return m_iNumUnknownCanMsgs; }
+
 
 	//--------------------------------- Commands specific for motor controller nodes
 
@@ -163,6 +252,12 @@ public:
 	 */
 	int setVelGearRadS(int iCanIdent, double dVelGearRadS);
 
+	/**
+	 * Sends the velocities of all motors, converted to encoder increments in one batch.
+	 * @param vdVelGearRadS joint-velocities in radian per second, indexed by MotorCANNode
+	 */
+	int setVelGearRadS(const std::vector<double>& vdVelGearRadS);
+
 	/**
 	 * Sends torques to the can node.
 	 * Status is requested, too.
@@ -195,7 +290,37 @@ public:
 	void requestMotorTorque();
 
 	/**
-	 * Gets the position and velocity.
+	 * Starts collecting the CAN messages of the following commands (e.g. setVelGearRadS() of all joints).
+	 * They are sent in one burst by flushCmdBatch().
+	 */
+	void beginCmdBatch();
+
+	/**
+	 * Sends the commands collected since beginCmdBatch(), the SYNC last.
+	 * The SYNC ends the SYNC cycle in progress, see waitForPosVelCycle().
+	 * @return number of CAN messages sent
+	 */
+	int flushCmdBatch();
+
+	/**
+	 * Gets the traffic statistics of the CAN bus (rates since the previous call,
+	 * errors and the command -> response latency of each drive).
+	 * @return false if the statistics are disabled ([TypeCan] Statistics=0)
+	 */
+	bool getCanStats(CanItfStats::Stats& stats);
+
+	/**
+	 * Gets the state of all motors of the last complete SYNC cycle.
+	 * The state is published once per cycle by the thread evaluating the can-buffer and
+	 * copied without locking, so it may be called from any thread while the CAN thread proceeds.
+	 * Check State.iCycle to see whether a new cycle arrived since the previous call
+	 * and State.bComplete whether all drives answered in it.
+	 * @return false if no cycle was published yet
+	 */
+	bool getPltfState(PltfState& State) const;
+
+	/**
+	 * Gets the position and velocity of the last complete SYNC cycle, see getPltfState().
 	 * @param iCanIdent choose a can node
 	 * @param pdAngleGearRad joint-position in radian
 	 * @param pdVelGearRadS joint-velocity in radian per second
@@ -203,7 +328,8 @@ public:
 	int getGearPosVelRadS(int iCanIdent, double* pdAngleGearRad, double* pdVelGearRadS);
 
 	/**
-	 * Gets the delta joint-angle since the last call and the velocity.
+	 * Gets the delta joint-angle since the last call and the velocity of the latest SYNC cycle (see getPltfState()).
+	 * Not thread-safe for the same motor, one caller per motor.
 	 * @param iCanIdent choose a can node
 	 * @param pdDeltaAngleGearRad delta joint-position since the last call in radian
 	 * @param pdVelGearRadS joint-velocity in radian per second
@@ -211,19 +337,33 @@ public:
 	int getGearDeltaPosVelRadS(int iCanIdent, double* pdDeltaAngleGearRad, double* pdVelGearRadS);
 
 	/**
-	 * Gets the status and temperature in degree celcius.
+	 * Gets the status and temperature in degree celcius of the last complete SYNC cycle, see getPltfState().
 	 * (Not implemented for CanDriveHarmonica)
 	 * @param iCanIdent choose a CANNode enumatraion
 	 */
 	void getStatus(int iCanIdent, int* piStatus, int* piTempCel);
 
 	/**
-	 * Gets the motor torque (calculated from motor active current).
+	 * Gets the motor torque (calculated from motor active current) of the last complete SYNC cycle, see getPltfState().
 	 * @param iCanIdent choose a can node
 	 * @param pdTorqueNm motor-torque in Newtonmeter
 	 */
 	void getMotorTorque(int iCanIdent, double* pdTorqueNm);
 
+	/**
+	 * Enables the streaming of active current, torque and following error of all motors with every SYNC.
+	 * Call before initPltf() to map the PDO while the drives are initialized.
+	 */
+	void setTelemetry(bool bEnable);
+
+	/**
+	 * Moves the streamed samples of a motor received since the previous call to vSamples (appended).
+	 * May be called from another thread than evalCanBuffer(), one reader per motor.
+	 * @param iCanIdent choose a can node
+	 * @return number of samples appended
+	 */
+	int readTelemetry(int iCanIdent, std::vector<CanDriveItf::TelemetrySample>& vSamples);
+
 
 
 	//--------------------------------- Commands specific for a certain motor controller
@@ -233,9 +373,10 @@ public:
 	 * Provides several functions for drive information recording purposes using the built in ElmoRecorder, which allows to record drive information at a high frequency.
 	 * @param iFlag To keep the interface slight, use iParam to command the recorder:
 	 * 0: Configure the Recorder to record the sources Main Speed(1), Main position(2), Active current(10), Speed command(16). With iParam = iRecordingGap you specify every which time quantum (4*90usec) a new data point (of 1024 points in total) is recorded;
-	 * 1: Query Upload of recorded source (1=Main Speed, 2=Main position, 10=Active Current, 16=Speed command) with iParam and log data to file sParam = file prefix. Filename is extended with _MotorNumber_RecordedSource.log
+	 * 1: Query Upload of recorded source (1=Main Speed, 2=Main position, 10=Active Current, 16=Speed command) with iParam and log data to file sParam = file prefix. Filename is extended with _MotorNumber_RecordedSource.rec
 	 * 99: Abort and clear current SDO readout process
 	 * 100: Request status of readout. Gives back 0 if all transmissions have finished and no CAN polling is needed anymore.
+	 * 101: Request progress of readout. Gives back the uploaded bytes in percent, averaged over all motors (the motors are read out concurrently).
 	 * @return -1: Unknown flag set; 0: Success; 1: Recorder hasn't been configured yet; 2: data collection still in progress
 	 *
 	*/
@@ -253,19 +394,96 @@ protected:
 	/**
 	 * Reads configuration of can node and components from Inifile
 	 * (should be adapted to use ROS-Parameter file)
+	 * @return false if the CAN interface could not be opened
 	 */
 	std::string sIniDirectory;
 	std::string sComposed;
-	void readConfiguration();
+	bool readConfiguration();
+
+	/**
+	 * Creates the motor object of the drive type set by the key MotorType in Platform.ini
+	 * ("Harmonica" for the Elmo binary interpreter, "CiA402" for a generic CiA 402 drive).
+	 * @param iTxPDO1 ... iRxSDO CAN identifiers of the drive as given in CanCtrl.ini
+	 */
+	CanDriveItf* createMotor(int iTxPDO1, int iTxPDO2, int iRxPDO2, int iTxSDO, int iRxSDO);
 
 	/**
 	 * Starts up can node
 	 */
 	void sendNetStartCanOpen();
 
+	/**
+	 * Builds the lookup table from 11-bit CAN identifier to motor index
+	 * out of the identifiers reported by the motors (see CanDriveItf::getRxCanIDs()).
+	 */
+	void buildCanIDDispatchTable();
+
+	/**
+	 * Hands received messages to the motors they belong to, caller holds m_Mutex.
+	 */
+	void dispatchMsgs(std::vector<CanMsg>& vCanMsgs, int iNumMsgs);
+
+	/**
+	 * Ends the SYNC cycle in progress and publishes the state of all motors, caller holds m_Mutex.
+	 * Does nothing if no PDO1 arrived since the previous cycle ended.
+	 */
+	void closePosVelCycle();
+
+	/**
+	 * Ends the SYNC cycle in progress if it is not completed in time, caller holds m_Mutex.
+	 */
+	void checkPosVelCycleTimeout();
+
+	/**
+	 * Publishes the state of the motors of the SYNC cycle in progress, caller holds m_Mutex.
+	 */
+	void publishPltfState();
+
+	/**
+	 * Handles the SDO timeouts of all motors and updates m_iNumPendingSDOs, caller holds m_Mutex.
+	 */
+	void processSDOs();
+
+	/**
+	 * Initializes and starts all motors at the same time (see CanDriveItf::beginInit())
+	 * and waits until each of them succeeded or failed.
+	 */
+	void initMotors();
+
+	/**
+	 * Homes all wheels at the same time. Each wheel proceeds on its own:
+	 * configure homing, turn to escape the homing switch, wait for the homing event, turn to position zero.
+	 * @return true if all wheels are homed
+	 */
+	bool homeWheels(std::vector<CanDriveItf*>& vpDriveMotor, std::vector<CanDriveItf*>& vpSteerMotor,
+		std::vector<double>& vdFactorVel);
+
 
 	//--------------------------------- Types
 
+	/**
+	 * Drive types which can be selected in Platform.ini, see createMotor().
+	 */
+	enum MotorType
+	{
+		MOTOR_HARMONICA,
+		MOTOR_CIA402
+	};
+
+	/**
+	 * Homing states of a wheel, see homeWheels().
+	 */
+	enum HomingState
+	{
+		HOMING_CONFIG,
+		HOMING_ESCAPE,
+		HOMING_ARMED,
+		HOMING_TO_ZERO,
+		HOMING_DONE,
+		HOMING_FAILED,
+		HOMING_STOPPED
+	};
+
 	/**
 	 * Parameters of the class CanCtrlPltfCOb3.
 	 */
@@ -282,6 +500,8 @@ protected:
 		int iHasWheel4DriveMotor;
 		int iHasWheel4SteerMotor;
 
+		int iMotorType;
+
 		double dWheel1SteerDriveCoupling;
 		double dWheel2SteerDriveCoupling;
 		double dWheel3SteerDriveCoupling;
@@ -437,13 +657,57 @@ protected:
 	GearMotorParamType m_GearMotSteer4;
 
 	//--------------------------------- Variables
-	CanMsg m_CanMsgRec;
+	// buffer for bulk reads of the can buffer in evalCanBuffer() and waitForPosVelCycle()
+	static const int c_iCanMsgRecBufSize = 64;
+	std::vector<CanMsg> m_vCanMsgRecBuf;
+	// 11-bit CAN identifier -> index in m_vpMotor (-1 if no motor listens to it)
+	static const int c_iNumCanIDs = 0x800;
+	std::vector<int> m_viCanIDToMotor;
+	unsigned long m_iNumUnknownCanMsgs;
+	// longest time waitForPosVelCycle() blocks the other threads while waiting for messages
+	static const int c_iWaitSliceUs = 100;
+	// completion bitmap of the current SYNC cycle: bit i is set when PDO1 of motor i arrived
+	std::vector<bool> m_vbCanIDIsPosVel;
+	unsigned int m_iPosVelReceived;
+	unsigned int m_iPosVelAllMotors;
+	bool m_bPosVelCycleComplete;
+	unsigned long m_iNumPosVelCycles;
+	unsigned long m_iNumIncompletePosVelCycles;
+	// reception of the first and the last PDO1 of the current cycle
+	TimeStamp m_PosVelCycleStart;
+	double m_dPosVelCycleTimeS;
+	// time after the first PDO1 after which an incomplete cycle is published
+	double m_dPosVelCycleTimeoutS;
+	// state of all motors, written by publishPltfState(), read lock-free by getPltfState()
+	SeqLock<PltfState> m_PltfState;
+	PltfState m_PltfStateWrite;
+	// position of the previous getGearDeltaPosVelRadS() call, indexed like m_vpMotor
+	double m_dDeltaPosGearRadMem[c_iMaxNumMotors];
+	// unit conversion of all motors, raw values and results indexed like m_vpMotor
+	DriveParamSet m_DriveParamSet;
+	std::vector<int> m_viPosMeasIncr;
+	std::vector<int> m_viVelMeasIncrPeriod;
+	std::vector<double> m_vdPosGearMeasRad;
+	std::vector<double> m_vdVelGearMeasRadS;
+	std::vector<double> m_vdVelCmdGearRadS;
+	std::vector<int> m_viVelCmdIncrPeriod;
+	// velocity estimation per motor (NULL: velocity of the drive) and reception time of its last PDO1
+	std::vector<VelEstimator*> m_vpVelEstimator;
+	std::vector<double> m_vdPosVelTimeS;
+	// SDO transfers of all motors queued or in progress after the last evaluation of the can-buffer
+	int m_iNumPendingSDOs;
 	Mutex m_Mutex;
-	bool m_bWatchdogErr;
+	// heartbeat and CAN timeouts of the drives, velocities are set to zero while it reports an error
+	DriveSupervisor m_DriveSupervisor;
+	DriveSupervisor::ParamType m_SupervisorParam;
+	// streaming of current, torque and following error, see setTelemetry()
+	bool m_bTelemetry;
 
 	//--------------------------------- Components
 	// Can-Interface
 	CanItf* m_pCanCtrl;
+	// traffic statistics, wraps the interface above (NULL if disabled)
+	CanItfStats* m_pCanStats;
 	IniFile m_IniFile;
 
 	int m_iNumMotors;
@@ -0,0 +1,197 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_base_drive_chain
+ * Description: Supervision of the drives: heartbeat production and CAN timeouts.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#ifndef DRIVESUPERVISOR_INCLUDEDEF_H
+#define DRIVESUPERVISOR_INCLUDEDEF_H
+//-----------------------------------------------
+#include <pthread.h>
+#include <vector>
+#include <boost/atomic.hpp>
+
+#include <cob_generic_can/CanItf.h>
+#include <cob_canopen_motor/CanDriveItf.h>
+#include <cob_utilities/Mutex.h>
+//-----------------------------------------------
+
+/**
+ * Supervises the drives of the platform in a thread of its own, so the control loop
+ * only has to check one flag (isError()).
+ * - Heartbeat production: the heartbeat (0x700) which keeps the watchdogs of the drives
+ *   inactive is sent at a fixed period as long as the control path sends commands
+ *   (notifyCmd()). If the control loop stalls, the heartbeat stops and the drives stop themselves.
+ * - Heartbeat consumption: every message of a drive (notifyRx()) counts as sign of life.
+ *   The deadlines of the drives are kept in a timer wheel with a slot per tick,
+ *   so a tick costs only the drives whose deadline falls into it.
+ * - The error states of the drives (CanDriveItf::isError()) are polled at a low rate.
+ */
+class DriveSupervisor
+{
+public:
+	/// Drives are identified by a bit of the error mask.
+	static const int c_iMaxNumDrives = 32;
+
+	/**
+	 * Parameters of the supervision.
+	 */
+	struct ParamType
+	{
+		/// resolution of the deadlines and period of the thread
+		double dTickS;
+		/// period of the heartbeat, has to be well below the consumer time of the drives
+		double dHeartbeatPeriodS;
+		/// the heartbeat stops if the control path didn't send a command for this time
+		double dCmdTimeoutS;
+		/// a drive is erroneous if it didn't send anything for this time
+		double dRxTimeoutS;
+		/// period the error states of the drives are polled with
+		double dErrorPollPeriodS;
+	};
+
+	DriveSupervisor();
+	~DriveSupervisor();
+
+	/**
+	 * Starts the supervision thread.
+	 * @param pCanItf interface the heartbeat is sent on
+	 * @param vpDrives drives to supervise, drive i is bit i of getErrorMask()
+	 * @param pMutex serializes the access to pCanItf and the drives with the other threads
+	 * @return true if the thread is running
+	 */
+	bool start(CanItf* pCanItf, const std::vector<CanDriveItf*>& vpDrives, Mutex* pMutex, const ParamType& Param);
+
+	/**
+	 * Stops the supervision thread, no heartbeat is sent afterwards.
+	 */
+	void stop();
+
+	/**
+	 * Signals a received message of drive iDrive.
+	 * Called by the receiving thread for each message, neither locks nor reads the clock.
+	 */
+	void notifyRx(int iDrive)
+	{
+		m_aiLastRxTick[iDrive].store(m_iTick.load(boost::memory_order_relaxed), boost::memory_order_relaxed);
+	}
+
+	/**
+	 * Signals a command of the control path, keeps the heartbeat alive.
+	 */
+	void notifyCmd()
+	{
+		m_iLastCmdTick.store(m_iTick.load(boost::memory_order_relaxed), boost::memory_order_relaxed);
+	}
+
+	/**
+	 * Returns true if a drive reported an error or timed out.
+	 */
+	bool isError() const
+	{
+		return m_iErrMask.load(boost::memory_order_acquire) != 0;
+	}
+
+	/**
+	 * Returns the erroneous drives, bit i is set for drive i.
+	 */
+	unsigned int getErrorMask() const
+	{
+		return m_iErrMask.load(boost::memory_order_acquire);
+	}
+
+private:
+	static void* threadFunc(void* pArg);
+	void run();
+
+	/**
+	 * Processes the deadlines of tick iTick.
+	 */
+	void advanceWheel(unsigned int iTick);
+	void armDeadline(int iDrive, unsigned int iDeadlineTick);
+	void checkRecovery(unsigned int iTick);
+	void sendHeartbeat(unsigned int iTick);
+	void pollDriveErrors();
+
+	ParamType m_Param;
+	CanItf* m_pCanItf;
+	std::vector<CanDriveItf*> m_vpDrives;
+	Mutex* m_pMutex;
+
+	pthread_t m_hThread;
+	boost::atomic<bool> m_bRunning;
+
+	// ------------------------- ticks
+	int m_iRxTimeoutTicks;
+	int m_iCmdTimeoutTicks;
+	int m_iHeartbeatTicks;
+	int m_iErrorPollTicks;
+
+	/// tick counter of the thread, read by notifyRx() and notifyCmd()
+	boost::atomic<unsigned int> m_iTick;
+	boost::atomic<unsigned int> m_aiLastRxTick[c_iMaxNumDrives];
+	boost::atomic<unsigned int> m_iLastCmdTick;
+
+	// ------------------------- timer wheel, only accessed by the thread
+	/// first drive of each slot, -1 if empty
+	std::vector<int> m_viSlotHead;
+	/// next drive in the same slot (intrusive list)
+	int m_aiNextInSlot[c_iMaxNumDrives];
+	/// last reception when the timeout was detected
+	unsigned int m_aiExpiredRxTick[c_iMaxNumDrives];
+
+	// ------------------------- error state
+	unsigned int m_iRxTimeoutMask;
+	unsigned int m_iDriveErrMask;
+	boost::atomic<unsigned int> m_iErrMask;
+};
+//-----------------------------------------------
+#endif
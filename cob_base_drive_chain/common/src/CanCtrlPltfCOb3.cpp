@@ -56,13 +56,23 @@
 
 // general includes
 #include <math.h>
+#include <sstream>
+#include <cstring>
+#include <algorithm>
 #include <unistd.h>
 
 // Headers provided by other cob-packages
+#include <cob_generic_can/CanDummy.h>
 #include <cob_generic_can/CanESD.h>
+#include <cob_generic_can/CanItfThread.h>
+#include <cob_generic_can/CanItfStats.h>
+#include <cob_generic_can/CanItfRecorder.h>
+#include <cob_generic_can/CanItfReplay.h>
 #include <cob_generic_can/CanPeakSys.h>
 #include <cob_generic_can/CanPeakSysUSB.h>
+#include <cob_canopen_motor/CanDriveHarmonicaSim.h>
 #include <cob_base_drive_chain/CanCtrlPltfCOb3.h>
+#include <cob_utilities/TimeStamp.h>
 
 #include <unistd.h>
 
@@ -85,6 +95,24 @@ CanCtrlPltfCOb3::CanCtrlPltfCOb3(std::string iniDirectory)
 
 	// ------------- first of all set used CanItf
 	m_pCanCtrl = NULL;
+	m_pCanStats = NULL;
+
+	// receive buffer for evalCanBuffer() and waitForPosVelCycle(), large enough for the PDO burst of one SYNC cycle
+	m_vCanMsgRecBuf.resize(c_iCanMsgRecBufSize);
+	m_viCanIDToMotor.assign(c_iNumCanIDs, -1);
+	m_iNumUnknownCanMsgs = 0;
+	m_vbCanIDIsPosVel.assign(c_iNumCanIDs, false);
+	m_iPosVelReceived = 0;
+	m_iPosVelAllMotors = 0;
+	m_bPosVelCycleComplete = false;
+	m_iNumPosVelCycles = 0;
+	m_iNumIncompletePosVelCycles = 0;
+	m_dPosVelCycleTimeS = 0;
+	m_dPosVelCycleTimeoutS = 0.01;
+	memset(&m_PltfStateWrite, 0, sizeof(m_PltfStateWrite));
+	memset(m_dDeltaPosGearRadMem, 0, sizeof(m_dDeltaPosGearRadMem));
+	m_iNumPendingSDOs = 0;
+	m_bTelemetry = false;
 
 	// ------------- init hardware-specific vectors and set default values
 	m_vpMotor.resize(m_iNumMotors);
@@ -134,13 +162,18 @@ CanCtrlPltfCOb3::CanCtrlPltfCOb3(std::string iniDirectory)
 	if(m_iNumMotors == 8)
 		m_Param.iHasWheel4SteerMotor = 0;
 
+	m_Param.iMotorType = MOTOR_HARMONICA;
 	m_Param.iHasRelayBoard = 0;
 	m_Param.iHasIOBoard = 0;
 	m_Param.iHasUSBoard = 0;
 	m_Param.iHasGyroBoard = 0;
 	m_Param.iHasRadarBoard = 0;
 
-	m_bWatchdogErr = false;
+	m_SupervisorParam.dTickS = 0.01;
+	m_SupervisorParam.dHeartbeatPeriodS = 0.1;
+	m_SupervisorParam.dCmdTimeoutS = 0.5;
+	m_SupervisorParam.dRxTimeoutS = m_Param.dCanTimeout;
+	m_SupervisorParam.dErrorPollPeriodS = 0.1;
 
 	// ------------ CanIds
 
@@ -226,6 +259,8 @@ CanCtrlPltfCOb3::CanCtrlPltfCOb3(std::string iniDirectory)
 //-----------------------------------------------
 CanCtrlPltfCOb3::~CanCtrlPltfCOb3()
 {
+	// the supervision sends on the interface and polls the motors
+	m_DriveSupervisor.stop();
 
 	if (m_pCanCtrl != NULL)
 	{
@@ -240,14 +275,22 @@ CanCtrlPltfCOb3::~CanCtrlPltfCOb3()
 		}
 	}
 
+	for(unsigned int i = 0; i < m_vpVelEstimator.size(); i++)
+	{
+		if (m_vpVelEstimator[i] != NULL)
+		{
+			delete m_vpVelEstimator[i];
+		}
+	}
 }
 
 //-----------------------------------------------
-void CanCtrlPltfCOb3::readConfiguration()
+bool CanCtrlPltfCOb3::readConfiguration()
 {
 
 	int iTypeCan = 0;
 	int iMaxMessages = 0;
+	CanDummy* pCanDummy = NULL;
 
 	DriveParam DriveParamW1DriveMotor;
 	DriveParam DriveParamW1SteerMotor;
@@ -288,7 +331,13 @@ void CanCtrlPltfCOb3::readConfiguration()
 
 	// read Configuration of the Can-Network (CanCtrl.ini)
 	m_IniFile.GetKeyInt("TypeCan", "Can", &iTypeCan, true);
-	if (iTypeCan == 0)
+	// an interface given by initPltfPassive() is used as it is
+	bool bReplay = (m_pCanCtrl != NULL) || (iTypeCan == CANITFTYPE_CAN_REPLAY);
+	if (m_pCanCtrl != NULL)
+	{
+		std::cout << "Uses given CAN interface" << std::endl;
+	}
+	else if (iTypeCan == 0)
 	{
 		sComposed = sIniDirectory;
 		sComposed += "CanCtrl.ini";
@@ -309,6 +358,76 @@ void CanCtrlPltfCOb3::readConfiguration()
 		m_pCanCtrl = new CanESD(sComposed.c_str(), false);
 		std::cout << "Uses CAN-ESD-card" << std::endl;
 	}
+	else if (iTypeCan == 3)
+	{
+		// no hardware, the drives are simulated (see below)
+		int iLatencyUs = 0;
+		int iJitterUs = 0;
+		m_IniFile.GetKeyInt("TypeCan", "DummyLatencyUs", &iLatencyUs, false);
+		m_IniFile.GetKeyInt("TypeCan", "DummyJitterUs", &iJitterUs, false);
+		pCanDummy = new CanDummy(iLatencyUs, iJitterUs);
+		m_pCanCtrl = pCanDummy;
+		std::cout << "Uses CAN-Dummy with simulated drives, latency " << iLatencyUs
+			<< " us, jitter " << iJitterUs << " us" << std::endl;
+	}
+	else if (iTypeCan == CANITFTYPE_CAN_REPLAY)
+	{
+		// no hardware, the received frames of a trace are replayed
+		std::string sReplayFile;
+		int iReplayRealTime = 1;
+		m_IniFile.GetKeyString("TypeCan", "ReplayFile", &sReplayFile, true);
+		m_IniFile.GetKeyInt("TypeCan", "ReplayRealTime", &iReplayRealTime, false);
+		CanItfReplay* pCanItfReplay = new CanItfReplay();
+		if (!pCanItfReplay->open(sReplayFile, iReplayRealTime != 0))
+		{
+			std::cout << "Initialization of CAN-Replay of " << sReplayFile << " failed" << std::endl;
+			delete pCanItfReplay;
+			return false;
+		}
+		m_pCanCtrl = pCanItfReplay;
+		std::cout << "Uses CAN-Replay of " << sReplayFile << (iReplayRealTime ? " in real time" : " at maximum speed") << std::endl;
+	}
+
+	// optionally record all frames of the interface to a trace file (see CanItfReplay)
+	std::string sTraceFile;
+	m_IniFile.GetKeyString("TypeCan", "TraceFile", &sTraceFile, false);
+	if (!sTraceFile.empty() && !bReplay && (m_pCanCtrl != NULL))
+	{
+		CanItfRecorder* pCanItfRecorder = new CanItfRecorder(m_pCanCtrl);
+		if (pCanItfRecorder->open(sTraceFile))
+			std::cout << "Records CAN trace to " << sTraceFile << std::endl;
+		m_pCanCtrl = pCanItfRecorder;
+	}
+
+	// optionally run the CAN I/O in a dedicated (real-time) thread,
+	// so sending commands and evaluating the can buffer never wait for the driver
+	int iIOThread = 0;
+	int iIOThreadPriority = 0;
+	m_IniFile.GetKeyInt("TypeCan", "IOThread", &iIOThread, false);
+	m_IniFile.GetKeyInt("TypeCan", "IOThreadPriority", &iIOThreadPriority, false);
+	if ((iIOThread != 0) && !bReplay && (m_pCanCtrl != NULL))
+	{
+		CanItfThread* pCanItfThread = new CanItfThread(m_pCanCtrl, iIOThreadPriority);
+		pCanItfThread->start();
+		m_pCanCtrl = pCanItfThread;
+		std::cout << "Uses CAN I/O thread with priority " << iIOThreadPriority << std::endl;
+	}
+
+	// bus load and latency statistics, the latency channels are added with the CAN identifiers of the drives
+	int iStatistics = 1;
+	int iBaudrateVal = 0;
+	m_IniFile.GetKeyInt("TypeCan", "Statistics", &iStatistics, false);
+	m_IniFile.GetKeyInt("CanCtrl", "BaudrateVal", &iBaudrateVal, false);
+	if ((iStatistics != 0) && (m_pCanCtrl != NULL))
+	{
+		m_pCanStats = new CanItfStats(m_pCanCtrl, CanItfStats::baudrateValToBitRate(iBaudrateVal));
+		m_pCanCtrl = m_pCanStats;
+	}
+
+	// a SYNC cycle a drive did not answer is published incomplete after this time, see waitForPosVelCycle()
+	int iPosVelCycleTimeoutUs = 10000;
+	m_IniFile.GetKeyInt("TypeCan", "PosVelCycleTimeoutUs", &iPosVelCycleTimeoutUs, false);
+	m_dPosVelCycleTimeoutS = iPosVelCycleTimeoutUs * 1e-6;
 
 	// CanOpenId's ----- Default values (DESIRE)
 	// Wheel 1
@@ -707,6 +826,33 @@ void CanCtrlPltfCOb3::readConfiguration()
 	// read Platform.ini
 	m_IniFile.SetFileName(sIniDirectory + "Platform.ini", "CanCtrlPltfCOb3.cpp");
 
+	// drive type of all motors, the Elmo Harmonica if not given
+	std::string sMotorType;
+	if(m_IniFile.GetKeyString("Config", "MotorType", &sMotorType, false) != 0)
+		sMotorType = "Harmonica";
+	if(sMotorType == "CiA402")
+		m_Param.iMotorType = MOTOR_CIA402;
+	else
+	{
+		if(sMotorType != "Harmonica")
+			std::cout << "Unknown MotorType " << sMotorType << ", using Harmonica" << std::endl;
+		sMotorType = "Harmonica";
+		m_Param.iMotorType = MOTOR_HARMONICA;
+	}
+
+	// supervision of the drives
+	m_IniFile.GetKeyDouble("Config", "HeartbeatPeriod", &m_SupervisorParam.dHeartbeatPeriodS, 0.1, false);
+	m_IniFile.GetKeyDouble("Config", "HeartbeatCmdTimeout", &m_SupervisorParam.dCmdTimeoutS, 0.5, false);
+
+
+	// conversion of all motors in one batch, see publishPltfState() and setVelGearRadS()
+	m_DriveParamSet.resize(m_vpMotor.size());
+	m_viPosMeasIncr.assign(m_vpMotor.size(), 0);
+	m_viVelMeasIncrPeriod.assign(m_vpMotor.size(), 0);
+	m_vdPosGearMeasRad.assign(m_vpMotor.size(), 0);
+	m_vdVelGearMeasRadS.assign(m_vpMotor.size(), 0);
+	m_vdVelCmdGearRadS.assign(m_vpMotor.size(), 0);
+	m_viVelCmdIncrPeriod.assign(m_vpMotor.size(), 0);
 
 	// ------ WHEEL 1 ------ //
 	// --- Motor Wheel 1 Drive
@@ -720,14 +866,14 @@ void CanCtrlPltfCOb3::readConfiguration()
 		}
 		else
 		{
-			// Motor Harmonica
-			std::cout << "Wheel1DriveMotor available = type version 2" << std::endl;
-			m_vpMotor[0] = new CanDriveHarmonica();
-			((CanDriveHarmonica*) m_vpMotor[0])->setCanOpenParam(
+			// Motor Harmonica or CiA 402
+			std::cout << "Wheel1DriveMotor available = type " << sMotorType << std::endl;
+			m_vpMotor[0] = createMotor(
 				m_CanOpenIDParam.TxPDO1_W1Drive, m_CanOpenIDParam.TxPDO2_W1Drive, m_CanOpenIDParam.RxPDO2_W1Drive,
 				m_CanOpenIDParam.TxSDO_W1Drive, m_CanOpenIDParam.RxSDO_W1Drive);
 			m_vpMotor[0]->setCanItf(m_pCanCtrl);
 			m_vpMotor[0]->setDriveParam(DriveParamW1DriveMotor);
+			m_DriveParamSet.setParam(0, DriveParamW1DriveMotor);
 		}
 	}
 
@@ -742,14 +888,14 @@ void CanCtrlPltfCOb3::readConfiguration()
 		}
 		else
 		{
-			// Motor Harmonica
-			std::cout << "Wheel1SteerMotor available = type version 2" << std::endl;
-			m_vpMotor[1] = new CanDriveHarmonica();
-			((CanDriveHarmonica*) m_vpMotor[1])->setCanOpenParam(
+			// Motor Harmonica or CiA 402
+			std::cout << "Wheel1SteerMotor available = type " << sMotorType << std::endl;
+			m_vpMotor[1] = createMotor(
 				m_CanOpenIDParam.TxPDO1_W1Steer, m_CanOpenIDParam.TxPDO2_W1Steer, m_CanOpenIDParam.RxPDO2_W1Steer,
 				m_CanOpenIDParam.TxSDO_W1Steer, m_CanOpenIDParam.RxSDO_W1Steer);
 			m_vpMotor[1]->setCanItf(m_pCanCtrl);
 			m_vpMotor[1]->setDriveParam(DriveParamW1SteerMotor);
+			m_DriveParamSet.setParam(1, DriveParamW1SteerMotor);
 
 		}
 	}
@@ -766,14 +912,14 @@ void CanCtrlPltfCOb3::readConfiguration()
 		}
 		else
 		{
-			// Motor Harmonica
-			std::cout << "Wheel2DriveMotor available = type version 2" << std::endl;
-			m_vpMotor[2] = new CanDriveHarmonica();
-			((CanDriveHarmonica*) m_vpMotor[2])->setCanOpenParam(
+			// Motor Harmonica or CiA 402
+			std::cout << "Wheel2DriveMotor available = type " << sMotorType << std::endl;
+			m_vpMotor[2] = createMotor(
 				m_CanOpenIDParam.TxPDO1_W2Drive, m_CanOpenIDParam.TxPDO2_W2Drive, m_CanOpenIDParam.RxPDO2_W2Drive,
 				m_CanOpenIDParam.TxSDO_W2Drive, m_CanOpenIDParam.RxSDO_W2Drive);
 			m_vpMotor[2]->setCanItf(m_pCanCtrl);
 			m_vpMotor[2]->setDriveParam(DriveParamW2DriveMotor);
+			m_DriveParamSet.setParam(2, DriveParamW2DriveMotor);
 		}
 	}
 
@@ -788,14 +934,14 @@ void CanCtrlPltfCOb3::readConfiguration()
 		}
 		else
 		{
-			// Motor Harmonica
-			std::cout << "Wheel2SteerMotor available = type version 2" << std::endl;
-			m_vpMotor[3] = new CanDriveHarmonica();
-			((CanDriveHarmonica*) m_vpMotor[3])->setCanOpenParam(
+			// Motor Harmonica or CiA 402
+			std::cout << "Wheel2SteerMotor available = type " << sMotorType << std::endl;
+			m_vpMotor[3] = createMotor(
 				m_CanOpenIDParam.TxPDO1_W2Steer, m_CanOpenIDParam.TxPDO2_W2Steer, m_CanOpenIDParam.RxPDO2_W2Steer,
 				m_CanOpenIDParam.TxSDO_W2Steer, m_CanOpenIDParam.RxSDO_W2Steer);
 			m_vpMotor[3]->setCanItf(m_pCanCtrl);
 			m_vpMotor[3]->setDriveParam(DriveParamW2SteerMotor);
+			m_DriveParamSet.setParam(3, DriveParamW2SteerMotor);
 
 		}
 	}
@@ -812,14 +958,14 @@ void CanCtrlPltfCOb3::readConfiguration()
 		}
 		else
 		{
-			// Motor Harmonica
-			std::cout << "Wheel3DriveMotor available = type version 2" << std::endl;
-			m_vpMotor[4] = new CanDriveHarmonica();
-			((CanDriveHarmonica*) m_vpMotor[4])->setCanOpenParam(
+			// Motor Harmonica or CiA 402
+			std::cout << "Wheel3DriveMotor available = type " << sMotorType << std::endl;
+			m_vpMotor[4] = createMotor(
 				m_CanOpenIDParam.TxPDO1_W3Drive, m_CanOpenIDParam.TxPDO2_W3Drive, m_CanOpenIDParam.RxPDO2_W3Drive,
 				m_CanOpenIDParam.TxSDO_W3Drive, m_CanOpenIDParam.RxSDO_W3Drive);
 			m_vpMotor[4]->setCanItf(m_pCanCtrl);
 			m_vpMotor[4]->setDriveParam(DriveParamW3DriveMotor);
+			m_DriveParamSet.setParam(4, DriveParamW3DriveMotor);
 		}
 	}
 
@@ -834,14 +980,14 @@ void CanCtrlPltfCOb3::readConfiguration()
 		}
 		else
 		{
-			// Motor Harmonica
-			std::cout << "Wheel3SteerMotor available = type version 2" << std::endl;
-			m_vpMotor[5] = new CanDriveHarmonica();
-			((CanDriveHarmonica*) m_vpMotor[5])->setCanOpenParam(
+			// Motor Harmonica or CiA 402
+			std::cout << "Wheel3SteerMotor available = type " << sMotorType << std::endl;
+			m_vpMotor[5] = createMotor(
 				m_CanOpenIDParam.TxPDO1_W3Steer, m_CanOpenIDParam.TxPDO2_W3Steer, m_CanOpenIDParam.RxPDO2_W3Steer,
 				m_CanOpenIDParam.TxSDO_W3Steer, m_CanOpenIDParam.RxSDO_W3Steer);
 			m_vpMotor[5]->setCanItf(m_pCanCtrl);
 			m_vpMotor[5]->setDriveParam(DriveParamW3SteerMotor);
+			m_DriveParamSet.setParam(5, DriveParamW3SteerMotor);
 
 		}
 	}
@@ -858,14 +1004,14 @@ void CanCtrlPltfCOb3::readConfiguration()
 		}
 		else
 		{
-			// Motor Harmonica
-			std::cout << "Wheel4DriveMotor available = type version 2" << std::endl;
-			m_vpMotor[6] = new CanDriveHarmonica();
-			((CanDriveHarmonica*) m_vpMotor[6])->setCanOpenParam(
+			// Motor Harmonica or CiA 402
+			std::cout << "Wheel4DriveMotor available = type " << sMotorType << std::endl;
+			m_vpMotor[6] = createMotor(
 				m_CanOpenIDParam.TxPDO1_W4Drive, m_CanOpenIDParam.TxPDO2_W4Drive, m_CanOpenIDParam.RxPDO2_W4Drive,
 				m_CanOpenIDParam.TxSDO_W4Drive, m_CanOpenIDParam.RxSDO_W4Drive);
 			m_vpMotor[6]->setCanItf(m_pCanCtrl);
 			m_vpMotor[6]->setDriveParam(DriveParamW4DriveMotor);
+			m_DriveParamSet.setParam(6, DriveParamW4DriveMotor);
 		}
 	}
 
@@ -880,59 +1026,403 @@ void CanCtrlPltfCOb3::readConfiguration()
 		}
 		else
 		{
-			// Motor Harmonica
-			std::cout << "Wheel4SteerMotor available = type version 2" << std::endl;
-			m_vpMotor[7] = new CanDriveHarmonica();
-			((CanDriveHarmonica*) m_vpMotor[7])->setCanOpenParam(
+			// Motor Harmonica or CiA 402
+			std::cout << "Wheel4SteerMotor available = type " << sMotorType << std::endl;
+			m_vpMotor[7] = createMotor(
 				m_CanOpenIDParam.TxPDO1_W4Steer, m_CanOpenIDParam.TxPDO2_W4Steer, m_CanOpenIDParam.RxPDO2_W4Steer,
 				m_CanOpenIDParam.TxSDO_W4Steer, m_CanOpenIDParam.RxSDO_W4Steer);
 			m_vpMotor[7]->setCanItf(m_pCanCtrl);
 			m_vpMotor[7]->setDriveParam(DriveParamW4SteerMotor);
+			m_DriveParamSet.setParam(7, DriveParamW4SteerMotor);
 
 		}
 	}
 
 	m_IniFile.GetKeyInt("Config", "GenericBufferLen", &iMaxMessages, true);
 
+	// velocity estimation from the positions and reception times of PDO1, the velocity of the drive if not given
+	std::string sVelEstimator;
+	VelEstimator::ParamType VelEstimParam;
+	m_vpVelEstimator.assign(m_vpMotor.size(), NULL);
+	m_vdPosVelTimeS.assign(m_vpMotor.size(), 0);
+	if(m_IniFile.GetKeyString("Config", "VelEstimator", &sVelEstimator, false) == 0)
+	{
+		m_IniFile.GetKeyDouble("Config", "VelEstimAlpha", &VelEstimParam.dAlpha, 0.5, false);
+		m_IniFile.GetKeyDouble("Config", "VelEstimBeta", &VelEstimParam.dBeta, 0.17, false);
+		m_IniFile.GetKeyDouble("Config", "VelEstimAccNoise", &VelEstimParam.dAccNoise, 1.0, false);
+		m_IniFile.GetKeyDouble("Config", "VelEstimPosNoise", &VelEstimParam.dPosNoise, 0.0, false);
+
+		for(unsigned int i = 0; i < m_vpMotor.size(); i++)
+		{
+			// default: one encoder increment
+			VelEstimator::ParamType ParamMotor = VelEstimParam;
+			if(ParamMotor.dPosNoise <= 0)
+				ParamMotor.dPosNoise = fabs(m_DriveParamSet.getPosIncrToGearRad(i));
+
+			m_vpVelEstimator[i] = VelEstimator::create(sVelEstimator, ParamMotor);
+		}
+
+		if(m_vpVelEstimator.empty() || (m_vpVelEstimator[0] != NULL))
+			std::cout << "Velocity estimator " << sVelEstimator << std::endl;
+		else
+			std::cout << "Unknown VelEstimator " << sVelEstimator << ", using the velocity of the drives" << std::endl;
+	}
+
+	// telemetry stream, mapped by the initialization of the drives
+	for(unsigned int i = 0; i < m_vpMotor.size(); i++)
+	{
+		if(m_vpMotor[i] != NULL)
+			m_vpMotor[i]->setTelemetry(m_bTelemetry);
+	}
+
+	// attach a simulated drive to the dummy bus for every configured motor
+	if (pCanDummy != NULL)
+	{
+		for(unsigned int i = 0; i < m_vpMotor.size(); i++)
+		{
+			if(m_vpMotor[i] == NULL)
+				continue;
+
+			if(m_Param.iMotorType == MOTOR_CIA402)
+				pCanDummy->addNode(new CanDriveHarmonicaSim(((CanDrive402*) m_vpMotor[i])->getCanOpenParam()));
+			else
+				pCanDummy->addNode(new CanDriveHarmonicaSim(((CanDriveHarmonica*) m_vpMotor[i])->getCanOpenParam()));
+		}
+	}
+
+	buildCanIDDispatchTable();
+
+	// latency of each drive: interpreter command -> reply, SDO request -> response, SYNC -> PDO1
+	if (m_pCanStats != NULL)
+	{
+		for(unsigned int i = 0; i < m_vpMotor.size(); i++)
+		{
+			if(m_vpMotor[i] == NULL)
+				continue;
+
+			std::ostringstream sName;
+			sName << "Wheel" << (i / 2 + 1) << ((i % 2 == 0) ? "Drive" : "Steer");
 
+			int iChannel = m_pCanStats->addLatencyChannel(sName.str());
+			if(m_Param.iMotorType == MOTOR_CIA402)
+			{
+				// no interpreter, the drive is commanded by RxPDO1 which is not answered
+				const CanDrive402::ParamCanOpenType& CanOpenParam =
+					((CanDrive402*) m_vpMotor[i])->getCanOpenParam();
+				m_pCanStats->addRequestResponse(iChannel, CanOpenParam.iRxSDO, CanOpenParam.iTxSDO);
+				m_pCanStats->addRequestResponse(iChannel, 0x80, CanOpenParam.iTxPDO1);
+			}
+			else
+			{
+				const CanDriveHarmonica::ParamCanOpenType& CanOpenParam =
+					((CanDriveHarmonica*) m_vpMotor[i])->getCanOpenParam();
+				m_pCanStats->addRequestResponse(iChannel, CanOpenParam.iRxPDO2, CanOpenParam.iTxPDO2);
+				m_pCanStats->addRequestResponse(iChannel, CanOpenParam.iRxSDO, CanOpenParam.iTxSDO);
+				m_pCanStats->addRequestResponse(iChannel, 0x80, CanOpenParam.iTxPDO1);
+			}
+		}
+	}
+
+	return true;
+}
+
+//-----------------------------------------------
+CanDriveItf* CanCtrlPltfCOb3::createMotor(int iTxPDO1, int iTxPDO2, int iRxPDO2, int iTxSDO, int iRxSDO)
+{
+	if(m_Param.iMotorType == MOTOR_CIA402)
+	{
+		CanDrive402* pMotor = new CanDrive402();
+		pMotor->setCanOpenParam(iTxPDO1, iTxPDO2, iRxPDO2, iTxSDO, iRxSDO);
+		return pMotor;
+	}
+
+	CanDriveHarmonica* pMotor = new CanDriveHarmonica();
+	pMotor->setCanOpenParam(iTxPDO1, iTxPDO2, iRxPDO2, iTxSDO, iRxSDO);
+	return pMotor;
 }
 
 //-----------------------------------------------
 int CanCtrlPltfCOb3::evalCanBuffer()
 {
-	bool bRet;
+	int iNumMsgs;
 //	char cBuf[200];
 
 	m_Mutex.lock();
 
-	// as long as there is something in the can buffer -> read out next message
-	while(m_pCanCtrl->receiveMsg(&m_CanMsgRec) == true)
+	// as long as there is something in the can buffer -> read out all pending messages at once
+	do
+	{
+		iNumMsgs = m_pCanCtrl->receiveMsgs(&m_vCanMsgRecBuf[0], m_vCanMsgRecBuf.size());
+		dispatchMsgs(m_vCanMsgRecBuf, iNumMsgs);
+	}
+	// a full buffer means there might be more messages waiting
+	while(iNumMsgs == (int)m_vCanMsgRecBuf.size());
+
+	checkPosVelCycleTimeout();
+	processSDOs();
+
+	m_Mutex.unlock();
+
+	return 0;
+}
+
+//-----------------------------------------------
+bool CanCtrlPltfCOb3::waitForPosVelCycle(int iTimeoutUs)
+{
+	TimeStamp StartTime, Now;
+	int iNumMsgs;
+	int iRemainingUs = iTimeoutUs;
+	bool bComplete;
+
+	StartTime.SetNow();
+
+	do
+	{
+		// the receive is serialized with evalCanBuffer() and the command senders by m_Mutex,
+		// which is held for one slice of the timeout at most so commands are not delayed for long;
+		// returns as soon as a message arrived
+		m_Mutex.lock();
+		iNumMsgs = m_pCanCtrl->receiveMsgs(&m_vCanMsgRecBuf[0], m_vCanMsgRecBuf.size(),
+			(iRemainingUs < c_iWaitSliceUs) ? iRemainingUs : c_iWaitSliceUs);
+		dispatchMsgs(m_vCanMsgRecBuf, iNumMsgs);
+		checkPosVelCycleTimeout();
+		processSDOs();
+		bComplete = m_bPosVelCycleComplete;
+		m_bPosVelCycleComplete = false;
+		m_Mutex.unlock();
+
+		if (bComplete)
+			return true;
+
+		Now.SetNow();
+		iRemainingUs = iTimeoutUs - (int)((Now - StartTime) * 1e6);
+	}
+	while (iRemainingUs > 0);
+
+	return false;
+}
+
+//-----------------------------------------------
+void CanCtrlPltfCOb3::dispatchMsgs(std::vector<CanMsg>& vCanMsgs, int iNumMsgs)
+{
+	bool bRet;
+	int iID;
+	int iMotor;
+
+	for (int j = 0; j < iNumMsgs; j++)
 	{
 		bRet = false;
-		// check for every motor if message belongs to it
-		for (unsigned int i = 0; i < m_vpMotor.size(); i++)
+		// look up the motor the message belongs to and let it write data (Pos, Vel, ...) to its internal member vars
+		iID = vCanMsgs[j].m_iID;
+		iMotor = ((iID >= 0) && (iID < c_iNumCanIDs)) ? m_viCanIDToMotor[iID] : -1;
+		if (iMotor >= 0)
 		{
-			// if message belongs to this motor write data (Pos, Vel, ...) to internal member vars
-			bRet |= m_vpMotor[i]->evalReceivedMsg(m_CanMsgRec);
+			bRet = m_vpMotor[iMotor]->evalReceivedMsg(vCanMsgs[j]);
 		}
 
+		// count messages with unknown identifier (printing them here would slow down the control loop)
 		if (bRet == false)
 		{
-			std::cout << "evalCanBuffer(): Received CAN_Message with unknown identifier " << m_CanMsgRec.m_iID << std::endl;
+			m_iNumUnknownCanMsgs++;
+			continue;
 		}
-	};
 
+		// every message is a sign of life of the drive
+		m_DriveSupervisor.notifyRx(iMotor);
 
-	m_Mutex.unlock();
+		// the cycle is complete when the last drive answered the SYNC
+		if (m_vbCanIDIsPosVel[iID])
+		{
+			long lSec, lNSec;
 
-	return 0;
+			// a drive answering twice answers the next SYNC, so another drive missed the current one
+			if (m_iPosVelReceived & (1u << iMotor))
+				closePosVelCycle();
+
+			if (m_iPosVelReceived == 0)
+				m_PosVelCycleStart.SetNow();
+
+			// reception time of the position (for the velocity estimation and the time of the cycle)
+			if (vCanMsgs[j].hasTimeStamp())
+				vCanMsgs[j].getTimeStamp(lSec, lNSec);
+			else
+			{
+				TimeStamp Now;
+				Now.SetNow();
+				Now.getTimeStamp(lSec, lNSec);
+			}
+			m_vdPosVelTimeS[iMotor] = lSec + lNSec * 1e-9;
+			m_dPosVelCycleTimeS = m_vdPosVelTimeS[iMotor];
+
+			m_iPosVelReceived |= 1u << iMotor;
+			if (m_iPosVelReceived == m_iPosVelAllMotors)
+				closePosVelCycle();
+		}
+	}
+}
+
+//-----------------------------------------------
+void CanCtrlPltfCOb3::closePosVelCycle()
+{
+	if (m_iPosVelReceived == 0)
+		return;
+
+	if (m_iPosVelReceived == m_iPosVelAllMotors)
+	{
+		m_bPosVelCycleComplete = true;
+		m_iNumPosVelCycles++;
+	}
+	else
+		m_iNumIncompletePosVelCycles++;
+
+	publishPltfState();
+	m_iPosVelReceived = 0;
+}
+
+//-----------------------------------------------
+void CanCtrlPltfCOb3::checkPosVelCycleTimeout()
+{
+	TimeStamp Now;
+
+	if (m_iPosVelReceived == 0)
+		return;
+
+	Now.SetNow();
+	if ((Now - m_PosVelCycleStart) > m_dPosVelCycleTimeoutS)
+		closePosVelCycle();
+}
+
+//-----------------------------------------------
+void CanCtrlPltfCOb3::publishPltfState()
+{
+	int iNumMotors = std::min<int>(m_vpMotor.size(), c_iMaxNumMotors);
+
+	m_PltfStateWrite.iCycle = m_iNumPosVelCycles + m_iNumIncompletePosVelCycles;
+	m_PltfStateWrite.dTimeS = m_dPosVelCycleTimeS;
+	m_PltfStateWrite.iMotorsReceived = m_iPosVelReceived;
+	m_PltfStateWrite.bComplete = (m_iPosVelReceived == m_iPosVelAllMotors);
+
+	// positions and velocities of all motors are converted in one batch
+	for(unsigned int i = 0; i < m_vpMotor.size(); i++)
+		m_vpMotor[i]->getMotPosVelIncr(&m_viPosMeasIncr[i], &m_viVelMeasIncrPeriod[i]);
+	m_DriveParamSet.convertPosVel(&m_viPosMeasIncr[0], &m_viVelMeasIncrPeriod[0],
+		&m_vdPosGearMeasRad[0], &m_vdVelGearMeasRadS[0]);
+
+	for(int i = 0; i < iNumMotors; i++)
+	{
+		DriveState& Drive = m_PltfStateWrite.Drive[i];
+
+		// a motor that did not answer keeps the state of its last cycle
+		if ((m_iPosVelReceived & (1u << i)) == 0)
+			continue;
+
+		Drive.dPosGearRad = m_vdPosGearMeasRad[i];
+		if (m_vpVelEstimator[i] != NULL)
+			Drive.dVelGearRadS = m_vpVelEstimator[i]->update(m_vdPosGearMeasRad[i], m_vdPosVelTimeS[i]);
+		else
+			Drive.dVelGearRadS = m_vdVelGearMeasRadS[i];
+		m_vpMotor[i]->getMotorTorque(&Drive.dTorqueNm);
+		m_vpMotor[i]->getStatus(&Drive.iStatus, &Drive.iTempCel);
+	}
+
+	m_PltfState.write(m_PltfStateWrite);
+}
+
+//-----------------------------------------------
+void CanCtrlPltfCOb3::processSDOs()
+{
+	m_iNumPendingSDOs = 0;
+
+	for (unsigned int i = 0; i < m_vpMotor.size(); i++)
+	{
+		m_iNumPendingSDOs += m_vpMotor[i]->processSDOs();
+	}
+}
+
+//-----------------------------------------------
+bool CanCtrlPltfCOb3::waitForSDOs(double dTimeoutS)
+{
+	TimeStamp StartTime, Now;
+	int iNumPending;
+
+	StartTime.SetNow();
+
+	while (true)
+	{
+		evalCanBuffer();
+
+		m_Mutex.lock();
+		iNumPending = m_iNumPendingSDOs;
+		m_Mutex.unlock();
+
+		if (iNumPending == 0)
+			return true;
+
+		Now.SetNow();
+		if ((Now - StartTime) > dTimeoutS)
+			break;
+
+		usleep(1000);
+	}
+
+	std::cout << "Timeout while waiting for " << iNumPending << " SDO transfers" << std::endl;
+	return false;
+}
+
+//-----------------------------------------------
+void CanCtrlPltfCOb3::buildCanIDDispatchTable()
+{
+	std::vector<int> viCanIDs;
+	std::vector<int> viFilterIDs;
+
+	m_viCanIDToMotor.assign(c_iNumCanIDs, -1);
+	m_vbCanIDIsPosVel.assign(c_iNumCanIDs, false);
+	m_iPosVelReceived = 0;
+	m_iPosVelAllMotors = 0;
+
+	for (unsigned int i = 0; i < m_vpMotor.size(); i++)
+	{
+		if (m_vpMotor[i] == NULL)
+			continue;
+
+		int iPosVelCanID = m_vpMotor[i]->getPosVelCanID();
+		if ((iPosVelCanID >= 0) && (iPosVelCanID < c_iNumCanIDs))
+		{
+			m_vbCanIDIsPosVel[iPosVelCanID] = true;
+			m_iPosVelAllMotors |= 1u << i;
+		}
+
+		viCanIDs.clear();
+		m_vpMotor[i]->getRxCanIDs(viCanIDs);
+
+		for (unsigned int j = 0; j < viCanIDs.size(); j++)
+		{
+			if ((viCanIDs[j] < 0) || (viCanIDs[j] >= c_iNumCanIDs))
+			{
+				std::cout << "buildCanIDDispatchTable(): invalid CAN identifier " << viCanIDs[j] << " of motor " << i << std::endl;
+				continue;
+			}
+			if (m_viCanIDToMotor[viCanIDs[j]] >= 0)
+			{
+				std::cout << "buildCanIDDispatchTable(): CAN identifier " << viCanIDs[j] << " used by motor "
+					<< m_viCanIDToMotor[viCanIDs[j]] << " and " << i << std::endl;
+			}
+			m_viCanIDToMotor[viCanIDs[j]] = i;
+			viFilterIDs.push_back(viCanIDs[j]);
+		}
+	}
+
+	// messages of other nodes are discarded by the driver / kernel if the interface supports it
+	if ((m_pCanCtrl != NULL) && m_pCanCtrl->setFilter(viFilterIDs))
+		std::cout << "CAN receive filter set to " << viFilterIDs.size() << " identifiers of the drives" << std::endl;
 }
 
 //-----------------------------------------------
 bool CanCtrlPltfCOb3::initPltf()
 {
 	// read Configuration parameters from Inifile
-	readConfiguration();
+	if (!readConfiguration())
+		return false;
 
 	// Vectors for drive objects and return values
 	std::vector<bool> vbRetDriveMotor;
@@ -986,7 +1476,7 @@ bool CanCtrlPltfCOb3::initPltf()
 	m_vpMotor[6]->startWatchdog(true);
 	m_vpMotor[7]->startWatchdog(true);
 */
-	usleep(10000);
+	waitForSDOs(1.0);
 
 	// 2nd send watchdogs to bed while initializing drives
 	for(int i=0; i<m_iNumMotors; i++)
@@ -1002,7 +1492,7 @@ bool CanCtrlPltfCOb3::initPltf()
 	m_vpMotor[6]->startWatchdog(false);
 	m_vpMotor[7]->startWatchdog(false);
 */
-	usleep(100000);
+	waitForSDOs(1.0);
 
 	std::cout << "Initialization of Watchdogs done" << std::endl;
 
@@ -1012,25 +1502,24 @@ bool CanCtrlPltfCOb3::initPltf()
 	// o.k. to avoid crashing hardware -> lets check that we have at least the 8 motors, like we have on cob
 	if( (int)m_vpMotor.size() == m_iNumMotors )
 	{
-		// Initialize and start all motors
+		// Initialize and start all motors at the same time
+		initMotors();
+
 		for (int i = 0; i<m_iNumDrives; i++)
 		{
-			// init + start
-			vbRetDriveMotor[i] = vpDriveMotor[i]->init();
-			vbRetSteerMotor[i] = vpSteerMotor[i]->init();
-			usleep(10000);
-			vbRetDriveMotor[i] = vbRetDriveMotor[i] && vpDriveMotor[i]->start();
-			vbRetSteerMotor[i] = vbRetSteerMotor[i] && vpSteerMotor[i]->start();
-			usleep(10000);
+			vbRetDriveMotor[i] = (vpDriveMotor[i]->processInit() == CanDriveItf::INIT_DONE);
+			vbRetSteerMotor[i] = (vpSteerMotor[i]->processInit() == CanDriveItf::INIT_DONE);
 			// output State / Errors
 			if (vbRetDriveMotor[i] && vbRetSteerMotor[i])
-				std::cout << "Initialization of Wheel "<< (i+1) << " OK" << std::endl;
+				std::cout << "Initialization of Wheel "<< (i+1) << " OK";
 			else if (!vbRetDriveMotor[i] && vbRetSteerMotor[i])
-				std::cout << "Initialization of Wheel "<< (i+1) << " ERROR while initializing DRIVE-Motor" << std::endl;
+				std::cout << "Initialization of Wheel "<< (i+1) << " ERROR while initializing DRIVE-Motor";
 			else if (vbRetDriveMotor[i] && !vbRetSteerMotor[i])
-				std::cout << "Initialization of Wheel "<< (i+1) << " ERROR while initializing STEER-Motor" << std::endl;
+				std::cout << "Initialization of Wheel "<< (i+1) << " ERROR while initializing STEER-Motor";
 			else
-				std::cout << "Initialization of Wheel "<< (i+1) << " ERROR while initializing STEER- and DRIVE-Motor" << std::endl;
+				std::cout << "Initialization of Wheel "<< (i+1) << " ERROR while initializing STEER- and DRIVE-Motor";
+			std::cout << " (drive " << vpDriveMotor[i]->getInitDurationS() << " s, steer "
+				<< vpSteerMotor[i]->getInitDurationS() << " s)" << std::endl;
 			// Just to be sure: Set vel to zero
 			vpDriveMotor[i]->setGearVelRadS(0);
 			vpSteerMotor[i]->setGearVelRadS(0);
@@ -1057,121 +1546,8 @@ bool CanCtrlPltfCOb3::initPltf()
 			if(m_iNumDrives == 4)
 				vdFactorVel[3] = - m_Param.dWheel4SteerDriveCoupling + double(m_Param.iDistSteerAxisToDriveWheelMM) / double(m_Param.iRadiusWheelMM);
 
-			// initialize homing procedure
-			for (int i = 0; i<m_iNumDrives; i++)
-				vpSteerMotor[i]->initHoming();
-
-			// make motors move
-			for (int i = 0; i<m_iNumDrives; i++)
-			{
-				vpSteerMotor[i]->setGearVelRadS(m_Param.dHomeVeloRadS);
-				vpDriveMotor[i]->setGearVelRadS(m_Param.dHomeVeloRadS * vdFactorVel[i]);
-			}
-
-			// wait at least 0.5 sec.
-			usleep(500000);
-
-			// Get rid of unnecessary can messages
-			bool bRet;
-			do
-				bRet = m_pCanCtrl->receiveMsg(&m_CanMsgRec);
-			while(bRet == true);
-
-			// arm homing procedure
-			for (int i = 0; i<m_iNumDrives; i++)
-				vpSteerMotor[i]->IntprtSetInt(8, 'H', 'M', 1, 1);
-
-			// wait until all steers are homed
-			bool bAllDone, bTimeOut=false;
-			int iCnt = 0;
-			do
-			{
-				// send request for homing status
-				for (int i = 0; i<m_iNumDrives; i++)
-					vpSteerMotor[i]->IntprtSetInt(4, 'H', 'M', 1, 0);
-
-				// eval Can Messages
-				evalCanBuffer();
-
-				// set already homed wheels to zero velocity
-				bAllDone = true;
-				for (int i = 0; i<m_iNumDrives; i++)
-				{
-					if (vpSteerMotor[i]->getStatusLimitSwitch())
-					{
-						vpSteerMotor[i]->setGearVelRadS(0);
-						vpDriveMotor[i]->setGearVelRadS(0);
-					}
-					bAllDone = bAllDone && vpSteerMotor[i]->getStatusLimitSwitch();
-				}
-
-				// increment timeout counter
-				if (iCnt++ > 1000) //cpc-ck has 500 for Cob 3.5 here
-					bTimeOut = true;
-
-				// Sleep: To avoid can overload
-			usleep(20000);
-			}
-			while(!bAllDone && !bTimeOut);
-
-			// Output State
-			if (bTimeOut)
-			{
-				for (int i=0;i<m_iNumDrives;i++)
-				{
-					vpSteerMotor[i]->setGearVelRadS(0);
-					vpDriveMotor[i]->setGearVelRadS(0);
-				}
-				std::cout << "Error while Homing: Timeout while waiting for homing signal" << std::endl;
-			}
-
-			// update Can Buffer once more
-			// read current can buffer and update position and velocity measurements
-			evalCanBuffer();
-
-			// Now make steers move to position: zero
-			// this could be handled also by the elmos themselve
-			// however this way synchronization of steering and driving is better
-			double m_d0 = 2.5;
-			if (bTimeOut == false)
-			{
-				do
-				{
-					bAllDone = true;
-					for (int i = 0; i<m_iNumDrives; i++)
-					{
-						// get current position of steer
-						double dCurrentPosRad;
-						vpSteerMotor[i]->getGearPosRad(&dCurrentPosRad);
-						// P-Ctrl
-						double dDeltaPhi = 0.0 - dCurrentPosRad;
-						// check if steer is at pos zero
-						if (fabs(dDeltaPhi) < 0.03)	//alter Wert=0.03
-						{
-							dDeltaPhi = 0.0;
-						}
-						else
-						{
-							bAllDone = false;
-						}
-						double dVelCmd = m_d0 * dDeltaPhi;
-						// set Outputs
-						vpSteerMotor[i]->setGearVelRadS(dVelCmd);
-						vpDriveMotor[i]->setGearVelRadS(dVelCmd*vdFactorVel[i]);
-					}
-					usleep(20000);
-					evalCanBuffer();
-				} while(!bAllDone);
-
-
-				// Homing done. Wheels at position zero (+/- 0.5°)
-				std::cout << "Wheels homed" << std::endl;
-				for (int i=0;i<m_iNumDrives;i++)
-				{
-					vpSteerMotor[i]->setGearVelRadS(0);
-					vpDriveMotor[i]->setGearVelRadS(0);
-				}
-			}
+			// each wheel is homed and turned to position zero on its own
+			bHomingOk = homeWheels(vpDriveMotor, vpSteerMotor, vdFactorVel);
 		}
 	}
 	// ---------------------- end homing procedure
@@ -1190,6 +1566,26 @@ bool CanCtrlPltfCOb3::initPltf()
 	m_vpMotor[6]->startWatchdog(true);
 	m_vpMotor[7]->startWatchdog(true);
 */
+	waitForSDOs(1.0);
+
+	// from now on the heartbeat is produced by the supervision, as long as velocities are commanded
+	m_Mutex.lock();
+	for(unsigned int i = 0; i < m_vpMotor.size(); i++)
+	{
+		m_vpMotor[i]->setHeartbeatProducer(false);
+	}
+	m_Mutex.unlock();
+	m_DriveSupervisor.start(m_pCanCtrl, m_vpMotor, &m_Mutex, m_SupervisorParam);
+
+	// homing moved the positions
+	m_Mutex.lock();
+	for(unsigned int i = 0; i < m_vpVelEstimator.size(); i++)
+	{
+		if(m_vpVelEstimator[i] != NULL)
+			m_vpVelEstimator[i]->reset();
+	}
+	m_Mutex.unlock();
+
 //	return  (
 //		vbRetDriveMotor[0] && vbRetDriveMotor[1] && vbRetDriveMotor[2] && vbRetDriveMotor[3] &&
 //		vbRetSteerMotor[0] && vbRetSteerMotor[1] && vbRetSteerMotor[2] && vbRetSteerMotor[3]);
@@ -1204,6 +1600,222 @@ bool CanCtrlPltfCOb3::initPltf()
 	return (bHomingOk);
 }
 
+//-----------------------------------------------
+void CanCtrlPltfCOb3::initMotors()
+{
+	TimeStamp StartTime, Now;
+	bool bAllDone;
+
+	StartTime.SetNow();
+
+	m_Mutex.lock();
+	for (int i = 0; i < m_iNumMotors; i++)
+		m_vpMotor[i]->beginInit();
+	m_Mutex.unlock();
+
+	// the motors advance on the answers received here,
+	// each step has its own timeout so the loop ends even if a motor does not answer
+	do
+	{
+		evalCanBuffer();
+
+		bAllDone = true;
+		m_Mutex.lock();
+		for (int i = 0; i < m_iNumMotors; i++)
+		{
+			if (m_vpMotor[i]->processInit() == CanDriveItf::INIT_BUSY)
+				bAllDone = false;
+		}
+		m_Mutex.unlock();
+
+		if (!bAllDone)
+			usleep(1000);
+	}
+	while (!bAllDone);
+
+	Now.SetNow();
+	std::cout << "Initialization of all motors took " << (Now - StartTime) << " s" << std::endl;
+}
+
+//-----------------------------------------------
+bool CanCtrlPltfCOb3::homeWheels(std::vector<CanDriveItf*>& vpDriveMotor, std::vector<CanDriveItf*>& vpSteerMotor,
+	std::vector<double>& vdFactorVel)
+{
+	// time the wheel turns before homing is armed, to escape the homing switch if it is in home position already
+	const double c_dEscapeTimeS = 0.5;
+	const double c_dHomingTimeoutS = 20.0;
+	// period of the homing status requests and velocity commands, to avoid can overload
+	const double c_dCycleTimeS = 0.02;
+	// P-Ctrl to position zero
+	const double c_dGainPosCtrl = 2.5;
+	const double c_dMaxErrPosRad = 0.03;
+
+	std::vector<int> viState(m_iNumDrives, HOMING_CONFIG);
+	std::vector<TimeStamp> vStateTime(m_iNumDrives);
+	std::vector<double> vdDurationS(m_iNumDrives, 0.0);
+	TimeStamp StartTime, Now, LastCycle;
+	bool bCycle, bAllDone, bRet;
+	int iInitState;
+	double dCurrentPosRad, dDeltaPhi, dVelCmd;
+
+	StartTime.SetNow();
+	LastCycle = StartTime;
+
+	// initialize homing procedure
+	m_Mutex.lock();
+	for (int i = 0; i < m_iNumDrives; i++)
+	{
+		vpSteerMotor[i]->beginInitHoming();
+		vStateTime[i] = StartTime;
+	}
+	m_Mutex.unlock();
+
+	do
+	{
+		// eval Can Messages
+		evalCanBuffer();
+
+		Now.SetNow();
+		bCycle = ((Now - LastCycle) >= c_dCycleTimeS);
+		if (bCycle)
+			LastCycle = Now;
+
+		bAllDone = true;
+		for (int i = 0; i < m_iNumDrives; i++)
+		{
+			switch (viState[i])
+			{
+			case HOMING_CONFIG:
+				m_Mutex.lock();
+				iInitState = vpSteerMotor[i]->processInit();
+				m_Mutex.unlock();
+
+				if (iInitState == CanDriveItf::INIT_DONE)
+				{
+					// make motors move
+					vpSteerMotor[i]->setGearVelRadS(m_Param.dHomeVeloRadS);
+					vpDriveMotor[i]->setGearVelRadS(m_Param.dHomeVeloRadS * vdFactorVel[i]);
+					vStateTime[i] = Now;
+					viState[i] = HOMING_ESCAPE;
+				}
+				else if (iInitState == CanDriveItf::INIT_FAILED)
+				{
+					viState[i] = HOMING_FAILED;
+				}
+				break;
+
+			case HOMING_ESCAPE:
+				if ((Now - vStateTime[i]) >= c_dEscapeTimeS)
+				{
+					// arm homing procedure
+					vpSteerMotor[i]->armHoming();
+					vStateTime[i] = Now;
+					viState[i] = HOMING_ARMED;
+				}
+				break;
+
+			case HOMING_ARMED:
+				if (vpSteerMotor[i]->getStatusLimitSwitch())
+				{
+					// Now make steer move to position: zero
+					// this could be handled also by the elmos themselve
+					// however this way synchronization of steering and driving is better
+					vpSteerMotor[i]->setGearVelRadS(0);
+					vpDriveMotor[i]->setGearVelRadS(0);
+					vStateTime[i] = Now;
+					viState[i] = HOMING_TO_ZERO;
+				}
+				else if ((Now - vStateTime[i]) > c_dHomingTimeoutS)
+				{
+					std::cout << "Error while Homing: Timeout while waiting for homing signal of wheel " << (i+1) << std::endl;
+					viState[i] = HOMING_FAILED;
+				}
+				else if (bCycle)
+				{
+					// send request for homing status
+					vpSteerMotor[i]->requestHomingStatus();
+				}
+				break;
+
+			case HOMING_TO_ZERO:
+				if (!bCycle)
+					break;
+
+				// get current position of steer
+				vpSteerMotor[i]->getGearPosRad(&dCurrentPosRad);
+				// P-Ctrl
+				dDeltaPhi = 0.0 - dCurrentPosRad;
+				// check if steer is at pos zero
+				if (fabs(dDeltaPhi) < c_dMaxErrPosRad)
+				{
+					vpSteerMotor[i]->setGearVelRadS(0);
+					vpDriveMotor[i]->setGearVelRadS(0);
+					vdDurationS[i] = Now - StartTime;
+					viState[i] = HOMING_DONE;
+				}
+				else if ((Now - vStateTime[i]) > c_dHomingTimeoutS)
+				{
+					std::cout << "Error while Homing: Timeout while turning wheel " << (i+1) << " to position zero" << std::endl;
+					viState[i] = HOMING_FAILED;
+				}
+				else
+				{
+					dVelCmd = c_dGainPosCtrl * dDeltaPhi;
+					// set Outputs
+					vpSteerMotor[i]->setGearVelRadS(dVelCmd);
+					vpDriveMotor[i]->setGearVelRadS(dVelCmd*vdFactorVel[i]);
+				}
+				break;
+
+			default:
+				break;
+			}
+
+			if (viState[i] == HOMING_FAILED)
+			{
+				vpSteerMotor[i]->setGearVelRadS(0);
+				vpDriveMotor[i]->setGearVelRadS(0);
+				vdDurationS[i] = Now - StartTime;
+				viState[i] = HOMING_STOPPED;
+			}
+
+			if (viState[i] != HOMING_DONE && viState[i] != HOMING_STOPPED)
+				bAllDone = false;
+		}
+
+		if (!bAllDone)
+			usleep(1000);
+	}
+	while (!bAllDone);
+
+	// Output State
+	bRet = true;
+	for (int i = 0; i < m_iNumDrives; i++)
+	{
+		if (viState[i] == HOMING_DONE)
+			std::cout << "Wheel " << (i+1) << " homed in " << vdDurationS[i] << " s" << std::endl;
+		else
+		{
+			std::cout << "Homing of wheel " << (i+1) << " failed after " << vdDurationS[i] << " s" << std::endl;
+			bRet = false;
+		}
+	}
+
+	// Homing done. Wheels at position zero (+/- 0.5°)
+	if (bRet)
+		std::cout << "Wheels homed" << std::endl;
+
+	return bRet;
+}
+
+//-----------------------------------------------
+void CanCtrlPltfCOb3::initPltfPassive(CanItf* pCanItf)
+{
+	m_pCanCtrl = pCanItf;
+
+	readConfiguration();
+}
+
 //-----------------------------------------------
 bool CanCtrlPltfCOb3::resetPltf()
 {
@@ -1230,6 +1842,7 @@ bool CanCtrlPltfCOb3::resetPltf()
 //-----------------------------------------------
 bool CanCtrlPltfCOb3::shutdownPltf()
 {
+	m_DriveSupervisor.stop();
 
 	for(unsigned int i = 0; i < m_vpMotor.size(); i++)
 	{
@@ -1242,53 +1855,8 @@ bool CanCtrlPltfCOb3::shutdownPltf()
 //-----------------------------------------------
 bool CanCtrlPltfCOb3::isPltfError()
 {
-
-	bool bErrMotor = false;
-	std::vector<bool> vbErrMotor;
-	vbErrMotor.resize(m_vpMotor.size());
-
-	// check all motors for errors
-	for(unsigned int i = 0; i < m_vpMotor.size(); i++)
-	{
-		vbErrMotor[i] = m_vpMotor[i]->isError();
-		// if watchdog is not yet in error state but one motor is errorneous Log Out Error-Msg
-		if( (m_bWatchdogErr == false) && (vbErrMotor[i] == true) )
-		{
-			std::cout << "Motor " << i << " error" << std::endl;
-		}
-		// check whether no motor was errorneous
-		bErrMotor |= vbErrMotor[i];
-	}
-
-	// if no motor is in error state force Watchdog to "No Error" state
-	if(bErrMotor == false)
-		m_bWatchdogErr = false;
-	else
-		m_bWatchdogErr = true;
-
-	if (m_bWatchdogErr) return true;
-
-
-	// Check communication
-	double dWatchTime = 0;
-
-	for(unsigned int i = 0; i < m_vpMotor.size(); i++)
-	{
-		dWatchTime = m_vpMotor[i]->getTimeToLastMsg();
-
-		if(dWatchTime <  m_Param.dCanTimeout)
-		{
-			m_bWatchdogErr = false;
-		}
-		if( (dWatchTime > m_Param.dCanTimeout) && (m_bWatchdogErr == false) )
-		{
-			std::cout << "timeout CAN motor " << i << std::endl;
-			m_bWatchdogErr = true;
-			return true;
-		}
-	}
-
-	return false;
+	// motor errors and CAN timeouts are detected (and logged) by the supervision thread
+	return m_DriveSupervisor.isError();
 }
 
 //-----------------------------------------------
@@ -1329,12 +1897,13 @@ int CanCtrlPltfCOb3::setVelGearRadS(int iCanIdent, double dVelGearRadS)
 {
 	m_Mutex.lock();
 
-	// If an error was detected and processed in isPltfErr().
-	if (m_bWatchdogErr == true)
+	m_DriveSupervisor.notifyCmd();
+
+	// If an error was detected by the supervision (see isPltfErr()).
+	if (m_DriveSupervisor.isError())
 	{
 		// Error -> Stop motor driving
 		dVelGearRadS = 0;
-		// The error is detected and quitted in the funtion isPltfErr().
 	}
 
 	for(unsigned int i = 0; i < m_vpMotor.size(); i++)
@@ -1351,6 +1920,70 @@ int CanCtrlPltfCOb3::setVelGearRadS(int iCanIdent, double dVelGearRadS)
 	return 0;
 }
 
+//-----------------------------------------------
+int CanCtrlPltfCOb3::setVelGearRadS(const std::vector<double>& vdVelGearRadS)
+{
+	unsigned int iNumMotors = std::min(vdVelGearRadS.size(), m_vpMotor.size());
+
+	bool bErr = m_DriveSupervisor.isError();
+
+	m_Mutex.lock();
+
+	m_DriveSupervisor.notifyCmd();
+
+	for(unsigned int i = 0; i < iNumMotors; i++)
+	{
+		// stop motor driving if an error was detected by the supervision (see isPltfErr())
+		m_vdVelCmdGearRadS[i] = bErr ? 0 : vdVelGearRadS[i];
+	}
+
+	m_DriveParamSet.convertVelCmd(&m_vdVelCmdGearRadS[0], &m_viVelCmdIncrPeriod[0]);
+
+	for(unsigned int i = 0; i < iNumMotors; i++)
+	{
+		m_vpMotor[i]->setMotVelIncrPeriod(m_viVelCmdIncrPeriod[i]);
+	}
+
+	m_Mutex.unlock();
+
+	return 0;
+}
+
+//-----------------------------------------------
+void CanCtrlPltfCOb3::beginCmdBatch()
+{
+	m_Mutex.lock();
+	m_pCanCtrl->beginBatch();
+	m_Mutex.unlock();
+}
+
+//-----------------------------------------------
+int CanCtrlPltfCOb3::flushCmdBatch()
+{
+	int iNumMsgs;
+	bool bSyncSent;
+
+	m_Mutex.lock();
+	iNumMsgs = m_pCanCtrl->flush(&bSyncSent);
+	// the drives answer the new SYNC, a cycle still in progress will not be completed
+	if (bSyncSent)
+		closePosVelCycle();
+	m_Mutex.unlock();
+
+	return iNumMsgs;
+}
+
+//-----------------------------------------------
+bool CanCtrlPltfCOb3::getCanStats(CanItfStats::Stats& stats)
+{
+	if (m_pCanStats == NULL)
+		return false;
+
+	m_pCanStats->getStats(stats);
+
+	return true;
+}
+
 //-----------------------------------------------
 int CanCtrlPltfCOb3::requestMotPosVel(int iCanIdent)
 {
@@ -1383,20 +2016,30 @@ void CanCtrlPltfCOb3::requestDriveStatus()
 	m_Mutex.unlock();
 }
 
+//-----------------------------------------------
+bool CanCtrlPltfCOb3::getPltfState(PltfState& State) const
+{
+	return (m_PltfState.read(State) > 0);
+}
+
 //-----------------------------------------------
 int CanCtrlPltfCOb3::getGearPosVelRadS(int iCanIdent, double* pdAngleGearRad, double* pdVelGearRadS)
 {
+	PltfState State;
 
 	// init default outputs
 	*pdAngleGearRad = 0;
 	*pdVelGearRadS = 0;
 
-	for(unsigned int i = 0; i < m_vpMotor.size(); i++)
+	m_PltfState.read(State);
+
+	for(unsigned int i = 0; (i < m_vpMotor.size()) && (i < (unsigned int)c_iMaxNumMotors); i++)
 	{
 		// check if Identifier fits to availlable hardware
 		if(iCanIdent == m_viMotorID[i])
 		{
-			m_vpMotor[i]->getGearPosVelRadS(pdAngleGearRad, pdVelGearRadS);
+			*pdAngleGearRad = State.Drive[i].dPosGearRad;
+			*pdVelGearRadS = State.Drive[i].dVelGearRadS;
 		}
 	}
 
@@ -1407,17 +2050,22 @@ int CanCtrlPltfCOb3::getGearPosVelRadS(int iCanIdent, double* pdAngleGearRad, do
 int CanCtrlPltfCOb3::getGearDeltaPosVelRadS(int iCanIdent, double* pdAngleGearRad,
 										   double* pdVelGearRadS)
 {
+	PltfState State;
 
 	// init default outputs
 	*pdAngleGearRad = 0;
 	*pdVelGearRadS = 0;
 
-	for(unsigned int i = 0; i < m_vpMotor.size(); i++)
+	m_PltfState.read(State);
+
+	for(unsigned int i = 0; (i < m_vpMotor.size()) && (i < (unsigned int)c_iMaxNumMotors); i++)
 	{
 		// check if Identifier fits to availlable hardware
 		if(iCanIdent == m_viMotorID[i])
 		{
-			m_vpMotor[i]->getGearDeltaPosVelRadS(pdAngleGearRad, pdVelGearRadS);
+			*pdAngleGearRad = State.Drive[i].dPosGearRad - m_dDeltaPosGearRadMem[i];
+			*pdVelGearRadS = State.Drive[i].dVelGearRadS;
+			m_dDeltaPosGearRadMem[i] = State.Drive[i].dPosGearRad;
 		}
 	}
 
@@ -1427,16 +2075,21 @@ int CanCtrlPltfCOb3::getGearDeltaPosVelRadS(int iCanIdent, double* pdAngleGearRa
 //-----------------------------------------------
 void CanCtrlPltfCOb3::getStatus(int iCanIdent, int* piStatus, int* piTempCel)
 {
+	PltfState State;
+
 	// init default outputs
 	*piStatus = 0;
 	*piTempCel = 0;
 
-	for(unsigned int i = 0; i < m_vpMotor.size(); i++)
+	m_PltfState.read(State);
+
+	for(unsigned int i = 0; (i < m_vpMotor.size()) && (i < (unsigned int)c_iMaxNumMotors); i++)
 	{
 		// check if Identifier fits to availlable hardware
 		if(iCanIdent == m_viMotorID[i])
 		{
-			m_vpMotor[i]->getStatus(piStatus, piTempCel);
+			*piStatus = State.Drive[i].iStatus;
+			*piTempCel = State.Drive[i].iTempCel;
 		}
 	}
 
@@ -1457,24 +2110,55 @@ void CanCtrlPltfCOb3::requestMotorTorque()
 //-----------------------------------------------
 void CanCtrlPltfCOb3::getMotorTorque(int iCanIdent, double* pdTorqueNm)
 {
+	PltfState State;
+
 	// init default outputs
 	*pdTorqueNm = 0;
 
-	for(unsigned int i = 0; i < m_vpMotor.size(); i++)
+	m_PltfState.read(State);
+
+	for(unsigned int i = 0; (i < m_vpMotor.size()) && (i < (unsigned int)c_iMaxNumMotors); i++)
 	{
 		// check if Identifier fits to availlable hardware
 		if(iCanIdent == m_viMotorID[i])
 		{
-			m_vpMotor[i]->getMotorTorque(pdTorqueNm);
+			*pdTorqueNm = State.Drive[i].dTorqueNm;
 		}
 	}
 
 }
+
+//-----------------------------------------------
+void CanCtrlPltfCOb3::setTelemetry(bool bEnable)
+{
+	m_bTelemetry = bEnable;
+
+	// motors created by initPltf() get the setting there
+	for(unsigned int i = 0; i < m_vpMotor.size(); i++)
+	{
+		if(m_vpMotor[i] != NULL)
+			m_vpMotor[i]->setTelemetry(bEnable);
+	}
+}
+
+//-----------------------------------------------
+int CanCtrlPltfCOb3::readTelemetry(int iCanIdent, std::vector<CanDriveItf::TelemetrySample>& vSamples)
+{
+	for(unsigned int i = 0; i < m_vpMotor.size(); i++)
+	{
+		if((iCanIdent == m_viMotorID[i]) && (m_vpMotor[i] != NULL))
+			return m_vpMotor[i]->readTelemetry(vSamples);
+	}
+
+	return 0;
+}
 //-----------------------------------------------
 void CanCtrlPltfCOb3::setMotorTorque(int iCanIdent, double dTorqueNm)
 {
 	m_Mutex.lock();
 
+	m_DriveSupervisor.notifyCmd();
+
 	for(unsigned int i = 0; i < m_vpMotor.size(); i++)
 	{
 		// check if Identifier fits to availlable hardware
@@ -1523,6 +2207,13 @@ int CanCtrlPltfCOb3::ElmoRecordings(int iFlag, int iParam, std::string sString)
 			}
 			return bRet;
 
+		case 101:
+			if(m_vpMotor.empty()) return 100;
+			for(unsigned int i = 0; i < m_vpMotor.size(); i++) {
+				bRet += m_vpMotor[i]->setRecorder(3, 0); //Request progress of transmission
+			}
+			return bRet / (int)m_vpMotor.size();
+
 		default:
 			return -1;
 	}
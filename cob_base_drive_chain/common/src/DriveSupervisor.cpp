@@ -0,0 +1,334 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_base_drive_chain
+ * Description: Supervision of the drives: heartbeat production and CAN timeouts.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#include <cob_base_drive_chain/DriveSupervisor.h>
+#include <cob_utilities/TimeStamp.h>
+
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <unistd.h>
+
+//-----------------------------------------------
+DriveSupervisor::DriveSupervisor()
+	: m_iTick(0), m_iLastCmdTick(0), m_iErrMask(0)
+{
+	m_Param.dTickS = 0.01;
+	m_Param.dHeartbeatPeriodS = 0.1;
+	m_Param.dCmdTimeoutS = 0.5;
+	m_Param.dRxTimeoutS = 7;
+	m_Param.dErrorPollPeriodS = 0.1;
+
+	m_pCanItf = NULL;
+	m_pMutex = NULL;
+	m_bRunning = false;
+
+	m_iRxTimeoutTicks = 1;
+	m_iCmdTimeoutTicks = 1;
+	m_iHeartbeatTicks = 1;
+	m_iErrorPollTicks = 1;
+
+	for(int i = 0; i < c_iMaxNumDrives; i++)
+	{
+		m_aiLastRxTick[i].store(0);
+		m_aiNextInSlot[i] = -1;
+		m_aiExpiredRxTick[i] = 0;
+	}
+
+	m_iRxTimeoutMask = 0;
+	m_iDriveErrMask = 0;
+}
+
+//-----------------------------------------------
+DriveSupervisor::~DriveSupervisor()
+{
+	stop();
+}
+
+//-----------------------------------------------
+bool DriveSupervisor::start(CanItf* pCanItf, const std::vector<CanDriveItf*>& vpDrives, Mutex* pMutex, const ParamType& Param)
+{
+	int iRet;
+	unsigned int iTick;
+
+	if (m_bRunning)
+		return true;
+
+	if (vpDrives.size() > (unsigned int)c_iMaxNumDrives)
+	{
+		std::cout << "DriveSupervisor::start(): supervises only the first " << c_iMaxNumDrives << " drives" << std::endl;
+	}
+
+	m_Param = Param;
+	m_pCanItf = pCanItf;
+	m_vpDrives.assign(vpDrives.begin(), vpDrives.begin() + std::min<int>(vpDrives.size(), c_iMaxNumDrives));
+	m_pMutex = pMutex;
+
+	m_iRxTimeoutTicks = std::max(1, (int)(m_Param.dRxTimeoutS / m_Param.dTickS + 0.5));
+	m_iCmdTimeoutTicks = std::max(1, (int)(m_Param.dCmdTimeoutS / m_Param.dTickS + 0.5));
+	m_iHeartbeatTicks = std::max(1, (int)(m_Param.dHeartbeatPeriodS / m_Param.dTickS + 0.5));
+	m_iErrorPollTicks = std::max(1, (int)(m_Param.dErrorPollPeriodS / m_Param.dTickS + 0.5));
+
+	// a deadline is at most m_iRxTimeoutTicks ahead, so one turn of the wheel covers all of them
+	m_viSlotHead.assign(m_iRxTimeoutTicks + 1, -1);
+
+	// all drives get the full timeout from now on
+	iTick = m_iTick.load();
+	for(unsigned int i = 0; i < m_vpDrives.size(); i++)
+	{
+		m_aiLastRxTick[i].store(iTick);
+		armDeadline(i, iTick + m_iRxTimeoutTicks);
+	}
+
+	// no heartbeat before the first command
+	m_iLastCmdTick.store(iTick - m_iCmdTimeoutTicks - 1);
+
+	m_iRxTimeoutMask = 0;
+	m_iDriveErrMask = 0;
+	m_iErrMask.store(0);
+
+	m_bRunning = true;
+
+	iRet = pthread_create(&m_hThread, NULL, &DriveSupervisor::threadFunc, this);
+	if (iRet != 0)
+	{
+		std::cout << "DriveSupervisor::start(): could not create thread: " << strerror(iRet) << std::endl;
+		m_bRunning = false;
+		return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------
+void DriveSupervisor::stop()
+{
+	if (!m_bRunning)
+		return;
+
+	m_bRunning = false;
+	pthread_join(m_hThread, NULL);
+}
+
+//-----------------------------------------------
+void* DriveSupervisor::threadFunc(void* pArg)
+{
+	((DriveSupervisor*)pArg)->run();
+	return NULL;
+}
+
+//-----------------------------------------------
+void DriveSupervisor::run()
+{
+	TimeStamp StartTime, Now;
+	unsigned int iStartTick, iTick, iNowTick;
+	bool bHeartbeat, bPoll;
+	double dSleepS;
+
+	StartTime.SetNow();
+	iStartTick = m_iTick.load();
+	iTick = iStartTick;
+
+	while (m_bRunning)
+	{
+		Now.SetNow();
+		iNowTick = iStartTick + (unsigned int)((Now - StartTime) / m_Param.dTickS);
+
+		// the clock was set back -> count the ticks from now on
+		if ((int)(iNowTick - iTick) < 0)
+		{
+			StartTime = Now;
+			iStartTick = iTick;
+			iNowTick = iTick;
+		}
+
+		// catch up on ticks which were missed (e.g. while the thread was preempted)
+		bHeartbeat = false;
+		bPoll = false;
+		while (iTick != iNowTick)
+		{
+			iTick++;
+			m_iTick.store(iTick, boost::memory_order_relaxed);
+			advanceWheel(iTick);
+			bHeartbeat |= ((iTick % m_iHeartbeatTicks) == 0);
+			bPoll |= ((iTick % m_iErrorPollTicks) == 0);
+		}
+
+		if (bHeartbeat)
+			sendHeartbeat(iTick);
+
+		if (bPoll)
+			pollDriveErrors();
+
+		checkRecovery(iTick);
+
+		m_iErrMask.store(m_iRxTimeoutMask | m_iDriveErrMask, boost::memory_order_release);
+
+		// sleep until the next tick
+		dSleepS = (iNowTick - iStartTick + 1) * m_Param.dTickS - (Now - StartTime);
+		if (dSleepS > 0)
+			usleep((useconds_t)(dSleepS * 1e6));
+	}
+}
+
+//-----------------------------------------------
+void DriveSupervisor::advanceWheel(unsigned int iTick)
+{
+	int iSlot = iTick % m_viSlotHead.size();
+	int iDrive = m_viSlotHead[iSlot];
+	int iNext;
+	unsigned int iLastRx, iDeadline;
+
+	m_viSlotHead[iSlot] = -1;
+
+	while (iDrive >= 0)
+	{
+		iNext = m_aiNextInSlot[iDrive];
+
+		// the deadline is only moved when it expires, not with every received message
+		iLastRx = m_aiLastRxTick[iDrive].load(boost::memory_order_relaxed);
+		iDeadline = iLastRx + m_iRxTimeoutTicks;
+
+		if ((int)(iDeadline - iTick) > 0)
+		{
+			armDeadline(iDrive, iDeadline);
+		}
+		else
+		{
+			std::cout << "timeout CAN motor " << iDrive << std::endl;
+			m_iRxTimeoutMask |= 1u << iDrive;
+			m_aiExpiredRxTick[iDrive] = iLastRx;
+		}
+
+		iDrive = iNext;
+	}
+}
+
+//-----------------------------------------------
+void DriveSupervisor::armDeadline(int iDrive, unsigned int iDeadlineTick)
+{
+	int iSlot = iDeadlineTick % m_viSlotHead.size();
+
+	m_aiNextInSlot[iDrive] = m_viSlotHead[iSlot];
+	m_viSlotHead[iSlot] = iDrive;
+}
+
+//-----------------------------------------------
+void DriveSupervisor::checkRecovery(unsigned int iTick)
+{
+	unsigned int iLastRx, iDeadline;
+
+	if (m_iRxTimeoutMask == 0)
+		return;
+
+	for(unsigned int i = 0; i < m_vpDrives.size(); i++)
+	{
+		if ((m_iRxTimeoutMask & (1u << i)) == 0)
+			continue;
+
+		iLastRx = m_aiLastRxTick[i].load(boost::memory_order_relaxed);
+		if (iLastRx == m_aiExpiredRxTick[i])
+			continue;
+
+		// drive is sending again
+		std::cout << "CAN motor " << i << " communicates again" << std::endl;
+		m_iRxTimeoutMask &= ~(1u << i);
+
+		iDeadline = iLastRx + m_iRxTimeoutTicks;
+		if ((int)(iDeadline - iTick) <= 0)
+			iDeadline = iTick + 1;
+		armDeadline(i, iDeadline);
+	}
+}
+
+//-----------------------------------------------
+void DriveSupervisor::sendHeartbeat(unsigned int iTick)
+{
+	CanMsg msg;
+
+	// a stalled control loop doesn't keep the watchdogs of the drives inactive
+	if ((int)(iTick - m_iLastCmdTick.load(boost::memory_order_relaxed)) > m_iCmdTimeoutTicks)
+		return;
+
+	// note: the COB-ID for a heartbeat message = 0x700 + Device ID (PC = 0)
+	msg.m_iID  = 0x700;
+	msg.m_iLen = 5;
+	msg.set(0x00,0,0,0,0,0,0,0);
+
+	m_pMutex->lock();
+	m_pCanItf->transmitMsg(msg, false);
+	m_pMutex->unlock();
+}
+
+//-----------------------------------------------
+void DriveSupervisor::pollDriveErrors()
+{
+	unsigned int iDriveErrMask = 0;
+
+	m_pMutex->lock();
+	for(unsigned int i = 0; i < m_vpDrives.size(); i++)
+	{
+		if (m_vpDrives[i]->isError())
+			iDriveErrMask |= 1u << i;
+	}
+	m_pMutex->unlock();
+
+	for(unsigned int i = 0; i < m_vpDrives.size(); i++)
+	{
+		if ((iDriveErrMask & ~m_iDriveErrMask) & (1u << i))
+			std::cout << "Motor " << i << " error" << std::endl;
+	}
+
+	m_iDriveErrMask = iDriveErrMask;
+}
@@ -0,0 +1,253 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_base_drive_chain
+ * Description: Replays a recorded CAN trace through CanCtrlPltfCOb3 and UndercarriageCtrlGeom.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <cob_generic_can/CanItfReplay.h>
+#include <cob_base_drive_chain/CanCtrlPltfCOb3.h>
+#include <cob_undercarriage_ctrl/UndercarriageCtrlGeom.h>
+#include <cob_utilities/IniFile.h>
+#include <cob_utilities/MathSup.h>
+#include <cob_utilities/TimeStamp.h>
+
+//-----------------------------------------------
+static void printUsage()
+{
+	std::cout << "usage: cob_base_drive_chain_replay <IniDirectory> <TraceFile> [--realtime] [--odom <CsvFile>]" << std::endl
+		<< "  Feeds the received frames of a CAN trace (recorded with [TypeCan] TraceFile) through the" << std::endl
+		<< "  decoding of the drives and the kinematics of the undercarriage and integrates the odometry." << std::endl
+		<< "  Without --realtime the trace is replayed as fast as possible, one SYNC cycle per step," << std::endl
+		<< "  and the throughput is reported as a benchmark of the decode and kinematics path." << std::endl;
+}
+
+//-----------------------------------------------
+int main(int argc, char** argv)
+{
+	std::string sIniDirectory;
+	std::string sTraceFile;
+	std::string sOdomFile;
+	bool bRealTime = false;
+	FILE* pOdomFile = NULL;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--realtime") == 0)
+			bRealTime = true;
+		else if ((strcmp(argv[i], "--odom") == 0) && (i + 1 < argc))
+			sOdomFile = argv[++i];
+		else if (sIniDirectory.empty())
+			sIniDirectory = argv[i];
+		else if (sTraceFile.empty())
+			sTraceFile = argv[i];
+		else
+		{
+			printUsage();
+			return 1;
+		}
+	}
+	if (sIniDirectory.empty() || sTraceFile.empty())
+	{
+		printUsage();
+		return 1;
+	}
+	if (sIniDirectory[sIniDirectory.size() - 1] != '/')
+		sIniDirectory += "/";
+
+	CanItfReplay* pReplay = new CanItfReplay();
+	if (!pReplay->open(sTraceFile, bRealTime))
+	{
+		delete pReplay;
+		return 1;
+	}
+
+	if (!sOdomFile.empty())
+	{
+		pOdomFile = fopen(sOdomFile.c_str(), "w");
+		if (pOdomFile == NULL)
+		{
+			std::cout << "cannot create " << sOdomFile << std::endl;
+			delete pReplay;
+			return 1;
+		}
+		fprintf(pOdomFile, "t,x,y,theta,vx,vy,vtheta\n");
+	}
+
+	// same configuration as cob_base_drive_chain and cob_undercarriage_ctrl
+	IniFile iniFile;
+	int iNumMotors = 8;
+	int iNumDrives = 4;
+	iniFile.SetFileName(sIniDirectory + "Platform.ini", "replay_can_trace.cpp");
+	iniFile.GetKeyInt("Config", "NumberOfMotors", &iNumMotors, true);
+	iniFile.GetKeyInt("Config", "NumberOfWheels", &iNumDrives, true);
+	if(iNumMotors < 2 || iNumMotors > 8) {
+		iNumMotors = 8;
+		iNumDrives = 4;
+	}
+
+	std::vector<double> vdWheelNtrlPosRad(iNumDrives, 0);
+	for(int i = 0; i < iNumDrives; i++)
+	{
+		char cKey[32];
+		sprintf(cKey, "Wheel%dNeutralPosition", i + 1);
+		iniFile.GetKeyDouble("DrivePrms", cKey, &vdWheelNtrlPosRad[i], true);
+		vdWheelNtrlPosRad[i] = MathSup::convDegToRad(vdWheelNtrlPosRad[i]);
+	}
+
+	CanCtrlPltfCOb3 Pltf(sIniDirectory);
+	Pltf.initPltfPassive(pReplay);
+
+	// the error of an unsupported configuration is printed by UndercarriageCtrlGeom
+	UndercarriageCtrlGeom* pUndercarriageCtrl;
+	try
+	{
+		pUndercarriageCtrl = new UndercarriageCtrlGeom(sIniDirectory);
+	}
+	catch (const std::runtime_error&)
+	{
+		return 1;
+	}
+	UndercarriageCtrlGeom& UndercarriageCtrl = *pUndercarriageCtrl;
+	UndercarriageCtrl.InitUndercarriageCtrl();
+
+	std::vector<double> vdVelGearDriveRadS(iNumDrives, 0);
+	std::vector<double> vdVelGearSteerRadS(iNumDrives, 0);
+	std::vector<double> vdAngGearDriveRad(iNumDrives, 0);
+	std::vector<double> vdAngGearSteerRad(iNumDrives, 0);
+	double dAngGearRad, dVelGearRadS;
+	double dDeltaLongMM, dDeltaLatMM, dDeltaRotRobRad, dDeltaRotVelRad;
+	double dVelLongMMS, dVelLatMMS, dRotRobRadS, dRotVelRadS;
+	double dX = 0, dY = 0, dTheta = 0;
+	double dVelXLast = 0, dVelYLast = 0;
+	double dTimeS, dLastTimeS = 0;
+	unsigned long iNumCycles = 0;
+	TimeStamp StartTime, EndTime;
+
+	StartTime.SetNow();
+
+	while (!pReplay->isFinished())
+	{
+		// one recorded cycle (max speed) resp. the frames due by now (real time)
+		Pltf.evalCanBuffer();
+
+		for (int i = 0; i < iNumMotors; i++)
+		{
+			Pltf.getGearPosVelRadS(i, &dAngGearRad, &dVelGearRadS);
+			if (i % 2 == 0)
+			{
+				vdAngGearDriveRad[i / 2] = dAngGearRad;
+				vdVelGearDriveRadS[i / 2] = dVelGearRadS;
+			}
+			else
+			{
+				// correct for the offset of the steering angle like cob_base_drive_chain
+				dAngGearRad += vdWheelNtrlPosRad[i / 2];
+				MathSup::normalizePi(dAngGearRad);
+				vdAngGearSteerRad[i / 2] = dAngGearRad;
+				vdVelGearSteerRadS[i / 2] = dVelGearRadS;
+			}
+		}
+
+		UndercarriageCtrl.SetActualWheelValues(vdVelGearDriveRadS, vdVelGearSteerRadS, vdAngGearDriveRad, vdAngGearSteerRad);
+		UndercarriageCtrl.GetActualPltfVelocity(dDeltaLongMM, dDeltaLatMM, dDeltaRotRobRad, dDeltaRotVelRad,
+			dVelLongMMS, dVelLatMMS, dRotRobRadS, dRotVelRadS);
+
+		// integrate the odometry over the recorded time like cob_undercarriage_ctrl (midpoint)
+		double dVelX = dVelLongMMS / 1000.0;
+		double dVelY = dVelLatMMS / 1000.0;
+		dTimeS = pReplay->getReplayTimeS();
+		double dt = dTimeS - dLastTimeS;
+		dLastTimeS = dTimeS;
+
+		dX += ((dVelX + dVelXLast) / 2.0 * cos(dTheta) - (dVelY + dVelYLast) / 2.0 * sin(dTheta)) * dt;
+		dY += ((dVelX + dVelXLast) / 2.0 * sin(dTheta) + (dVelY + dVelYLast) / 2.0 * cos(dTheta)) * dt;
+		dTheta += dRotRobRadS * dt;
+		dVelXLast = dVelX;
+		dVelYLast = dVelY;
+
+		if (pOdomFile != NULL)
+			fprintf(pOdomFile, "%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f\n", dTimeS, dX, dY, dTheta, dVelX, dVelY, dRotRobRadS);
+
+		iNumCycles++;
+
+		// cycle time of cob_base_drive_chain
+		if (bRealTime)
+			usleep(10000);
+	}
+
+	EndTime.SetNow();
+	double dElapsedS = EndTime - StartTime;
+
+	if (pOdomFile != NULL)
+		fclose(pOdomFile);
+
+	std::cout << "replayed " << pReplay->getNumFramesReplayed() << " frames in " << iNumCycles << " cycles, "
+		<< pReplay->getDurationS() << " s of trace in " << dElapsedS << " s" << std::endl;
+	if (dElapsedS > 0)
+	{
+		std::cout << "throughput " << pReplay->getNumFramesReplayed() / dElapsedS << " frames/s, "
+			<< iNumCycles / dElapsedS << " cycles/s" << std::endl;
+	}
+	std::cout << "final pose x " << dX << " m, y " << dY << " m, theta " << dTheta << " rad" << std::endl;
+
+	delete pUndercarriageCtrl;
+	return 0;
+}
@@ -55,7 +55,7 @@
 //#### includes ####
 
 // standard includes
-//--
+#include <sstream>
 
 // ROS includes
 #include <ros/ros.h>
@@ -67,6 +67,7 @@
 #include <diagnostic_msgs/DiagnosticArray.h>
 #include <control_msgs/JointTrajectoryControllerState.h>
 #include <control_msgs/JointControllerState.h>
+#include <cob_base_drive_chain/DriveTelemetry.h>
 
 // ROS service includes
 #include <std_srvs/Trigger.h>
@@ -78,6 +79,7 @@
 #include <cob_base_drive_chain/CanCtrlPltfCOb3.h>
 #include <cob_utilities/IniFile.h>
 #include <cob_utilities/MathSup.h>
+#include <cob_utilities/TimeStamp.h>
 
 //####################
 //#### node class ####
@@ -105,6 +107,11 @@ class NodeClass
 		*/
 		ros::Publisher topicPub_Diagnostic;
 
+		/**
+		* On this topic "telemetry" of type cob_base_drive_chain::DriveTelemetry the node publishes current, torque and following error of every SYNC cycle (parameter PublishTelemetry)
+		*/
+		ros::Publisher topicPub_Telemetry;
+
                 /**
                 * Timer to publish global diagnostic messages
                 */
@@ -153,7 +160,7 @@ class NodeClass
 		*
 		* string fileprefix
 		* #Enter the path+file-prefix for the logfile (of an existing directory!)
-		* #The file-prefix is extended with _MotorNumber_RecordedSource.log
+		* #The file-prefix is extended with _MotorNumber_RecordedSource.rec
 		*/
 		ros::ServiceServer srvServer_ElmoRecorderReadout;
 
@@ -177,6 +184,15 @@ class NodeClass
 		ros::Subscriber topicSub_GazeboJointStates;
 #else
 		CanCtrlPltfCOb3 *m_CanCtrlPltf;
+		// CAN errors reported in the previous diagnostics, to detect new ones
+		unsigned long m_iLastCanErrors;
+		// SYNC cycle of the last published joint states, the time it was first published
+		// and its reception time in ROS time (stamp of the joint states)
+		unsigned long m_iLastPltfCycle;
+		ros::Time m_LastPltfCycleTime;
+		ros::Time m_LastPltfStamp;
+		// samples of one motor, reused by publish_Telemetry()
+		std::vector<CanDriveItf::TelemetrySample> m_vTelemetrySamples;
 #endif
 		bool m_bisInitialized;
 		int m_iNumMotors;
@@ -194,6 +210,8 @@ class NodeClass
 		std::string sIniDirectory;
 		bool m_bPubEffort;
 		bool m_bReadoutElmo;
+		bool m_bEventDrivenFeedback;
+		bool m_bPubTelemetry;
 
 		// Constructor
 		NodeClass()
@@ -214,6 +232,12 @@ class NodeClass
 			n.param<bool>("PublishEffort", m_bPubEffort, false);
 			if(m_bPubEffort) ROS_INFO("You have choosen to publish effort of motors, that charges capacity of CAN");
 
+			n.param<bool>("EventDrivenFeedback", m_bEventDrivenFeedback, false);
+			if(m_bEventDrivenFeedback) ROS_INFO("Joint states are published as soon as all drives answered a SYNC");
+
+			n.param<bool>("PublishTelemetry", m_bPubTelemetry, false);
+			if(m_bPubTelemetry) ROS_INFO("Current, torque and following error of the motors are streamed with every SYNC");
+
 
 			IniFile iniFile;
 			iniFile.SetFileName(sIniDirectory + "Platform.ini", "PltfHardwareCoB3.h");
@@ -243,6 +267,11 @@ class NodeClass
 #else
 			topicPub_JointState = n.advertise<sensor_msgs::JointState>("/joint_states", 1);
 			m_CanCtrlPltf = new CanCtrlPltfCOb3(sIniDirectory);
+			m_CanCtrlPltf->setTelemetry(m_bPubTelemetry);
+			m_iLastCanErrors = 0;
+			m_iLastPltfCycle = 0;
+			if(m_bPubTelemetry)
+				topicPub_Telemetry = n.advertise<cob_base_drive_chain::DriveTelemetry>("telemetry", 10);
 #endif
 
 			// implementation of topics
@@ -361,6 +390,11 @@ class NodeClass
 					}
 				}
 
+#ifdef __SIM__
+#else
+				// collect the commands of all joints and send them in one burst
+				m_CanCtrlPltf->beginCmdBatch();
+#endif
 
 				// check if velocities lie inside allowed boundaries
 				for(int i = 0; i < m_iNumMotors; i++)
@@ -414,19 +448,21 @@ class NodeClass
 					if(msg->joint_names[i] == "br_caster_rotation_joint")
 						br_steer_pub.publish(fl);
 					ROS_DEBUG("Successfully sent velicities to gazebo");
-#else
-					ROS_DEBUG("Send velocity data to drives");
-					m_CanCtrlPltf->setVelGearRadS(i, JointStateCmd.velocity[i]);
-					ROS_DEBUG("Successfully sent velicities to drives");
 #endif
 				}
 
 #ifdef __SIM__
 
 #else
-				if(m_bPubEffort) {
+				ROS_DEBUG("Send velocity data to drives");
+				m_CanCtrlPltf->setVelGearRadS(JointStateCmd.velocity);
+				ROS_DEBUG("Successfully sent velicities to drives");
+
+				// the telemetry stream contains the torque already
+				if(m_bPubEffort && !m_bPubTelemetry) {
 					m_CanCtrlPltf->requestMotorTorque();
 				}
+				m_CanCtrlPltf->flushCmdBatch();
 #endif
 			}
 		}
@@ -492,7 +528,7 @@ class NodeClass
 				if(res.success == 0) {
 					res.message = "Successfully requested reading out of Recorded data";
 					m_bReadoutElmo = true;
-					ROS_WARN("CPU consuming evalCanBuffer used for ElmoReadout activated");
+					ROS_INFO("ElmoReadout of all motors started");
 				} else if(res.success == 1) res.message = "Recorder hasn't been configured well yet";
 				else if(res.success == 2) res.message = "A previous transmission is still in progress";
 			}
@@ -549,11 +585,33 @@ class NodeClass
 		}
 
 		//publish JointStates cyclical instead of service callback
+#ifndef __SIM__
+		// converts a reception time (CLOCK_REALTIME, see CanMsg::getTimeStamp()) to ROS time via its age,
+		// so it is consistent with ros::Time::now() also with simulated time
+		ros::Time toRosTime(double dTimeS)
+		{
+			// the state is evaluated within a few cycles, an older or future time is from
+			// another clock (e.g. a replayed trace) -> use the time of evaluation
+			const double c_dMaxAgeS = 1.0;
+			TimeStamp Now;
+			long lSec, lNSec;
+
+			Now.SetNow();
+			Now.getTimeStamp(lSec, lNSec);
+			double dAgeS = (lSec - dTimeS) + lNSec * 1e-9;
+			if((dAgeS < 0) || (dAgeS > c_dMaxAgeS))
+				dAgeS = 0;
+
+			return ros::Time::now() - ros::Duration(dAgeS);
+		}
+#endif
+
 		bool publish_JointStates()
 		{
 			// init local variables
 			int j, k;
 			bool bIsError;
+			bool bPltfStateComplete = true;
 			std::vector<double> vdAngGearRad, vdVelGearRad, vdEffortGearNM;
 
 			// set default values
@@ -617,6 +675,32 @@ class NodeClass
 				ROS_DEBUG("Read CAN-Buffer");
 				m_CanCtrlPltf->evalCanBuffer();
 				ROS_DEBUG("Successfully read CAN-Buffer");
+
+				// positions, velocities and torques of all motors from the same SYNC cycle
+				CanCtrlPltfCOb3::PltfState PltfState;
+				if(!m_CanCtrlPltf->getPltfState(PltfState))
+				{
+					// no SYNC cycle was answered yet, there is no valid state to publish
+					ROS_DEBUG("No state of the drives received yet, joint states not published");
+					diagnostics.level = 1;
+					diagnostics.name = "drive-chain can node";
+					diagnostics.message = "no state of the drives received yet";
+					topicPub_Diagnostic.publish(diagnostics);
+					return false;
+				}
+
+				// without SYNC (no commands) the state of the last cycle is published again
+				if(PltfState.iCycle != m_iLastPltfCycle)
+				{
+					m_iLastPltfCycle = PltfState.iCycle;
+					m_LastPltfCycleTime = ros::Time::now();
+					m_LastPltfStamp = toRosTime(PltfState.dTimeS);
+				}
+				bPltfStateComplete = PltfState.bComplete;
+
+				// stamp with the reception time of the cycle, so the odometry is integrated at the sample times
+				jointstate.header.stamp = m_LastPltfStamp;
+				controller_state.header.stamp = m_LastPltfStamp;
 #endif
 				j = 0;
 				k = 0;
@@ -626,7 +710,8 @@ class NodeClass
 					vdAngGearRad[i] = m_gazeboPos[i];
 					vdVelGearRad[i] = m_gazeboVel[i];
 #else
-					m_CanCtrlPltf->getGearPosVelRadS(i,  &vdAngGearRad[i], &vdVelGearRad[i]);
+					vdAngGearRad[i] = PltfState.Drive[i].dPosGearRad;
+					vdVelGearRad[i] = PltfState.Drive[i].dVelGearRadS;
 #endif
 
 					//Get motor torque
@@ -636,7 +721,7 @@ class NodeClass
 #ifdef __SIM__
 							//vdEffortGearNM[i] = m_gazeboEff[i];
 #else
-							m_CanCtrlPltf->getMotorTorque(i, &vdEffortGearNM[i]); //(int iCanIdent, double* pdTorqueNm)
+							vdEffortGearNM[i] = PltfState.Drive[i].dTorqueNm;
 #endif
 						}
 					}
@@ -705,7 +790,13 @@ class NodeClass
 			}
 			else
 			{
-				if (m_bisInitialized)
+				if (m_bisInitialized && !bPltfStateComplete)
+				{
+					diagnostics.level = 1;
+					diagnostics.name = "drive-chain can node";
+					diagnostics.message = "not all drives answered the last SYNC cycle";
+				}
+				else if (m_bisInitialized)
 				{
 					diagnostics.level = 0;
 					diagnostics.name = "drive-chain can node";
@@ -719,6 +810,15 @@ class NodeClass
 				}
 			}
 
+#ifndef __SIM__
+			if(m_bisInitialized)
+			{
+				// age of the published state, it grows while no SYNC is sent
+				addKeyValue(diagnostics, "sync cycle", m_iLastPltfCycle);
+				addKeyValue(diagnostics, "state age [s]", (ros::Time::now() - m_LastPltfCycleTime).toSec());
+			}
+#endif
+
 			// publish diagnostic message
 			topicPub_Diagnostic.publish(diagnostics);
 			ROS_DEBUG("published new drive-chain configuration (JointState message)");
@@ -727,6 +827,54 @@ class NodeClass
 			return true;
 		}
 
+#ifndef __SIM__
+		//publish the telemetry samples received since the previous call
+		void publish_Telemetry()
+		{
+			static const char* c_sJointNames[] = { "fl_caster_r_wheel_joint", "fl_caster_rotation_joint",
+				"bl_caster_r_wheel_joint", "bl_caster_rotation_joint", "br_caster_r_wheel_joint", "br_caster_rotation_joint",
+				"fr_caster_r_wheel_joint", "fr_caster_rotation_joint" };
+
+			if(!m_bPubTelemetry || !m_bisInitialized)
+				return;
+
+			cob_base_drive_chain::DriveTelemetry telemetry;
+
+			for(int i = 0; i < m_iNumMotors; i++)
+			{
+				m_vTelemetrySamples.clear();
+				m_CanCtrlPltf->readTelemetry(i, m_vTelemetrySamples);
+
+				for(unsigned int k = 0; k < m_vTelemetrySamples.size(); k++)
+				{
+					const CanDriveItf::TelemetrySample& Sample = m_vTelemetrySamples[k];
+					double dPosRad = Sample.dPosGearRad;
+
+					// correct steering motors for the initial offset like the joint states
+					if(i % 2 == 1)
+					{
+						dPosRad += m_Param.vdWheelNtrlPosRad[i / 2];
+						MathSup::normalizePi(dPosRad);
+					}
+
+					telemetry.joint_names.push_back(c_sJointNames[i]);
+					telemetry.stamps.push_back(ros::Time(Sample.dTimeS));
+					telemetry.position.push_back(dPosRad);
+					telemetry.velocity.push_back(Sample.dVelGearRadS);
+					telemetry.current.push_back(Sample.dMotorCurrA);
+					telemetry.torque.push_back(Sample.dTorqueNm);
+					telemetry.following_error.push_back(Sample.dFollowingErrorGearRad);
+				}
+			}
+
+			if(telemetry.joint_names.empty())
+				return;
+
+			telemetry.header.stamp = ros::Time::now();
+			topicPub_Telemetry.publish(telemetry);
+		}
+#endif
+
 		void publish_globalDiagnostics(const ros::TimerEvent& event)
 		{
 		  //publish global diagnostic messages
@@ -760,10 +908,79 @@ class NodeClass
                       diagnostics_gl.status[0].message = "base_drive_chain not initialized";
                     }
                   }
+#ifndef __SIM__
+                  // traffic of the CAN bus
+                  CanItfStats::Stats CanStats;
+                  if(m_bisInitialized && m_CanCtrlPltf->getCanStats(CanStats))
+                  {
+                    diagnostic_msgs::DiagnosticStatus status;
+                    unsigned long iNumErrors = CanStats.iNumTxErrors + CanStats.iNumRxOverruns;
+
+                    status.name = ros::this_node::getName() + "/can_bus";
+                    if(CanStats.dBusLoadPercent > 80.0)
+                    {
+                      status.level = 1;
+                      status.message = "CAN bus load high";
+                    }
+                    else if(iNumErrors > m_iLastCanErrors)
+                    {
+                      status.level = 1;
+                      status.message = "CAN transmit errors or receive overruns";
+                    }
+                    else
+                    {
+                      status.level = 0;
+                      status.message = "CAN bus ok";
+                    }
+                    m_iLastCanErrors = iNumErrors;
+
+                    addKeyValue(status, "bus load [%]", CanStats.dBusLoadPercent);
+                    addKeyValue(status, "tx frames/s", CanStats.dTxFramesPerS);
+                    addKeyValue(status, "rx frames/s", CanStats.dRxFramesPerS);
+                    addKeyValue(status, "tx bytes/s", CanStats.dTxBytesPerS);
+                    addKeyValue(status, "rx bytes/s", CanStats.dRxBytesPerS);
+                    addKeyValue(status, "tx errors", CanStats.iNumTxErrors);
+                    addKeyValue(status, "rx overruns", CanStats.iNumRxOverruns);
+                    for(unsigned int i = 0; i < CanStats.vLatency.size(); i++)
+                    {
+                      const CanItfStats::LatencyHistogram& Hist = CanStats.vLatency[i];
+                      addKeyValue(status, Hist.sName + " latency samples", Hist.iNumSamples);
+                      if(Hist.iNumSamples == 0)
+                        continue;
+                      addKeyValue(status, Hist.sName + " latency mean [ms]", 1000.0 * Hist.dSumS / Hist.iNumSamples);
+                      addKeyValue(status, Hist.sName + " latency min [ms]", 1000.0 * Hist.dMinS);
+                      addKeyValue(status, Hist.sName + " latency max [ms]", 1000.0 * Hist.dMaxS);
+                    }
+                    diagnostics_gl.status.push_back(status);
+                  }
+
+                  // progress of a read-out of the Elmo Recorder
+                  if(m_bisInitialized && m_bReadoutElmo)
+                  {
+                    diagnostic_msgs::DiagnosticStatus status;
+                    status.level = 0;
+                    status.name = ros::this_node::getName() + "/elmo_recorder";
+                    status.message = "ElmoReadout in progress";
+                    addKeyValue(status, "progress [%]", m_CanCtrlPltf->ElmoRecordings(101, 0, ""));
+                    diagnostics_gl.status.push_back(status);
+                  }
+#endif
                   // publish diagnostic message
                   topicPub_DiagnosticGlobal_.publish(diagnostics_gl);
 		}
 
+		template<typename T>
+		static void addKeyValue(diagnostic_msgs::DiagnosticStatus& status, const std::string& sKey, const T& value)
+		{
+			std::ostringstream sValue;
+			diagnostic_msgs::KeyValue keyValue;
+
+			sValue << value;
+			keyValue.key = sKey;
+			keyValue.value = sValue.str();
+			status.values.push_back(keyValue);
+		}
+
 		// other function declarations
 		bool initDrives();
 
@@ -824,25 +1041,39 @@ int main(int argc, char** argv)
 
 	// specify looprate of control-cycle
  	ros::Rate loop_rate(100); // Hz
+	ros::Time LastPublish = ros::Time::now();
 
 	while(nodeClass.n.ok())
 	{
 #ifdef __SIM__
 
 #else
-		//Read-out of CAN buffer is only necessary during read-out of Elmo Recorder
-		if( nodeClass.m_bReadoutElmo )
+		if( nodeClass.m_bReadoutElmo && (nodeClass.m_CanCtrlPltf->ElmoRecordings(100, 0, "") == 0) )
 		{
-			if(nodeClass.m_bisInitialized) nodeClass.m_CanCtrlPltf->evalCanBuffer();
-			if(nodeClass.m_CanCtrlPltf->ElmoRecordings(100, 0, "") == 0)
+			nodeClass.m_bReadoutElmo = false;
+			ROS_INFO("ElmoReadout finished");
+		}
+
+		//During read-out of the Elmo Recorder the segments are confirmed as they arrive, so the loop waits for CAN messages instead of sleeping
+		if((nodeClass.m_bEventDrivenFeedback || nodeClass.m_bReadoutElmo) && nodeClass.m_bisInitialized)
+		{
+			// publish as soon as the PDO1 of all drives of a SYNC cycle arrived,
+			// without SYNC (no commands) at the rate of the loop; callbacks are handled between short waits
+			if(nodeClass.m_CanCtrlPltf->waitForPosVelCycle(1000) || (ros::Time::now() - LastPublish).toSec() >= loop_rate.expectedCycleTime().toSec())
 			{
-				nodeClass.m_bReadoutElmo = false;
-				ROS_INFO("CPU consuming evalCanBuffer used for ElmoReadout deactivated");
+				nodeClass.publish_JointStates();
+				nodeClass.publish_Telemetry();
+				LastPublish = ros::Time::now();
 			}
+			ros::spinOnce();
+			continue;
 		}
 #endif
 
 		nodeClass.publish_JointStates();
+#ifndef __SIM__
+		nodeClass.publish_Telemetry();
+#endif
 
 		loop_rate.sleep();
 		ros::spinOnce();
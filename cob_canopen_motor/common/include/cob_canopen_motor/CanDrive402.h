@@ -0,0 +1,499 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_canopen_motor
+ * Description: Driver for CiA 402 drives controlled by PDOs.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#ifndef CANDRIVE402_INCLUDEDEF_H
+#define CANDRIVE402_INCLUDEDEF_H
+
+//-----------------------------------------------
+#include <boost/atomic.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <cob_canopen_motor/CanDriveItf.h>
+#include <cob_canopen_motor/SDOClient.h>
+#include <cob_utilities/TimeStamp.h>
+//-----------------------------------------------
+
+/**
+ * Driver class for drives following the CiA 402 device profile (e.g. Elmo Gold / Harmonica in CANopen mode).
+ * In contrast to CanDriveHarmonica no binary interpreter is used:
+ * - the drive runs in profile velocity mode (0x6060 = 3),
+ * - RxPDO1 carries controlword (0x6040), target velocity (0x60FF) and touch probe function (0x60B8),
+ *   it is sent once per control cycle and applied by the drive at the following SYNC,
+ * - TxPDO1 carries position (0x6064) and velocity (0x606C),
+ *   TxPDO4 statusword (0x6041), touch probe status (0x60B9) and position (0x60BA), both on SYNC,
+ * - the device state machine is switched by SDO downloads of the controlword during the initialization.
+ * The homing event is latched by touch probe 1 on its positive edge,
+ * the position is corrected by the driver, so the drive needs no homing mode.
+ * Only velocity control is supported.
+ * \ingroup DriversCanModul
+ */
+class CanDrive402 : public CanDriveItf
+{
+public:
+	// ------------------------- Types
+	/**
+	 * Internal parameters.
+	 */
+	struct ParamType
+	{
+		double dCanTimeout;
+		double dHeartbeatPeriodS;
+		int iMaxEnableRetries;
+	};
+
+	/**
+	 * States of the drive.
+	 */
+	enum State402
+	{
+		ST_PRE_INITIALIZED,
+		ST_OPERATION_ENABLED,
+		ST_OPERATION_DISABLED,
+		ST_MOTOR_FAILURE
+	};
+
+	/**
+	 * Identifier of the CAN messages, as in the predefined connection set.
+	 */
+	struct ParamCanOpenType
+	{
+		int iTxPDO1;
+		/// telemetry stream, see setTelemetry()
+		int iTxPDO3;
+		int iTxPDO4;
+		int iRxPDO1;
+		int iTxSDO;
+		int iRxSDO;
+		int iNodeID;
+	};
+
+	// ------------------------- Interface
+	void setCanItf(CanItf* pCanItf);
+
+	/**
+	 * Initializes the driver, blocking version of beginInit() without enabling the motor.
+	 */
+	bool init();
+
+	bool isInitialized() { return m_bIsInitialized; }
+
+	/**
+	 * Switches the device state machine to "operation enabled", blocking.
+	 */
+	bool start();
+
+	/**
+	 * Switches the device state machine to "switched on", the motor is not powered anymore.
+	 */
+	bool stop();
+
+	/**
+	 * Resets a fault and starts the drive again.
+	 */
+	bool reset();
+
+	/**
+	 * Disables the voltage of the drive.
+	 */
+	bool shutdown();
+
+	/**
+	 * Not implemented, the brake is controlled by the drive.
+	 */
+	bool disableBrake(bool bDisabled) { return true; }
+
+	/**
+	 * Prepares the homing, blocking version of beginInitHoming().
+	 */
+	bool initHoming();
+
+	/**
+	 * Arms the homing and waits for the event, blocking.
+	 * Not used by CanCtrlPltfCOb3, that has its own homing implementation.
+	 */
+	bool execHoming();
+
+	/**
+	 * Starts the configuration by SDOs (mode, profile, PDO mapping),
+	 * followed by the transitions of the device state machine up to "operation enabled".
+	 */
+	void beginInit();
+
+	/**
+	 * Disarms touch probe 1, the homing is armed by armHoming().
+	 */
+	void beginInitHoming();
+
+	/**
+	 * Advances the sequence started by beginInit() or beginInitHoming().
+	 * @return state of the sequence, see CanDriveItf::InitState.
+	 */
+	int processInit();
+
+	double getInitDurationS();
+
+	double getTimeToLastMsg();
+
+	/**
+	 * Returns true as soon as touch probe 1 latched the homing event after armHoming().
+	 */
+	bool getStatusLimitSwitch() { return m_bLimSwRight; }
+
+	/**
+	 * Enables touch probe 1 on its positive edge by RxPDO1 (with the last commanded velocity).
+	 * The position latched by the drive is set to the encoder offset of the drive parameters.
+	 */
+	void armHoming();
+
+	/**
+	 * Sends a SYNC, the touch probe status is transmitted with TxPDO4.
+	 */
+	void requestHomingStatus() { requestPosVel(); }
+
+	/**
+	 * Configures the heartbeat consumer (1 s) and the reaction on its timeout (quick stop).
+	 */
+	bool startWatchdog(bool bStarted);
+
+	/**
+	 * Enables or disables the heartbeat sent with the velocity commands.
+	 */
+	void setHeartbeatProducer(bool bOn) { m_bHeartbeatProducer = bOn; }
+
+	bool evalReceivedMsg(CanMsg& msg);
+
+	bool evalReceivedMsg() { return true; }
+
+	/**
+	 * Returns TxPDO1, TxPDO3, TxPDO4 and TxSDO.
+	 */
+	void getRxCanIDs(std::vector<int>& viCanIDs);
+
+	/**
+	 * Returns TxPDO1, which carries position and velocity.
+	 */
+	int getPosVelCanID() { return m_ParamCanOpen.iTxPDO1; }
+
+	int processSDOs() { return m_SDOClient.process(); }
+
+	/**
+	 * Sends the target position and the profile velocity by SDO and starts the motion (profile position mode).
+	 * The steering moves to the absolute position, the driving wheel relative to the current one.
+	 * Only in position mode, see setTypeMotion().
+	 */
+	void setGearPosVelRadS(double dPosRad, double dVelRadS);
+
+	/**
+	 * Sends RxPDO1 with the target velocity and a SYNC.
+	 * The heartbeat for the watchdog of the drive is sent every 0.1 s.
+	 */
+	void setGearVelRadS(double dVelGearRadS);
+
+	/**
+	 * Sets the velocity in encoder increments per measurement period, see setGearVelRadS().
+	 */
+	void setMotVelIncrPeriod(int iVelEncIncrPeriod);
+
+	/**
+	 * Switches between MOTIONTYPE_VELCTRL (profile velocity mode, default)
+	 * and MOTIONTYPE_POSCTRL (profile position mode).
+	 */
+	bool setTypeMotion(int iType);
+
+	void getGearPosVelRadS(double* pdAngleGearRad, double* pdVelGearRadS);
+
+	/**
+	 * Returns the position relative to the homing position and the velocity of the drive in encoder increments.
+	 */
+	void getMotPosVelIncr(int* piPosIncr, int* piVelIncrPeriod)
+	{
+		*piPosIncr = (int)((unsigned int)m_iPosMeasIncr - (unsigned int)m_iPosOffsetIncr);
+		*piVelIncrPeriod = m_iVelMeasIncrPeriod;
+	}
+
+	void getGearDeltaPosVelRadS(double* pdDeltaAngleGearRad, double* pdVelGearRadS);
+
+	void getGearPosRad(double* pdPosGearRad);
+
+	void setDriveParam(DriveParam driveParam) { m_DriveParam = driveParam; }
+
+	/**
+	 * Returns true if the drive reported a fault or didn't send anything for dCanTimeout.
+	 */
+	bool isError();
+
+	/**
+	 * Returns the error code (0x603F) of the last fault.
+	 */
+	unsigned int getError() { return m_iErrorCode; }
+
+	/**
+	 * Sends a SYNC, position and velocity are sent by the drive on every SYNC.
+	 */
+	void requestPosVel();
+
+	/**
+	 * Does nothing, the statusword is sent by the drive on every SYNC.
+	 */
+	void requestStatus() {}
+
+	/**
+	 * Returns the statusword.
+	 */
+	void getStatus(int* piStatus, int* piTempCel) { *piStatus = m_iStatusWord; *piTempCel = 0; }
+
+	bool setEMStop() {
+		std::cout << "The function setEMStop() is not implemented!!!" << std::endl;
+		return false;
+	}
+
+	bool resetEMStop() {
+		std::cout << "The function resetEMStop() is not implemented!!!" << std::endl;
+		return false;
+	}
+
+	/**
+	 * Not supported, there is no binary interpreter. The rejected command is printed.
+	 */
+	void IntprtSetInt(int iDataLen, char cCmdChar1, char cCmdChar2, int iIndex, int iData);
+
+	/**
+	 * The Elmo Recorder isn't available, the readout returns 1 (not configured).
+	 */
+	int setRecorder(int iFlag, int iParam = 0, std::string sParam = "/home/MyLog_");
+
+	/**
+	 * Requests the active current (0x6078) by SDO.
+	 */
+	void requestMotorTorque();
+
+	void getMotorTorque(double* dTorqueNm);
+
+	/**
+	 * Not supported, only velocity control is implemented.
+	 */
+	void setMotorTorque(double dTorqueNm);
+
+	/**
+	 * Same mapping of TPDO3 as CanDriveHarmonica::setTelemetry().
+	 */
+	void setTelemetry(bool bEnable);
+
+	int readTelemetry(std::vector<TelemetrySample>& vSamples);
+
+	// ------------------------- Interface: CiA 402 specific
+	/**
+	 * Default constructor.
+	 */
+	CanDrive402();
+
+	/**
+	 * Sets the CAN identifiers of the drive node.
+	 * Takes the same identifiers as CanDriveHarmonica::setCanOpenParam(),
+	 * the other PDOs are derived from them as in the predefined connection set.
+	 * @param iTxPDO1 first transmit process data object
+	 * @param iTxPDO2 second transmit process data object (not used)
+	 * @param iRxPDO2 second receive process data object, RxPDO1 is iRxPDO2 - 0x100
+	 * @param iTxSDO transmit service data object
+	 * @param iRxSDO receive service data object, the node ID is iRxSDO - 0x600
+	 */
+	void setCanOpenParam(int iTxPDO1, int iTxPDO2, int iRxPDO2, int iTxSDO, int iRxSDO);
+
+	/**
+	 * Returns the identifiers of the CAN messages as set by setCanOpenParam().
+	 */
+	const ParamCanOpenType& getCanOpenParam() { return m_ParamCanOpen; }
+
+	/**
+	 * CANopen: Queues the download of a service data object (expedited transfer).
+	 */
+	void sendSDODownload(int iObjIndex, int iObjSub, int iData);
+
+	/**
+	 * Controlword bits and statusword states of the device state machine.
+	 */
+	enum
+	{
+		CW_SHUTDOWN = 0x06,
+		CW_SWITCH_ON = 0x07,
+		CW_ENABLE_OPERATION = 0x0F,
+		CW_DISABLE_VOLTAGE = 0x00,
+		CW_FAULT_RESET = 0x80,
+		CW_NEW_SET_POINT = 0x10,
+		CW_CHANGE_SET_IMMEDIATELY = 0x20,
+		CW_RELATIVE = 0x40,
+
+		SW_STATE_MASK = 0x6F,
+		SW_READY_TO_SWITCH_ON = 0x21,
+		SW_SWITCHED_ON = 0x23,
+		SW_OPERATION_ENABLED = 0x27,
+		SW_FAULT_BIT = 0x08
+	};
+
+protected:
+	// ------------------------- Parameters
+	ParamCanOpenType m_ParamCanOpen;
+	DriveParam m_DriveParam;
+	ParamType m_Param;
+
+	// ------------------------- Variables
+	CanItf* m_pCanCtrl;
+	SDOClient m_SDOClient;
+
+	TimeStamp m_CurrentTime;
+	TimeStamp m_WatchdogTime;
+	TimeStamp m_HeartbeatTime;
+
+	int m_iMotorState;
+	bool m_bIsInitialized;
+	bool m_bWatchdogActive;
+	bool m_bHeartbeatProducer;
+	bool m_bOutputOfFailure;
+
+	// feedback, the position is relative to m_iPosOffsetIncr (set at init and by the homing)
+	int m_iPosMeasIncr;
+	int m_iVelMeasIncrPeriod;
+	int m_iPosOffsetIncr;
+	double m_dPosGearMeasRad;
+	double m_dVelGearMeasRadS;
+	double m_dAngleGearRadMem;
+	int m_iStatusWord;
+	unsigned int m_iErrorCode;
+
+	// content of RxPDO1
+	int m_iControlWord;
+	int m_iVelCmdIncrS;
+	int m_iTouchProbeFunction;
+	// MOTIONTYPE_VELCTRL or MOTIONTYPE_POSCTRL
+	int m_iTypeMotion;
+
+	// homing by touch probe 1
+	bool m_bHomingArmed;
+	bool m_bLimSwRight;
+
+	// ------------------------- current, torque and telemetry stream
+	double m_dMotorCurr;
+	bool m_bTelemetry;
+	// scale of the per mille values, 0 if unknown
+	double m_dRatedCurrA;
+	double m_dRatedTorqueNm;
+	// written by evalReceivedMsg(), read by readTelemetry()
+	boost::lockfree::spsc_queue<TelemetrySample, boost::lockfree::capacity<1024> > m_TelemetryQueue;
+	boost::atomic<unsigned long> m_iNumTelemetryOverruns;
+
+	// ------------------------- non-blocking initialization
+	enum InitPhase
+	{
+		PHASE_NONE,
+		PHASE_CONFIG,
+		PHASE_ENABLE,
+		PHASE_DISABLE
+	};
+
+	int m_iInitState;
+	int m_iInitPhase;
+	int m_iEnableRetries;
+	// set by the callback of the statusword upload of the current phase
+	bool m_bStatusUploaded;
+	// false for init(), which doesn't enable the motor
+	bool m_bEnableAfterConfig;
+	unsigned long m_iNumSDOFailuresAtInit;
+	TimeStamp m_InitStartTime;
+	TimeStamp m_InitEndTime;
+
+	// ------------------------- Member functions
+	/**
+	 * Sends the mapping of RxPDO1, TxPDO1 and TxPDO4.
+	 */
+	void sendPDOMapping();
+
+	/**
+	 * Sends the mapping of TPDO3 (resp. disables it), see setTelemetry().
+	 */
+	void sendTelemetryMapping();
+
+	/**
+	 * Starts a phase of the initialization.
+	 */
+	void beginPhase(int iPhase);
+
+	/**
+	 * Queues the controlword transitions from the current state to iTargetState
+	 * (SW_OPERATION_ENABLED or SW_SWITCHED_ON) and the upload of the statusword.
+	 */
+	void sendStateTransitions(int iTargetState);
+
+	/**
+	 * Sends RxPDO1 with the controlword, the target velocity and the touch probe function.
+	 */
+	void sendRxPDO1(int iVelIncrS);
+
+	/**
+	 * Runs processInit() and evaluates the received messages until the sequence is finished.
+	 */
+	bool waitForInit();
+
+	void finishInit(int iState);
+
+	/**
+	 * Evaluates the statusword, latches a fault.
+	 */
+	void evalStatusWord(int iStatusWord);
+
+	/**
+	 * Called by m_SDOClient when an upload is finished.
+	 */
+	void finishedUpload(const SDOClient::Transfer& Tr);
+};
+//-----------------------------------------------
+#endif
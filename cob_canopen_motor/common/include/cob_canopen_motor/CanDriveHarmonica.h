@@ -58,10 +58,14 @@
 #define CANDRIVEHARMONICA_INCLUDEDEF_H
 
 //-----------------------------------------------
+#include <deque>
+#include <boost/atomic.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
 #include <cob_canopen_motor/CanDriveItf.h>
 #include <cob_utilities/TimeStamp.h>
 
 #include <cob_canopen_motor/SDOSegmented.h>
+#include <cob_canopen_motor/SDOClient.h>
 #include <cob_canopen_motor/ElmoRecorder.h>
 //-----------------------------------------------
 
@@ -81,6 +85,7 @@ public:
 		int iNumRetryOfSend;
 		int iDivForRequestStatus;
 		double dCanTimeout;
+		int iSDOBlockSize;
 	};
 
 	/**
@@ -104,13 +109,15 @@ public:
 		int iRxPDO2;
 		int iTxSDO;
 		int iRxSDO;
+		/// telemetry stream, iTxPDO1 + 0x200 as in the predefined connection set
+		int iTxPDO3;
 	};
 
 	// ------------------------- Interface
 	/**
 	 * Sets the CAN interface.
 	 */
-	void setCanItf(CanItf* pCanItf){ m_pCanCtrl = pCanItf; }
+	void setCanItf(CanItf* pCanItf);
 
 	/**
 	 * Initializes the driver.
@@ -165,6 +172,29 @@ public:
 	 */
 	bool execHoming();
 
+	/**
+	 * Starts the steps of init() and start() without blocking.
+	 * The interpreter commands are sent one after the other, each as soon as the drive echoed the previous one.
+	 */
+	void beginInit();
+
+	/**
+	 * Starts the steps of initHoming() without blocking.
+	 */
+	void beginInitHoming();
+
+	/**
+	 * Advances the sequence started by beginInit() or beginInitHoming().
+	 * A command is repeated if the drive does not answer within 0.1 s, the sequence fails after three repetitions.
+	 * @return state of the sequence, see CanDriveItf::InitState.
+	 */
+	int processInit();
+
+	/**
+	 * Returns the duration of the last sequence started by beginInit() or beginInitHoming().
+	 */
+	double getInitDurationS();
+
 	/**
 	 * Performs homing procedure
 	 * Drives wheel in neutral Position for Startup.
@@ -182,6 +212,16 @@ public:
 	 */
 	bool getStatusLimitSwitch();
 
+	/**
+	 * Arms the homing process (HM[1] = 1).
+	 */
+	void armHoming() { IntprtSetInt(8, 'H', 'M', 1, 1); }
+
+	/**
+	 * Requests HM[1], the drive disarms it at the homing event.
+	 */
+	void requestHomingStatus() { IntprtSetInt(4, 'H', 'M', 1, 0); }
+
 	/**
 	 * Starts the watchdog.
 	 * The Harmonica provides watchdog functionality which means the drive stops if the watchdog
@@ -191,6 +231,11 @@ public:
 	 */
 	bool startWatchdog(bool bStarted);
 
+	/**
+	 * Enables or disables the heartbeat sent with each velocity or torque command.
+	 */
+	void setHeartbeatProducer(bool bOn) { m_bHeartbeatProducer = bOn; }
+
 	/**
 	 * Evals a received message.
 	 * Only messages with fitting identifiers are evaluated.
@@ -204,6 +249,23 @@ public:
 	 */
 	bool evalReceivedMsg() { return true; }
 
+	/**
+	 * Returns the CAN identifiers evaluated by evalReceivedMsg(CanMsg&),
+	 * i.e. TxPDO1, TxPDO2 and TxSDO as set by setCanOpenParam().
+	 */
+	void getRxCanIDs(std::vector<int>& viCanIDs);
+
+	/**
+	 * Returns TxPDO1, which carries position and velocity.
+	 */
+	int getPosVelCanID() { return m_ParamCanOpen.iTxPDO1; }
+
+	/**
+	 * Handles the timeouts of the queued SDO transfers and of the blocks of a block upload.
+	 * @return number of SDO transfers queued or in progress.
+	 */
+	int processSDOs();
+
 
 	/**
 	 * Sets required position and veolocity.
@@ -217,6 +279,11 @@ public:
 	 */
 	void setGearVelRadS(double dVelEncRadS);
 
+	/**
+	 * Sets the velocity in encoder increments per measurement period, see setGearVelRadS().
+	 */
+	void setMotVelIncrPeriod(int iVelEncIncrPeriod);
+
 	/**
 	 * Sets the motion type drive.
 	 */
@@ -227,6 +294,15 @@ public:
 	 */
 	void getGearPosVelRadS(double* pdAngleGearRad, double* pdVelGearRadS);
 
+	/**
+	 * Returns the position and the velocity of the drive in encoder increments.
+	 */
+	void getMotPosVelIncr(int* piPosIncr, int* piVelIncrPeriod)
+	{
+		*piPosIncr = m_iPosMeasIncr;
+		*piVelIncrPeriod = m_iVelMeasIncrPeriod;
+	}
+
 	/**
 	 * Returns the change of the position and the velocity.
 	 * The given delta position is given since the last call of this function.
@@ -299,6 +375,11 @@ public:
 	 */
 	void setCanOpenParam( int iTxPDO1, int iTxPDO2, int iRxPDO2, int iTxSDO, int iRxSDO);
 
+	/**
+	 * Returns the identifiers of the CAN messages as set by setCanOpenParam().
+	 */
+	const ParamCanOpenType& getCanOpenParam() { return m_ParamCanOpen; }
+
 	/**
 	 * Sends an integer value to the Harmonica using the built in interpreter.
 	 */
@@ -342,12 +423,27 @@ public:
 	 */
 	void getMotorTorque(double* dTorqueNm);
 
+	/**
+	 * Maps active current (0x6078), torque (0x6077) and following error (0x60F4) to TPDO3, transmitted on SYNC.
+	 * The current and torque are scaled by the motor rated current (0x6075) and torque (0x6076) read at the same time;
+	 * if the rated torque isn't set the torque is calculated from the current like getMotorTorque().
+	 */
+	void setTelemetry(bool bEnable);
+
+	int readTelemetry(std::vector<TelemetrySample>& vSamples);
+
+	/**
+	 * Number of samples dropped because readTelemetry() wasn't called often enough.
+	 */
+	unsigned long getNumTelemetryOverruns() { return m_iNumTelemetryOverruns; }
+
 	/**
 	 * Provides several functions for drive information recording purposes using the built in ElmoRecorder, which allows to record drive information at a high frequency.
 	 * @param iFlag To keep the interface slight, use iParam to command the recorder:
 	 * 0: Configure the Recorder to record the sources Main Speed(1), Main position(2), Active current(10), Speed command(16). With iParam = iRecordingGap you specify every which time quantum (4*90usec) a new data point (of 1024 points in total) is recorded;
-	 * 1: Query Upload of recorded source (1=Main Speed, 2=Main position, 10=Active Current, 16=Speed command) with iParam and log data to file sParam = file prefix. Filename is extended with _MotorNumber_RecordedSource.log
+	 * 1: Query Upload of recorded source (1=Main Speed, 2=Main position, 10=Active Current, 16=Speed command) with iParam and log data to file sParam = file prefix. Filename is extended with _MotorNumber_RecordedSource.rec
 	 * 2: Request status of ongoing readout process
+	 * 3: Request progress of ongoing readout process, returned in percent of the uploaded bytes
 	 * 99: Abort and clear current SDO readout process
 	 * @return 0: Success, 1: Recorder hasn't been configured yet, 2: data collection still in progress
 	 *
@@ -364,17 +460,27 @@ public:
 	void IntprtSetFloat(int iDataLen, char cCmdChar1, char cCmdChar2, int iIndex, float fData);
 
 	/**
-	 * CANopen: Uploads a service data object (device to master). (in expedited transfer mode, means in only one message)
+	 * CANopen: Queues the upload of a service data object (device to master).
+	 * The request is sent as soon as the previous SDO transfer of the drive is finished.
+	 * An expedited response is ignored, a segmented one is collected in seg_Data.
 	 */
 	void sendSDOUpload(int iObjIndex, int iObjSub);
 
+	/**
+	 * CANopen: Queues the upload of a service data object by SDO block transfer, collected in seg_Data.
+	 * The drive sends up to 127 segments per confirmation instead of one.
+	 * Falls back to sendSDOUpload() if the drive doesn't support block transfers.
+	 */
+	void sendSDOBlockUpload(int iObjIndex, int iObjSub);
+
     /**
 	 * CANopen: This protocol cancels an active segmented transmission due to the given Error Code
 	 */
     void sendSDOAbort(int iObjIndex, int iObjSubIndex, unsigned int iErrorCode);
 
 	/**
-	 * CANopen: Downloads a service data object (master to device). (in expedited transfer mode, means in only one message)
+	 * CANopen: Queues the download of a service data object (master to device). (in expedited transfer mode, means in only one message)
+	 * The function returns immediately, the request is sent as soon as the previous SDO transfer of the drive is finished.
 	 */
 	void sendSDODownload(int iObjIndex, int iObjSub, int iData);
 
@@ -408,7 +514,6 @@ protected:
 
 	TimeStamp m_CurrentTime;
 	TimeStamp m_WatchdogTime;
-	TimeStamp m_VelCalcTime;
 	TimeStamp m_FailureStartTime;
 	TimeStamp m_SendTime;
 	TimeStamp m_StartTime;
@@ -416,12 +521,12 @@ protected:
 	double m_dAngleGearRadMem;
 	double m_dVelGearMeasRadS;
 	double m_dPosGearMeasRad;
+	int m_iPosMeasIncr;
+	int m_iVelMeasIncrPeriod;
 
 	bool m_bLimSwLeft;
 	bool m_bLimSwRight;
 
-	double m_dOldPos;
-
 	std::string m_sErrorMessage;
 
 	int m_iMotorState;
@@ -440,13 +545,63 @@ protected:
 	double m_dMotorCurr;
 
 	bool m_bWatchdogActive;
+	bool m_bHeartbeatProducer;
 
 	segData seg_Data;
 
+	// queue of the SDO transfers, one in progress at a time
+	SDOClient m_SDOClient;
 
-	// ------------------------- Member functions
-	double estimVel(double dPos);
+	// set when the drive aborted a block upload as unknown command, further uploads are segmented
+	bool m_bSDOBlockUnsupported;
+	// reception of the last segment of a block upload, see processSDOs()
+	TimeStamp m_SDOBlockSegmentTime;
 
+	// ------------------------- telemetry stream
+	bool m_bTelemetry;
+	// scale of the streamed per mille values, 0 if unknown
+	double m_dRatedCurrA;
+	double m_dRatedTorqueNm;
+	double m_dFollowingErrorGearRad;
+	// written by evalReceivedMsg(), read by readTelemetry()
+	boost::lockfree::spsc_queue<TelemetrySample, boost::lockfree::capacity<1024> > m_TelemetryQueue;
+	boost::atomic<unsigned long> m_iNumTelemetryOverruns;
+
+	// ------------------------- non-blocking initialization
+	/**
+	 * Interpreter command of a sequence, see beginInit().
+	 */
+	struct IntprtCmdType
+	{
+		int iDataLen;
+		char cCmdChar1;
+		char cCmdChar2;
+		int iIndex;
+		int iData;
+	};
+
+	enum InitPhase
+	{
+		PHASE_NONE,
+		PHASE_CONFIG,
+		PHASE_START,
+		PHASE_HOMING
+	};
+
+	// commands of the current phase, the front one is sent and waits for its answer if m_bIntprtSeqWaiting
+	std::deque<IntprtCmdType> m_IntprtSeq;
+	bool m_bIntprtSeqWaiting;
+	int m_iIntprtSeqRetries;
+	TimeStamp m_IntprtSeqSendTime;
+
+	int m_iInitState;
+	int m_iInitPhase;
+	unsigned long m_iNumSDOFailuresAtInit;
+	TimeStamp m_InitStartTime;
+	TimeStamp m_InitEndTime;
+
+
+	// ------------------------- Member functions
 	bool evalStatusRegister(int iStatus);
 	void evalMotorFailure(int iFailure);
 
@@ -484,6 +639,31 @@ protected:
 	 */
 	int receivedSDOSegmentedInitiation(CanMsg& msg);
 
+	/**
+	 * CANopen: Starts the collection of a block upload and requests the first block.
+	 * Function is called, when the response to the initiate block upload request is received (by evalReceivedMsg)
+	 */
+	int receivedSDOBlockInitiation(CanMsg& msg);
+
+	/**
+	 * CANopen: Segment data of a block upload is stored to the SDOSegmented container.
+	 * Segments out of sequence are dropped; after the last segment of a block the number of segments received in sequence is confirmed,
+	 * so the drive repeats the missing ones with the next block.
+	 * If the last segment of a block is lost, processSDOs() confirms after a short time without segments.
+	 */
+	int receivedSDOBlockSegment(CanMsg& msg);
+
+	/**
+	 * CANopen: Removes the unused bytes of the last segment, checks the CRC and confirms the end of a block upload.
+	 * @see finishedSDOSegmentedTransfer()
+	 */
+	int receivedSDOBlockEnd(CanMsg& msg);
+
+	/**
+	 * CANopen: Sends a request of the block upload protocol (ccs = 5) with the client sub-command iSubCmd and the data bytes 1 and 2.
+	 */
+	void sendSDOBlockCmd(int iSubCmd, int iByte1, int iByte2);
+
     /**
 	 * CANopen: Function is called by evalReceivedMsg when the current segmented SDO transfer is cancelled with an error code.
 	 * @see evalReceivedMsg()
@@ -498,6 +678,52 @@ protected:
 	 */
 	void finishedSDOSegmentedTransfer();
 
+	/**
+	 * Sends the mapping of position and velocity to TPDO1, transmitted on SYNC.
+	 */
+	void sendPDOMapping();
+
+	/**
+	 * Sends the mapping of TPDO3 (resp. disables it) and requests the rated current and torque, see setTelemetry().
+	 */
+	void sendTelemetryMapping();
+
+	/**
+	 * Called by m_SDOClient when the rated current or torque is uploaded.
+	 */
+	void finishedTelemetryUpload(const SDOClient::Transfer& Tr);
+
+	/**
+	 * Starts a sequence of interpreter commands, see beginInit().
+	 */
+	void beginIntprtSeq(int iPhase);
+
+	/**
+	 * Appends an interpreter command to the current sequence.
+	 */
+	void queueIntprtCmd(int iDataLen, char cCmdChar1, char cCmdChar2, int iIndex, int iData);
+
+	/**
+	 * Sends the front command of the sequence if no answer is outstanding.
+	 */
+	void sendNextIntprtCmd();
+
+	/**
+	 * Removes the front command of the sequence if msg is its answer and sends the next one.
+	 */
+	void evalIntprtSeqReply(CanMsg& msg);
+
+	/**
+	 * Ends the current sequence.
+	 */
+	void finishInit(int iState);
+
+	/**
+	 * Called by m_SDOClient when an upload requested by sendSDOUpload() or sendSDOBlockUpload() is finished.
+	 * Releases seg_Data if the upload failed.
+	 */
+	void finishedSDOUpload(const SDOClient::Transfer& Tr);
+
 };
 //-----------------------------------------------
 #endif
@@ -0,0 +1,178 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_canopen_motor
+ * Description: Simulated Elmo Harmonica drive for the CanDummy bus.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+
+#ifndef CANDRIVEHARMONICASIM_INCLUDEDEF_H
+#define CANDRIVEHARMONICASIM_INCLUDEDEF_H
+
+//-----------------------------------------------
+#include <vector>
+
+#include <cob_generic_can/CanDummy.h>
+#include <cob_utilities/TimeStamp.h>
+#include <cob_canopen_motor/CanDriveHarmonica.h>
+#include <cob_canopen_motor/CanDrive402.h>
+//-----------------------------------------------
+
+/**
+ * Simulation of an Elmo Harmonica drive connected to a CanDummy bus.
+ * Answers the messages CanDriveHarmonica resp. CanDrive402 sends:
+ * - SYNC: TPDO1 with position and velocity (integrated from the commanded JV resp. target velocity),
+ *   TPDO3 with the active current if it is mapped (telemetry),
+ *   TPDO4 with statusword and touch probe if it is mapped (CiA 402)
+ * - binary interpreter on RxPDO2: MO, JV, PX, HM and RR are evaluated,
+ *   queries (SR, MF, IQ, IP, HM, PX, ...) and sets are answered on TxPDO2
+ * - RxPDO1 if it is mapped (CiA 402): controlword, target velocity and touch probe function
+ * - SDO: expedited downloads are acknowledged, the controlword 0x6040 is evaluated,
+ *   uploads of the recorder object 0x2030 are answered as segmented or block transfer
+ * \ingroup DriversCanModul
+ */
+class CanDriveHarmonicaSim : public CanDummyNode
+{
+public:
+	/**
+	 * Constructor.
+	 * @param ParamCanOpen CAN identifiers of the simulated drive (same as for the CanDriveHarmonica talking to it)
+	 */
+	CanDriveHarmonicaSim(const CanDriveHarmonica::ParamCanOpenType& ParamCanOpen);
+
+	/**
+	 * Constructor for a simulated CiA 402 drive.
+	 * @param ParamCanOpen CAN identifiers of the simulated drive (same as for the CanDrive402 talking to it)
+	 */
+	CanDriveHarmonicaSim(const CanDrive402::ParamCanOpenType& ParamCanOpen);
+
+	void evalMsg(const CanMsg& CMsg, std::vector<CanMsg>& vReplies);
+
+	/**
+	 * Latches a motor failure: sets bit 6 of the status register and reports iFailure on MF.
+	 * 0 clears the failure.
+	 */
+	void setFailure(int iFailure);
+
+	/**
+	 * Sets the active current reported on IQ per commanded velocity (A per incr/s).
+	 */
+	void setCurrentPerVel(double dCurrentPerVel) { m_dCurrentPerVel = dCurrentPerVel; }
+
+	/**
+	 * Sets the distance (incr) an armed homing resp. touch probe has to travel until the homing event occurs.
+	 */
+	void setHomingDistIncr(int iHomingDistIncr) { m_iHomingDistIncr = iHomingDistIncr; }
+
+protected:
+	void init();
+	void evalIntprt(const CanMsg& CMsg, std::vector<CanMsg>& vReplies);
+	void evalSDO(const CanMsg& CMsg, std::vector<CanMsg>& vReplies);
+	void updatePos();
+
+	// CiA 402 state machine and touch probe 1
+	void evalControlWord(int iControlWord);
+	void evalTouchProbeFunction(int iTouchProbeFunction);
+	int getStatusWord();
+
+	void appendIntprt(std::vector<CanMsg>& vReplies, char cCmdChar1, char cCmdChar2, int iIndex, int iData, bool bFloat = false);
+	void appendSDO(std::vector<CanMsg>& vReplies, int iByte0, int iObjIndex, int iObjSubIndex, unsigned int iData);
+
+	// fills m_vUploadData with a synthetic recording in the format of object 0x2030
+	void fillRecorderData();
+
+	// appends the segments of the next block of a block upload, resp. its end if all data was confirmed
+	void appendUploadBlock(std::vector<CanMsg>& vReplies);
+
+	CanDriveHarmonica::ParamCanOpenType m_ParamCanOpen;
+	int m_iRxPDO1;
+	int m_iTxPDO4;
+
+	// ------------------------- drive state
+	TimeStamp m_LastUpdate;
+	double m_dPosIncr;
+	int m_iVelIncrS;
+	bool m_bMotorOn;
+	int m_iFailure;
+	double m_dCurrentPerVel;
+	int m_iDigIn;
+
+	// ------------------------- homing
+	bool m_bHomingArmed;
+	int m_iHomingPosRef;
+	int m_iHomingDistIncr;
+	double m_dHomingStartPos;
+
+	// ------------------------- recorder, SDO segmented or block upload
+	int m_iRecorderStatus;
+	int m_iRecordingGap;
+	std::vector<unsigned char> m_vUploadData;
+	unsigned int m_iUploadOffset;
+	int m_iUploadObjIndex;
+	int m_iUploadObjSubIndex;
+	bool m_bUploadToggle;
+	bool m_bUploadActive;
+	bool m_bUploadBlock;
+	int m_iUploadBlockSize;
+	unsigned int m_iUploadBlockStart;
+
+	// ------------------------- telemetry, number of objects mapped to TPDO3 (0x1A02:0)
+	int m_iNumTPDO3Mapped;
+
+	// ------------------------- CiA 402, number of objects mapped to RPDO1 (0x1600:0) and TPDO4 (0x1A03:0)
+	int m_iNumRPDO1Mapped;
+	int m_iNumTPDO4Mapped;
+	int m_iControlWord;
+	bool m_bTouchProbeArmed;
+	int m_iTouchProbeStatus;
+	int m_iTouchProbePos;
+};
+//-----------------------------------------------
+#endif
@@ -56,6 +56,7 @@
 #define CANDRIVEITF_INCLUDEDEF_H
 
 //-----------------------------------------------
+#include <vector>
 #include <cob_generic_can/CanItf.h>
 #include <cob_canopen_motor/DriveParam.h>
 #include <cob_canopen_motor/SDOSegmented.h>
@@ -78,6 +79,36 @@ public:
 		MOTIONTYPE_POSCTRL
 	};
 
+	/**
+	 * States of the non-blocking initialization, see beginInit().
+	 */
+	enum InitState
+	{
+		INIT_IDLE,
+		INIT_BUSY,
+		INIT_DONE,
+		INIT_FAILED
+	};
+
+	/**
+	 * Drive state of one SYNC cycle, streamed if enabled by setTelemetry().
+	 */
+	struct TelemetrySample
+	{
+		/// receive time of the sample (seconds, same clock as CanMsg time stamps resp. TimeStamp)
+		double dTimeS;
+		double dPosGearRad;
+		double dVelGearRadS;
+		double dMotorCurrA;
+		double dTorqueNm;
+		double dFollowingErrorGearRad;
+	};
+
+	/**
+	 * The drives are owned and deleted through this interface.
+	 */
+	virtual ~CanDriveItf() {}
+
 	/**
 	 * Sets the CAN interface.
 	 */
@@ -139,6 +170,32 @@ public:
 	 */
 	virtual bool execHoming() = 0;
 
+	/**
+	 * Starts the steps of init() and start() without blocking.
+	 * Each step is sent as soon as the drive answered the previous one,
+	 * so all drives of a CAN bus can be initialized at the same time.
+	 * Call processInit() cyclically after evaluating the received messages.
+	 */
+	virtual void beginInit() = 0;
+
+	/**
+	 * Starts the steps of initHoming() without blocking, see beginInit().
+	 */
+	virtual void beginInitHoming() = 0;
+
+	/**
+	 * Handles the timeouts of the sequence started by beginInit() or beginInitHoming()
+	 * and advances it to the next phase.
+	 * @return state of the sequence, see InitState.
+	 */
+	virtual int processInit() = 0;
+
+	/**
+	 * Returns the duration of the last sequence started by beginInit() or beginInitHoming(),
+	 * resp. the time since its begin while it is running.
+	 */
+	virtual double getInitDurationS() = 0;
+
 	/**
 	 * Returns the elapsed time since the last received message.
 	 */
@@ -150,6 +207,19 @@ public:
 	 */
 	virtual bool getStatusLimitSwitch() = 0;
 
+	/**
+	 * Arms the homing prepared by initHoming() resp. beginInitHoming().
+	 * At the homing event the position is set to the encoder offset
+	 * and getStatusLimitSwitch() returns true.
+	 */
+	virtual void armHoming() = 0;
+
+	/**
+	 * Requests the state of an armed homing, evaluated by evalReceivedMsg().
+	 * Call this function cyclically while waiting for the homing event.
+	 */
+	virtual void requestHomingStatus() = 0;
+
 	/**
 	 * Starts the watchdog.
 	 * The Harmonica provides watchdog functionality which means the drive stops if the watchdog
@@ -159,6 +229,13 @@ public:
 	 */
 	virtual bool startWatchdog(bool bStarted) = 0;
 
+	/**
+	 * Enables or disables the heartbeat the drive sends together with each velocity or torque command.
+	 * Disable it if the heartbeat is produced by a separate supervision (see DriveSupervisor).
+	 * Enabled by default.
+	 */
+	virtual void setHeartbeatProducer(bool bOn) = 0;
+
 	/**
 	 * Evals a received message.
 	 * Only messages with fitting identifiers are evaluated.
@@ -173,6 +250,27 @@ public:
 	 */
 	virtual bool evalReceivedMsg() = 0;
 
+	/**
+	 * Returns the CAN identifiers of all messages the drive evaluates in evalReceivedMsg(CanMsg&).
+	 * Used to build an identifier based dispatch table, so a received message
+	 * is only handed to the drive it belongs to.
+	 * @param viCanIDs vector the identifiers are appended to.
+	 */
+	virtual void getRxCanIDs(std::vector<int>& viCanIDs) = 0;
+
+	/**
+	 * Returns the CAN identifier of the message with position and velocity the drive sends on every SYNC.
+	 * Used to detect when the feedback of all drives of a SYNC cycle has arrived.
+	 */
+	virtual int getPosVelCanID() = 0;
+
+	/**
+	 * Handles the timeouts of the queued SDO transfers and sends the next request.
+	 * Call this function cyclically, e.g. after evaluating the received messages.
+	 * @return number of SDO transfers queued or in progress.
+	 */
+	virtual int processSDOs() = 0;
+
 	/**
 	 * Sets required position and veolocity.
 	 * Use this function only in position mode.
@@ -186,6 +284,12 @@ public:
 	 */
 	virtual void setGearVelRadS(double dVelRadS) = 0;
 
+	/**
+	 * Sets the velocity in encoder increments per measurement period (sign of the drive included),
+	 * as converted for all drives by DriveParamSet::convertVelCmd(). Otherwise the same as setGearVelRadS().
+	 */
+	virtual void setMotVelIncrPeriod(int iVelEncIncrPeriod) = 0;
+
 	/**
 	 * Sets the motion type drive.
 	 * The function is not implemented for Harmonica.
@@ -198,6 +302,12 @@ public:
 	 */
 	virtual void getGearPosVelRadS(double* pdAngleGearRad, double* pdVelGearRadS) = 0;
 
+	/**
+	 * Returns the position and the velocity of the drive in encoder increments as received
+	 * (before the conversion of getGearPosVelRadS()), see DriveParamSet::convertPosVel().
+	 */
+	virtual void getMotPosVelIncr(int* piPosIncr, int* piVelIncrPeriod) = 0;
+
 	/**
 	 * Returns the change of the position and the velocity.
 	 * The given delta position is given since the last call of this function.
@@ -275,6 +385,20 @@ public:
      * Sends command for motor Torque (in Nm)
      */
     virtual void setMotorTorque(double dTorqueNm) = 0;
+
+	/**
+	 * Enables or disables the streaming of current, torque and following error with every SYNC.
+	 * The PDO mapping is sent at init() resp. immediately if the drive is initialized already.
+	 * While the stream is enabled getMotorTorque() is updated without requestMotorTorque().
+	 */
+	virtual void setTelemetry(bool bEnable) = 0;
+
+	/**
+	 * Moves the streamed samples received since the previous call to vSamples (appended).
+	 * Can be called from another thread than the one evaluating the CAN messages (single reader).
+	 * @return number of samples appended
+	 */
+	virtual int readTelemetry(std::vector<TelemetrySample>& vSamples) = 0;
 };
 
 
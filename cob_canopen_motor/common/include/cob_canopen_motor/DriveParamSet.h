@@ -0,0 +1,150 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_canopen_motor
+ * Description: unit conversion of all drives of a platform in one batch
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#ifndef DRIVEPARAMSET_INCLUDEDEF_H
+#define DRIVEPARAMSET_INCLUDEDEF_H
+
+//-----------------------------------------------
+#include <vector>
+#include <cob_canopen_motor/DriveParam.h>
+//-----------------------------------------------
+
+/**
+ * Conversion factors of several drives stored as arrays (one entry per drive),
+ * so the positions and velocities of all drives are converted in one loop the compiler can vectorize.
+ * The factors include the sign of the drive and are the reciprocals of the ones used for commands,
+ * the conversion is a multiplication only.
+ * \ingroup DriversCanModul
+ */
+class DriveParamSet
+{
+public:
+
+	/**
+	 * Sets the number of drives. The factors of new drives are 0 until setParam() is called.
+	 */
+	void resize(int iNumDrives)
+	{
+		m_vdPosIncrToGearRad.resize(iNumDrives, 0);
+		m_vdVelIncrToGearRadS.resize(iNumDrives, 0);
+		m_vdGearRadSToVelIncr.resize(iNumDrives, 0);
+	}
+
+	/**
+	 * Returns the number of drives.
+	 */
+	int size() const
+	{
+		return m_vdPosIncrToGearRad.size();
+	}
+
+	/**
+	 * Takes the conversion factors of a drive.
+	 * @param iDrive index of the drive, see resize()
+	 */
+	void setParam(int iDrive, DriveParam& Param)
+	{
+		m_vdPosIncrToGearRad[iDrive] = Param.getSign() * Param.PosMotIncrToPosGearRad(1);
+		m_vdVelIncrToGearRadS[iDrive] = Param.getSign() * Param.VelMotIncrPeriodToVelGearRadS(1);
+		m_vdGearRadSToVelIncr[iDrive] = 1.0 / m_vdVelIncrToGearRadS[iDrive];
+	}
+
+	/**
+	 * Returns one encoder increment of a drive in radians of the gear (incl. sign).
+	 */
+	double getPosIncrToGearRad(int iDrive) const
+	{
+		return m_vdPosIncrToGearRad[iDrive];
+	}
+
+	/**
+	 * Converts encoder increments and increments per measurement period of all drives
+	 * to gear position in radians and gear velocity in rad/s (same as DriveParam incl. sign).
+	 * The arrays have size() entries.
+	 */
+	void convertPosVel(const int* piPosIncr, const int* piVelIncrPeriod,
+		double* pdPosGearRad, double* pdVelGearRadS) const
+	{
+		const int iNumDrives = size();
+		const double* pdPosFactor = &m_vdPosIncrToGearRad[0];
+		const double* pdVelFactor = &m_vdVelIncrToGearRadS[0];
+
+		for (int i = 0; i < iNumDrives; i++)
+			pdPosGearRad[i] = piPosIncr[i] * pdPosFactor[i];
+
+		for (int i = 0; i < iNumDrives; i++)
+			pdVelGearRadS[i] = piVelIncrPeriod[i] * pdVelFactor[i];
+	}
+
+	/**
+	 * Converts the gear velocities of all drives in rad/s to increments per measurement period (incl. sign).
+	 * The arrays have size() entries.
+	 */
+	void convertVelCmd(const double* pdVelGearRadS, int* piVelIncrPeriod) const
+	{
+		const int iNumDrives = size();
+		const double* pdVelFactor = &m_vdGearRadSToVelIncr[0];
+
+		for (int i = 0; i < iNumDrives; i++)
+			piVelIncrPeriod[i] = (int)(pdVelGearRadS[i] * pdVelFactor[i]);
+	}
+
+private:
+
+	std::vector<double> m_vdPosIncrToGearRad;
+	std::vector<double> m_vdVelIncrToGearRadS;
+	std::vector<double> m_vdGearRadSToVelIncr;
+};
+//-----------------------------------------------
+#endif
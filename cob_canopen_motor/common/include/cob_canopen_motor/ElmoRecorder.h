@@ -12,7 +12,7 @@
  * ROS package name: canopen_motor
  * Description: The in Elmo drives integrated Recorder allows the user to record drive information at a high frequency.
  * The Recorder firstly has to be configured properly. It can be started immidiately after configuring or later, triggered by a signal (e.g. a begin-motion-command).
- * When the recording is finished, you can read out the data via CANopen using a segmented SDO transfer. Appropriate functions for this CANopen specific process are provided by the CanDriveHarmonica class.
+ * When the recording is finished, you can read out the data via CANopen using a SDO block transfer (or a segmented one, if the drive doesn't support block transfers). Appropriate functions for this CANopen specific process are provided by the CanDriveHarmonica class.
  * This class brings all the functions to use the Elmo Recorder in a comfortable way.
  *
  * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -58,6 +58,7 @@
 #define _ElmoRecorder_H
 
 #include <string>
+#include <vector>
 #include <cob_canopen_motor/SDOSegmented.h>
 
 class CanDriveHarmonica;
@@ -66,7 +67,7 @@ class CanDriveHarmonica;
  * The in Elmo drives integrated Recorder allows the user to record drive information at a high frequency.
  *
  * The Recorder firstly has to be configured properly. It can be started immidiately after configuring or later, triggered by a signal (e.g. a begin-motion-command).
- * When the recording is finished, you can read out the data via CANopen using a segmented SDO transfer. Appropriate functions for this CANopen specific process are provided by the CanDriveHarmonica class.
+ * When the recording is finished, you can read out the data via CANopen using a SDO block transfer (or a segmented one, if the drive doesn't support block transfers). Appropriate functions for this CANopen specific process are provided by the CanDriveHarmonica class.
  * This class brings all the functions to use the Elmo Recorder in a comfortable way.
  */
 class ElmoRecorder {
@@ -113,7 +114,7 @@ class ElmoRecorder {
 		int readoutRecorderTryStatus(int iStatusReg, segData& SDOData);
 
 		/**
-		* @param sLogFileprefix Path (to an existing directory!) and file-prefix for the created logfile. It is extended with _MotorNumber_RecordedSource.log
+		* @param sLogFileprefix Path (to an existing directory!) and file-prefix for the created logfile. It is extended with _MotorNumber_RecordedSource.rec
 		*/
 		int setLogFilename(std::string sLogFileprefix);
 
@@ -150,11 +151,16 @@ class ElmoRecorder {
 		int readoutRecorder(int iObjSubIndex);
 
 		/**
-		* After processing the collected Recorder data log it to a file.
-		* @param vtValues[] A 2 x N vector with a time stamp in the first column and the according data point value in teh second
-		* @param filename Path and file-prefix to an existing directory! It is extended with _MotorNumber_RecordedSource.log
+		* Decoded values of the last readout, kept to reuse the memory
 		*/
-		int logToFile(std::string filename, std::vector<float> vtValues[]);
+		std::vector<float> m_vfValues;
+
+		/**
+		* After processing the collected Recorder data log it to a binary file, see ElmoRecorderFileHeader.
+		* @param vfValues The recorded data points, the time stamps follow from the recording gap
+		* @param filename Path and file-prefix to an existing directory! It is extended with _MotorNumber_RecordedSource.rec
+		*/
+		int logToFile(std::string filename, const std::vector<float>& vfValues);
 
 		/**
 		* Convert the 32bit binary representation of a float to an actual 32bit float value
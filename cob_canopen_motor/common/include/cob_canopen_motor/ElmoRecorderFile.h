@@ -0,0 +1,119 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_canopen_motor
+ * Description: Binary file format of the Elmo Recorder data.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#ifndef ELMORECORDERFILE_INCLUDEDEF_H
+#define ELMORECORDERFILE_INCLUDEDEF_H
+//-----------------------------------------------
+#include <stdint.h>
+#include <string>
+#include <vector>
+//-----------------------------------------------
+
+/**
+ * File layout of an Elmo Recorder readout: an ElmoRecorderFileHeader followed by iNumColumns
+ * columns of iNumSamples float values each. Sample i was recorded at i * fSamplePeriodS.
+ * All values are in host byte order; the columns are 4 byte aligned, so a mapped file can be
+ * used without copying.
+ */
+struct ElmoRecorderFileHeader
+{
+	char cMagic[8];
+	uint32_t iVersion;
+	uint32_t iHeaderSize;
+	int32_t iDriveID;
+	/// recorded source, i.e. the subindex of object 0x2030 (1=Main Speed, 2=Main position, 10=Active Current, 16=Speed command)
+	int32_t iSource;
+	float fSamplePeriodS;
+	uint32_t iNumSamples;
+	uint32_t iNumColumns;
+	uint32_t iReserved;
+};
+
+typedef char ElmoRecorderFileHeaderSizeCheck[(sizeof(ElmoRecorderFileHeader) == 40) ? 1 : -1];
+
+/**
+ * Writes header and columns of a recording with a single write.
+ * @param vfColumns iNumColumns * iNumSamples values, column by column
+ */
+bool writeElmoRecorderFile(const std::string& sFileName, int iDriveID, int iSource, float fSamplePeriodS,
+	unsigned int iNumSamples, const std::vector<float>& vfColumns);
+
+/**
+ * Read access to a recording (memory-mapped, read-only).
+ */
+class ElmoRecorderFileReader
+{
+public:
+	ElmoRecorderFileReader();
+	~ElmoRecorderFileReader();
+
+	bool open(const std::string& sFileName);
+	void close();
+
+	const ElmoRecorderFileHeader& getHeader() { return *m_pHeader; }
+
+	/**
+	 * Direct access to column iColumn, valid until close().
+	 */
+	const float* getColumn(unsigned int iColumn) { return m_pData + iColumn * m_pHeader->iNumSamples; }
+
+private:
+	int m_iFd;
+	size_t m_iMapSize;
+	void* m_pMap;
+	const ElmoRecorderFileHeader* m_pHeader;
+	const float* m_pData;
+};
+//-----------------------------------------------
+#endif
@@ -0,0 +1,198 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_canopen_motor
+ * Description: Asynchronous client for the expedited SDO transfers of one CANopen node.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#ifndef SDOCLIENT_INCLUDEDEF_H
+#define SDOCLIENT_INCLUDEDEF_H
+//-----------------------------------------------
+#include <deque>
+
+#include <boost/function.hpp>
+
+#include <cob_generic_can/CanItf.h>
+#include <cob_utilities/Mutex.h>
+#include <cob_utilities/TimeStamp.h>
+//-----------------------------------------------
+
+/**
+ * Queue of SDO transfers to one CANopen node.
+ * CANopen allows one outstanding SDO transfer per node, so the next request is sent
+ * as soon as the response (or an abort) of the previous one was received.
+ * Requests return immediately; the result is reported to an optional callback.
+ * Transfers to different nodes proceed in parallel at bus speed.
+ *
+ * Segmented uploads are started like expedited ones. The segments are handled by the owner
+ * of the client, which reports the end of the transfer with finishSegmented().
+ * Block uploads (CiA 301) are handled the same way: the client sends the initiate request,
+ * all further frames of the transfer are left to the owner.
+ */
+class SDOClient
+{
+public:
+	enum Result
+	{
+		SDO_PENDING = 0,
+		SDO_DONE,
+		SDO_ABORTED,
+		SDO_TIMEOUT
+	};
+
+	struct Transfer;
+
+	/**
+	 * Called (without any lock held) when a transfer is finished.
+	 */
+	typedef boost::function<void (const Transfer&)> Callback;
+
+	struct Transfer
+	{
+		bool bUpload;
+		/// upload by SDO block transfer
+		bool bBlock;
+		/// number of segments per block requested by a block upload
+		int iBlockSize;
+		int iObjIndex;
+		int iObjSubIndex;
+		/// value to download resp. uploaded value (number of bytes of a segmented upload)
+		int iData;
+		int iResult;
+		/// abort code sent by the node if iResult is SDO_ABORTED
+		unsigned int iAbortCode;
+		Callback Done;
+	};
+
+	SDOClient();
+
+	/**
+	 * Sets the CAN interface and the identifiers of the SDO channel.
+	 * @param iRxSDO identifier of the requests (received by the node)
+	 * @param iTxSDO identifier of the responses (sent by the node)
+	 */
+	void setCanItf(CanItf* pCanItf, int iRxSDO, int iTxSDO);
+
+	/**
+	 * Sets the time to wait for a response before the transfer fails with SDO_TIMEOUT.
+	 */
+	void setTimeout(double dTimeoutS) { m_dTimeoutS = dTimeoutS; }
+
+	/**
+	 * Queues an expedited download (master to node) of a 32 bit value.
+	 */
+	void download(int iObjIndex, int iObjSubIndex, int iData, const Callback& Done = Callback());
+
+	/**
+	 * Queues an upload (node to master).
+	 */
+	void upload(int iObjIndex, int iObjSubIndex, const Callback& Done = Callback());
+
+	/**
+	 * Queues a block upload (node to master).
+	 * The node sends up to iBlockSize (1..127) segments before it waits for an acknowledge.
+	 * If the node doesn't support block transfers, it aborts the transfer.
+	 */
+	void uploadBlock(int iObjIndex, int iObjSubIndex, int iBlockSize, const Callback& Done = Callback());
+
+	/**
+	 * Evaluates a message of the node's SDO channel.
+	 * @return true if the message finished the transfer in progress,
+	 *         false if it belongs to a segmented or block upload or to no transfer of this client
+	 */
+	bool evalReceivedMsg(const CanMsg& CMsg);
+
+	/**
+	 * Finishes the segmented or block upload in progress.
+	 * @param bOk false if the owner aborted the upload
+	 * @param iNumBytes number of bytes received
+	 */
+	void finishSegmented(bool bOk, int iNumBytes);
+
+	/**
+	 * Checks the timeout of the transfer in progress. Call cyclically.
+	 * A transfer timing out is aborted (0x05040000) on the node before the next one starts.
+	 * @return number of transfers queued or in progress
+	 */
+	int process();
+
+	/**
+	 * Number of transfers which failed by timeout resp. abort of the node since construction.
+	 */
+	unsigned long getNumTimeouts() { return m_iNumTimeouts; }
+	unsigned long getNumAborts() { return m_iNumAborts; }
+
+private:
+	// sends the first queued transfer if none is in progress, caller holds m_Mutex
+	void sendNext();
+
+	// removes the transfer in progress and starts the next one, caller holds m_Mutex
+	Transfer finishActive(int iResult, int iData, unsigned int iAbortCode);
+
+	// sends an abort of the transfer in progress to the node, caller holds m_Mutex
+	void sendAbort(unsigned int iAbortCode);
+
+	CanItf* m_pCanItf;
+	int m_iRxSDO;
+	int m_iTxSDO;
+	double m_dTimeoutS;
+
+	Mutex m_Mutex;
+	// the front transfer is in progress if m_bActive is set
+	std::deque<Transfer> m_Queue;
+	bool m_bActive;
+	bool m_bSegmented;
+	TimeStamp m_LastActivity;
+
+	unsigned long m_iNumTimeouts;
+	unsigned long m_iNumAborts;
+};
+//-----------------------------------------------
+#endif
@@ -59,6 +59,7 @@
 /**
 * This class is used to collect data that is uploaded to the master in an segmented SDO transfer. Additionally, it includes some administrative functions for this proccess.
 * It can be seen as a SDO segmented collector.
+* The same collector is used for SDO block uploads (CiA 301), which transfer up to 127 segments per confirmation.
 */
 class segData {
 
@@ -79,6 +80,8 @@ class segData {
 			objectSubID = 0x00;
 			toggleBit = false;
 			statusFlag = SDO_SEG_FREE;
+			numTotalBytes = 0;
+			resetBlockData();
 		}
 
 		~segData() {}
@@ -92,6 +95,37 @@ class segData {
 			objectSubID = 0x00;
 			toggleBit = false;
 			statusFlag = SDO_SEG_FREE;
+			numTotalBytes = 0;
+			resetBlockData();
+		}
+
+		/**
+		* Clear the state of a block transfer
+		*/
+		void resetBlockData() {
+			blockTransfer = false;
+			blockSize = 0;
+			seqNo = 0;
+			numBlockSegments = 0;
+			lastSegment = false;
+			crcSupported = false;
+		}
+
+		/**
+		* Calculates the CRC of the data as used by the SDO block transfer (CRC-16-CCITT, polynom 0x1021, start value 0)
+		*/
+		static unsigned short calcCRC(const std::vector<unsigned char>& data) {
+			unsigned short crc = 0;
+
+			for(unsigned int i = 0; i < data.size(); i++) {
+				crc ^= (unsigned short)data[i] << 8;
+				for(int j = 0; j < 8; j++) {
+					if(crc & 0x8000) crc = (crc << 1) ^ 0x1021;
+					else crc = crc << 1;
+				}
+			}
+
+			return crc;
 		}
 
 		//public attributes
@@ -126,6 +160,36 @@ class segData {
 		*/
 		unsigned int numTotalBytes;
 
+		/**
+		* Set if the data is uploaded in a SDO block transfer instead of a segmented transfer
+		*/
+		bool blockTransfer;
+
+		/**
+		* Block transfer: number of segments the server sends before it waits for a confirmation
+		*/
+		int blockSize;
+
+		/**
+		* Block transfer: sequence number of the last segment received in order within the current block
+		*/
+		int seqNo;
+
+		/**
+		* Block transfer: number of segments received since the last confirmation (in sequence or not)
+		*/
+		int numBlockSegments;
+
+		/**
+		* Block transfer: the last segment has been received, the end of the transfer is pending
+		*/
+		bool lastSegment;
+
+		/**
+		* Block transfer: the server sends a CRC of the data at the end of the transfer
+		*/
+		bool crcSupported;
+
 		/**
 		* This vector holds the received data byte-wise
 		*/
@@ -0,0 +1,170 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_canopen_motor
+ * Description: velocity estimation from sampled drive positions
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#ifndef VELESTIMATOR_INCLUDEDEF_H
+#define VELESTIMATOR_INCLUDEDEF_H
+
+//-----------------------------------------------
+#include <string>
+//-----------------------------------------------
+
+/**
+ * Estimates the velocity of a drive from its sampled positions.
+ * The samples are stamped with the reception time of the PDO (not the time of evaluation),
+ * so the jitter of the control loop doesn't enter the estimate.
+ * Use create() to get the estimator selected by name.
+ * \ingroup DriversCanModul
+ */
+class VelEstimator
+{
+public:
+
+	/**
+	 * Parameters of all estimators, each one uses its part.
+	 */
+	struct ParamType
+	{
+		/// alpha-beta filter: position gain (0..1)
+		double dAlpha;
+		/// alpha-beta filter: velocity gain (0..2 - alpha)
+		double dBeta;
+		/// Kalman filter: standard deviation of the acceleration (rad/s^2) driving the constant velocity model
+		double dAccNoise;
+		/// Kalman filter: standard deviation of the position measurement (rad), about one encoder increment
+		double dPosNoise;
+	};
+
+	virtual ~VelEstimator() {}
+
+	/**
+	 * Creates an estimator.
+	 * @param sType "Diff" (finite difference), "AlphaBeta" or "Kalman"
+	 * @return NULL for an unknown type
+	 */
+	static VelEstimator* create(const std::string& sType, const ParamType& Param);
+
+	/**
+	 * Adds a position sample.
+	 * @param dPos position (rad)
+	 * @param dTimeS time of the sample (s), samples not newer than the previous one are ignored
+	 * @return estimated velocity (rad/s)
+	 */
+	virtual double update(double dPos, double dTimeS) = 0;
+
+	/**
+	 * Returns the last estimated velocity (rad/s).
+	 */
+	double getVel() { return m_dVel; }
+
+	/**
+	 * Restarts the estimation with the next sample (e.g. after homing moved the position).
+	 */
+	void reset() { m_bInitialized = false; m_dVel = 0; }
+
+protected:
+	VelEstimator() : m_bInitialized(false), m_dPos(0), m_dVel(0), m_dTimeS(0) {}
+
+	bool m_bInitialized;
+	double m_dPos;
+	double m_dVel;
+	double m_dTimeS;
+};
+
+//-----------------------------------------------
+/**
+ * Finite difference of two successive samples.
+ */
+class VelEstimatorDiff : public VelEstimator
+{
+public:
+	double update(double dPos, double dTimeS);
+};
+
+//-----------------------------------------------
+/**
+ * Alpha-beta filter (steady state Kalman filter of a constant velocity model with fixed gains).
+ */
+class VelEstimatorAlphaBeta : public VelEstimator
+{
+public:
+	VelEstimatorAlphaBeta(double dAlpha, double dBeta) : m_dAlpha(dAlpha), m_dBeta(dBeta) {}
+
+	double update(double dPos, double dTimeS);
+
+private:
+	double m_dAlpha;
+	double m_dBeta;
+};
+
+//-----------------------------------------------
+/**
+ * Kalman filter of a constant velocity model with white noise acceleration.
+ * Unlike the alpha-beta filter the gains follow the actual sample period.
+ */
+class VelEstimatorKalman : public VelEstimator
+{
+public:
+	VelEstimatorKalman(double dAccNoise, double dPosNoise);
+
+	double update(double dPos, double dTimeS);
+
+private:
+	double m_dAccVar;
+	double m_dPosVar;
+
+	// covariance of position and velocity
+	double m_dP11, m_dP12, m_dP22;
+};
+//-----------------------------------------------
+#endif
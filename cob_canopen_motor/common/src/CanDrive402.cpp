@@ -0,0 +1,970 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_canopen_motor
+ * Description: Driver for CiA 402 drives controlled by PDOs.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#include <cob_canopen_motor/CanDrive402.h>
+#include <unistd.h>
+#include <boost/bind.hpp>
+
+//-----------------------------------------------
+CanDrive402::CanDrive402()
+{
+	// Parameter
+	m_Param.dCanTimeout = 6;
+	m_Param.dHeartbeatPeriodS = 0.1;
+	m_Param.iMaxEnableRetries = 10;
+
+	// Variables
+	m_pCanCtrl = NULL;
+
+	m_iMotorState = ST_PRE_INITIALIZED;
+	m_bIsInitialized = false;
+	m_bWatchdogActive = false;
+	m_bHeartbeatProducer = true;
+	m_bOutputOfFailure = false;
+
+	m_iPosMeasIncr = 0;
+	m_iVelMeasIncrPeriod = 0;
+	m_iPosOffsetIncr = 0;
+	m_dPosGearMeasRad = 0;
+	m_dVelGearMeasRadS = 0;
+	m_dAngleGearRadMem = 0;
+	m_iStatusWord = 0;
+	m_iErrorCode = 0;
+
+	m_iControlWord = CW_SHUTDOWN;
+	m_iVelCmdIncrS = 0;
+	m_iTypeMotion = MOTIONTYPE_VELCTRL;
+	m_iTouchProbeFunction = 0;
+
+	m_bHomingArmed = false;
+	m_bLimSwRight = false;
+
+	m_dMotorCurr = 0;
+	m_bTelemetry = false;
+	m_dRatedCurrA = 0;
+	m_dRatedTorqueNm = 0;
+	m_iNumTelemetryOverruns = 0;
+
+	m_iInitState = INIT_IDLE;
+	m_iInitPhase = PHASE_NONE;
+	m_iEnableRetries = 0;
+	m_bStatusUploaded = false;
+	m_bEnableAfterConfig = true;
+	m_iNumSDOFailuresAtInit = 0;
+
+	m_WatchdogTime.SetNow();
+	m_HeartbeatTime.SetNow();
+}
+
+//-----------------------------------------------
+void CanDrive402::setCanOpenParam(int iTxPDO1, int iTxPDO2, int iRxPDO2, int iTxSDO, int iRxSDO)
+{
+	m_ParamCanOpen.iTxPDO1 = iTxPDO1;
+	m_ParamCanOpen.iTxPDO3 = iTxPDO1 + 0x200;
+	m_ParamCanOpen.iTxPDO4 = iTxPDO1 + 0x300;
+	m_ParamCanOpen.iRxPDO1 = iRxPDO2 - 0x100;
+	m_ParamCanOpen.iTxSDO = iTxSDO;
+	m_ParamCanOpen.iRxSDO = iRxSDO;
+	m_ParamCanOpen.iNodeID = iRxSDO - 0x600;
+
+	m_SDOClient.setCanItf(m_pCanCtrl, m_ParamCanOpen.iRxSDO, m_ParamCanOpen.iTxSDO);
+}
+
+//-----------------------------------------------
+void CanDrive402::setCanItf(CanItf* pCanItf)
+{
+	m_pCanCtrl = pCanItf;
+	m_SDOClient.setCanItf(m_pCanCtrl, m_ParamCanOpen.iRxSDO, m_ParamCanOpen.iTxSDO);
+}
+
+//-----------------------------------------------
+void CanDrive402::getRxCanIDs(std::vector<int>& viCanIDs)
+{
+	viCanIDs.push_back(m_ParamCanOpen.iTxPDO1);
+	viCanIDs.push_back(m_ParamCanOpen.iTxPDO3);
+	viCanIDs.push_back(m_ParamCanOpen.iTxPDO4);
+	viCanIDs.push_back(m_ParamCanOpen.iTxSDO);
+}
+
+//-----------------------------------------------
+bool CanDrive402::evalReceivedMsg(CanMsg& msg)
+{
+	bool bRet = false;
+	int iTemp1, iTemp2;
+
+	//-----------------------
+	// PDO1 - position and velocity, transmitted on SYNC
+	if (msg.m_iID == m_ParamCanOpen.iTxPDO1)
+	{
+		iTemp1 = (msg.getAt(3) << 24) | (msg.getAt(2) << 16)
+				| (msg.getAt(1) << 8) | (msg.getAt(0) );
+		iTemp2 = (msg.getAt(7) << 24) | (msg.getAt(6) << 16)
+				| (msg.getAt(5) << 8) | (msg.getAt(4) );
+
+		// difference modulo 2^32, so an overflow of the position counter doesn't matter
+		m_iPosMeasIncr = iTemp1;
+		iTemp1 = (int)((unsigned int)iTemp1 - (unsigned int)m_iPosOffsetIncr);
+
+		m_dPosGearMeasRad = m_DriveParam.getSign() * m_DriveParam.PosMotIncrToPosGearRad(iTemp1);
+		m_dVelGearMeasRadS = m_DriveParam.getSign() * m_DriveParam.VelMotIncrPeriodToVelGearRadS(iTemp2);
+		m_iVelMeasIncrPeriod = iTemp2;
+
+		m_WatchdogTime.SetNow();
+
+		bRet = true;
+	}
+
+	//-----------------------
+	// PDO4 - statusword and touch probe, transmitted on SYNC
+	if (msg.m_iID == m_ParamCanOpen.iTxPDO4)
+	{
+		int iTouchProbeStatus = (msg.getAt(3) << 8) | msg.getAt(2);
+
+		evalStatusWord( (msg.getAt(1) << 8) | msg.getAt(0) );
+
+		// homing event: positive edge of touch probe 1 stored, the latched position becomes the encoder offset
+		if (m_bHomingArmed && ((iTouchProbeStatus & 0x02) != 0))
+		{
+			iTemp1 = (msg.getAt(7) << 24) | (msg.getAt(6) << 16)
+					| (msg.getAt(5) << 8) | (msg.getAt(4) );
+
+			m_iPosOffsetIncr = (int)((unsigned int)iTemp1 - (unsigned int)m_DriveParam.getEncOffset());
+			m_bHomingArmed = false;
+			m_bLimSwRight = true;
+			m_iTouchProbeFunction = 0;
+		}
+
+		m_WatchdogTime.SetNow();
+
+		bRet = true;
+	}
+
+	//-----------------------
+	// PDO3 - telemetry, transmitted on SYNC
+	if (m_bTelemetry && (msg.m_iID == m_ParamCanOpen.iTxPDO3))
+	{
+		TelemetrySample Sample;
+		TimeStamp Now;
+		long lSec, lNSec;
+
+		// current and torque in per mille of the rated values
+		short iCurrPerMille = (msg.getAt(1) << 8) | msg.getAt(0);
+		short iTorquePerMille = (msg.getAt(3) << 8) | msg.getAt(2);
+
+		iTemp1 = (msg.getAt(7) << 24) | (msg.getAt(6) << 16)
+				| (msg.getAt(5) << 8) | (msg.getAt(4) );
+
+		m_dMotorCurr = iCurrPerMille * m_dRatedCurrA / 1000.0;
+
+		if (msg.hasTimeStamp())
+			msg.getTimeStamp(lSec, lNSec);
+		else
+		{
+			Now.SetNow();
+			Now.getTimeStamp(lSec, lNSec);
+		}
+
+		Sample.dTimeS = lSec + 1e-9 * lNSec;
+		Sample.dPosGearRad = m_dPosGearMeasRad;
+		Sample.dVelGearRadS = m_dVelGearMeasRadS;
+		Sample.dMotorCurrA = m_DriveParam.getSign() * m_dMotorCurr;
+		if (m_dRatedTorqueNm > 0)
+			Sample.dTorqueNm = m_DriveParam.getSign() * iTorquePerMille * m_dRatedTorqueNm / 1000.0;
+		else
+			getMotorTorque(&Sample.dTorqueNm);
+		Sample.dFollowingErrorGearRad = m_DriveParam.getSign() * m_DriveParam.PosMotIncrToPosGearRad(iTemp1);
+
+		if (!m_TelemetryQueue.push(Sample))
+			m_iNumTelemetryOverruns++;
+
+		bRet = true;
+	}
+
+	//-----------------------
+	// SDO
+	if (msg.m_iID == m_ParamCanOpen.iTxSDO)
+	{
+		m_WatchdogTime.SetNow();
+
+		// only expedited transfers are used
+		m_SDOClient.evalReceivedMsg(msg);
+
+		bRet = true;
+	}
+
+	return bRet;
+}
+
+//-----------------------------------------------
+void CanDrive402::evalStatusWord(int iStatusWord)
+{
+	m_iStatusWord = iStatusWord;
+
+	if ((iStatusWord & SW_FAULT_BIT) != 0)
+	{
+		if (m_iMotorState != ST_MOTOR_FAILURE)
+		{
+			std::cout << "Motor " << m_DriveParam.getDriveIdent() << " fault, statusword 0x"
+				<< std::hex << iStatusWord << std::dec << std::endl;
+
+			// the error code is reported by finishedUpload()
+			m_SDOClient.upload(0x603F, 0, boost::bind(&CanDrive402::finishedUpload, this, _1));
+
+			m_iMotorState = ST_MOTOR_FAILURE;
+		}
+	}
+	else if ((iStatusWord & SW_STATE_MASK) == SW_OPERATION_ENABLED)
+	{
+		m_iMotorState = ST_OPERATION_ENABLED;
+	}
+	else if (m_iMotorState == ST_OPERATION_ENABLED)
+	{
+		m_iMotorState = ST_OPERATION_DISABLED;
+	}
+}
+
+//-----------------------------------------------
+void CanDrive402::finishedUpload(const SDOClient::Transfer& Tr)
+{
+	if (Tr.iResult != SDOClient::SDO_DONE)
+		return;
+
+	switch (Tr.iObjIndex)
+	{
+	case 0x6041:
+		// statusword at the end of a state transition, evaluated by processInit()
+		m_iStatusWord = Tr.iData & 0xFFFF;
+		m_bStatusUploaded = true;
+		break;
+
+	case 0x6064:
+		// position counter at init, corresponds to position zero
+		m_iPosOffsetIncr = Tr.iData;
+		m_iPosMeasIncr = Tr.iData;
+		m_dPosGearMeasRad = 0;
+		m_dAngleGearRadMem = 0;
+		break;
+
+	case 0x603F:
+		m_iErrorCode = Tr.iData & 0xFFFF;
+		std::cout << "Motor " << m_DriveParam.getDriveIdent() << " error code 0x"
+			<< std::hex << m_iErrorCode << std::dec << std::endl;
+		break;
+
+	case 0x6078:
+		m_dMotorCurr = (short)Tr.iData * m_dRatedCurrA / 1000.0;
+		break;
+
+	case 0x6075:
+		// rated current in mA
+		m_dRatedCurrA = (unsigned int)Tr.iData / 1000.0;
+		break;
+
+	case 0x6076:
+		// rated torque in mNm
+		m_dRatedTorqueNm = (unsigned int)Tr.iData / 1000.0;
+		break;
+
+	default:
+		break;
+	}
+}
+
+//-----------------------------------------------
+// Initialization: the configuration and the state transitions are SDO transfers,
+// each sent as soon as the previous one is answered (see SDOClient).
+//-----------------------------------------------
+
+//-----------------------------------------------
+void CanDrive402::beginInit()
+{
+	m_iMotorState = ST_PRE_INITIALIZED;
+	m_bWatchdogActive = false;
+	m_bIsInitialized = false;
+
+	beginPhase(PHASE_CONFIG);
+	m_bEnableAfterConfig = true;
+
+	// profile velocity or profile position mode, see setTypeMotion()
+	sendSDODownload(0x6060, 0, (m_iTypeMotion == MOTIONTYPE_POSCTRL) ? 1 : 3);
+
+	// profile acceleration and deceleration
+	sendSDODownload(0x6083, 0, int(m_DriveParam.getMaxAcc()));
+	sendSDODownload(0x6084, 0, int(m_DriveParam.getMaxDec()));
+
+	// the current position becomes position zero
+	m_SDOClient.upload(0x6064, 0, boost::bind(&CanDrive402::finishedUpload, this, _1));
+
+	// scale of the current and torque
+	m_SDOClient.upload(0x6075, 0, boost::bind(&CanDrive402::finishedUpload, this, _1));
+	m_SDOClient.upload(0x6076, 0, boost::bind(&CanDrive402::finishedUpload, this, _1));
+
+	sendPDOMapping();
+}
+
+//-----------------------------------------------
+void CanDrive402::beginInitHoming()
+{
+	beginPhase(PHASE_NONE);
+
+	// touch probe 1 is disabled until armHoming(), so the next enable latches a new event
+	m_iTouchProbeFunction = 0;
+	m_bHomingArmed = false;
+	m_bLimSwRight = false;
+
+	finishInit(INIT_DONE);
+}
+
+//-----------------------------------------------
+void CanDrive402::armHoming()
+{
+	// enable touch probe 1, trigger on the first event, touch probe 1 input, positive edge
+	m_iTouchProbeFunction = 0x0011;
+	m_bHomingArmed = true;
+	m_bLimSwRight = false;
+
+	sendRxPDO1(m_iVelCmdIncrS);
+}
+
+//-----------------------------------------------
+void CanDrive402::beginPhase(int iPhase)
+{
+	m_iInitState = INIT_BUSY;
+	m_iInitPhase = iPhase;
+	m_iEnableRetries = 0;
+	m_iNumSDOFailuresAtInit = m_SDOClient.getNumTimeouts() + m_SDOClient.getNumAborts();
+
+	m_InitStartTime.SetNow();
+	m_InitEndTime = m_InitStartTime;
+}
+
+//-----------------------------------------------
+void CanDrive402::sendStateTransitions(int iTargetState)
+{
+	if (iTargetState == SW_OPERATION_ENABLED)
+	{
+		// fault reset (disables the voltage in any other state), then the transitions 2, 3 and 4
+		sendSDODownload(0x6040, 0, CW_FAULT_RESET);
+		sendSDODownload(0x6040, 0, CW_SHUTDOWN);
+		sendSDODownload(0x6040, 0, CW_SWITCH_ON);
+		sendSDODownload(0x6040, 0, CW_ENABLE_OPERATION);
+	}
+	else
+	{
+		// disable operation (transition 5)
+		sendSDODownload(0x6040, 0, CW_SWITCH_ON);
+	}
+
+	m_bStatusUploaded = false;
+	m_SDOClient.upload(0x6041, 0, boost::bind(&CanDrive402::finishedUpload, this, _1));
+}
+
+//-----------------------------------------------
+int CanDrive402::processInit()
+{
+	int iTargetState;
+
+	if (m_iInitState != INIT_BUSY)
+		return m_iInitState;
+
+	// the phase proceeds when all its SDOs are answered
+	if (m_SDOClient.process() > 0)
+		return m_iInitState;
+
+	if ((m_SDOClient.getNumTimeouts() + m_SDOClient.getNumAborts()) != m_iNumSDOFailuresAtInit)
+	{
+		std::cout << "Motor " << m_DriveParam.getDriveIdent() << ": "
+			<< ((m_iInitPhase == PHASE_CONFIG) ? "configuration" : "state transition") << " failed" << std::endl;
+		finishInit(INIT_FAILED);
+		return m_iInitState;
+	}
+
+	switch (m_iInitPhase)
+	{
+	case PHASE_CONFIG:
+		m_bIsInitialized = true;
+
+		if (!m_bEnableAfterConfig)
+		{
+			finishInit(INIT_DONE);
+			break;
+		}
+
+		m_iInitPhase = PHASE_ENABLE;
+		sendStateTransitions(SW_OPERATION_ENABLED);
+		break;
+
+	case PHASE_ENABLE:
+	case PHASE_DISABLE:
+		iTargetState = (m_iInitPhase == PHASE_ENABLE) ? SW_OPERATION_ENABLED : SW_SWITCHED_ON;
+
+		if (m_bStatusUploaded && ((m_iStatusWord & SW_STATE_MASK) == iTargetState))
+		{
+			// RxPDO1 keeps the state
+			m_iControlWord = (m_iInitPhase == PHASE_ENABLE) ? CW_ENABLE_OPERATION : CW_SWITCH_ON;
+			m_iMotorState = (m_iInitPhase == PHASE_ENABLE) ? ST_OPERATION_ENABLED : ST_OPERATION_DISABLED;
+			m_WatchdogTime.SetNow();
+			m_HeartbeatTime.SetNow();
+			finishInit(INIT_DONE);
+		}
+		else if (m_iEnableRetries >= m_Param.iMaxEnableRetries)
+		{
+			std::cout << "Motor " << m_DriveParam.getDriveIdent() << ": state transition failed, statusword 0x"
+				<< std::hex << m_iStatusWord << std::dec << std::endl;
+			finishInit(INIT_FAILED);
+		}
+		else
+		{
+			// the drive didn't follow (yet), send the transitions once more
+			m_iEnableRetries++;
+			sendStateTransitions(iTargetState);
+		}
+		break;
+
+	default:
+		finishInit(INIT_FAILED);
+		break;
+	}
+
+	return m_iInitState;
+}
+
+//-----------------------------------------------
+void CanDrive402::finishInit(int iState)
+{
+	m_iInitState = iState;
+	m_iInitPhase = PHASE_NONE;
+	m_InitEndTime.SetNow();
+}
+
+//-----------------------------------------------
+double CanDrive402::getInitDurationS()
+{
+	if (m_iInitState == INIT_BUSY)
+	{
+		m_CurrentTime.SetNow();
+		return m_CurrentTime - m_InitStartTime;
+	}
+
+	return m_InitEndTime - m_InitStartTime;
+}
+
+//-----------------------------------------------
+bool CanDrive402::waitForInit()
+{
+	CanMsg Msg;
+
+	// messages of other nodes are dropped, like in the blocking functions of CanDriveHarmonica
+	while (processInit() == INIT_BUSY)
+	{
+		while (m_pCanCtrl->receiveMsg(&Msg))
+			evalReceivedMsg(Msg);
+
+		usleep(1000);
+	}
+
+	return (m_iInitState == INIT_DONE);
+}
+
+//-----------------------------------------------
+bool CanDrive402::init()
+{
+	beginInit();
+
+	// the motor is enabled by start()
+	m_bEnableAfterConfig = false;
+
+	return waitForInit();
+}
+
+//-----------------------------------------------
+bool CanDrive402::start()
+{
+	beginPhase(PHASE_ENABLE);
+	sendStateTransitions(SW_OPERATION_ENABLED);
+
+	return waitForInit();
+}
+
+//-----------------------------------------------
+bool CanDrive402::stop()
+{
+	beginPhase(PHASE_DISABLE);
+	sendStateTransitions(SW_SWITCHED_ON);
+
+	return waitForInit();
+}
+
+//-----------------------------------------------
+bool CanDrive402::reset()
+{
+	// start network
+	CanMsg msg;
+	msg.m_iID  = 0;
+	msg.m_iLen = 2;
+	msg.set(1,0,0,0,0,0,0,0);
+	m_pCanCtrl->transmitMsg(msg);
+
+	// configure and enable, a fault is reset by the state transitions
+	beginInit();
+
+	return waitForInit();
+}
+
+//-----------------------------------------------
+bool CanDrive402::shutdown()
+{
+	std::cout << "shutdown drive " << m_DriveParam.getDriveIdent() << std::endl;
+
+	m_iControlWord = CW_DISABLE_VOLTAGE;
+	sendSDODownload(0x6040, 0, CW_DISABLE_VOLTAGE);
+
+	return true;
+}
+
+//-----------------------------------------------
+bool CanDrive402::initHoming()
+{
+	beginInitHoming();
+
+	return true;
+}
+
+//-----------------------------------------------
+bool CanDrive402::execHoming()
+{
+	const double c_dTimeoutS = 20.0;
+	TimeStamp StartTime;
+	CanMsg Msg;
+
+	armHoming();
+	StartTime.SetNow();
+
+	// the motor has to be moved by the caller, the touch probe status arrives with every SYNC
+	do
+	{
+		requestPosVel();
+		usleep(10000);
+
+		while (m_pCanCtrl->receiveMsg(&Msg))
+			evalReceivedMsg(Msg);
+
+		m_CurrentTime.SetNow();
+	}
+	while (!m_bLimSwRight && ((m_CurrentTime - StartTime) < c_dTimeoutS));
+
+	if (!m_bLimSwRight)
+	{
+		std::cout << "Homing failed - limit switch " << m_DriveParam.getDriveIdent() << " not reached" << std::endl;
+		return false;
+	}
+
+	std::cout << "Homing successful - limit switch " << m_DriveParam.getDriveIdent() << " ok" << std::endl;
+	return true;
+}
+
+//-----------------------------------------------
+bool CanDrive402::startWatchdog(bool bStarted)
+{
+	// consumer heartbeat of the master, see CanDriveHarmonica::startWatchdog()
+	const int c_iHeartbeatTimeMS = 1000;
+	const int c_iNMTNodeID = 0x00;
+
+	m_bWatchdogActive = bStarted;
+
+	if (bStarted)
+	{
+		// consumer (PC) heartbeat time
+		sendSDODownload(0x1016, 1, (c_iNMTNodeID << 16) | c_iHeartbeatTimeMS);
+
+		// error behavior after failure: 2 = stopped
+		sendSDODownload(0x1029, 1, 2);
+
+		// abort connection option code: "quick stop"
+		sendSDODownload(0x6007, 0, 3);
+	}
+	else
+	{
+		// abort connection option code: no action
+		sendSDODownload(0x6007, 0, 0);
+
+		// error behavior: no state change
+		sendSDODownload(0x1029, 1, 1);
+	}
+
+	return true;
+}
+
+//-----------------------------------------------
+double CanDrive402::getTimeToLastMsg()
+{
+	m_CurrentTime.SetNow();
+
+	return m_CurrentTime - m_WatchdogTime;
+}
+
+//-----------------------------------------------
+void CanDrive402::sendPDOMapping()
+{
+	const int c_iPDOInvalid = 0x80000000;
+
+	// The COB-ID of a valid PDO must not be changed (CiA 301), so the PDO is switched invalid
+	// (bit 31 of the COB-ID) while it is mapped and valid again with the new COB-ID
+
+	// Mapping of RxPDO1, applied by the drive on SYNC:
+	// - controlword
+	// - target velocity
+	// - touch probe function
+	sendSDODownload(0x1400, 1, m_ParamCanOpen.iRxPDO1 | c_iPDOInvalid);
+	sendSDODownload(0x1600, 0, 0);
+	sendSDODownload(0x1600, 1, 0x60400010);
+	sendSDODownload(0x1600, 2, 0x60FF0020);
+	sendSDODownload(0x1600, 3, 0x60B80010);
+	sendSDODownload(0x1400, 2, 1);
+	sendSDODownload(0x1600, 0, 3);
+	sendSDODownload(0x1400, 1, m_ParamCanOpen.iRxPDO1);
+
+	// Mapping of TPDO1 on SYNC:
+	// - position
+	// - velocity
+	sendSDODownload(0x1A00, 0, 0);
+	sendSDODownload(0x1A00, 1, 0x60640020);
+	sendSDODownload(0x1A00, 2, 0x606C0020);
+	sendSDODownload(0x1800, 2, 1);
+	sendSDODownload(0x1A00, 0, 2);
+
+	// Mapping of TPDO4 on SYNC:
+	// - statusword
+	// - touch probe status
+	// - touch probe 1 position at positive edge
+	sendSDODownload(0x1803, 1, m_ParamCanOpen.iTxPDO4 | c_iPDOInvalid);
+	sendSDODownload(0x1A03, 0, 0);
+	sendSDODownload(0x1A03, 1, 0x60410010);
+	sendSDODownload(0x1A03, 2, 0x60B90010);
+	sendSDODownload(0x1A03, 3, 0x60BA0020);
+	sendSDODownload(0x1803, 2, 1);
+	sendSDODownload(0x1A03, 0, 3);
+	sendSDODownload(0x1803, 1, m_ParamCanOpen.iTxPDO4);
+
+	// TPDO3 carries the telemetry if enabled, otherwise it is switched off
+	sendTelemetryMapping();
+}
+
+//-----------------------------------------------
+void CanDrive402::sendTelemetryMapping()
+{
+	// stop all emissions of TPDO3
+	sendSDODownload(0x1A02, 0, 0);
+
+	if (!m_bTelemetry)
+		return;
+
+	// active current, torque and following error, see CanDriveHarmonica::sendTelemetryMapping()
+	sendSDODownload(0x1A02, 1, 0x60780010);
+	sendSDODownload(0x1A02, 2, 0x60770010);
+	sendSDODownload(0x1A02, 3, 0x60F40020);
+	sendSDODownload(0x1802, 2, 1);
+	sendSDODownload(0x1A02, 0, 3);
+}
+
+//-----------------------------------------------
+void CanDrive402::setTelemetry(bool bEnable)
+{
+	m_bTelemetry = bEnable;
+
+	// otherwise mapped by init()
+	if (m_bIsInitialized)
+		sendTelemetryMapping();
+}
+
+//-----------------------------------------------
+int CanDrive402::readTelemetry(std::vector<TelemetrySample>& vSamples)
+{
+	TelemetrySample Sample;
+	int iNumSamples = 0;
+
+	while (m_TelemetryQueue.pop(Sample))
+	{
+		vSamples.push_back(Sample);
+		iNumSamples++;
+	}
+
+	return iNumSamples;
+}
+
+//-----------------------------------------------
+void CanDrive402::sendRxPDO1(int iVelIncrS)
+{
+	CanMsg msg;
+
+	m_iVelCmdIncrS = iVelIncrS;
+
+	msg.m_iID = m_ParamCanOpen.iRxPDO1;
+	msg.m_iLen = 8;
+	msg.set(m_iControlWord, m_iControlWord >> 8,
+		iVelIncrS, iVelIncrS >> 8, iVelIncrS >> 16, iVelIncrS >> 24,
+		m_iTouchProbeFunction, m_iTouchProbeFunction >> 8);
+	m_pCanCtrl->transmitMsg(msg);
+}
+
+//-----------------------------------------------
+void CanDrive402::setGearVelRadS(double dVelGearRadS)
+{
+	// calc motor velocity from joint velocity
+	setMotVelIncrPeriod(m_DriveParam.getSign() * m_DriveParam.VelGearRadSToVelMotIncrPeriod(dVelGearRadS));
+}
+
+//-----------------------------------------------
+void CanDrive402::setMotVelIncrPeriod(int iVelEncIncrPeriod)
+{
+	CanMsg msg;
+
+	if (iVelEncIncrPeriod > m_DriveParam.getVelMax())
+		iVelEncIncrPeriod = (int)m_DriveParam.getVelMax();
+
+	if (iVelEncIncrPeriod < -m_DriveParam.getVelMax())
+		iVelEncIncrPeriod = -1 * (int)m_DriveParam.getVelMax();
+
+	sendRxPDO1(iVelEncIncrPeriod);
+
+	// the target velocity is applied and position, velocity and status are sent on SYNC
+	msg.m_iID  = 0x80;
+	msg.m_iLen = 0;
+	msg.set(0,0,0,0,0,0,0,0);
+	m_pCanCtrl->transmitMsg(msg);
+
+	// heartbeat to keep the watchdog inactive, the consumer time is 1 s
+	if (!m_bHeartbeatProducer)
+		return;
+
+	m_CurrentTime.SetNow();
+	if ((m_CurrentTime - m_HeartbeatTime) >= m_Param.dHeartbeatPeriodS)
+	{
+		msg.m_iID  = 0x700;
+		msg.m_iLen = 5;
+		msg.set(0x00,0,0,0,0,0,0,0);
+		m_pCanCtrl->transmitMsg(msg);
+		m_HeartbeatTime = m_CurrentTime;
+	}
+}
+
+//-----------------------------------------------
+void CanDrive402::setGearPosVelRadS(double dPosGearRad, double dVelGearRadS)
+{
+	int iPosEncIncr;
+	int iVelEncIncrPeriod;
+
+	if (m_iTypeMotion != MOTIONTYPE_POSCTRL)
+	{
+		std::cout << "CanDrive402: setGearPosVelRadS() needs position control, see setTypeMotion()" << std::endl;
+		return;
+	}
+
+	m_DriveParam.PosVelRadToIncr(dPosGearRad, dVelGearRadS, &iPosEncIncr, &iVelEncIncrPeriod);
+
+	// the profile velocity is a magnitude, the direction follows from the target position
+	if (iVelEncIncrPeriod < 0)
+		iVelEncIncrPeriod = -iVelEncIncrPeriod;
+
+	if (iVelEncIncrPeriod > m_DriveParam.getVelMax())
+		iVelEncIncrPeriod = (int)m_DriveParam.getVelMax();
+
+	// as CanDriveHarmonica: absolute for the homed steering, relative for the driving wheel
+	int iControlWord = m_iControlWord | CW_NEW_SET_POINT | CW_CHANGE_SET_IMMEDIATELY;
+	iPosEncIncr *= m_DriveParam.getSign();
+	if (m_DriveParam.getIsSteer())
+		iPosEncIncr = (int)((unsigned int)iPosEncIncr + (unsigned int)m_iPosOffsetIncr);
+	else
+		iControlWord |= CW_RELATIVE;
+
+	sendSDODownload(0x6081, 0, iVelEncIncrPeriod);
+	sendSDODownload(0x607A, 0, iPosEncIncr);
+
+	// the set point is taken on the rising edge of the new set point bit,
+	// the next RxPDO1 (m_iControlWord) clears it again
+	sendSDODownload(0x6040, 0, iControlWord);
+}
+
+//-----------------------------------------------
+bool CanDrive402::setTypeMotion(int iType)
+{
+	if ((iType != MOTIONTYPE_VELCTRL) && (iType != MOTIONTYPE_POSCTRL))
+	{
+		std::cout << "CanDrive402: only velocity and position control are supported" << std::endl;
+		return false;
+	}
+
+	// profile position mode or profile velocity mode, switched while the drive is enabled
+	sendSDODownload(0x6060, 0, (iType == MOTIONTYPE_POSCTRL) ? 1 : 3);
+
+	m_iTypeMotion = iType;
+	return true;
+}
+
+//-----------------------------------------------
+void CanDrive402::getGearPosRad(double* pdPosGearRad)
+{
+	*pdPosGearRad = m_dPosGearMeasRad;
+}
+
+//-----------------------------------------------
+void CanDrive402::getGearPosVelRadS(double* pdAngleGearRad, double* pdVelGearRadS)
+{
+	*pdAngleGearRad = m_dPosGearMeasRad;
+	*pdVelGearRadS = m_dVelGearMeasRadS;
+}
+
+//-----------------------------------------------
+void CanDrive402::getGearDeltaPosVelRadS(double* pdAngleGearRad, double* pdVelGearRadS)
+{
+	*pdAngleGearRad = m_dPosGearMeasRad - m_dAngleGearRadMem;
+	*pdVelGearRadS = m_dVelGearMeasRadS;
+	m_dAngleGearRadMem = m_dPosGearMeasRad;
+}
+
+//-----------------------------------------------
+void CanDrive402::requestPosVel()
+{
+	CanMsg msg;
+	msg.m_iID  = 0x80;
+	msg.m_iLen = 0;
+	msg.set(0,0,0,0,0,0,0,0);
+	m_pCanCtrl->transmitMsg(msg);
+}
+
+//-----------------------------------------------
+bool CanDrive402::isError()
+{
+	if (m_iMotorState != ST_MOTOR_FAILURE)
+	{
+		// Check timeout of can communication
+		double dWatchTime = getTimeToLastMsg();
+
+		if (dWatchTime > m_Param.dCanTimeout)
+		{
+			if (m_bOutputOfFailure == false)
+			{
+				std::cout << "Motor " << m_DriveParam.getDriveIdent() <<
+					" has no can communication for " << dWatchTime << " s." << std::endl;
+			}
+
+			m_iMotorState = ST_MOTOR_FAILURE;
+		}
+	}
+
+	return (m_iMotorState == ST_MOTOR_FAILURE);
+}
+
+//-----------------------------------------------
+void CanDrive402::IntprtSetInt(int iDataLen, char cCmdChar1, char cCmdChar2, int iIndex, int iData)
+{
+	// print the command as the interpreter of CanDriveHarmonica would get it:
+	// length 4 executes or queries the command, length 8 assigns iData
+	std::cout << "CanDrive402: the binary interpreter command " << cCmdChar1 << cCmdChar2;
+	if (iIndex != 0)
+		std::cout << "[" << iIndex << "]";
+	if (iDataLen == 8)
+		std::cout << "=" << iData;
+	else if (iDataLen != 4)
+		std::cout << " with invalid length " << iDataLen;
+	std::cout << " is not supported" << std::endl;
+}
+
+//-----------------------------------------------
+int CanDrive402::setRecorder(int iFlag, int iParam, std::string sParam)
+{
+	switch (iFlag)
+	{
+	case 0:
+		std::cout << "Motor " << m_DriveParam.getDriveIdent() << ": the Elmo Recorder isn't available for CiA 402 drives" << std::endl;
+		return 0;
+
+	case 1:
+		// not configured
+		return 1;
+
+	case 3:
+		// nothing to read out
+		return 100;
+
+	default:
+		return 0;
+	}
+}
+
+//-----------------------------------------------
+void CanDrive402::requestMotorTorque()
+{
+	// active current, per mille of the rated current
+	m_SDOClient.upload(0x6078, 0, boost::bind(&CanDrive402::finishedUpload, this, _1));
+}
+
+//-----------------------------------------------
+void CanDrive402::getMotorTorque(double* dTorqueNm)
+{
+	// With motor sign:
+	*dTorqueNm = m_DriveParam.getSign() * m_dMotorCurr * m_DriveParam.getCurrToTorque();
+}
+
+//-----------------------------------------------
+void CanDrive402::setMotorTorque(double dTorqueNm)
+{
+	std::cout << "CanDrive402: torque control is not supported" << std::endl;
+}
+
+//-----------------------------------------------
+void CanDrive402::sendSDODownload(int iObjIndex, int iObjSubIndex, int iData)
+{
+	m_SDOClient.download(iObjIndex, iObjSubIndex, iData);
+}
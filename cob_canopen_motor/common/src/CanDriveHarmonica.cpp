@@ -57,6 +57,8 @@
 #include <assert.h>
 #include <cob_canopen_motor/CanDriveHarmonica.h>
 #include <unistd.h>
+#include <algorithm>
+#include <boost/bind.hpp>
 
 //-----------------------------------------------
 CanDriveHarmonica::CanDriveHarmonica()
@@ -64,6 +66,7 @@ CanDriveHarmonica::CanDriveHarmonica()
 	// Parameter
 	m_Param.iDivForRequestStatus = 10;
 	m_Param.dCanTimeout = 6;
+	m_Param.iSDOBlockSize = 127;
 
 	// Variables
 	m_pCanCtrl = NULL;
@@ -72,8 +75,8 @@ CanDriveHarmonica::CanDriveHarmonica()
 	m_dPosGearMeasRad = 0;
 	m_dAngleGearRadMem  = 0;
 	m_dVelGearMeasRadS = 0;
-
-	m_VelCalcTime.SetNow();
+	m_iPosMeasIncr = 0;
+	m_iVelMeasIncrPeriod = 0;
 
 	m_bLimSwLeft = false;
 	m_bLimSwRight = false;
@@ -94,6 +97,22 @@ CanDriveHarmonica::CanDriveHarmonica()
 
 	m_bIsInitialized = false;
 
+	m_bHeartbeatProducer = true;
+
+	m_bIntprtSeqWaiting = false;
+	m_iIntprtSeqRetries = 0;
+	m_iInitState = INIT_IDLE;
+	m_iInitPhase = PHASE_NONE;
+	m_iNumSDOFailuresAtInit = 0;
+
+	m_bSDOBlockUnsupported = false;
+
+	m_bTelemetry = false;
+	m_dRatedCurrA = 0;
+	m_dRatedTorqueNm = 0;
+	m_dFollowingErrorGearRad = 0;
+	m_iNumTelemetryOverruns = 0;
+	m_dMotorCurr = 0;
 
 	ElmoRec = new ElmoRecorder(this);
 
@@ -107,7 +126,25 @@ void CanDriveHarmonica::setCanOpenParam( int iTxPDO1, int iTxPDO2, int iRxPDO2,
 	m_ParamCanOpen.iRxPDO2 = iRxPDO2;
 	m_ParamCanOpen.iTxSDO = iTxSDO;
 	m_ParamCanOpen.iRxSDO = iRxSDO;
+	m_ParamCanOpen.iTxPDO3 = iTxPDO1 + 0x200;
+
+	m_SDOClient.setCanItf(m_pCanCtrl, m_ParamCanOpen.iRxSDO, m_ParamCanOpen.iTxSDO);
+}
 
+//-----------------------------------------------
+void CanDriveHarmonica::setCanItf(CanItf* pCanItf)
+{
+	m_pCanCtrl = pCanItf;
+	m_SDOClient.setCanItf(m_pCanCtrl, m_ParamCanOpen.iRxSDO, m_ParamCanOpen.iTxSDO);
+}
+
+//-----------------------------------------------
+void CanDriveHarmonica::getRxCanIDs(std::vector<int>& viCanIDs)
+{
+	viCanIDs.push_back(m_ParamCanOpen.iTxPDO1);
+	viCanIDs.push_back(m_ParamCanOpen.iTxPDO2);
+	viCanIDs.push_back(m_ParamCanOpen.iTxSDO);
+	viCanIDs.push_back(m_ParamCanOpen.iTxPDO3);
 }
 
 //-----------------------------------------------
@@ -139,17 +176,68 @@ bool CanDriveHarmonica::evalReceivedMsg(CanMsg& msg)
 		m_dVelGearMeasRadS = m_DriveParam.getSign() * m_DriveParam.
 			VelMotIncrPeriodToVelGearRadS(iTemp2);
 
+		m_iPosMeasIncr = iTemp1;
+		m_iVelMeasIncrPeriod = iTemp2;
+
 		m_WatchdogTime.SetNow();
 
 		bRet = true;
 	}
 
+	//-----------------------
+	// eval telemetry from PDO3 - transmitted on SYNC msg after PDO1
+	if (m_bTelemetry && (msg.m_iID == m_ParamCanOpen.iTxPDO3))
+	{
+		TelemetrySample Sample;
+		TimeStamp Now;
+		long lSec, lNSec;
+
+		// current and torque in per mille of the rated values
+		short iCurrPerMille = (msg.getAt(1) << 8) | msg.getAt(0);
+		short iTorquePerMille = (msg.getAt(3) << 8) | msg.getAt(2);
+
+		iTemp1 = (msg.getAt(7) << 24) | (msg.getAt(6) << 16)
+				| (msg.getAt(5) << 8) | (msg.getAt(4) );
+
+		m_dMotorCurr = iCurrPerMille * m_dRatedCurrA / 1000.0;
+		m_dFollowingErrorGearRad = m_DriveParam.getSign() * m_DriveParam.PosMotIncrToPosGearRad(iTemp1);
+
+		if (msg.hasTimeStamp())
+			msg.getTimeStamp(lSec, lNSec);
+		else
+		{
+			Now.SetNow();
+			Now.getTimeStamp(lSec, lNSec);
+		}
+
+		Sample.dTimeS = lSec + 1e-9 * lNSec;
+		Sample.dPosGearRad = m_dPosGearMeasRad;
+		Sample.dVelGearRadS = m_dVelGearMeasRadS;
+		Sample.dMotorCurrA = m_DriveParam.getSign() * m_dMotorCurr;
+		if (m_dRatedTorqueNm > 0)
+			Sample.dTorqueNm = m_DriveParam.getSign() * iTorquePerMille * m_dRatedTorqueNm / 1000.0;
+		else
+			getMotorTorque(&Sample.dTorqueNm);
+		Sample.dFollowingErrorGearRad = m_dFollowingErrorGearRad;
+
+		if (!m_TelemetryQueue.push(Sample))
+			m_iNumTelemetryOverruns++;
+
+		bRet = true;
+	}
+
 	//-----------------------
 	// eval answers from binary interpreter
 	if (msg.m_iID == m_ParamCanOpen.iTxPDO2)
 	{
 		if( (msg.getAt(0) == 'P') && (msg.getAt(1) == 'X') ) // current pos
 		{
+			iPara = (msg.getAt(7) << 24) | (msg.getAt(6) << 16)
+				| (msg.getAt(5) << 8) | (msg.getAt(4) );
+
+			m_dPosGearMeasRad = m_DriveParam.getSign() * m_DriveParam.PosMotIncrToPosGearRad(iPara);
+			m_dAngleGearRadMem  = m_dPosGearMeasRad;
+			m_iPosMeasIncr = iPara;
 		}
 
 		else if( (msg.getAt(0) == 'P') && (msg.getAt(1) == 'A') ) // position absolute
@@ -201,7 +289,7 @@ bool CanDriveHarmonica::evalReceivedMsg(CanMsg& msg)
 			evalMotorFailure(iFailure);
 		}
 
-		// debug eval
+		// debug eval (quiet for the echoes of an initialization sequence)
 		else if( (msg.getAt(0) == 'U') && (msg.getAt(1) == 'M') )
 		{
 			iPara = (msg.getAt(7) << 24) | (msg.getAt(6) << 16)
@@ -215,7 +303,8 @@ bool CanDriveHarmonica::evalReceivedMsg(CanMsg& msg)
 			iPara = (msg.getAt(7) << 24) | (msg.getAt(6) << 16)
 				| (msg.getAt(5) << 8) | (msg.getAt(4) );
 
-			std::cout << "pm " << iPara << std::endl;
+			if( !m_bIntprtSeqWaiting )
+				std::cout << "pm " << iPara << std::endl;
 		}
 
 		else if( (msg.getAt(0) == 'A') && (msg.getAt(1) == 'C') )
@@ -223,7 +312,8 @@ bool CanDriveHarmonica::evalReceivedMsg(CanMsg& msg)
 			iPara = (msg.getAt(7) << 24) | (msg.getAt(6) << 16)
 				| (msg.getAt(5) << 8) | (msg.getAt(4) );
 
-			std::cout << "ac " << iPara << std::endl;
+			if( !m_bIntprtSeqWaiting )
+				std::cout << "ac " << iPara << std::endl;
 		}
 
 		else if( (msg.getAt(0) == 'D') && (msg.getAt(1) == 'C') )
@@ -231,12 +321,13 @@ bool CanDriveHarmonica::evalReceivedMsg(CanMsg& msg)
 			iPara = (msg.getAt(7) << 24) | (msg.getAt(6) << 16)
 				| (msg.getAt(5) << 8) | (msg.getAt(4) );
 
-			std::cout << "dc " << iPara << std::endl;
+			if( !m_bIntprtSeqWaiting )
+				std::cout << "dc " << iPara << std::endl;
 		}
 		else if( (msg.getAt(0) == 'H') && (msg.getAt(1) == 'M') )
 		{
-			// status message (homing armed = 1 / disarmed = 0) is encoded in 5th byte
-			if(msg.getAt(4) == 0)
+			// status message (homing armed = 1 / disarmed = 0) is encoded in 5th byte of HM[1]
+			if( (msg.getAt(2) == 1) && (msg.getAt(4) == 0) )
 			{
 				// if 0 received: elmo disarmed homing after receiving the defined event
 				m_bLimSwRight = true;
@@ -256,6 +347,10 @@ bool CanDriveHarmonica::evalReceivedMsg(CanMsg& msg)
 		{
 		}
 
+		// answer to the command of a running initialization sequence
+		if( m_bIntprtSeqWaiting )
+			evalIntprtSeqReply(msg);
+
 		m_WatchdogTime.SetNow();
 
 		bRet = true;
@@ -267,7 +362,21 @@ bool CanDriveHarmonica::evalReceivedMsg(CanMsg& msg)
 	{
 		m_WatchdogTime.SetNow();
 
-		if( (msg.getAt(0) >> 5) == 0) { //Received Upload SDO Segment (scs = 0)
+		if(m_SDOClient.evalReceivedMsg(msg)) {
+			// response to a queued expedited transfer or abort, handled by the callback
+
+		} else if( seg_Data.blockTransfer && (seg_Data.statusFlag == segData::SDO_SEG_COLLECTING) ) {
+			//Block upload in progress: segments (byte 0 = sequence number) up to the last one, then the end (scs = 6 AND ss = 1)
+			if(!seg_Data.lastSegment) {
+				receivedSDOBlockSegment(msg);
+			} else if( (msg.getAt(0) & 0xE3) == 0xC1) {
+				receivedSDOBlockEnd(msg);
+			}
+
+		} else if( (msg.getAt(0) & 0xE1) == 0xC0) { //Received Initiate Block Upload response -> start block upload (scs = 6 AND ss = 0)
+			receivedSDOBlockInitiation(msg);
+
+		} else if( (msg.getAt(0) >> 5) == 0) { //Received Upload SDO Segment (scs = 0)
 			//std::cout << "SDO Upload Segment received" << std::endl;
 			receivedSDODataSegment(msg);
 
@@ -323,6 +432,7 @@ bool CanDriveHarmonica::init()
 
 			m_dPosGearMeasRad = m_DriveParam.getSign() * m_DriveParam.PosMotIncrToPosGearRad(iPosCnt);
 			m_dAngleGearRadMem  = m_dPosGearMeasRad;
+			m_iPosMeasIncr = iPosCnt;
 			break;
 		}
 
@@ -338,6 +448,18 @@ bool CanDriveHarmonica::init()
 	}
 
 	// ---------- set PDO mapping
+	sendPDOMapping();
+
+	m_bWatchdogActive = false;
+
+	if( bRet )
+		m_bIsInitialized = true;
+
+	return bRet;
+}
+//-----------------------------------------------
+void CanDriveHarmonica::sendPDOMapping()
+{
 	// Mapping of TPDO1:
 	// - position
 	// - velocity
@@ -357,13 +479,86 @@ bool CanDriveHarmonica::init()
 	// activate mapped objects
 	sendSDODownload(0x1A00, 0, 2);
 
-	m_bWatchdogActive = false;
+	// TPDO3 carries the telemetry if enabled, otherwise it is switched off
+	sendTelemetryMapping();
+}
 
-	if( bRet )
-		m_bIsInitialized = true;
+//-----------------------------------------------
+void CanDriveHarmonica::sendTelemetryMapping()
+{
+	// Mapping of TPDO3:
+	// - active current
+	// - torque
+	// - following error
 
-	return bRet;
+	// stop all emissions of TPDO3
+	sendSDODownload(0x1A02, 0, 0);
+
+	if (!m_bTelemetry)
+		return;
+
+	// scale of current and torque
+	m_SDOClient.upload(0x6075, 0, boost::bind(&CanDriveHarmonica::finishedTelemetryUpload, this, _1));
+	m_SDOClient.upload(0x6076, 0, boost::bind(&CanDriveHarmonica::finishedTelemetryUpload, this, _1));
+
+	// active current 2 byte of TPDO3
+	sendSDODownload(0x1A02, 1, 0x60780010);
+
+	// torque 2 byte of TPDO3
+	sendSDODownload(0x1A02, 2, 0x60770010);
+
+	// following error 4 byte of TPDO3
+	sendSDODownload(0x1A02, 3, 0x60F40020);
+
+	// transmission type "synch"
+	sendSDODownload(0x1802, 2, 1);
+
+	// activate mapped objects
+	sendSDODownload(0x1A02, 0, 3);
+}
+
+//-----------------------------------------------
+void CanDriveHarmonica::finishedTelemetryUpload(const SDOClient::Transfer& Tr)
+{
+	if (Tr.iResult != SDOClient::SDO_DONE)
+	{
+		std::cout << "Rated current / torque of drive " << m_DriveParam.getDriveIdent()
+			<< " not available, telemetry current and torque are invalid" << std::endl;
+		return;
+	}
+
+	// rated current in mA, rated torque in mNm
+	if (Tr.iObjIndex == 0x6075)
+		m_dRatedCurrA = (unsigned int)Tr.iData / 1000.0;
+	else if (Tr.iObjIndex == 0x6076)
+		m_dRatedTorqueNm = (unsigned int)Tr.iData / 1000.0;
+}
+
+//-----------------------------------------------
+void CanDriveHarmonica::setTelemetry(bool bEnable)
+{
+	m_bTelemetry = bEnable;
+
+	// otherwise mapped by init()
+	if (m_bIsInitialized)
+		sendTelemetryMapping();
 }
+
+//-----------------------------------------------
+int CanDriveHarmonica::readTelemetry(std::vector<TelemetrySample>& vSamples)
+{
+	TelemetrySample Sample;
+	int iNumSamples = 0;
+
+	while (m_TelemetryQueue.pop(Sample))
+	{
+		vSamples.push_back(Sample);
+		iNumSamples++;
+	}
+
+	return iNumSamples;
+}
+
 //-----------------------------------------------
 bool CanDriveHarmonica::stop()
 {
@@ -483,7 +678,6 @@ bool CanDriveHarmonica::startWatchdog(bool bStarted)
 		// Object 0x2F21 = "Emergency Events" which cause an Emergency Message
 		// Bit 3 is responsible for Heartbeart-Failure.--> Hex 0x08
 		sendSDODownload(0x2F21, 0, 0x08);
-		usleep(20000);
 
 	}
 	else
@@ -501,7 +695,6 @@ bool CanDriveHarmonica::startWatchdog(bool bStarted)
 		// Object 0x2F21 = "Emergency Events" which cause an Emergency Message
 		// Bit 3 is responsible for Heartbeart-Failure.
 		sendSDODownload(0x2F21, 0, 0x00);
-		usleep(25000);
 
 
 	}
@@ -651,6 +844,226 @@ bool CanDriveHarmonica::execHoming() //not used by CanCtrlPltf, that has its own
 
 	return bRet;
 }
+//-----------------------------------------------
+// Non-blocking initialization: the steps of init(), start() and initHoming()
+// are sent as interpreter command sequences, each command as soon as the
+// drive echoed the previous one (instead of sleeping between them).
+//-----------------------------------------------
+
+//-----------------------------------------------
+void CanDriveHarmonica::beginInit()
+{
+	int iIncrRevWheel = int( (double)m_DriveParam.getGearRatio() * (double)m_DriveParam.getBeltRatio()
+					* (double)m_DriveParam.getEncIncrPerRevMot() * 3 );
+	int iMaxAcc = int(m_DriveParam.getMaxAcc());
+	int iMaxDcc = int(m_DriveParam.getMaxDec());
+
+	m_iMotorState = ST_PRE_INITIALIZED;
+	m_bWatchdogActive = false;
+
+	beginIntprtSeq(PHASE_CONFIG);
+
+	// Modulo-Counting, see init()
+	queueIntprtCmd(8, 'M', 'O', 0, 0);
+	queueIntprtCmd(8, 'X', 'M', 2, iIncrRevWheel * 5000);
+	queueIntprtCmd(8, 'X', 'M', 1, -iIncrRevWheel * 5000);
+
+	// velocity control, see setTypeMotion()
+	queueIntprtCmd(8, 'U', 'M', 0, 2);
+	queueIntprtCmd(8, 'P', 'M', 0, 1);
+	queueIntprtCmd(8, 'A', 'C', 0, iMaxAcc);
+	queueIntprtCmd(8, 'D', 'C', 0, iMaxDcc);
+	m_iTypeMotion = MOTIONTYPE_VELCTRL;
+
+	// set position counter to zero, the echo sets the measured position
+	queueIntprtCmd(8, 'P', 'X', 0, 0);
+
+	sendNextIntprtCmd();
+
+	// the SDOs are transferred in parallel to the interpreter commands
+	sendPDOMapping();
+}
+
+//-----------------------------------------------
+void CanDriveHarmonica::beginInitHoming()
+{
+	const int c_iPosRef = m_DriveParam.getEncOffset();
+
+	beginIntprtSeq(PHASE_HOMING);
+
+	// see initHoming()
+	queueIntprtCmd(8, 'H', 'M', 1, 0);
+	queueIntprtCmd(8, 'H', 'M', 2, c_iPosRef);
+	queueIntprtCmd(8, 'H', 'M', 3, m_DriveParam.getHomingDigIn());
+	queueIntprtCmd(8, 'H', 'M', 4, 2);
+	queueIntprtCmd(8, 'H', 'M', 5, 0);
+
+	sendNextIntprtCmd();
+}
+
+//-----------------------------------------------
+int CanDriveHarmonica::processInit()
+{
+	const double c_dAnswerTimeoutS = 0.1;
+	const int c_iMaxRetries = 3;
+
+	if( m_iInitState != INIT_BUSY )
+		return m_iInitState;
+
+	// ---------- waiting for the answer of the drive
+	if( m_bIntprtSeqWaiting )
+	{
+		m_CurrentTime.SetNow();
+		if( (m_CurrentTime - m_IntprtSeqSendTime) < c_dAnswerTimeoutS )
+			return m_iInitState;
+
+		const IntprtCmdType& Cmd = m_IntprtSeq.front();
+		if( m_iIntprtSeqRetries >= c_iMaxRetries )
+		{
+			std::cout << "Motor " << m_DriveParam.getDriveIdent() << ": no answer on "
+				<< Cmd.cCmdChar1 << Cmd.cCmdChar2 << "[" << Cmd.iIndex << "]" << std::endl;
+			finishInit(INIT_FAILED);
+			return m_iInitState;
+		}
+
+		// send the command once more
+		m_iIntprtSeqRetries++;
+		m_bIntprtSeqWaiting = false;
+	}
+
+	if( !m_IntprtSeq.empty() )
+	{
+		sendNextIntprtCmd();
+		return m_iInitState;
+	}
+
+	// ---------- all commands of the phase answered
+	switch( m_iInitPhase )
+	{
+	case PHASE_CONFIG:
+		// the PDO mapping has to be complete before the motor is started
+		if( m_SDOClient.process() > 0 )
+			break;
+
+		if( (m_SDOClient.getNumTimeouts() + m_SDOClient.getNumAborts()) != m_iNumSDOFailuresAtInit )
+		{
+			std::cout << "Motor " << m_DriveParam.getDriveIdent() << ": PDO mapping failed" << std::endl;
+			finishInit(INIT_FAILED);
+			break;
+		}
+
+		m_bIsInitialized = true;
+
+		// motor on and request status, see start()
+		m_iInitPhase = PHASE_START;
+		queueIntprtCmd(8, 'M', 'O', 0, 1);
+		queueIntprtCmd(4, 'S', 'R', 0, 0);
+		sendNextIntprtCmd();
+		break;
+
+	case PHASE_START:
+		// the status was evaluated by evalReceivedMsg()
+		m_WatchdogTime.SetNow();
+		m_SendTime.SetNow();
+		finishInit( (m_iMotorState == ST_MOTOR_FAILURE) ? INIT_FAILED : INIT_DONE );
+		break;
+
+	case PHASE_HOMING:
+		// the echo of HM[1] = 0 must not be taken for the homing event
+		m_bLimSwRight = false;
+		finishInit(INIT_DONE);
+		break;
+
+	default:
+		finishInit(INIT_FAILED);
+		break;
+	}
+
+	return m_iInitState;
+}
+
+//-----------------------------------------------
+double CanDriveHarmonica::getInitDurationS()
+{
+	if( m_iInitState == INIT_BUSY )
+	{
+		m_CurrentTime.SetNow();
+		return m_CurrentTime - m_InitStartTime;
+	}
+
+	return m_InitEndTime - m_InitStartTime;
+}
+
+//-----------------------------------------------
+void CanDriveHarmonica::beginIntprtSeq(int iPhase)
+{
+	m_IntprtSeq.clear();
+	m_bIntprtSeqWaiting = false;
+	m_iIntprtSeqRetries = 0;
+
+	m_iInitState = INIT_BUSY;
+	m_iInitPhase = iPhase;
+	m_iNumSDOFailuresAtInit = m_SDOClient.getNumTimeouts() + m_SDOClient.getNumAborts();
+
+	m_InitStartTime.SetNow();
+	m_InitEndTime = m_InitStartTime;
+}
+
+//-----------------------------------------------
+void CanDriveHarmonica::queueIntprtCmd(int iDataLen, char cCmdChar1, char cCmdChar2, int iIndex, int iData)
+{
+	IntprtCmdType Cmd;
+
+	Cmd.iDataLen = iDataLen;
+	Cmd.cCmdChar1 = cCmdChar1;
+	Cmd.cCmdChar2 = cCmdChar2;
+	Cmd.iIndex = iIndex;
+	Cmd.iData = iData;
+
+	m_IntprtSeq.push_back(Cmd);
+}
+
+//-----------------------------------------------
+void CanDriveHarmonica::sendNextIntprtCmd()
+{
+	if( m_bIntprtSeqWaiting || m_IntprtSeq.empty() )
+		return;
+
+	const IntprtCmdType& Cmd = m_IntprtSeq.front();
+
+	m_bIntprtSeqWaiting = true;
+	m_IntprtSeqSendTime.SetNow();
+
+	IntprtSetInt(Cmd.iDataLen, Cmd.cCmdChar1, Cmd.cCmdChar2, Cmd.iIndex, Cmd.iData);
+}
+
+//-----------------------------------------------
+void CanDriveHarmonica::evalIntprtSeqReply(CanMsg& msg)
+{
+	const IntprtCmdType& Cmd = m_IntprtSeq.front();
+	int iIndex = msg.getAt(2) | ((msg.getAt(3) & 0x3F) << 8);
+
+	if( (msg.getAt(0) != Cmd.cCmdChar1) || (msg.getAt(1) != Cmd.cCmdChar2) || (iIndex != Cmd.iIndex) )
+		return;
+
+	m_IntprtSeq.pop_front();
+	m_bIntprtSeqWaiting = false;
+	m_iIntprtSeqRetries = 0;
+
+	sendNextIntprtCmd();
+}
+
+//-----------------------------------------------
+void CanDriveHarmonica::finishInit(int iState)
+{
+	m_IntprtSeq.clear();
+	m_bIntprtSeqWaiting = false;
+
+	m_iInitState = iState;
+	m_iInitPhase = PHASE_NONE;
+	m_InitEndTime.SetNow();
+}
+
 //-----------------------------------------------
 void CanDriveHarmonica::setGearPosVelRadS(double dPosGearRad, double dVelGearRadS)
 {
@@ -705,11 +1118,13 @@ void CanDriveHarmonica::setGearPosVelRadS(double dPosGearRad, double dVelGearRad
 //-----------------------------------------------
 void CanDriveHarmonica::setGearVelRadS(double dVelGearRadS)
 {
-	int iVelEncIncrPeriod;
-
 	// calc motor velocity from joint velocity
-	iVelEncIncrPeriod = m_DriveParam.getSign() * m_DriveParam.VelGearRadSToVelMotIncrPeriod(dVelGearRadS);
+	setMotVelIncrPeriod(m_DriveParam.getSign() * m_DriveParam.VelGearRadSToVelMotIncrPeriod(dVelGearRadS));
+}
 
+//-----------------------------------------------
+void CanDriveHarmonica::setMotVelIncrPeriod(int iVelEncIncrPeriod)
+{
 	if(iVelEncIncrPeriod > m_DriveParam.getVelMax())
 	{
 		std::cout << "SteerVelo asked for " << iVelEncIncrPeriod << " EncIncrements" << std::endl;
@@ -735,10 +1150,8 @@ void CanDriveHarmonica::setGearVelRadS(double dVelGearRadS)
 	m_pCanCtrl->transmitMsg(msg);
 
 	// send heartbeat to keep watchdog inactive
-	msg.m_iID  = 0x700;
-	msg.m_iLen = 5;
-	msg.set(0x00,0,0,0,0,0,0,0);
-	m_pCanCtrl->transmitMsg(msg);
+	if (m_bHeartbeatProducer)
+		sendHeartbeat();
 
 	m_CurrentTime.SetNow();
 	double dt = m_CurrentTime - m_SendTime;
@@ -1001,53 +1414,26 @@ void CanDriveHarmonica::receivedSDOTransferAbort(unsigned int iErrorCode){
 //-----------------------------------------------
 void CanDriveHarmonica::sendSDOUpload(int iObjIndex, int iObjSubIndex)
 {
-	CanMsg CMsgTr;
-	const int ciInitUploadReq = 0x40;
-
-	CMsgTr.m_iLen = 8;
-	CMsgTr.m_iID = m_ParamCanOpen.iRxSDO;
-
-	unsigned char cMsg[8];
+	m_SDOClient.upload(iObjIndex, iObjSubIndex,
+		boost::bind(&CanDriveHarmonica::finishedSDOUpload, this, _1));
+}
 
-	cMsg[0] = ciInitUploadReq;
-	cMsg[1] = iObjIndex;
-	cMsg[2] = iObjIndex >> 8;
-	cMsg[3] = iObjSubIndex;
-	cMsg[4] = 0x00;
-	cMsg[5] = 0x00;
-	cMsg[6] = 0x00;
-	cMsg[7] = 0x00;
+//-----------------------------------------------
+void CanDriveHarmonica::sendSDOBlockUpload(int iObjIndex, int iObjSubIndex)
+{
+	if(m_bSDOBlockUnsupported) {
+		sendSDOUpload(iObjIndex, iObjSubIndex);
+		return;
+	}
 
-	CMsgTr.set(cMsg[0], cMsg[1], cMsg[2], cMsg[3], cMsg[4], cMsg[5], cMsg[6], cMsg[7]);
-	m_pCanCtrl->transmitMsg(CMsgTr);
+	m_SDOClient.uploadBlock(iObjIndex, iObjSubIndex, m_Param.iSDOBlockSize,
+		boost::bind(&CanDriveHarmonica::finishedSDOUpload, this, _1));
 }
 
 //-----------------------------------------------
 void CanDriveHarmonica::sendSDODownload(int iObjIndex, int iObjSubIndex, int iData)
 {
-	CanMsg CMsgTr;
-
-	const int ciInitDownloadReq = 0x20;
-	const int ciNrBytesNoData = 0x00;
-	const int ciExpedited = 0x02;
-	const int ciDataSizeInd = 0x01;
-
-	CMsgTr.m_iLen = 8;
-	CMsgTr.m_iID = m_ParamCanOpen.iRxSDO;
-
-	unsigned char cMsg[8];
-
-	cMsg[0] = ciInitDownloadReq | (ciNrBytesNoData << 2) | ciExpedited | ciDataSizeInd;
-	cMsg[1] = iObjIndex;
-	cMsg[2] = iObjIndex >> 8;
-	cMsg[3] = iObjSubIndex;
-	cMsg[4] = iData;
-	cMsg[5] = iData >> 8;
-	cMsg[6] = iData >> 16;
-	cMsg[7] = iData >> 24;
-
-	CMsgTr.set(cMsg[0], cMsg[1], cMsg[2], cMsg[3], cMsg[4], cMsg[5], cMsg[6], cMsg[7]);
-	m_pCanCtrl->transmitMsg(CMsgTr);
+	m_SDOClient.download(iObjIndex, iObjSubIndex, iData);
 }
 
 //-----------------------------------------------
@@ -1100,6 +1486,7 @@ int CanDriveHarmonica::receivedSDODataSegment(CanMsg& msg){
 	if( (msg.getAt(0) & 0x10) != (seg_Data.toggleBit << 4) ) {
 		std::cout << "Toggle Bit error, send Abort SDO with \"Toggle bit not alternated\" error" << std::endl;
 		sendSDOAbort(seg_Data.objectID, seg_Data.objectSubID, 0x05030000); //Send SDO Abort with error code Toggle-Bit not alternated
+		m_SDOClient.finishSegmented(false, seg_Data.data.size());
 		return 1;
 	}
 
@@ -1127,6 +1514,126 @@ int CanDriveHarmonica::receivedSDODataSegment(CanMsg& msg){
 	return 0;
 }
 
+//-----------------------------------------------
+int CanDriveHarmonica::receivedSDOBlockInitiation(CanMsg& msg) {
+
+	//Read SDO Block Upload Protocol:
+	//Byte 0: SSS 00 C S 0 | SSS=Cmd-Specifier (6), C=CRC supported, S=Size indicated
+	//Byte 4 to 7: number of bytes to be uploaded
+
+	if(seg_Data.statusFlag == segData::SDO_SEG_FREE || seg_Data.statusFlag == segData::SDO_SEG_WAITING) { //only accept new SDO Block Upload if seg_Data is free
+		seg_Data.resetTransferData();
+		seg_Data.statusFlag = segData::SDO_SEG_COLLECTING;
+		seg_Data.blockTransfer = true;
+		seg_Data.blockSize = m_Param.iSDOBlockSize;
+		seg_Data.crcSupported = ( (msg.getAt(0) & 0x04) != 0 );
+
+		evalSDO(msg, &seg_Data.objectID, &seg_Data.objectSubID);
+
+		if( (msg.getAt(0) & 0x02) != 0) {
+			seg_Data.numTotalBytes = msg.getAt(7) << 24 | msg.getAt(6) << 16 | msg.getAt(5) << 8 | msg.getAt(4);
+			seg_Data.data.reserve(seg_Data.numTotalBytes + 7);
+		} else seg_Data.numTotalBytes = 0;
+
+		sendSDOBlockCmd(3, 0x00, 0x00); //start upload
+	}
+
+	return 0;
+}
+
+//-----------------------------------------------
+int CanDriveHarmonica::receivedSDOBlockSegment(CanMsg& msg) {
+
+	//Byte 0: C NNNNNNN | C=last segment of the transfer, NNNNNNN=sequence number within the block (1 to blockSize)
+	//Byte 1 to 7: Data
+	int iSeqNo = msg.getAt(0) & 0x7F;
+	bool bLast = ( (msg.getAt(0) & 0x80) != 0 );
+
+	seg_Data.numBlockSegments++;
+	m_SDOBlockSegmentTime.SetNow();
+
+	if(iSeqNo == seg_Data.seqNo + 1) {
+		//the unused bytes of the last segment are given by the end of the transfer
+		for(int i=1; i<=7; i++) {
+			seg_Data.data.push_back(msg.getAt(i));
+		}
+		seg_Data.seqNo = iSeqNo;
+		seg_Data.lastSegment = bLast;
+	}
+
+	if(bLast || (iSeqNo >= seg_Data.blockSize)) {
+		//confirm the segments received in sequence, the drive continues with the one after them
+		sendSDOBlockCmd(2, seg_Data.seqNo, seg_Data.blockSize);
+		seg_Data.seqNo = 0;
+		seg_Data.numBlockSegments = 0;
+	}
+
+	return 0;
+}
+
+//-----------------------------------------------
+int CanDriveHarmonica::processSDOs() {
+
+	//time without segments after which the current block is considered to be finished,
+	//short compared to the SDO timeout (the segments of a block follow each other immediately)
+	const double c_dBlockTimeoutS = 0.02;
+	TimeStamp Now;
+
+	//if the segment that ends a block is lost, the drive waits for the confirmation:
+	//confirm the segments received in sequence, the drive repeats the ones after them
+	if( (seg_Data.statusFlag == segData::SDO_SEG_COLLECTING) && seg_Data.blockTransfer && (seg_Data.numBlockSegments > 0) ) {
+		Now.SetNow();
+		if( (Now - m_SDOBlockSegmentTime) > c_dBlockTimeoutS ) {
+			sendSDOBlockCmd(2, seg_Data.seqNo, seg_Data.blockSize);
+			seg_Data.seqNo = 0;
+			seg_Data.numBlockSegments = 0;
+		}
+	}
+
+	return m_SDOClient.process();
+}
+
+//-----------------------------------------------
+int CanDriveHarmonica::receivedSDOBlockEnd(CanMsg& msg) {
+
+	//Byte 0: SSS NNN 0 1 | SSS=Cmd-Specifier (6), NNN=num of unused bytes in the last segment
+	//Byte 1 to 2: CRC
+	unsigned int numEmptyBytes = (msg.getAt(0) >> 2) & 0x07;
+
+	if(numEmptyBytes <= seg_Data.data.size()) {
+		seg_Data.data.resize(seg_Data.data.size() - numEmptyBytes);
+	}
+
+	if(seg_Data.crcSupported) {
+		unsigned short iCRC = msg.getAt(1) | (msg.getAt(2) << 8);
+
+		if(iCRC != segData::calcCRC(seg_Data.data)) {
+			std::cout << "CRC error, send Abort SDO with \"CRC error\" error" << std::endl;
+			sendSDOAbort(seg_Data.objectID, seg_Data.objectSubID, 0x05040004); //Send SDO Abort with error code CRC error
+			m_SDOClient.finishSegmented(false, seg_Data.data.size());
+			return 1;
+		}
+	}
+
+	sendSDOBlockCmd(1, 0x00, 0x00); //end upload
+	finishedSDOSegmentedTransfer();
+
+	return 0;
+}
+
+//-----------------------------------------------
+void CanDriveHarmonica::sendSDOBlockCmd(int iSubCmd, int iByte1, int iByte2) {
+
+	CanMsg CMsgTr;
+
+	CMsgTr.m_iLen = 8;
+	CMsgTr.m_iID = m_ParamCanOpen.iRxSDO;
+
+	//first three bits must be ccs = 5, the last two bits are the client sub-command: 101000CC
+	CMsgTr.set(0xA0 | iSubCmd, iByte1, iByte2, 0x00, 0x00, 0x00, 0x00, 0x00);
+	m_pCanCtrl->transmitMsg(CMsgTr);
+}
+
 //-----------------------------------------------
 void CanDriveHarmonica::sendSDOUploadSegmentConfirmation(bool toggleBit) {
 
@@ -1162,28 +1669,31 @@ void CanDriveHarmonica::finishedSDOSegmentedTransfer() {
 		//abort processing?
 	}
 
+	//the next queued SDO transfer may start now
+	m_SDOClient.finishSegmented(true, seg_Data.data.size());
+
 	if(seg_Data.objectID == 0x2030) {
 		if(ElmoRec->processData(seg_Data) == 0) seg_Data.statusFlag = segData::SDO_SEG_FREE;
 	}
 }
 
 //-----------------------------------------------
-double CanDriveHarmonica::estimVel(double dPos)
-{
-	double dVel;
-	double dt;
-
-	m_CurrentTime.SetNow();
-
-	dt = m_CurrentTime - m_VelCalcTime;
-
-	dVel = (dPos - m_dOldPos)/dt;
-
-	m_dOldPos = dPos;
-	m_VelCalcTime.SetNow();
-
-	return dVel;
+void CanDriveHarmonica::finishedSDOUpload(const SDOClient::Transfer& Tr) {
+	if(Tr.bBlock && (Tr.iResult == SDOClient::SDO_ABORTED) && (seg_Data.statusFlag == segData::SDO_SEG_WAITING)) {
+		//block upload refused before it started, try again segmented
+		if(Tr.iAbortCode == 0x05040001) { //command specifier not valid or unknown
+			std::cout << "Drive doesn't support SDO block transfer, uploading segmented" << std::endl;
+			m_bSDOBlockUnsupported = true;
+		}
+		sendSDOUpload(Tr.iObjIndex, Tr.iObjSubIndex);
+	} else if(Tr.iResult == SDOClient::SDO_ABORTED && Tr.iAbortCode != 0) {
+		receivedSDOTransferAbort(Tr.iAbortCode);
+	} else if(Tr.iResult != SDOClient::SDO_DONE) {
+		//timeout or aborted by us, don't block further readouts
+		seg_Data.statusFlag = segData::SDO_SEG_FREE;
+	}
 }
+
 //-----------------------------------------------
 bool CanDriveHarmonica::evalStatusRegister(int iStatus)
 {
@@ -1352,7 +1862,8 @@ void CanDriveHarmonica::setMotorTorque(double dTorqueNm)
 	m_pCanCtrl->transmitMsg(msg);
 
 	// send heartbeat to keep watchdog inactive
-	sendHeartbeat();
+	if (m_bHeartbeatProducer)
+		sendHeartbeat();
 
 	m_CurrentTime.SetNow();
 	double dt = m_CurrentTime - m_SendTime;
@@ -1433,8 +1944,21 @@ int CanDriveHarmonica::setRecorder(int iFlag, int iParam, std::string sParam) {
 
 			break;
 
+		case 3: //request progress of the ReadOut process in percent of the uploaded bytes
+			if(seg_Data.statusFlag == segData::SDO_SEG_WAITING) {
+				return 0;
+			} else if(seg_Data.statusFlag == segData::SDO_SEG_COLLECTING) {
+				if(seg_Data.numTotalBytes == 0) return 0;
+				return (int)std::min<unsigned int>(99, 100 * seg_Data.data.size() / seg_Data.numTotalBytes);
+			} else { //finished transmission
+				return 100;
+			}
+
+			break;
+
 		case 99: //Abort ongoing SDO data Transmission and clear collected data
 			sendSDOAbort(0x2030, 0x00, 0x08000020); //send general error abort
+			m_SDOClient.finishSegmented(false, 0);
 			seg_Data.resetTransferData(); //!overwrites previous collected data (even from other processes)
 			return 0;
 	}
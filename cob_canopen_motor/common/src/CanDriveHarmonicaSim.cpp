@@ -0,0 +1,647 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_canopen_motor
+ * Description: Simulated Elmo Harmonica drive for the CanDummy bus.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+
+#include <cob_canopen_motor/CanDriveHarmonicaSim.h>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+//-----------------------------------------------
+// rated current (0x6075) of the simulated motor, the rated torque (0x6076) isn't set
+static const int c_iRatedCurrMA = 10000;
+
+//-----------------------------------------------
+CanDriveHarmonicaSim::CanDriveHarmonicaSim(const CanDriveHarmonica::ParamCanOpenType& ParamCanOpen)
+{
+	m_ParamCanOpen = ParamCanOpen;
+	m_iRxPDO1 = ParamCanOpen.iRxPDO2 - 0x100;
+	m_iTxPDO4 = ParamCanOpen.iTxPDO1 + 0x300;
+
+	init();
+}
+
+//-----------------------------------------------
+CanDriveHarmonicaSim::CanDriveHarmonicaSim(const CanDrive402::ParamCanOpenType& ParamCanOpen)
+{
+	m_ParamCanOpen.iTxPDO1 = ParamCanOpen.iTxPDO1;
+	m_ParamCanOpen.iTxPDO2 = ParamCanOpen.iTxPDO1 + 0x100;
+	m_ParamCanOpen.iRxPDO2 = ParamCanOpen.iRxPDO1 + 0x100;
+	m_ParamCanOpen.iTxSDO = ParamCanOpen.iTxSDO;
+	m_ParamCanOpen.iRxSDO = ParamCanOpen.iRxSDO;
+	m_ParamCanOpen.iTxPDO3 = ParamCanOpen.iTxPDO3;
+	m_iRxPDO1 = ParamCanOpen.iRxPDO1;
+	m_iTxPDO4 = ParamCanOpen.iTxPDO4;
+
+	init();
+}
+
+//-----------------------------------------------
+void CanDriveHarmonicaSim::init()
+{
+	m_LastUpdate.SetNow();
+	m_dPosIncr = 0;
+	m_iVelIncrS = 0;
+	m_bMotorOn = false;
+	m_iFailure = 0;
+	m_dCurrentPerVel = 0.0001;
+	m_iDigIn = 0;
+
+	m_bHomingArmed = false;
+	m_iHomingPosRef = 0;
+	m_iHomingDistIncr = 1000;
+	m_dHomingStartPos = 0;
+
+	m_iRecorderStatus = 0;
+	m_iRecordingGap = 1;
+	m_iUploadOffset = 0;
+	m_iUploadObjIndex = 0;
+	m_iUploadObjSubIndex = 0;
+	m_bUploadToggle = false;
+	m_bUploadActive = false;
+	m_bUploadBlock = false;
+	m_iUploadBlockSize = 0;
+	m_iUploadBlockStart = 0;
+
+	m_iNumTPDO3Mapped = 0;
+
+	m_iNumRPDO1Mapped = 0;
+	m_iNumTPDO4Mapped = 0;
+	m_iControlWord = 0;
+	m_bTouchProbeArmed = false;
+	m_iTouchProbeStatus = 0;
+	m_iTouchProbePos = 0;
+}
+
+//-----------------------------------------------
+void CanDriveHarmonicaSim::evalMsg(const CanMsg& CMsg, std::vector<CanMsg>& vReplies)
+{
+	CanMsg Reply;
+	int iPos;
+
+	//-----------------------
+	// SYNC -> PDO1 with position and velocity
+	if (CMsg.m_iID == 0x80)
+	{
+		updatePos();
+		iPos = (int)m_dPosIncr;
+
+		Reply.m_iID = m_ParamCanOpen.iTxPDO1;
+		Reply.m_iLen = 8;
+		Reply.set(iPos, iPos >> 8, iPos >> 16, iPos >> 24,
+			m_iVelIncrS, m_iVelIncrS >> 8, m_iVelIncrS >> 16, m_iVelIncrS >> 24);
+		vReplies.push_back(Reply);
+
+		// TPDO3 with active current (per mille of the rated current), torque (rated torque not set) and following error
+		if (m_iNumTPDO3Mapped > 0)
+		{
+			int iCurrPerMille = (int)(1000.0 * m_dCurrentPerVel * m_iVelIncrS / (c_iRatedCurrMA / 1000.0));
+
+			Reply.m_iID = m_ParamCanOpen.iTxPDO3;
+			Reply.set(iCurrPerMille, iCurrPerMille >> 8, 0, 0, 0, 0, 0, 0);
+			vReplies.push_back(Reply);
+		}
+
+		// TPDO4 with statusword, touch probe status and touch probe 1 position
+		if (m_iNumTPDO4Mapped > 0)
+		{
+			int iStatusWord = getStatusWord();
+
+			Reply.m_iID = m_iTxPDO4;
+			Reply.set(iStatusWord, iStatusWord >> 8, m_iTouchProbeStatus, m_iTouchProbeStatus >> 8,
+				m_iTouchProbePos, m_iTouchProbePos >> 8, m_iTouchProbePos >> 16, m_iTouchProbePos >> 24);
+			vReplies.push_back(Reply);
+		}
+	}
+
+	//-----------------------
+	// CiA 402 RxPDO1: controlword, target velocity, touch probe function
+	else if ((CMsg.m_iID == m_iRxPDO1) && (m_iNumRPDO1Mapped > 0))
+	{
+		updatePos();
+		evalControlWord(CMsg.getAt(0) | (CMsg.getAt(1) << 8));
+		if (m_bMotorOn)
+		{
+			m_iVelIncrS = (CMsg.getAt(5) << 24) | (CMsg.getAt(4) << 16)
+				| (CMsg.getAt(3) << 8) | (CMsg.getAt(2) );
+		}
+		evalTouchProbeFunction(CMsg.getAt(6) | (CMsg.getAt(7) << 8));
+	}
+
+	//-----------------------
+	// binary interpreter
+	else if (CMsg.m_iID == m_ParamCanOpen.iRxPDO2)
+	{
+		evalIntprt(CMsg, vReplies);
+	}
+
+	//-----------------------
+	// SDO
+	else if (CMsg.m_iID == m_ParamCanOpen.iRxSDO)
+	{
+		evalSDO(CMsg, vReplies);
+	}
+}
+
+//-----------------------------------------------
+void CanDriveHarmonicaSim::setFailure(int iFailure)
+{
+	m_iFailure = iFailure;
+
+	// a failure switches the motor off
+	if (m_iFailure != 0)
+	{
+		updatePos();
+		m_bMotorOn = false;
+		m_iVelIncrS = 0;
+	}
+}
+
+//-----------------------------------------------
+void CanDriveHarmonicaSim::evalIntprt(const CanMsg& CMsg, std::vector<CanMsg>& vReplies)
+{
+	char cCmdChar1 = CMsg.getAt(0);
+	char cCmdChar2 = CMsg.getAt(1);
+	int iIndex = CMsg.getAt(2) | ((CMsg.getAt(3) & 0x3F) << 8);
+	bool bFloat = ((CMsg.getAt(3) & 0x80) != 0);
+	int iData = (CMsg.getAt(7) << 24) | (CMsg.getAt(6) << 16)
+		| (CMsg.getAt(5) << 8) | (CMsg.getAt(4) );
+	int iStatus;
+	float fCurr;
+
+	updatePos();
+
+	if (CMsg.m_iLen == 8)
+	{
+		// ------------------- set command, the drive echoes it
+		if( (cCmdChar1 == 'M') && (cCmdChar2 == 'O') )
+		{
+			m_bMotorOn = (iData == 1) && (m_iFailure == 0);
+			if (!m_bMotorOn)
+				m_iVelIncrS = 0;
+		}
+		else if( (cCmdChar1 == 'J') && (cCmdChar2 == 'V') )
+		{
+			if (m_bMotorOn)
+				m_iVelIncrS = iData;
+		}
+		else if( (cCmdChar1 == 'P') && (cCmdChar2 == 'X') )
+		{
+			m_dPosIncr = iData;
+		}
+		else if( (cCmdChar1 == 'H') && (cCmdChar2 == 'M') )
+		{
+			if (iIndex == 1)
+			{
+				m_bHomingArmed = (iData != 0);
+				m_dHomingStartPos = m_dPosIncr;
+			}
+			else if (iIndex == 2)
+				m_iHomingPosRef = iData;
+		}
+		else if( (cCmdChar1 == 'R') && (cCmdChar2 == 'G') )
+		{
+			m_iRecordingGap = iData;
+		}
+		else if( (cCmdChar1 == 'R') && (cCmdChar2 == 'R') )
+		{
+			// the simulated recorder finishes immediately
+			if (iData != 0)
+				m_iRecorderStatus = 2;
+		}
+
+		appendIntprt(vReplies, cCmdChar1, cCmdChar2, iIndex, iData, bFloat);
+	}
+	else
+	{
+		// ------------------- query
+		if( (cCmdChar1 == 'S') && (cCmdChar2 == 'R') )
+		{
+			iStatus = 0;
+			if (m_bMotorOn)
+				iStatus |= (1 << 4);
+			if (m_iFailure != 0)
+				iStatus |= (1 << 6);
+			iStatus |= (m_iRecorderStatus << 16);
+
+			appendIntprt(vReplies, 'S', 'R', iIndex, iStatus);
+		}
+		else if( (cCmdChar1 == 'M') && (cCmdChar2 == 'F') )
+		{
+			appendIntprt(vReplies, 'M', 'F', iIndex, m_iFailure);
+		}
+		else if( (cCmdChar1 == 'I') && (cCmdChar2 == 'Q') )
+		{
+			fCurr = (float)(m_dCurrentPerVel * m_iVelIncrS);
+			memcpy(&iData, &fCurr, sizeof(iData));
+			appendIntprt(vReplies, 'I', 'Q', iIndex, iData, true);
+		}
+		else if( (cCmdChar1 == 'I') && (cCmdChar2 == 'P') )
+		{
+			appendIntprt(vReplies, 'I', 'P', iIndex, m_iDigIn);
+		}
+		else if( (cCmdChar1 == 'H') && (cCmdChar2 == 'M') )
+		{
+			// homing armed = 1 / disarmed = 0
+			appendIntprt(vReplies, 'H', 'M', iIndex, (iIndex == 1) ? m_bHomingArmed : m_iHomingPosRef);
+		}
+		else if( (cCmdChar1 == 'P') && (cCmdChar2 == 'X') )
+		{
+			appendIntprt(vReplies, 'P', 'X', iIndex, (int)m_dPosIncr);
+		}
+		else if( (cCmdChar1 == 'V') && (cCmdChar2 == 'X') )
+		{
+			appendIntprt(vReplies, 'V', 'X', iIndex, m_iVelIncrS);
+		}
+		else if( (cCmdChar1 == 'M') && (cCmdChar2 == 'O') )
+		{
+			appendIntprt(vReplies, 'M', 'O', iIndex, m_bMotorOn);
+		}
+		else if( (cCmdChar1 == 'B') && (cCmdChar2 == 'G') )
+		{
+			// execute command, no answer
+		}
+		else
+		{
+			appendIntprt(vReplies, cCmdChar1, cCmdChar2, iIndex, 0, bFloat);
+		}
+	}
+}
+
+//-----------------------------------------------
+void CanDriveHarmonicaSim::evalSDO(const CanMsg& CMsg, std::vector<CanMsg>& vReplies)
+{
+	int iCmdSpec = CMsg.getAt(0) >> 5;
+	int iObjIndex = CMsg.getAt(1) | (CMsg.getAt(2) << 8);
+	int iObjSubIndex = CMsg.getAt(3);
+	bool bToggle = ((CMsg.getAt(0) & 0x10) != 0);
+	unsigned int iNumBytes;
+	CanMsg Reply;
+
+	if (iCmdSpec == 1)
+	{
+		// initiate download (only expedited ones are sent) -> confirm
+		if ((iObjIndex == 0x1A02) && (iObjSubIndex == 0))
+			m_iNumTPDO3Mapped = CMsg.getAt(4);
+		else if ((iObjIndex == 0x1600) && (iObjSubIndex == 0))
+			m_iNumRPDO1Mapped = CMsg.getAt(4);
+		else if ((iObjIndex == 0x1A03) && (iObjSubIndex == 0))
+			m_iNumTPDO4Mapped = CMsg.getAt(4);
+		else if (iObjIndex == 0x6040)
+		{
+			updatePos();
+			evalControlWord(CMsg.getAt(4) | (CMsg.getAt(5) << 8));
+		}
+		appendSDO(vReplies, 0x60, iObjIndex, iObjSubIndex, 0);
+	}
+	else if (iCmdSpec == 2)
+	{
+		// initiate upload
+		if (iObjIndex == 0x2030)
+		{
+			if (m_iRecorderStatus != 2)
+			{
+				// no data available
+				appendSDO(vReplies, 0x80, iObjIndex, iObjSubIndex, 0x08000024);
+				return;
+			}
+
+			m_iUploadObjIndex = iObjIndex;
+			m_iUploadObjSubIndex = iObjSubIndex;
+			fillRecorderData();
+			m_iUploadOffset = 0;
+			m_bUploadToggle = false;
+			m_bUploadActive = true;
+			m_bUploadBlock = false;
+
+			// segmented transfer, size indicated
+			appendSDO(vReplies, 0x41, iObjIndex, iObjSubIndex, m_vUploadData.size());
+		}
+		else
+		{
+			updatePos();
+			if (iObjIndex == 0x6064)
+				appendSDO(vReplies, 0x43, iObjIndex, iObjSubIndex, (int)m_dPosIncr);
+			else if ((iObjIndex == 0x6069) || (iObjIndex == 0x606C))
+				appendSDO(vReplies, 0x43, iObjIndex, iObjSubIndex, m_iVelIncrS);
+			else if (iObjIndex == 0x6041)
+				appendSDO(vReplies, 0x43, iObjIndex, iObjSubIndex, getStatusWord());
+			else if (iObjIndex == 0x6075)
+				appendSDO(vReplies, 0x43, iObjIndex, iObjSubIndex, c_iRatedCurrMA);
+			else
+				appendSDO(vReplies, 0x43, iObjIndex, iObjSubIndex, 0);
+		}
+	}
+	else if (iCmdSpec == 3)
+	{
+		// upload segment
+		if (!m_bUploadActive || m_bUploadBlock)
+		{
+			// command specifier not valid
+			appendSDO(vReplies, 0x80, m_iUploadObjIndex, m_iUploadObjSubIndex, 0x05040001);
+			return;
+		}
+
+		if (bToggle != m_bUploadToggle)
+		{
+			// toggle bit not alternated
+			appendSDO(vReplies, 0x80, m_iUploadObjIndex, m_iUploadObjSubIndex, 0x05030000);
+			m_bUploadActive = false;
+			return;
+		}
+
+		iNumBytes = m_vUploadData.size() - m_iUploadOffset;
+		if (iNumBytes > 7)
+			iNumBytes = 7;
+
+		Reply.m_iID = m_ParamCanOpen.iTxSDO;
+		Reply.m_iLen = 8;
+		Reply.set(0,0,0,0,0,0,0,0);
+		for (unsigned int i = 0; i < iNumBytes; i++)
+			Reply.setAt(m_vUploadData[m_iUploadOffset + i], i + 1);
+		m_iUploadOffset += iNumBytes;
+
+		// Byte 0: SSS T NNN C | SSS=Cmd-Specifier, T=ToggleBit, NNN=num of empty bytes, C=Finished
+		Reply.setAt((m_bUploadToggle << 4) | ((7 - iNumBytes) << 1)
+			| ((m_iUploadOffset >= m_vUploadData.size()) ? 1 : 0), 0);
+		vReplies.push_back(Reply);
+
+		m_bUploadToggle = !m_bUploadToggle;
+		if (m_iUploadOffset >= m_vUploadData.size())
+			m_bUploadActive = false;
+	}
+	else if (iCmdSpec == 4)
+	{
+		// abort by the client
+		m_bUploadActive = false;
+	}
+	else if (iCmdSpec == 5)
+	{
+		// block upload, Byte 0: 101 00 C SS | C=CRC supported (initiate), SS=client sub-command
+		int iSubCmd = CMsg.getAt(0) & 0x03;
+
+		if (iSubCmd == 0)
+		{
+			// initiate
+			if ((iObjIndex != 0x2030) || (m_iRecorderStatus != 2))
+			{
+				// block transfers are supported for the recorder data only
+				appendSDO(vReplies, 0x80, iObjIndex, iObjSubIndex, 0x05040001);
+				return;
+			}
+
+			m_iUploadObjIndex = iObjIndex;
+			m_iUploadObjSubIndex = iObjSubIndex;
+			fillRecorderData();
+			m_iUploadOffset = 0;
+			m_iUploadBlockStart = 0;
+			m_iUploadBlockSize = CMsg.getAt(4);
+			m_bUploadActive = true;
+			m_bUploadBlock = true;
+
+			// CRC supported, size indicated
+			appendSDO(vReplies, 0xC6, iObjIndex, iObjSubIndex, m_vUploadData.size());
+		}
+		else if (!m_bUploadActive || !m_bUploadBlock)
+		{
+			// command specifier not valid
+			appendSDO(vReplies, 0x80, m_iUploadObjIndex, m_iUploadObjSubIndex, 0x05040001);
+		}
+		else if (iSubCmd == 3)
+		{
+			// start upload
+			appendUploadBlock(vReplies);
+		}
+		else if (iSubCmd == 2)
+		{
+			// block confirmed up to the sequence number in byte 1, byte 2 is the next block size
+			m_iUploadOffset = std::min<unsigned int>(m_iUploadBlockStart + 7 * CMsg.getAt(1), m_vUploadData.size());
+			m_iUploadBlockStart = m_iUploadOffset;
+			m_iUploadBlockSize = CMsg.getAt(2);
+			appendUploadBlock(vReplies);
+		}
+		else
+		{
+			// end confirmed
+			m_bUploadActive = false;
+			m_bUploadBlock = false;
+		}
+	}
+}
+
+//-----------------------------------------------
+void CanDriveHarmonicaSim::appendUploadBlock(std::vector<CanMsg>& vReplies)
+{
+	CanMsg Reply;
+	unsigned int iOffset = m_iUploadBlockStart;
+	unsigned int iNumBytes;
+
+	Reply.m_iID = m_ParamCanOpen.iTxSDO;
+	Reply.m_iLen = 8;
+
+	if (iOffset >= m_vUploadData.size())
+	{
+		// end, Byte 0: 110 NNN 0 1 | NNN=num of unused bytes in the last segment, Byte 1..2: CRC
+		unsigned short iCRC = segData::calcCRC(m_vUploadData);
+		int iNumEmpty = (7 - m_vUploadData.size() % 7) % 7;
+
+		Reply.set(0xC1 | (iNumEmpty << 2), iCRC, iCRC >> 8, 0, 0, 0, 0, 0);
+		vReplies.push_back(Reply);
+		return;
+	}
+
+	for (int iSeqNo = 1; (iSeqNo <= m_iUploadBlockSize) && (iOffset < m_vUploadData.size()); iSeqNo++)
+	{
+		iNumBytes = m_vUploadData.size() - iOffset;
+		if (iNumBytes > 7)
+			iNumBytes = 7;
+
+		Reply.set(0,0,0,0,0,0,0,0);
+		for (unsigned int i = 0; i < iNumBytes; i++)
+			Reply.setAt(m_vUploadData[iOffset + i], i + 1);
+		iOffset += iNumBytes;
+
+		// Byte 0: C NNNNNNN | C=last segment, NNNNNNN=sequence number
+		Reply.setAt(((iOffset >= m_vUploadData.size()) ? 0x80 : 0x00) | iSeqNo, 0);
+		vReplies.push_back(Reply);
+	}
+}
+
+//-----------------------------------------------
+void CanDriveHarmonicaSim::updatePos()
+{
+	TimeStamp Now;
+
+	Now.SetNow();
+	m_dPosIncr += m_iVelIncrS * (Now - m_LastUpdate);
+	m_LastUpdate = Now;
+
+	// homing event: HM[4] = 2 (do nothing), HM[5] = 0 (PX = HM[2])
+	if (m_bHomingArmed && (fabs(m_dPosIncr - m_dHomingStartPos) >= m_iHomingDistIncr))
+	{
+		m_dPosIncr = m_iHomingPosRef;
+		m_bHomingArmed = false;
+	}
+
+	// touch probe 1 event: position stored, positive edge stored (bit 1)
+	if (m_bTouchProbeArmed && (fabs(m_dPosIncr - m_dHomingStartPos) >= m_iHomingDistIncr))
+	{
+		m_iTouchProbePos = (int)m_dPosIncr;
+		m_iTouchProbeStatus |= 0x02;
+		m_bTouchProbeArmed = false;
+	}
+}
+
+//-----------------------------------------------
+void CanDriveHarmonicaSim::evalControlWord(int iControlWord)
+{
+	// fault reset on the rising edge of bit 7
+	if (((iControlWord & 0x80) != 0) && ((m_iControlWord & 0x80) == 0))
+		m_iFailure = 0;
+
+	m_iControlWord = iControlWord;
+
+	// operation enabled: switch on, enable voltage, quick stop and enable operation set
+	m_bMotorOn = ((iControlWord & 0x8F) == 0x0F) && (m_iFailure == 0);
+	if (!m_bMotorOn)
+		m_iVelIncrS = 0;
+}
+
+//-----------------------------------------------
+void CanDriveHarmonicaSim::evalTouchProbeFunction(int iTouchProbeFunction)
+{
+	if ((iTouchProbeFunction & 0x01) == 0)
+	{
+		// switched off
+		m_bTouchProbeArmed = false;
+		m_iTouchProbeStatus = 0;
+	}
+	else if (m_iTouchProbeStatus == 0)
+	{
+		// switched on, the first event is stored
+		m_bTouchProbeArmed = true;
+		m_iTouchProbeStatus = 0x01;
+		m_dHomingStartPos = m_dPosIncr;
+	}
+}
+
+//-----------------------------------------------
+int CanDriveHarmonicaSim::getStatusWord()
+{
+	if (m_iFailure != 0)
+		return 0x08;
+	if (m_bMotorOn)
+		return 0x27;
+	if ((m_iControlWord & 0x87) == 0x07)
+		return 0x23;
+	if ((m_iControlWord & 0x87) == 0x06)
+		return 0x21;
+
+	// switch on disabled
+	return 0x40;
+}
+
+//-----------------------------------------------
+void CanDriveHarmonicaSim::appendIntprt(std::vector<CanMsg>& vReplies, char cCmdChar1, char cCmdChar2, int iIndex, int iData, bool bFloat)
+{
+	CanMsg Reply;
+
+	Reply.m_iID = m_ParamCanOpen.iTxPDO2;
+	Reply.m_iLen = 8;
+	Reply.set(cCmdChar1, cCmdChar2, iIndex, ((iIndex >> 8) & 0x3F) | (bFloat ? 0x80 : 0x00),
+		iData, iData >> 8, iData >> 16, iData >> 24);
+	vReplies.push_back(Reply);
+}
+
+//-----------------------------------------------
+void CanDriveHarmonicaSim::appendSDO(std::vector<CanMsg>& vReplies, int iByte0, int iObjIndex, int iObjSubIndex, unsigned int iData)
+{
+	CanMsg Reply;
+
+	Reply.m_iID = m_ParamCanOpen.iTxSDO;
+	Reply.m_iLen = 8;
+	Reply.set(iByte0, iObjIndex, iObjIndex >> 8, iObjSubIndex,
+		iData, iData >> 8, iData >> 16, iData >> 24);
+	vReplies.push_back(Reply);
+}
+
+//-----------------------------------------------
+void CanDriveHarmonicaSim::fillRecorderData()
+{
+	// recording length as configured by ElmoRecorder (RL = 1024)
+	const int c_iNumItems = 1024;
+	const float c_fFactor = 1.0f;
+	unsigned int iBits;
+	float fVal;
+
+	m_vUploadData.clear();
+
+	// see SimplIQ CANopen DS 301 Implementation Guide, object 0x2030
+	// Byte 0: data type (5 = float) and recording gap, Byte 1..2: number of items, Byte 3..6: floating point factor
+	memcpy(&iBits, &c_fFactor, sizeof(iBits));
+	m_vUploadData.push_back((5 << 4) | (m_iRecordingGap & 0x0F));
+	m_vUploadData.push_back(c_iNumItems & 0xFF);
+	m_vUploadData.push_back(c_iNumItems >> 8);
+	for (int i = 0; i < 4; i++)
+		m_vUploadData.push_back(iBits >> (8 * i));
+
+	// current velocity with a ripple, differing per recorded signal (subindex)
+	for (int i = 0; i < c_iNumItems; i++)
+	{
+		fVal = (float)(m_iVelIncrS + 10.0 * m_iUploadObjSubIndex * sin(2.0 * M_PI * i / 64.0));
+		memcpy(&iBits, &fVal, sizeof(iBits));
+		for (int j = 0; j < 4; j++)
+			m_vUploadData.push_back(iBits >> (8 * j));
+	}
+}
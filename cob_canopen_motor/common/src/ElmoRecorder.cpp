@@ -51,11 +51,12 @@
  *
  ****************************************************************/
 
-#include <math.h>
+#include <stdint.h>
+#include <string.h>
 #include <vector>
-#include <stdio.h>
 #include <sstream>
 #include <cob_canopen_motor/ElmoRecorder.h>
+#include <cob_canopen_motor/ElmoRecorderFile.h>
 #include <cob_canopen_motor/CanDriveHarmonica.h>
 
 ElmoRecorder::ElmoRecorder(CanDriveHarmonica * pParentHarmonicaDrive) {
@@ -63,6 +64,9 @@ ElmoRecorder::ElmoRecorder(CanDriveHarmonica * pParentHarmonicaDrive) {
 
 	m_bIsInitialized = false;
 	m_iReadoutRecorderTry = 0;
+	m_iCurrentObject = 0;
+	m_iDriveID = 0;
+	m_fRecordingStepSec = 0;
 }
 
 ElmoRecorder::~ElmoRecorder() {
@@ -143,10 +147,10 @@ int ElmoRecorder::readoutRecorderTryStatus(int iStatusReg, segData& SDOData) {
 }
 
 int ElmoRecorder::readoutRecorder(int iObjSubIndex){
-	//initialize Upload of Recorded Data (object 0x2030)
+	//initialize Upload of Recorded Data (object 0x2030), block transfer if supported by the drive
 	int iObjIndex = 0x2030;
 
-	m_pHarmonicaDrive->sendSDOUpload(iObjIndex, iObjSubIndex);
+	m_pHarmonicaDrive->sendSDOBlockUpload(iObjIndex, iObjSubIndex);
 	m_iCurrentObject = iObjSubIndex;
 
 	return 0;
@@ -154,12 +158,11 @@ int ElmoRecorder::readoutRecorder(int iObjSubIndex){
 
 int ElmoRecorder::processData(segData& SDOData) {
 	int iItemSize = 4;
-	int iItemCount = 0;
+	int iDataType = 0;
 	unsigned int iNumDataItems = 0;
-	bool bCollectFloats = true;
+	unsigned int iNumReceivedItems = 0;
 	float fFloatingPointFactor = 0;
-
-	std::vector<float> vfResData[2];
+	const unsigned char* pItem;
 
 	//see SimplIQ CANopen DS 301 Implementation Guide, object 0x2030
 
@@ -173,69 +176,55 @@ int ElmoRecorder::processData(segData& SDOData) {
 	//
 	//Byte 7 to Byte (7+ iNumdataItems * 4) contain data
 
-	//B[0]: Time quantum and data type
-	switch ((SDOData.data[0] >> 4) ) {
-		case 4:
-			bCollectFloats = false;
-			iItemSize = 4;
-			break;
-		case 5:
-			bCollectFloats = true;
-			iItemSize = 4;
-			break;
-		case 1:
-			bCollectFloats = true;
-			iItemSize = 2;
-			break;
-		default:
-			bCollectFloats = false;
-			iItemSize = 4;
-			break;
+	if(SDOData.data.size() < 7) {
+		std::cout << "Recorder " << m_iDriveID << ": uploaded data too short for the header" << std::endl;
+		SDOData.statusFlag = segData::SDO_SEG_FREE;
+		return 1;
 	}
-	std::cout << ">>>>>ElmoRec: HEADER INFOS<<<<<\nData type is: " << (SDOData.data[0] >> 4) << std::endl;
-
-	//std::cout << "fTimeQuantum from Header is " << fTimeQuantum << " m_fRecordingStepSec is " << m_fRecordingStepSec << std::endl;
 
+	//B[0]: Time quantum and data type
+	iDataType = SDOData.data[0] >> 4;
+	iItemSize = (iDataType == 1) ? 2 : 4;
+	std::cout << ">>>>>ElmoRec: HEADER INFOS<<<<<\nData type is: " << iDataType << std::endl;
 
 	//B[1]..[2] //Number of recorded items
 	iNumDataItems = (SDOData.data[2] << 8 | SDOData.data[1]);
-	//std::cout << "Number of recorded data points: " << iNumDataItems << std::endl;
 
 	//B[3] ... [6] //Floating point factor
 	fFloatingPointFactor = convertBinaryToFloat( (SDOData.data[6] << 24) | (SDOData.data[5] << 16) | (SDOData.data[4] << 8) | (SDOData.data[3]) );
 	std::cout << "Floating point factor for recorded values is: " << fFloatingPointFactor << std::endl;
 
-
-	if( ((SDOData.numTotalBytes-7)/iItemSize) != iNumDataItems)
-		std::cout << "SDODataSize announced in SDO-Header" << ((SDOData.numTotalBytes-7)/iItemSize) << " differs from NumDataItems by ElmoData-Header" <<  iNumDataItems << std::endl;
+	iNumReceivedItems = (SDOData.data.size() - 7) / iItemSize;
+	if(iNumReceivedItems != iNumDataItems) {
+		std::cout << "SDODataSize " << iNumReceivedItems << " differs from NumDataItems by ElmoData-Header " << iNumDataItems << std::endl;
+		if(iNumReceivedItems < iNumDataItems) iNumDataItems = iNumReceivedItems;
+	}
 	//END HEADER
 	//--------------------------------------
 
-	vfResData[0].assign(iNumDataItems, 0.0);
-	vfResData[1].assign(iNumDataItems, 0.0);
-	iItemCount = 0;
+	m_vfValues.resize(iNumDataItems);
+	pItem = iNumDataItems > 0 ? &SDOData.data[7] : NULL;
 
 	//extract values from data stream, consider Little Endian conversion for every single object!
-	for(unsigned int i=7;i<=SDOData.data.size() - iItemSize; i=i+iItemSize) {
-		if(bCollectFloats) {
-			if(iItemSize == 4)
-				vfResData[1][iItemCount] = fFloatingPointFactor * convertBinaryToFloat( (SDOData.data[i] << 0) | (SDOData.data[i+1] << 8) | (SDOData.data[i+2] << 16) | (SDOData.data[i+3] << 24) );
-
-				//DEBUG
-				if(iItemCount == 120)
-					std::cout << (unsigned int)( (SDOData.data[i] << 0) | (SDOData.data[i+1] << 8) | (SDOData.data[i+2] << 16) | (SDOData.data[i+3] << 24) ) << std::endl;
-
-			else vfResData[1][iItemCount] = fFloatingPointFactor * convertBinaryToHalfFloat( (SDOData.data[i] << 0) | (SDOData.data[i+1] << 8) | (SDOData.data[i+2] << 16) | (SDOData.data[i+3] << 24) );
-			iItemCount ++;
-		} else {
-			vfResData[1][iItemCount] = fFloatingPointFactor * (float)( (SDOData.data[i] << 0) | (SDOData.data[i+1] << 8) | (SDOData.data[i+2] << 16) | (SDOData.data[i+3] << 24) );
-			iItemCount ++;
-		}
-
-		vfResData[0][iItemCount] = m_fRecordingStepSec * iItemCount;
+	switch(iDataType) {
+		case 5:
+			for(unsigned int i = 0; i < iNumDataItems; i++, pItem += 4) {
+				m_vfValues[i] = fFloatingPointFactor * convertBinaryToFloat( pItem[0] | (pItem[1] << 8) | (pItem[2] << 16) | (pItem[3] << 24) );
+			}
+			break;
+		case 1:
+			for(unsigned int i = 0; i < iNumDataItems; i++, pItem += 2) {
+				m_vfValues[i] = fFloatingPointFactor * convertBinaryToHalfFloat( pItem[0] | (pItem[1] << 8) );
+			}
+			break;
+		default: //Long Int
+			for(unsigned int i = 0; i < iNumDataItems; i++, pItem += 4) {
+				m_vfValues[i] = fFloatingPointFactor * (float)(int)( pItem[0] | (pItem[1] << 8) | (pItem[2] << 16) | (pItem[3] << 24) );
+			}
+			break;
 	}
 
-	logToFile(m_sLogFilename, vfResData);
+	logToFile(m_sLogFilename, m_vfValues);
 
 	SDOData.statusFlag = segData::SDO_SEG_FREE;
 	return 0;
@@ -249,80 +238,51 @@ int ElmoRecorder::setLogFilename(std::string sLogFileprefix) {
 
 
 float ElmoRecorder::convertBinaryToFloat(unsigned int iBinaryRepresentation) {
-	//Converting binary-numbers to 32bit float values according to IEEE 754 see http://de.wikipedia.org/wiki/IEEE_754
-	int iSign;
-	int iExponent;
-	unsigned int iMantissa;
-	float iNumMantissa = 0.0f;
-
-	if((iBinaryRepresentation & (1 << 31)) == 0) //first bit is sign bit: 0 = +, 1 = -
-		iSign = 1;
-	else
-		iSign = -1;
-
-	iExponent = ((iBinaryRepresentation >> 23) & 0xFF) - 127; //take away Bias(127) for positive and negative exponents
+	//The bits are a 32bit float value according to IEEE 754 see http://de.wikipedia.org/wiki/IEEE_754
+	uint32_t iBits = iBinaryRepresentation;
+	float fValue;
 
-	iMantissa = (iBinaryRepresentation & 0x7FFFFF); //only keep mantissa part of binary number
-
-	iNumMantissa = 1.0f;
-
-	for(int i=1; i<=23; i++) { //calculate decimal places (convert binary mantissa to decimal number
-		if((iMantissa & (1 << (23-i))) > 0) {
-			iNumMantissa = iNumMantissa + pow(2,(-1)*i);
-		}
-	}
-
-	return iSign * pow(2,iExponent) * iNumMantissa;
+	memcpy(&fValue, &iBits, sizeof(fValue));
+	return fValue;
 }
 
 float ElmoRecorder::convertBinaryToHalfFloat(unsigned int iBinaryRepresentation) {
 	//Converting binary-numbers to 16bit float values according to IEEE 754 see http://de.wikipedia.org/wiki/IEEE_754
-	int iSign;
-	int iExponent;
-	unsigned int iMantissa;
-	float iNumMantissa = 0.0f;
-
-	if((iBinaryRepresentation & (1 << 15)) == 0) //first bit is sign bit: 0 = +, 1 = -
-		iSign = 1;
-	else
-		iSign = -1;
-
-	iExponent = ((iBinaryRepresentation >> 10) & 0x1F) - 15; //take away Bias(15) for positive and negative exponents
-
-	iMantissa = (iBinaryRepresentation & 0x3FF); //only keep mantissa part of binary number
-
-	iNumMantissa = 1.0f;
-
-	for(int i=1; i<=10; i++) { //calculate decimal places (convert binary mantissa to decimal number
-		if((iMantissa & (1 << (10-i))) > 0) {
-			iNumMantissa = iNumMantissa + pow(2,(-1)*i);
+	//by moving sign, exponent (bias 15 -> 127) and mantissa (10 -> 23 bits) to a 32bit float
+	uint32_t iSign = (iBinaryRepresentation & 0x8000) << 16;
+	uint32_t iExponent = (iBinaryRepresentation >> 10) & 0x1F;
+	uint32_t iMantissa = iBinaryRepresentation & 0x3FF;
+	uint32_t iBits;
+	float fValue;
+
+	if(iExponent == 0x1F) { //infinity or NaN
+		iBits = iSign | 0x7F800000 | (iMantissa << 13);
+	} else if(iExponent != 0) { //normalized
+		iBits = iSign | ((iExponent + 127 - 15) << 23) | (iMantissa << 13);
+	} else if(iMantissa == 0) { //zero
+		iBits = iSign;
+	} else { //denormalized, normalize the mantissa
+		iExponent = 127 - 15 + 1;
+		while((iMantissa & 0x400) == 0) {
+			iMantissa <<= 1;
+			iExponent--;
 		}
+		iBits = iSign | (iExponent << 23) | ((iMantissa & 0x3FF) << 13);
 	}
 
-	return iSign * pow(2,iExponent) * iNumMantissa;
+	memcpy(&fValue, &iBits, sizeof(fValue));
+	return fValue;
 }
 
 // Function for writing Logfile
-int ElmoRecorder::logToFile(std::string filename, std::vector<float> vtValues[]) {
+int ElmoRecorder::logToFile(std::string filename, const std::vector<float>& vfValues) {
 	std::stringstream outputFileName;
-	outputFileName << filename << "mot_" << m_iDriveID << "_" << m_iCurrentObject << ".log";
+	outputFileName << filename << "mot_" << m_iDriveID << "_" << m_iCurrentObject << ".rec";
 
-	FILE* pFile;
-	//open FileStream
-	pFile = fopen(outputFileName.str().c_str(), "w");
-
-	//Check if there was a problem
-	if( pFile == NULL )
-	{
-		std::cout << "Error while writing file: " << outputFileName.str() << " Maybe the selected folder does'nt exist." << std::endl;
-	}
-	else
-	{
-		// write all data from vector to file
-		for (unsigned int i = 0; i < vtValues[0].size(); i++)
-			fprintf(pFile, "%e %e\n", vtValues[0][i], vtValues[1][i]);
-		fclose(pFile);
+	if(vfValues.empty()) {
+		std::cout << "Recorder " << m_iDriveID << ": no data to write to " << outputFileName.str() << std::endl;
+		return false;
 	}
 
-	return true;
+	return writeElmoRecorderFile(outputFileName.str(), m_iDriveID, m_iCurrentObject, m_fRecordingStepSec, vfValues.size(), vfValues);
 }
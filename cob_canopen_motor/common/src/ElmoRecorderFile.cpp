@@ -0,0 +1,187 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_canopen_motor
+ * Description: Binary file format of the Elmo Recorder data.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+
+#include <cob_canopen_motor/ElmoRecorderFile.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <iostream>
+
+//-----------------------------------------------
+static const char c_cRecorderMagic[8] = { 'E', 'L', 'M', 'O', 'R', 'E', 'C', '\0' };
+static const uint32_t c_iRecorderVersion = 1;
+
+//-----------------------------------------------
+bool writeElmoRecorderFile(const std::string& sFileName, int iDriveID, int iSource, float fSamplePeriodS,
+	unsigned int iNumSamples, const std::vector<float>& vfColumns)
+{
+	ElmoRecorderFileHeader Header;
+	std::vector<char> vcBuffer;
+	FILE* pFile;
+	bool bRet;
+
+	if ((iNumSamples == 0) || (vfColumns.size() % iNumSamples != 0))
+		return false;
+
+	memset(&Header, 0, sizeof(Header));
+	memcpy(Header.cMagic, c_cRecorderMagic, sizeof(c_cRecorderMagic));
+	Header.iVersion = c_iRecorderVersion;
+	Header.iHeaderSize = sizeof(Header);
+	Header.iDriveID = iDriveID;
+	Header.iSource = iSource;
+	Header.fSamplePeriodS = fSamplePeriodS;
+	Header.iNumSamples = iNumSamples;
+	Header.iNumColumns = vfColumns.size() / iNumSamples;
+
+	vcBuffer.resize(sizeof(Header) + vfColumns.size() * sizeof(float));
+	memcpy(&vcBuffer[0], &Header, sizeof(Header));
+	memcpy(&vcBuffer[sizeof(Header)], &vfColumns[0], vfColumns.size() * sizeof(float));
+
+	pFile = fopen(sFileName.c_str(), "wb");
+	if (pFile == NULL)
+	{
+		std::cout << "Error while writing file: " << sFileName << " Maybe the selected folder doesn't exist." << std::endl;
+		return false;
+	}
+
+	bRet = (fwrite(&vcBuffer[0], vcBuffer.size(), 1, pFile) == 1);
+	bRet = (fclose(pFile) == 0) && bRet;
+
+	return bRet;
+}
+
+//-----------------------------------------------
+ElmoRecorderFileReader::ElmoRecorderFileReader()
+{
+	m_iFd = -1;
+	m_iMapSize = 0;
+	m_pMap = NULL;
+	m_pHeader = NULL;
+	m_pData = NULL;
+}
+
+//-----------------------------------------------
+ElmoRecorderFileReader::~ElmoRecorderFileReader()
+{
+	close();
+}
+
+//-----------------------------------------------
+bool ElmoRecorderFileReader::open(const std::string& sFileName)
+{
+	struct stat FileStat;
+	const ElmoRecorderFileHeader* pHeader;
+
+	close();
+
+	m_iFd = ::open(sFileName.c_str(), O_RDONLY);
+	if (m_iFd < 0)
+	{
+		std::cout << "ElmoRecorderFileReader::open(): cannot open " << sFileName << std::endl;
+		return false;
+	}
+
+	if ((fstat(m_iFd, &FileStat) != 0) || (FileStat.st_size < (off_t)sizeof(ElmoRecorderFileHeader)))
+	{
+		std::cout << "ElmoRecorderFileReader::open(): " << sFileName << " is no recording" << std::endl;
+		close();
+		return false;
+	}
+
+	m_iMapSize = FileStat.st_size;
+	m_pMap = mmap(NULL, m_iMapSize, PROT_READ, MAP_PRIVATE, m_iFd, 0);
+	if (m_pMap == MAP_FAILED)
+	{
+		std::cout << "ElmoRecorderFileReader::open(): cannot map " << sFileName << std::endl;
+		m_pMap = NULL;
+		close();
+		return false;
+	}
+
+	pHeader = (const ElmoRecorderFileHeader*)m_pMap;
+	if ((memcmp(pHeader->cMagic, c_cRecorderMagic, sizeof(c_cRecorderMagic)) != 0)
+		|| (pHeader->iVersion != c_iRecorderVersion) || (pHeader->iHeaderSize < sizeof(ElmoRecorderFileHeader))
+		|| (pHeader->iHeaderSize % sizeof(float) != 0)
+		|| (m_iMapSize < pHeader->iHeaderSize + (size_t)pHeader->iNumColumns * pHeader->iNumSamples * sizeof(float)))
+	{
+		std::cout << "ElmoRecorderFileReader::open(): " << sFileName << " is no complete recording of version " << c_iRecorderVersion << std::endl;
+		close();
+		return false;
+	}
+
+	m_pHeader = pHeader;
+	m_pData = (const float*)((const char*)m_pMap + pHeader->iHeaderSize);
+
+	return true;
+}
+
+//-----------------------------------------------
+void ElmoRecorderFileReader::close()
+{
+	if (m_pMap != NULL)
+		munmap(m_pMap, m_iMapSize);
+	if (m_iFd >= 0)
+		::close(m_iFd);
+
+	m_iFd = -1;
+	m_iMapSize = 0;
+	m_pMap = NULL;
+	m_pHeader = NULL;
+	m_pData = NULL;
+}
@@ -0,0 +1,397 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_canopen_motor
+ * Description: Asynchronous client for the expedited SDO transfers of one CANopen node.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+//-----------------------------------------------
+#include <cob_canopen_motor/SDOClient.h>
+#include <iostream>
+//-----------------------------------------------
+
+//-----------------------------------------------
+SDOClient::SDOClient()
+{
+	m_pCanItf = NULL;
+	m_iRxSDO = 0;
+	m_iTxSDO = 0;
+	m_dTimeoutS = 0.2;
+
+	m_bActive = false;
+	m_bSegmented = false;
+
+	m_iNumTimeouts = 0;
+	m_iNumAborts = 0;
+}
+
+//-----------------------------------------------
+void SDOClient::setCanItf(CanItf* pCanItf, int iRxSDO, int iTxSDO)
+{
+	m_pCanItf = pCanItf;
+	m_iRxSDO = iRxSDO;
+	m_iTxSDO = iTxSDO;
+}
+
+//-----------------------------------------------
+void SDOClient::download(int iObjIndex, int iObjSubIndex, int iData, const Callback& Done)
+{
+	Transfer Tr;
+
+	Tr.bUpload = false;
+	Tr.bBlock = false;
+	Tr.iBlockSize = 0;
+	Tr.iObjIndex = iObjIndex;
+	Tr.iObjSubIndex = iObjSubIndex;
+	Tr.iData = iData;
+	Tr.iResult = SDO_PENDING;
+	Tr.iAbortCode = 0;
+	Tr.Done = Done;
+
+	m_Mutex.lock();
+	m_Queue.push_back(Tr);
+	sendNext();
+	m_Mutex.unlock();
+}
+
+//-----------------------------------------------
+void SDOClient::upload(int iObjIndex, int iObjSubIndex, const Callback& Done)
+{
+	Transfer Tr;
+
+	Tr.bUpload = true;
+	Tr.bBlock = false;
+	Tr.iBlockSize = 0;
+	Tr.iObjIndex = iObjIndex;
+	Tr.iObjSubIndex = iObjSubIndex;
+	Tr.iData = 0;
+	Tr.iResult = SDO_PENDING;
+	Tr.iAbortCode = 0;
+	Tr.Done = Done;
+
+	m_Mutex.lock();
+	m_Queue.push_back(Tr);
+	sendNext();
+	m_Mutex.unlock();
+}
+
+//-----------------------------------------------
+void SDOClient::uploadBlock(int iObjIndex, int iObjSubIndex, int iBlockSize, const Callback& Done)
+{
+	Transfer Tr;
+
+	if(iBlockSize < 1)
+		iBlockSize = 1;
+	if(iBlockSize > 127)
+		iBlockSize = 127;
+
+	Tr.bUpload = true;
+	Tr.bBlock = true;
+	Tr.iBlockSize = iBlockSize;
+	Tr.iObjIndex = iObjIndex;
+	Tr.iObjSubIndex = iObjSubIndex;
+	Tr.iData = 0;
+	Tr.iResult = SDO_PENDING;
+	Tr.iAbortCode = 0;
+	Tr.Done = Done;
+
+	m_Mutex.lock();
+	m_Queue.push_back(Tr);
+	sendNext();
+	m_Mutex.unlock();
+}
+
+//-----------------------------------------------
+bool SDOClient::evalReceivedMsg(const CanMsg& CMsg)
+{
+	if(CMsg.m_iID != m_iTxSDO)
+		return false;
+
+	int iCmd = CMsg.getAt(0);
+	int iObjIndex = (CMsg.getAt(2) << 8) | CMsg.getAt(1);
+	int iObjSubIndex = CMsg.getAt(3);
+	int iData = (CMsg.getAt(7) << 24) | (CMsg.getAt(6) << 16) |
+		(CMsg.getAt(5) << 8) | CMsg.getAt(4);
+
+	m_Mutex.lock();
+
+	if(!m_bActive)
+	{
+		m_Mutex.unlock();
+		return false;
+	}
+
+	const Transfer& Active = m_Queue.front();
+
+	if(Active.bBlock)
+	{
+		// the first byte of a block segment is a sequence number, so any value but the
+		// abort (cs = 4 without further bits) may belong to the transfer
+		if(m_bSegmented && (iCmd != 0x80))
+		{
+			m_LastActivity.SetNow();
+			m_Mutex.unlock();
+			return false;
+		}
+		if(!m_bSegmented && (iObjIndex == Active.iObjIndex) && (iObjSubIndex == Active.iObjSubIndex)
+			&& ((iCmd & 0xE1) == 0xC0))
+		{
+			// initiate block upload response, scs = 6 and ss = 0
+			m_bSegmented = true;
+			m_LastActivity.SetNow();
+			m_Mutex.unlock();
+			return false;
+		}
+	}
+
+	if(m_bSegmented)
+	{
+		// segments carry no object index, the owner collects them
+		if((iCmd >> 5) == 0)
+		{
+			m_LastActivity.SetNow();
+			m_Mutex.unlock();
+			return false;
+		}
+	}
+	else if((iObjIndex != Active.iObjIndex) || (iObjSubIndex != Active.iObjSubIndex))
+	{
+		m_Mutex.unlock();
+		return false;
+	}
+
+	Transfer Finished;
+
+	if((iCmd >> 5) == 4)
+	{
+		// abort transfer, cs = 4
+		m_iNumAborts++;
+		Finished = finishActive(SDO_ABORTED, 0, (unsigned int)iData);
+	}
+	else if(m_bSegmented)
+	{
+		m_Mutex.unlock();
+		return false;
+	}
+	else if(!Active.bUpload && (iCmd == 0x60))
+	{
+		// download response, scs = 3
+		Finished = finishActive(SDO_DONE, Active.iData, 0);
+	}
+	else if(Active.bUpload && ((iCmd & 0xE2) == 0x42))
+	{
+		// expedited upload response, scs = 2 and e = 1
+		if(iCmd & 0x01)
+		{
+			int iNumBytes = 4 - ((iCmd >> 2) & 0x03);
+			if(iNumBytes < 4)
+				iData &= (1 << (8 * iNumBytes)) - 1;
+		}
+		Finished = finishActive(SDO_DONE, iData, 0);
+	}
+	else if(Active.bUpload && ((iCmd & 0xE2) == 0x40))
+	{
+		// initiate segmented upload, scs = 2 and e = 0
+		m_bSegmented = true;
+		m_LastActivity.SetNow();
+		m_Mutex.unlock();
+		return false;
+	}
+	else
+	{
+		m_Mutex.unlock();
+		return false;
+	}
+
+	m_Mutex.unlock();
+
+	if(Finished.Done)
+		Finished.Done(Finished);
+
+	return true;
+}
+
+//-----------------------------------------------
+void SDOClient::finishSegmented(bool bOk, int iNumBytes)
+{
+	m_Mutex.lock();
+
+	if(!m_bActive || !m_bSegmented)
+	{
+		m_Mutex.unlock();
+		return;
+	}
+
+	Transfer Finished;
+
+	if(bOk)
+		Finished = finishActive(SDO_DONE, iNumBytes, 0);
+	else
+	{
+		m_iNumAborts++;
+		Finished = finishActive(SDO_ABORTED, iNumBytes, 0);
+	}
+
+	m_Mutex.unlock();
+
+	if(Finished.Done)
+		Finished.Done(Finished);
+}
+
+//-----------------------------------------------
+int SDOClient::process()
+{
+	TimeStamp Now;
+	Transfer Finished;
+	int iNumPending;
+
+	Now.SetNow();
+
+	m_Mutex.lock();
+
+	if(m_bActive && ((Now - m_LastActivity) > m_dTimeoutS))
+	{
+		const Transfer& Active = m_Queue.front();
+		std::cout << "SDO timeout on " << std::hex << m_iRxSDO << ", object "
+			<< Active.iObjIndex << "/" << Active.iObjSubIndex << std::dec << std::endl;
+
+		// the node may still be in the transfer (e.g. sending segments), abort it
+		// before the next transfer starts so its late messages are not mixed into that one
+		sendAbort(0x05040000);
+
+		m_iNumTimeouts++;
+		Finished = finishActive(SDO_TIMEOUT, 0, 0);
+	}
+	else
+		sendNext();
+
+	iNumPending = m_Queue.size();
+
+	m_Mutex.unlock();
+
+	if(Finished.Done)
+		Finished.Done(Finished);
+
+	return iNumPending;
+}
+
+//-----------------------------------------------
+void SDOClient::sendNext()
+{
+	if(m_bActive || m_Queue.empty() || (m_pCanItf == NULL))
+		return;
+
+	const Transfer& Next = m_Queue.front();
+	CanMsg CMsgTr;
+
+	CMsgTr.m_iLen = 8;
+	CMsgTr.m_iID = m_iRxSDO;
+
+	if(Next.bBlock)
+	{
+		// initiate block upload, ccs = 5, cc = 1 (CRC supported), cs = 0, no protocol switch
+		CMsgTr.set(0xA4, Next.iObjIndex, Next.iObjIndex >> 8, Next.iObjSubIndex,
+			Next.iBlockSize, 0x00, 0x00, 0x00);
+	}
+	else if(Next.bUpload)
+	{
+		// initiate upload, ccs = 2
+		CMsgTr.set(0x40, Next.iObjIndex, Next.iObjIndex >> 8, Next.iObjSubIndex,
+			0x00, 0x00, 0x00, 0x00);
+	}
+	else
+	{
+		// initiate expedited download of 4 bytes, ccs = 1, e = 1, s = 1
+		CMsgTr.set(0x23, Next.iObjIndex, Next.iObjIndex >> 8, Next.iObjSubIndex,
+			Next.iData, Next.iData >> 8, Next.iData >> 16, Next.iData >> 24);
+	}
+
+	m_bActive = true;
+	m_bSegmented = false;
+	m_LastActivity.SetNow();
+
+	m_pCanItf->transmitMsg(CMsgTr);
+}
+
+//-----------------------------------------------
+void SDOClient::sendAbort(unsigned int iAbortCode)
+{
+	if(!m_bActive || (m_pCanItf == NULL))
+		return;
+
+	const Transfer& Active = m_Queue.front();
+	CanMsg CMsgTr;
+
+	// abort transfer, cs = 4
+	CMsgTr.m_iLen = 8;
+	CMsgTr.m_iID = m_iRxSDO;
+	CMsgTr.set(0x80, Active.iObjIndex, Active.iObjIndex >> 8, Active.iObjSubIndex,
+		iAbortCode, iAbortCode >> 8, iAbortCode >> 16, iAbortCode >> 24);
+
+	m_pCanItf->transmitMsg(CMsgTr);
+}
+
+//-----------------------------------------------
+SDOClient::Transfer SDOClient::finishActive(int iResult, int iData, unsigned int iAbortCode)
+{
+	Transfer Finished = m_Queue.front();
+
+	Finished.iResult = iResult;
+	Finished.iData = iData;
+	Finished.iAbortCode = iAbortCode;
+
+	m_Queue.pop_front();
+	m_bActive = false;
+	m_bSegmented = false;
+
+	sendNext();
+
+	return Finished;
+}
@@ -0,0 +1,179 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_canopen_motor
+ * Description: velocity estimation from sampled drive positions
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#include <cob_canopen_motor/VelEstimator.h>
+
+//-----------------------------------------------
+VelEstimator* VelEstimator::create(const std::string& sType, const ParamType& Param)
+{
+	if (sType == "Diff")
+		return new VelEstimatorDiff();
+	if (sType == "AlphaBeta")
+		return new VelEstimatorAlphaBeta(Param.dAlpha, Param.dBeta);
+	if (sType == "Kalman")
+		return new VelEstimatorKalman(Param.dAccNoise, Param.dPosNoise);
+
+	return NULL;
+}
+
+//-----------------------------------------------
+double VelEstimatorDiff::update(double dPos, double dTimeS)
+{
+	double dt = dTimeS - m_dTimeS;
+
+	if (!m_bInitialized)
+	{
+		m_bInitialized = true;
+	}
+	else if (dt > 0)
+	{
+		m_dVel = (dPos - m_dPos) / dt;
+	}
+	else
+	{
+		return m_dVel;
+	}
+
+	m_dPos = dPos;
+	m_dTimeS = dTimeS;
+
+	return m_dVel;
+}
+
+//-----------------------------------------------
+double VelEstimatorAlphaBeta::update(double dPos, double dTimeS)
+{
+	double dt = dTimeS - m_dTimeS;
+	double dResidual;
+
+	if (!m_bInitialized)
+	{
+		m_bInitialized = true;
+		m_dPos = dPos;
+		m_dVel = 0;
+		m_dTimeS = dTimeS;
+		return m_dVel;
+	}
+
+	if (dt <= 0)
+		return m_dVel;
+
+	// predict, correct with the residual
+	m_dPos += m_dVel * dt;
+	dResidual = dPos - m_dPos;
+	m_dPos += m_dAlpha * dResidual;
+	m_dVel += m_dBeta / dt * dResidual;
+	m_dTimeS = dTimeS;
+
+	return m_dVel;
+}
+
+//-----------------------------------------------
+VelEstimatorKalman::VelEstimatorKalman(double dAccNoise, double dPosNoise)
+{
+	m_dAccVar = dAccNoise * dAccNoise;
+	m_dPosVar = dPosNoise * dPosNoise;
+
+	m_dP11 = 0;
+	m_dP12 = 0;
+	m_dP22 = 0;
+}
+
+//-----------------------------------------------
+double VelEstimatorKalman::update(double dPos, double dTimeS)
+{
+	double dt = dTimeS - m_dTimeS;
+	double dt2, dt3;
+	double dResidual, dS, dK1, dK2;
+	double dP11, dP12, dP22;
+
+	if (!m_bInitialized)
+	{
+		// position known up to the measurement noise, velocity unknown
+		m_bInitialized = true;
+		m_dPos = dPos;
+		m_dVel = 0;
+		m_dTimeS = dTimeS;
+		m_dP11 = m_dPosVar;
+		m_dP12 = 0;
+		m_dP22 = 1e6 * m_dPosVar;
+		return m_dVel;
+	}
+
+	if (dt <= 0)
+		return m_dVel;
+
+	// predict: x = F x, P = F P F' + Q with F = [1 dt; 0 1], Q of white noise acceleration
+	dt2 = dt * dt;
+	dt3 = dt2 * dt;
+	m_dPos += m_dVel * dt;
+	dP11 = m_dP11 + 2 * dt * m_dP12 + dt2 * m_dP22 + m_dAccVar * dt3 * dt / 4;
+	dP12 = m_dP12 + dt * m_dP22 + m_dAccVar * dt3 / 2;
+	dP22 = m_dP22 + m_dAccVar * dt2;
+
+	// correct with the measured position
+	dS = dP11 + m_dPosVar;
+	dK1 = dP11 / dS;
+	dK2 = dP12 / dS;
+	dResidual = dPos - m_dPos;
+
+	m_dPos += dK1 * dResidual;
+	m_dVel += dK2 * dResidual;
+	m_dP11 = (1 - dK1) * dP11;
+	m_dP12 = (1 - dK1) * dP12;
+	m_dP22 = dP22 - dK2 * dP12;
+	m_dTimeS = dTimeS;
+
+	return m_dVel;
+}
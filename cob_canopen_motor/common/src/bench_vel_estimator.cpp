@@ -0,0 +1,318 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_canopen_motor
+ * Description: Benchmark of the velocity estimators on recorded CAN traces.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cob_generic_can/CanTrace.h>
+#include <cob_canopen_motor/VelEstimator.h>
+#include <cob_utilities/TimeStamp.h>
+
+//-----------------------------------------------
+static void printUsage()
+{
+	std::cout << "usage: cob_canopen_motor_bench_vel_estimator [options] <TraceFile> [<TraceFile> ...]" << std::endl
+		<< "  Runs the velocity estimators on the positions of PDO1 in CAN traces (recorded with [TypeCan] TraceFile)" << std::endl
+		<< "  and reports the cost of one SYNC cycle of all drives and the noise of the estimated velocity." << std::endl
+		<< "  The noise is the rms deviation of the estimate from its centered mean over +-<window> samples," << std::endl
+		<< "  the error the one from the centered difference of the positions (noise and delay)." << std::endl
+		<< "  The reduction of the noise is the one against the finite difference of successive samples." << std::endl
+		<< "  --pdo1 <COB-ID>        TxPDO1 of the first drive, the drives follow with consecutive IDs (default 0x181)" << std::endl
+		<< "  --drives <n>           number of drives of a SYNC cycle (default 8)" << std::endl
+		<< "  --incr-per-rad <f>     encoder increments per rad of the gear (default 1, i.e. increments)" << std::endl
+		<< "  --alpha <f> --beta <f> gains of AlphaBeta (default 0.5, 0.17)" << std::endl
+		<< "  --acc-noise <f>        acceleration noise of Kalman in rad/s^2 (default 1.0)" << std::endl
+		<< "  --pos-noise <f>        position noise of Kalman in rad (default one increment)" << std::endl
+		<< "  --window <n>           half width of the reference difference (default 5)" << std::endl
+		<< "  --repeat <n>           passes over the samples for the timing (default 100)" << std::endl;
+}
+
+//-----------------------------------------------
+// position samples of one drive
+struct DriveTrace
+{
+	std::vector<double> vdTimeS;
+	std::vector<double> vdPosRad;
+};
+
+//-----------------------------------------------
+static bool readTrace(const std::string& sFileName, int iPDO1, double dIncrPerRad, std::vector<DriveTrace>& vTrace)
+{
+	CanTraceReader Reader;
+	if (!Reader.open(sFileName))
+		return false;
+
+	for (uint64_t i = 0; i < Reader.getNumRecords(); i++)
+	{
+		const CanTraceRecord& Rec = Reader.getRecord(i);
+		int iDrive = (int)Rec.iID - iPDO1;
+
+		if ((Rec.iDir != CanTraceRecord::RX) || (Rec.iLen < 4) || (iDrive < 0) || (iDrive >= (int)vTrace.size()))
+			continue;
+
+		int iPosIncr = (Rec.bDat[3] << 24) | (Rec.bDat[2] << 16) | (Rec.bDat[1] << 8) | Rec.bDat[0];
+		vTrace[iDrive].vdTimeS.push_back(Rec.iTimeStampNSec * 1e-9);
+		vTrace[iDrive].vdPosRad.push_back(iPosIncr / dIncrPerRad);
+	}
+
+	return true;
+}
+
+//-----------------------------------------------
+// accuracy of an estimator on the samples of one drive
+struct NoiseResult
+{
+	/// rms deviation of the estimate from its own centered mean over +-window samples,
+	/// i.e. the part of the estimate faster than the window (noise)
+	double dNoise;
+	/// rms deviation of the estimate from the centered difference of the positions over +-window samples,
+	/// i.e. noise and delay
+	double dError;
+};
+
+//-----------------------------------------------
+static NoiseResult calcNoise(const std::string& sType, const VelEstimator::ParamType& Param, const DriveTrace& Trace, int iWindow)
+{
+	const int c_iSettleSamples = 50;
+	const int iNumSamples = Trace.vdTimeS.size();
+	VelEstimator* pEstimator = VelEstimator::create(sType, Param);
+	std::vector<double> vdVel(iNumSamples);
+	NoiseResult Result;
+	double dSumSqNoise = 0;
+	double dSumSqError = 0;
+	int iNum = 0;
+
+	for (int k = 0; k < iNumSamples; k++)
+		vdVel[k] = pEstimator->update(Trace.vdPosRad[k], Trace.vdTimeS[k]);
+	delete pEstimator;
+
+	for (int k = std::max(c_iSettleSamples, iWindow); k + iWindow < iNumSamples; k++)
+	{
+		double dt = Trace.vdTimeS[k + iWindow] - Trace.vdTimeS[k - iWindow];
+		if (dt <= 0)
+			continue;
+
+		double dVelMean = 0;
+		for (int j = k - iWindow; j <= k + iWindow; j++)
+			dVelMean += vdVel[j];
+		dVelMean /= 2 * iWindow + 1;
+
+		double dVelRef = (Trace.vdPosRad[k + iWindow] - Trace.vdPosRad[k - iWindow]) / dt;
+		dSumSqNoise += (vdVel[k] - dVelMean) * (vdVel[k] - dVelMean);
+		dSumSqError += (vdVel[k] - dVelRef) * (vdVel[k] - dVelRef);
+		iNum++;
+	}
+
+	Result.dNoise = (iNum > 0) ? sqrt(dSumSqNoise / iNum) : 0;
+	Result.dError = (iNum > 0) ? sqrt(dSumSqError / iNum) : 0;
+	return Result;
+}
+
+//-----------------------------------------------
+// time of one SYNC cycle (one sample of every drive) in seconds
+static double calcCycleTime(const std::string& sType, const VelEstimator::ParamType& Param,
+	const std::vector<DriveTrace>& vTrace, int iNumCycles, int iRepeat)
+{
+	std::vector<VelEstimator*> vpEstimator(vTrace.size());
+	TimeStamp Start, End;
+	double dSum = 0;
+
+	for (unsigned int i = 0; i < vpEstimator.size(); i++)
+		vpEstimator[i] = VelEstimator::create(sType, Param);
+
+	Start.SetNow();
+	for (int r = 0; r < iRepeat; r++)
+	{
+		// the passes continue in time, so the estimators don't drop the samples as old
+		double dOffsetS = r * (vTrace[0].vdTimeS[iNumCycles - 1] - vTrace[0].vdTimeS[0] + 1.0);
+
+		for (int k = 0; k < iNumCycles; k++)
+		{
+			for (unsigned int i = 0; i < vTrace.size(); i++)
+				dSum += vpEstimator[i]->update(vTrace[i].vdPosRad[k], vTrace[i].vdTimeS[k] + dOffsetS);
+		}
+	}
+	End.SetNow();
+
+	for (unsigned int i = 0; i < vpEstimator.size(); i++)
+		delete vpEstimator[i];
+
+	// keeps the loop from being optimized away
+	if (dSum == 1.2345)
+		std::cout << std::endl;
+
+	return (End - Start) / ((double)iNumCycles * iRepeat);
+}
+
+//-----------------------------------------------
+int main(int argc, char** argv)
+{
+	const char* c_sTypes[] = { "Diff", "AlphaBeta", "Kalman" };
+	const int c_iNumTypes = sizeof(c_sTypes) / sizeof(c_sTypes[0]);
+
+	std::vector<std::string> vsFiles;
+	int iPDO1 = 0x181;
+	int iNumDrives = 8;
+	int iWindow = 5;
+	int iRepeat = 100;
+	double dIncrPerRad = 1.0;
+	VelEstimator::ParamType Param;
+
+	Param.dAlpha = 0.5;
+	Param.dBeta = 0.17;
+	Param.dAccNoise = 1.0;
+	Param.dPosNoise = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		bool bValue = (i + 1 < argc);
+
+		if (bValue && (strcmp(argv[i], "--pdo1") == 0))
+			iPDO1 = strtol(argv[++i], NULL, 0);
+		else if (bValue && (strcmp(argv[i], "--drives") == 0))
+			iNumDrives = atoi(argv[++i]);
+		else if (bValue && (strcmp(argv[i], "--incr-per-rad") == 0))
+			dIncrPerRad = atof(argv[++i]);
+		else if (bValue && (strcmp(argv[i], "--alpha") == 0))
+			Param.dAlpha = atof(argv[++i]);
+		else if (bValue && (strcmp(argv[i], "--beta") == 0))
+			Param.dBeta = atof(argv[++i]);
+		else if (bValue && (strcmp(argv[i], "--acc-noise") == 0))
+			Param.dAccNoise = atof(argv[++i]);
+		else if (bValue && (strcmp(argv[i], "--pos-noise") == 0))
+			Param.dPosNoise = atof(argv[++i]);
+		else if (bValue && (strcmp(argv[i], "--window") == 0))
+			iWindow = atoi(argv[++i]);
+		else if (bValue && (strcmp(argv[i], "--repeat") == 0))
+			iRepeat = atoi(argv[++i]);
+		else if (argv[i][0] == '-')
+		{
+			printUsage();
+			return 1;
+		}
+		else
+			vsFiles.push_back(argv[i]);
+	}
+	if (vsFiles.empty() || (iNumDrives < 1) || (iWindow < 1) || (iRepeat < 1) || (dIncrPerRad == 0))
+	{
+		printUsage();
+		return 1;
+	}
+	if (Param.dPosNoise <= 0)
+		Param.dPosNoise = fabs(1.0 / dIncrPerRad);
+
+	for (unsigned int f = 0; f < vsFiles.size(); f++)
+	{
+		std::vector<DriveTrace> vTrace(iNumDrives);
+		std::vector<DriveTrace> vPresent;
+
+		if (!readTrace(vsFiles[f], iPDO1, dIncrPerRad, vTrace))
+			return 1;
+
+		printf("# %s\n", vsFiles[f].c_str());
+		for (int i = 0; i < iNumDrives; i++)
+		{
+			if (vTrace[i].vdTimeS.size() > (unsigned int)(2 * iWindow))
+				vPresent.push_back(vTrace[i]);
+			else
+				printf("# drive %d (PDO1 0x%x): %u samples, skipped\n", i, iPDO1 + i, (unsigned int)vTrace[i].vdTimeS.size());
+		}
+		if (vPresent.empty())
+		{
+			std::cout << "no PDO1 found in " << vsFiles[f] << std::endl;
+			continue;
+		}
+
+		// noise of each drive
+		printf("# noise and error in rad/s (increments/s without --incr-per-rad), reduction of the noise against Diff\n");
+		printf("%-6s", "drive");
+		for (int t = 0; t < c_iNumTypes; t++)
+			printf(" %10s %10s %9s", c_sTypes[t], "error", "reduction");
+		printf("\n");
+		for (unsigned int i = 0; i < vPresent.size(); i++)
+		{
+			NoiseResult Diff = calcNoise("Diff", Param, vPresent[i], iWindow);
+
+			printf("%-6u", i);
+			for (int t = 0; t < c_iNumTypes; t++)
+			{
+				NoiseResult Result = calcNoise(c_sTypes[t], Param, vPresent[i], iWindow);
+				printf(" %10.3e %10.3e %9.2f", Result.dNoise, Result.dError, (Result.dNoise > 0) ? Diff.dNoise / Result.dNoise : 0.0);
+			}
+			printf("\n");
+		}
+
+		// the cycle always has iNumDrives drives, missing ones repeat the present ones
+		std::vector<DriveTrace> vCycle(iNumDrives);
+		int iNumCycles = vPresent[0].vdTimeS.size();
+		for (int i = 0; i < iNumDrives; i++)
+		{
+			vCycle[i] = vPresent[i % vPresent.size()];
+			if ((int)vCycle[i].vdTimeS.size() < iNumCycles)
+				iNumCycles = vCycle[i].vdTimeS.size();
+		}
+
+		printf("# cost of one SYNC cycle of %d drives, %d cycles x %d passes\n", iNumDrives, iNumCycles, iRepeat);
+		for (int t = 0; t < c_iNumTypes; t++)
+			printf("%-10s %8.1f ns/cycle\n", c_sTypes[t], 1e9 * calcCycleTime(c_sTypes[t], Param, vCycle, iNumCycles, iRepeat));
+	}
+
+	return 0;
+}
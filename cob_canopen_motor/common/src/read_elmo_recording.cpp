@@ -0,0 +1,140 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_canopen_motor
+ * Description: Prints Elmo Recorder files as text.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <cob_canopen_motor/ElmoRecorderFile.h>
+
+//-----------------------------------------------
+static void printUsage()
+{
+	std::cout << "usage: cob_canopen_motor_read_recording [--info] <RecFile> [<RecFile> ...]" << std::endl
+		<< "  Prints Elmo Recorder files (written by the ElmoRecorderReadout service) as text:" << std::endl
+		<< "  a line per sample with the time and the value of each file." << std::endl
+		<< "  With --info only the headers are printed." << std::endl;
+}
+
+//-----------------------------------------------
+int main(int argc, char** argv)
+{
+	std::vector<std::string> vsFiles;
+	bool bInfoOnly = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--info") == 0)
+			bInfoOnly = true;
+		else if (argv[i][0] == '-')
+		{
+			printUsage();
+			return 1;
+		}
+		else
+			vsFiles.push_back(argv[i]);
+	}
+	if (vsFiles.empty())
+	{
+		printUsage();
+		return 1;
+	}
+
+	std::vector<ElmoRecorderFileReader> vReader(vsFiles.size());
+	unsigned int iNumSamples = 0;
+	float fSamplePeriodS = 0;
+
+	for (unsigned int i = 0; i < vsFiles.size(); i++)
+	{
+		if (!vReader[i].open(vsFiles[i]))
+			return 1;
+
+		const ElmoRecorderFileHeader& Header = vReader[i].getHeader();
+		printf("# %s: drive %d, source %d, sample period %g s, %u samples, %u columns\n", vsFiles[i].c_str(),
+			Header.iDriveID, Header.iSource, Header.fSamplePeriodS, Header.iNumSamples, Header.iNumColumns);
+
+		// the files are joined by the sample index
+		if (i == 0)
+		{
+			iNumSamples = Header.iNumSamples;
+			fSamplePeriodS = Header.fSamplePeriodS;
+		}
+		else
+		{
+			if (Header.fSamplePeriodS != fSamplePeriodS)
+				std::cout << "# warning: sample period of " << vsFiles[i] << " differs, the time is taken from " << vsFiles[0] << std::endl;
+			if (Header.iNumSamples < iNumSamples)
+				iNumSamples = Header.iNumSamples;
+		}
+	}
+
+	if (bInfoOnly)
+		return 0;
+
+	for (unsigned int iSample = 0; iSample < iNumSamples; iSample++)
+	{
+		printf("%e", iSample * fSamplePeriodS);
+		for (unsigned int i = 0; i < vReader.size(); i++)
+		{
+			for (unsigned int iColumn = 0; iColumn < vReader[i].getHeader().iNumColumns; iColumn++)
+				printf(" %e", vReader[i].getColumn(iColumn)[iSample]);
+		}
+		printf("\n");
+	}
+
+	return 0;
+}
@@ -0,0 +1,142 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_generic_can
+ * Description: In-process CAN bus simulation with pluggable node simulators.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+
+#ifndef CANDUMMY_INCLUDEDEF_H
+#define CANDUMMY_INCLUDEDEF_H
+//-----------------------------------------------
+#include <deque>
+#include <vector>
+
+#include <cob_generic_can/CanItf.h>
+#include <cob_utilities/Mutex.h>
+#include <cob_utilities/TimeStamp.h>
+//-----------------------------------------------
+
+/**
+ * Simulated participant of a CanDummy bus.
+ * \ingroup DriversCanModul
+ */
+class CanDummyNode
+{
+public:
+	virtual ~CanDummyNode() {
+	}
+
+	/**
+	 * Evaluates a message sent on the bus (by the user or by another node)
+	 * and appends the answers of the node to vReplies.
+	 */
+	virtual void evalMsg(const CanMsg& CMsg, std::vector<CanMsg>& vReplies) = 0;
+};
+
+/**
+ * CAN interface without hardware (CANITFTYPE_CAN_DUMMY).
+ * Every transmitted message is offered to the attached simulated nodes,
+ * their answers are delivered to the receiving side after a configurable latency and jitter.
+ * The order of the messages on the bus is preserved.
+ * \ingroup DriversCanModul
+ */
+class CanDummy : public CanItf
+{
+public:
+	/**
+	 * Constructor.
+	 * @param iLatencyUs minimum time between transmitting a message and receiving the answers
+	 * @param iJitterUs random additional delay (0..iJitterUs) of each answer
+	 */
+	CanDummy(int iLatencyUs = 0, int iJitterUs = 0);
+	~CanDummy();
+
+	bool init_ret() { return true; }
+	void init() { }
+
+	/**
+	 * Attaches a simulated node to the bus. The object takes ownership of it.
+	 */
+	void addNode(CanDummyNode* pNode);
+
+	/**
+	 * Changes latency and jitter of the answers.
+	 */
+	void setLatency(int iLatencyUs, int iJitterUs);
+
+	bool transmitMsg(const CanMsg& CMsg, bool bBlocking = true);
+	bool receiveMsg(CanMsg* pCMsg);
+	bool receiveMsgRetry(CanMsg* pCMsg, int iNrOfRetry);
+	bool receiveMsgTimeout(CanMsg* pCMsg, int nMicroSecTimeout);
+	int receiveMsgs(CanMsg* pCMsgs, size_t iMaxMsgs, int nMicroSecTimeout = 0);
+	bool isObjectMode() { return false; }
+
+private:
+	struct PendingMsg
+	{
+		TimeStamp Due;
+		CanMsg Msg;
+	};
+
+	// pop the due messages, caller holds m_Mutex
+	int popDueMsgs(CanMsg* pCMsgs, size_t iMaxMsgs);
+
+	std::vector<CanDummyNode*> m_vpNodes;
+	std::deque<PendingMsg> m_Pending;
+	std::vector<CanMsg> m_vReplies;
+	Mutex m_Mutex;
+
+	int m_iLatencyUs;
+	int m_iJitterUs;
+	unsigned int m_iRandSeed;
+};
+//-----------------------------------------------
+#endif
@@ -95,10 +95,13 @@ public:
     ~CanESD();
     bool init_ret();
     void init(){};
-    bool transmitMsg(CanMsg CMsg, bool bBlocking = true);
+    bool transmitMsg(const CanMsg& CMsg, bool bBlocking = true);
+    int transmitMsgs(const CanMsg* pCMsgs, size_t iNumMsgs, bool bBlocking = true);
     bool receiveMsgRetry(CanMsg* pCMsg, int iNrOfRetry);
     bool receiveMsg(CanMsg* pCMsg);
     bool receiveMsgTimeout(CanMsg* pCMsg, int nMicroSeconds);
+    int receiveMsgs(CanMsg* pCMsgs, size_t iMaxMsgs, int nMicroSecTimeout = 0);
+    bool setFilter(const std::vector<int>& viCanIDs);
     bool isObjectMode() { return m_bObjectMode; }
     bool isTransmitError() { return m_bIsTXError; }
 
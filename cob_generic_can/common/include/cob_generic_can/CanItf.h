@@ -55,6 +55,8 @@
 #ifndef CANITF_INCLUDEDEF_H
 #define CANITF_INCLUDEDEF_H
 //-----------------------------------------------
+#include <cstddef>
+#include <vector>
 #include <cob_generic_can/CanMsg.h>
 //-----------------------------------------------
 
@@ -65,6 +67,7 @@
 #define CANITFTYPE_CAN_DUMMY	3
 #define CANITFTYPE_CAN_BECKHOFF	4
 #define CANITFTYPE_SOCKET_CAN 5
+#define CANITFTYPE_CAN_REPLAY	6
 
 #define CANITFBAUD_1M 	0x0
 #define CANITFBAUD_500K	0x2
@@ -87,9 +90,13 @@ public:
 		CAN_ESD = 2,
 		CAN_DUMMY = 3,
 		CAN_BECKHOFF = 4,
-		CAN_SOCKETCAN = 5
+		CAN_SOCKETCAN = 5,
+		CAN_REPLAY = 6
 	};
 
+	CanItf() : m_bBatching(false) {
+	}
+
 	/**
 	 * The destructor does not necessarily have to be overwritten.
 	 * But it makes sense to close any resources like handles.
@@ -109,10 +116,93 @@ public:
 
 	/**
 	 * Sends a CAN message.
-	 * @param pCMsg CAN message
+	 * The message is passed by reference, interfaces copy it directly into the driver buffer.
+	 * @param CMsg CAN message
+	 * @param bBlocking specifies whether send should be blocking or non-blocking
+	 */
+	virtual bool transmitMsg(const CanMsg& CMsg, bool bBlocking = true) = 0;
+
+	/**
+	 * Sends several CAN messages in one call.
+	 * The default implementation calls transmitMsg() for each message,
+	 * interfaces with a native burst write (e.g. sendmmsg) should overwrite it.
+	 * @param pCMsgs CAN messages
+	 * @param iNumMsgs number of messages in pCMsgs
 	 * @param bBlocking specifies whether send should be blocking or non-blocking
+	 * @return number of messages sent
+	 */
+	virtual int transmitMsgs(const CanMsg* pCMsgs, size_t iNumMsgs, bool bBlocking = true)
+	{
+		size_t iNumSent = 0;
+
+		while((iNumSent < iNumMsgs) && transmitMsg(pCMsgs[iNumSent], bBlocking))
+			iNumSent++;
+
+		return (int)iNumSent;
+	}
+
+	/**
+	 * Starts a transmit batch: all messages passed to transmitMsg() are collected
+	 * (and transmitMsg() returns true) until flush() sends them in one burst.
+	 * Meant for the commands of one control cycle sent by a single thread.
+	 */
+	void beginBatch()
+	{
+		m_vBatch.clear();
+		m_bBatching = true;
+	}
+
+	/**
+	 * Ends the transmit batch and sends the collected messages with transmitMsgs().
+	 * All SYNC messages of the batch are merged into one which is sent last,
+	 * so all drives got their commands before they answer the SYNC.
+	 * @param pbSyncSent optional, set to true if the batch contained a SYNC and it was sent
+	 * @return number of messages sent
+	 */
+	int flush(bool* pbSyncSent = NULL)
+	{
+		const int c_iSyncID = 0x80;
+		size_t iNumMsgs = 0;
+		int iNumSent;
+		bool bSync = false;
+		CanMsg SyncMsg;
+
+		if(pbSyncSent != NULL)
+			*pbSyncSent = false;
+
+		if(!m_bBatching)
+			return 0;
+		m_bBatching = false;
+
+		// move the SYNC to the end, keep the order of the other messages
+		for(size_t i = 0; i < m_vBatch.size(); i++)
+		{
+			if(m_vBatch[i].m_iID == c_iSyncID)
+			{
+				SyncMsg = m_vBatch[i];
+				bSync = true;
+			}
+			else
+				m_vBatch[iNumMsgs++] = m_vBatch[i];
+		}
+		if(bSync)
+			m_vBatch[iNumMsgs++] = SyncMsg;
+
+		if(iNumMsgs == 0)
+			return 0;
+
+		iNumSent = transmitMsgs(&m_vBatch[0], iNumMsgs);
+		// the SYNC is the last message
+		if(pbSyncSent != NULL)
+			*pbSyncSent = bSync && (iNumSent == (int)iNumMsgs);
+
+		return iNumSent;
+	}
+
+	/**
+	 * Check if a transmit batch is active.
 	 */
-	virtual bool transmitMsg(CanMsg CMsg, bool bBlocking = true) = 0;
+	bool isBatching() { return m_bBatching; }
 
 	/**
 	 * Reads a CAN message.
@@ -137,6 +227,66 @@ public:
 	 */
 	virtual bool receiveMsgTimeout(CanMsg* pCMsg, int nMicroSecTimeout) = 0;
 
+	/**
+	 * Reads all pending CAN messages (up to iMaxMsgs) in one call.
+	 * Waits at most nMicroSecTimeout for the first message and then drains
+	 * the messages already queued without blocking again.
+	 * The default implementation falls back to receiveMsgTimeout() / receiveMsg(),
+	 * interfaces with a native bulk read should overwrite it.
+	 * @param pCMsgs buffer for at least iMaxMsgs CAN messages
+	 * @param iMaxMsgs capacity of pCMsgs
+	 * @param nMicroSecTimeout timeout in us for the first message, 0 to poll only
+	 * @return number of messages written to pCMsgs
+	 */
+	virtual int receiveMsgs(CanMsg* pCMsgs, size_t iMaxMsgs, int nMicroSecTimeout = 0)
+	{
+		size_t iNumMsgs = 0;
+
+		if(iMaxMsgs == 0)
+			return 0;
+
+		if(nMicroSecTimeout > 0)
+		{
+			if(!receiveMsgTimeout(&pCMsgs[0], nMicroSecTimeout))
+				return 0;
+			iNumMsgs = 1;
+		}
+
+		while((iNumMsgs < iMaxMsgs) && receiveMsg(&pCMsgs[iNumMsgs]))
+			iNumMsgs++;
+
+		return (int)iNumMsgs;
+	}
+
+	/**
+	 * Restricts the received messages to the given identifiers.
+	 * Interfaces supporting it install the filter in the driver or kernel,
+	 * so messages of other nodes on the bus don't wake up the process.
+	 * @param viCanIDs identifiers to receive, empty to receive all messages
+	 * @return true if the filter is active, false if the interface receives all messages
+	 */
+	virtual bool setFilter(const std::vector<int>& viCanIDs)
+	{
+		return false;
+	}
+
+	/**
+	 * Number of messages that failed to be sent asynchronously,
+	 * i.e. after transmitMsg() already returned true. 0 if not supported.
+	 */
+	virtual unsigned long getNumTxErrors()
+	{
+		return 0;
+	}
+
+	/**
+	 * Number of received messages dropped because a buffer was full. 0 if not supported.
+	 */
+	virtual unsigned long getNumRxOverruns()
+	{
+		return 0;
+	}
+
 	/**
 	 * Check if the current CAN interface was opened on OBJECT mode.
 	 * @return true if opened in OBJECT mode, false if not.
@@ -157,9 +307,28 @@ public:
 	 */
 	CanItfType getCanItfType() { return m_iCanItfType; }
 
+protected:
+	/**
+	 * To be called by transmitMsg() of the interfaces first:
+	 * queues the message if a transmit batch is active.
+	 * @return true if the message was queued
+	 */
+	bool addToBatch(const CanMsg& CMsg)
+	{
+		if(!m_bBatching)
+			return false;
+
+		m_vBatch.push_back(CMsg);
+		return true;
+	}
+
 private:
 	/// The CAN interface type.
 	CanItfType m_iCanItfType;
+
+	/// Messages of the active transmit batch.
+	std::vector<CanMsg> m_vBatch;
+	bool m_bBatching;
 };
 //-----------------------------------------------
 
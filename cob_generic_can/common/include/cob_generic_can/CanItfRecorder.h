@@ -0,0 +1,113 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_generic_can
+ * Description: Records the frames of a CAN interface to a trace file.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#ifndef CANITFRECORDER_INCLUDEDEF_H
+#define CANITFRECORDER_INCLUDEDEF_H
+//-----------------------------------------------
+#include <string>
+
+#include <cob_generic_can/CanItf.h>
+#include <cob_generic_can/CanTrace.h>
+#include <cob_utilities/Mutex.h>
+//-----------------------------------------------
+
+/**
+ * Records all frames sent and received through an arbitrary CAN interface to a CanTrace file.
+ * Received frames keep the time stamp of the driver, sent frames are stamped when passed to the driver.
+ * The object wraps the interface doing the actual I/O and forwards all calls to it.
+ * \ingroup DriversCanModul
+ */
+class CanItfRecorder : public CanItf
+{
+public:
+	/**
+	 * Constructor.
+	 * @param pCanItf CAN interface doing the actual I/O. The object takes ownership of it.
+	 */
+	CanItfRecorder(CanItf* pCanItf);
+	~CanItfRecorder();
+
+	/**
+	 * Starts recording to a new trace file.
+	 */
+	bool open(const std::string& sFileName);
+
+	/**
+	 * Stops recording and closes the trace file.
+	 */
+	void close();
+
+	// --------------- CanItf, forwarded to the wrapped interface
+	bool init_ret() { return m_pCanItf->init_ret(); }
+	void init() { m_pCanItf->init(); }
+	bool transmitMsg(const CanMsg& CMsg, bool bBlocking = true);
+	int transmitMsgs(const CanMsg* pCMsgs, size_t iNumMsgs, bool bBlocking = true);
+	bool receiveMsg(CanMsg* pCMsg);
+	bool receiveMsgRetry(CanMsg* pCMsg, int iNrOfRetry);
+	bool receiveMsgTimeout(CanMsg* pCMsg, int nMicroSecTimeout);
+	int receiveMsgs(CanMsg* pCMsgs, size_t iMaxMsgs, int nMicroSecTimeout = 0);
+	bool setFilter(const std::vector<int>& viCanIDs) { return m_pCanItf->setFilter(viCanIDs); }
+	bool isObjectMode() { return m_pCanItf->isObjectMode(); }
+	unsigned long getNumTxErrors() { return m_pCanItf->getNumTxErrors(); }
+	unsigned long getNumRxOverruns() { return m_pCanItf->getNumRxOverruns(); }
+
+private:
+	void record(const CanMsg* pCMsgs, int iNumMsgs, int iDir);
+
+	CanItf* m_pCanItf;
+	CanTraceWriter m_Writer;
+	Mutex m_Mutex;
+};
+//-----------------------------------------------
+#endif
@@ -0,0 +1,139 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_generic_can
+ * Description: CAN interface replaying a recorded trace.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#ifndef CANITFREPLAY_INCLUDEDEF_H
+#define CANITFREPLAY_INCLUDEDEF_H
+//-----------------------------------------------
+#include <string>
+
+#include <cob_generic_can/CanItf.h>
+#include <cob_generic_can/CanTrace.h>
+#include <cob_utilities/Mutex.h>
+#include <cob_utilities/TimeStamp.h>
+//-----------------------------------------------
+
+/**
+ * CAN interface without hardware (CANITFTYPE_CAN_REPLAY) delivering the received frames of a
+ * CanTrace recorded with CanItfRecorder. Transmitted messages are discarded.
+ *
+ * In real-time mode a frame is delivered when the time since the first receive call
+ * reaches its time in the trace.
+ * Otherwise the trace is replayed as fast as it is read, one SYNC cycle at a time:
+ * a receive call stops at the next recorded SYNC, so every evalCanBuffer()
+ * of CanCtrlPltfCOb3 evaluates exactly the frames of one recorded cycle.
+ * Both modes are deterministic for a given trace.
+ * \ingroup DriversCanModul
+ */
+class CanItfReplay : public CanItf
+{
+public:
+	CanItfReplay();
+
+	/**
+	 * Opens the trace file.
+	 * @param bRealTime replay in wall-clock time (true) or as fast as possible (false)
+	 */
+	bool open(const std::string& sFileName, bool bRealTime);
+
+	/**
+	 * Check if all frames of the trace were delivered.
+	 */
+	bool isFinished();
+
+	/**
+	 * Number of frames delivered so far.
+	 */
+	unsigned long getNumFramesReplayed();
+
+	/**
+	 * Duration of the trace in seconds.
+	 */
+	double getDurationS();
+
+	/**
+	 * Time of the last delivered frame relative to the start of the trace in seconds.
+	 */
+	double getReplayTimeS();
+
+	bool init_ret() { return true; }
+	void init() { }
+	bool transmitMsg(const CanMsg& CMsg, bool bBlocking = true);
+	bool receiveMsg(CanMsg* pCMsg);
+	bool receiveMsgRetry(CanMsg* pCMsg, int iNrOfRetry);
+	bool receiveMsgTimeout(CanMsg* pCMsg, int nMicroSecTimeout);
+	int receiveMsgs(CanMsg* pCMsgs, size_t iMaxMsgs, int nMicroSecTimeout = 0);
+	bool isObjectMode() { return false; }
+
+private:
+	// pop the due frames, caller holds m_Mutex
+	int popDueMsgs(CanMsg* pCMsgs, size_t iMaxMsgs);
+
+	CanTraceReader m_Reader;
+	Mutex m_Mutex;
+
+	bool m_bRealTime;
+	uint64_t m_iNextRecord;
+	unsigned long m_iNumFramesReplayed;
+	int64_t m_iLastRecordNSec;
+
+	// real-time mode: start of the replay and time of the first record
+	bool m_bStarted;
+	TimeStamp m_StartTime;
+	int64_t m_iFirstRecordNSec;
+
+	// max-speed mode: frames were delivered since the last SYNC
+	bool m_bCycleDelivered;
+};
+//-----------------------------------------------
+#endif
@@ -0,0 +1,200 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_generic_can
+ * Description: Bus load and latency statistics of a CAN interface.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+
+#ifndef CANITFSTATS_INCLUDEDEF_H
+#define CANITFSTATS_INCLUDEDEF_H
+//-----------------------------------------------
+#include <string>
+#include <vector>
+
+#include <cob_generic_can/CanItf.h>
+#include <cob_utilities/Mutex.h>
+#include <cob_utilities/TimeStamp.h>
+//-----------------------------------------------
+
+/**
+ * Measures the traffic of an arbitrary CAN interface: frames and bytes per second,
+ * estimated bus load, TX errors, RX overruns and histograms of the request -> response latency.
+ * The object wraps the interface doing the actual I/O and forwards all calls to it.
+ * \ingroup DriversCanModul
+ */
+class CanItfStats : public CanItf
+{
+public:
+	/// Number of bins of the latency histograms.
+	static const int c_iNumLatencyBins = 10;
+
+	/**
+	 * Latency of the responses of one channel (e.g. one drive).
+	 */
+	struct LatencyHistogram
+	{
+		std::string sName;
+		unsigned long iNumSamples;
+		double dMinS;
+		double dMaxS;
+		double dSumS;
+		/// viBins[i] counts the latencies up to getLatencyBinUpperS(i)
+		std::vector<unsigned long> viBins;
+	};
+
+	/**
+	 * Statistics since the previous call of getStats() (rates) resp. since construction (counters).
+	 */
+	struct Stats
+	{
+		double dPeriodS;
+		double dTxFramesPerS;
+		double dRxFramesPerS;
+		double dTxBytesPerS;
+		double dRxBytesPerS;
+		/// estimated from the frame lengths without bit stuffing (lower bound)
+		double dBusLoadPercent;
+		unsigned long iNumTxFrames;
+		unsigned long iNumRxFrames;
+		unsigned long iNumTxErrors;
+		unsigned long iNumRxOverruns;
+		std::vector<LatencyHistogram> vLatency;
+	};
+
+	/**
+	 * Constructor.
+	 * @param pCanItf CAN interface doing the actual I/O. The object takes ownership of it.
+	 * @param iBitRate bit rate of the bus in bit/s, see baudrateValToBitRate()
+	 */
+	CanItfStats(CanItf* pCanItf, int iBitRate);
+	~CanItfStats();
+
+	/**
+	 * Converts the baud rate codes used in CanCtrl.ini (CANITFBAUD_*) to bit/s.
+	 */
+	static int baudrateValToBitRate(int iBaudrateVal);
+
+	/**
+	 * Upper limit of a latency histogram bin, the last bin is unbounded.
+	 */
+	static double getLatencyBinUpperS(int iBin);
+
+	/**
+	 * Adds a latency histogram.
+	 * @return index of the channel in Stats::vLatency
+	 */
+	int addLatencyChannel(const std::string& sName);
+
+	/**
+	 * Measures the time from sending a message with iRequestID to receiving the next message
+	 * with iResponseID and counts it in the histogram of iChannel.
+	 * A request can have several responses (e.g. SYNC -> PDO1 of all drives).
+	 */
+	void addRequestResponse(int iChannel, int iRequestID, int iResponseID);
+
+	/**
+	 * Returns the statistics and starts a new period for the rates.
+	 */
+	void getStats(Stats& stats);
+
+	// --------------- CanItf, forwarded to the wrapped interface
+	bool init_ret() { return m_pCanItf->init_ret(); }
+	void init() { m_pCanItf->init(); }
+	bool transmitMsg(const CanMsg& CMsg, bool bBlocking = true);
+	int transmitMsgs(const CanMsg* pCMsgs, size_t iNumMsgs, bool bBlocking = true);
+	bool receiveMsg(CanMsg* pCMsg);
+	bool receiveMsgRetry(CanMsg* pCMsg, int iNrOfRetry);
+	bool receiveMsgTimeout(CanMsg* pCMsg, int nMicroSecTimeout);
+	int receiveMsgs(CanMsg* pCMsgs, size_t iMaxMsgs, int nMicroSecTimeout = 0);
+	bool setFilter(const std::vector<int>& viCanIDs) { return m_pCanItf->setFilter(viCanIDs); }
+	bool isObjectMode() { return m_pCanItf->isObjectMode(); }
+
+	/**
+	 * Messages rejected by the wrapped interface plus its own asynchronous TX errors.
+	 */
+	unsigned long getNumTxErrors();
+	unsigned long getNumRxOverruns() { return m_pCanItf->getNumRxOverruns(); }
+
+private:
+	static const int c_iNumCanIDs = 0x800;
+
+	void countTx(const CanMsg* pCMsgs, int iNumMsgs, int iNumFailed);
+	void countRx(const CanMsg* pCMsgs, int iNumMsgs);
+
+	CanItf* m_pCanItf;
+	int m_iBitRate;
+	Mutex m_Mutex;
+
+	// counters since construction
+	unsigned long m_iNumTxFrames;
+	unsigned long m_iNumRxFrames;
+	unsigned long m_iNumTxBytes;
+	unsigned long m_iNumRxBytes;
+	unsigned long m_iNumBusBits;
+	unsigned long m_iNumTxFailed;
+
+	// counters at the previous getStats()
+	TimeStamp m_LastStats;
+	unsigned long m_iLastTxFrames;
+	unsigned long m_iLastRxFrames;
+	unsigned long m_iLastTxBytes;
+	unsigned long m_iLastRxBytes;
+	unsigned long m_iLastBusBits;
+
+	// latency measurement, indexed by CAN identifier
+	std::vector<LatencyHistogram> m_vLatency;
+	std::vector<std::vector<int> > m_vviResponseIDs;
+	std::vector<int> m_viResponseChannel;
+	std::vector<TimeStamp> m_vRequestTime;
+	std::vector<bool> m_vbRequestPending;
+};
+//-----------------------------------------------
+#endif
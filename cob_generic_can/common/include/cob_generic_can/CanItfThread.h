@@ -0,0 +1,161 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_generic_can
+ * Description: CAN interface decorator running the bus I/O in its own thread
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#ifndef CANITFTHREAD_INCLUDEDEF_H
+#define CANITFTHREAD_INCLUDEDEF_H
+//-----------------------------------------------
+#include <pthread.h>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+
+#include <cob_generic_can/CanItf.h>
+#include <cob_utilities/Mutex.h>
+//-----------------------------------------------
+
+/**
+ * Runs the I/O of an arbitrary CAN interface in a dedicated (optionally real-time) thread.
+ * The thread is connected to the user through two single-producer/single-consumer
+ * ring buffers, one for transmitted and one for received messages. So transmitMsg()
+ * and receiveMsg() only copy a message from / into a queue and never block on the driver.
+ * Multiple transmitting (resp. receiving) threads are serialized by a mutex on their
+ * side of the queue, the I/O thread itself never takes a lock.
+ * \ingroup DriversCanModul
+ */
+class CanItfThread : public CanItf
+{
+public:
+	/**
+	 * Constructor.
+	 * @param pCanItf CAN interface doing the actual I/O. The object takes ownership of it.
+	 * @param iPriority SCHED_FIFO priority of the I/O thread (1..99), 0 to use the default scheduler
+	 * @param iQueueSize capacity of the transmit and receive queue (messages)
+	 * @param iRxTimeoutUs time the I/O thread waits for new messages before it checks the transmit queue again
+	 */
+	CanItfThread(CanItf* pCanItf, int iPriority = 0, int iQueueSize = 1024, int iRxTimeoutUs = 500);
+	~CanItfThread();
+
+	/**
+	 * Initializes the underlying interface and starts the I/O thread.
+	 * If the underlying interface was already initialized (e.g. by its constructor)
+	 * use start() instead.
+	 */
+	bool init_ret();
+	void init();
+
+	/**
+	 * Starts the I/O thread.
+	 * @return true if the thread is running
+	 */
+	bool start();
+
+	/**
+	 * Stops the I/O thread. Messages still in the transmit queue are discarded.
+	 */
+	void stop();
+
+	/**
+	 * Queues a message for transmission.
+	 * @return false if the transmit queue is full
+	 */
+	bool transmitMsg(const CanMsg& CMsg, bool bBlocking = true);
+
+	/**
+	 * Queues several messages at once, the I/O thread sends them in one burst.
+	 * @return number of messages queued
+	 */
+	int transmitMsgs(const CanMsg* pCMsgs, size_t iNumMsgs, bool bBlocking = true);
+	bool receiveMsg(CanMsg* pCMsg);
+	bool receiveMsgRetry(CanMsg* pCMsg, int iNrOfRetry);
+	bool receiveMsgTimeout(CanMsg* pCMsg, int nMicroSecTimeout);
+	int receiveMsgs(CanMsg* pCMsgs, size_t iMaxMsgs, int nMicroSecTimeout = 0);
+	bool setFilter(const std::vector<int>& viCanIDs) { return m_pCanItf->setFilter(viCanIDs); }
+	bool isObjectMode() { return m_pCanItf->isObjectMode(); }
+
+	/**
+	 * Number of messages dropped because the receive queue was full.
+	 */
+	unsigned long getNumRxOverruns() { return m_iNumRxOverruns; }
+
+	/**
+	 * Number of queued messages the underlying interface failed to send.
+	 * (A full transmit queue is reported by the return value of transmitMsg().)
+	 */
+	unsigned long getNumTxErrors() { return m_iNumTxErrors; }
+
+private:
+	static void* threadFunc(void* pArg);
+	void run();
+
+	CanItf* m_pCanItf;
+	int m_iPriority;
+	int m_iRxTimeoutUs;
+
+	pthread_t m_hThread;
+	boost::atomic<bool> m_bRunning;
+
+	boost::lockfree::spsc_queue<CanMsg> m_TxQueue;
+	boost::lockfree::spsc_queue<CanMsg> m_RxQueue;
+	Mutex m_TxMutex;
+	Mutex m_RxMutex;
+
+	// buffers of the I/O thread for bulk reads and writes
+	std::vector<CanMsg> m_vRxBuf;
+	std::vector<CanMsg> m_vTxBuf;
+
+	boost::atomic<unsigned long> m_iNumRxOverruns;
+	boost::atomic<unsigned long> m_iNumTxErrors;
+};
+//-----------------------------------------------
+#endif
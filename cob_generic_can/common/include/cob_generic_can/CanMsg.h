@@ -56,10 +56,18 @@
 #define CANMSG_INCLUDEDEF_H
 //-----------------------------------------------
 #include <iostream>
+#include <cstddef>
+#include <cstring>
 //-----------------------------------------------
 
 /**
  * Represents a CAN message.
+ * The message is trivially copyable. Its first c_iFrameSize bytes have the layout of
+ * struct can_frame (linux/can.h): identifier, length, three padding bytes, data.
+ * m_iType is kept in the second padding byte (__res0), which the kernel ignores.
+ * So interfaces can copy it with memcpy() or hand it to the driver without conversion.
+ * The ESD CMSG has identifier, length and data at the same offsets, but msg_lost and
+ * reserved bytes in between, so CanESD sets these fields itself.
  * \ingroup DriversCanModul
  */
 class CanMsg
@@ -67,20 +75,34 @@ class CanMsg
 public:
 	/// Include typedefs from windows.h
 	typedef unsigned char BYTE;
+
+	/// Size of the part compatible to struct can_frame.
+	static const size_t c_iFrameSize = 16;
+
 	/// @todo This should be private.
 	int m_iID;
 	/// @todo This should be private.
-	int m_iLen;
+	BYTE m_iLen;
+	/// Padding of struct can_frame, always 0.
+	BYTE m_bPad0;
 	/// @todo This should be private.
-	int m_iType;
+	BYTE m_iType;
+	/// Padding of struct can_frame, always 0.
+	BYTE m_bPad1;
 
-protected:
 	/**
 	 * A CAN message consists of eight bytes.
+	 * @todo This should be private.
 	 */
-	BYTE m_bDat[8];
+	BYTE m_bDat[8] __attribute__((aligned(8)));
+
+	/**
+	 * Receive time (CLOCK_REALTIME) as provided by the interface, 0 if unknown.
+	 * @todo This should be private.
+	 */
+	long m_iTimeStampSec;
+	long m_iTimeStampNSec;
 
-public:
 	/**
 	 * Default constructor.
 	 */
@@ -88,7 +110,40 @@ public:
 	{
 		m_iID = 0;
 		m_iLen = 8;
+		m_bPad0 = 0;
 		m_iType = 0x00;
+		m_bPad1 = 0;
+		m_iTimeStampSec = 0;
+		m_iTimeStampNSec = 0;
+	}
+
+	/**
+	 * Sets all eight data bytes at once.
+	 */
+	void setData(const BYTE* pData)
+	{
+		memcpy(m_bDat, pData, 8);
+	}
+
+	/**
+	 * Returns the eight data bytes.
+	 */
+	const BYTE* getData() const
+	{
+		return m_bDat;
+	}
+
+	/**
+	 * Returns the message in the layout of struct can_frame (c_iFrameSize bytes).
+	 */
+	void* getFrame()
+	{
+		return this;
+	}
+
+	const void* getFrame() const
+	{
+		return this;
 	}
 
 	/**
@@ -117,7 +172,7 @@ public:
 	/**
 	 * Gets the bytes of the telegram.
 	 */
-	void get(BYTE* pData0, BYTE* pData1, BYTE* pData2, BYTE* pData3, BYTE* pData4, BYTE* pData5, BYTE* pData6, BYTE* pData7)
+	void get(BYTE* pData0, BYTE* pData1, BYTE* pData2, BYTE* pData3, BYTE* pData4, BYTE* pData5, BYTE* pData6, BYTE* pData7) const
 	{
 		*pData0 = m_bDat[0];
 		*pData1 = m_bDat[1];
@@ -133,7 +188,7 @@ public:
 	 * Returns a spezific byte of the telegram.
 	 * @param iNr number of the byte.
 	 */
-	int getAt(int iNr)
+	int getAt(int iNr) const
 	{
 		return m_bDat[iNr];
 	}
@@ -142,7 +197,7 @@ public:
 	 * Prints the telegram to the standard output.
 	 * @deprecated function uses a spetific format of the telegram.
 	 */
-	int printCanIdentMsgStatus()
+	int printCanIdentMsgStatus() const
 	{
 		if(getStatus() == 0)
 		{
@@ -159,9 +214,9 @@ public:
 	/**
 	 * Prints the telegram.
 	 */
-	void print()
+	void print() const
 	{
-		std::cout << "id= " << m_iID << " type= " << m_iType << " len= " << m_iLen << " data= " <<
+		std::cout << "id= " << m_iID << " type= " << (int)m_iType << " len= " << (int)m_iLen << " data= " <<
 			(int)m_bDat[0] << " " << (int)m_bDat[1] << " " << (int)m_bDat[2] << " " << (int)m_bDat[3] << " " <<
 			(int)m_bDat[4] << " " << (int)m_bDat[5] << " " << (int)m_bDat[6] << " " << (int)m_bDat[7] << std::endl;
 	}
@@ -169,7 +224,7 @@ public:
 	/**
 	 * @deprecated function uses a spetific format of the telegram.
 	 */
-	int getStatus()
+	int getStatus() const
 	{
 		//bit 0 and bit 1 contain MsgStatus
 		return (int)(m_bDat[7] & 0x0003);
@@ -178,7 +233,7 @@ public:
 	/**
 	 * @deprecated function uses a spetific format of the telegram.
 	 */
-	int getCmd()
+	int getCmd() const
 	{
 		return (m_bDat[7] >> 2);
 	}
@@ -187,7 +242,7 @@ public:
 	 * Get the identifier stored in this message structure.
 	 * @return the message identifier.
 	 */
-	int getID()
+	int getID() const
 	{
 		return m_iID;
 	}
@@ -207,7 +262,7 @@ public:
 	 * Get the message length set within this data structure.
 	 * @return The message length in the range [0..8].
 	 */
-	int getLength()
+	int getLength() const
 	{
 		return m_iLen;
 	}
@@ -226,7 +281,7 @@ public:
 	 * Get the message type. By default, the type is 0x00.
 	 * @return The message type.
 	 */
-	int getType()
+	int getType() const
 	{
 		return m_iType;
 	}
@@ -240,7 +295,38 @@ public:
 		m_iType = type;
 	}
 
+	/**
+	 * Get the receive time of the message, e.g. the kernel timestamp of SocketCan.
+	 * Both values are 0 if the interface doesn't provide timestamps.
+	 * The values can be passed to TimeStamp::setTimeStamp().
+	 */
+	void getTimeStamp(long& lSeconds, long& lNanoSeconds) const
+	{
+		lSeconds = m_iTimeStampSec;
+		lNanoSeconds = m_iTimeStampNSec;
+	}
+
+	/**
+	 * Set the receive time of the message (CLOCK_REALTIME).
+	 */
+	void setTimeStamp(long lSeconds, long lNanoSeconds)
+	{
+		m_iTimeStampSec = lSeconds;
+		m_iTimeStampNSec = lNanoSeconds;
+	}
+
+	/**
+	 * Check if the interface provided a receive time.
+	 */
+	bool hasTimeStamp() const
+	{
+		return (m_iTimeStampSec != 0) || (m_iTimeStampNSec != 0);
+	}
+
+} __attribute__((aligned(16)));
 
-};
+// layout checks, see class description
+typedef char CanMsgLayoutCheckLen[(offsetof(CanMsg, m_iLen) == 4) ? 1 : -1];
+typedef char CanMsgLayoutCheckDat[(offsetof(CanMsg, m_bDat) == 8) ? 1 : -1];
 //-----------------------------------------------
 #endif
@@ -69,7 +69,7 @@ public:
 	bool init_ret();
 	void init();
 	void destroy() {}
-	bool transmitMsg(CanMsg CMsg, bool bBlocking = true);
+	bool transmitMsg(const CanMsg& CMsg, bool bBlocking = true);
 	bool receiveMsg(CanMsg* pCMsg);
 	bool receiveMsgRetry(CanMsg* pCMsg, int iNrOfRetry);
 	bool receiveMsgTimeout(CanMsg* pCMsg, int nSecTimeout);
@@ -69,10 +69,11 @@ public:
 	bool init_ret();
 	void init();
 	void destroy() {};
-	bool transmitMsg(CanMsg CMsg, bool bBlocking = true);
+	bool transmitMsg(const CanMsg& CMsg, bool bBlocking = true);
 	bool receiveMsg(CanMsg* pCMsg);
 	bool receiveMsgRetry(CanMsg* pCMsg, int iNrOfRetry);
 	bool receiveMsgTimeout(CanMsg* pCMsg, int nMicroSeconds);
+	int receiveMsgs(CanMsg* pCMsgs, size_t iMaxMsgs, int nMicroSecTimeout = 0);
 	bool isObjectMode() { return false; }
 
 private:
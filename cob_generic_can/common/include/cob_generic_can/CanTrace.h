@@ -0,0 +1,172 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_generic_can
+ * Description: Binary memory-mapped trace of CAN frames.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#ifndef CANTRACE_INCLUDEDEF_H
+#define CANTRACE_INCLUDEDEF_H
+//-----------------------------------------------
+#include <stdint.h>
+#include <string>
+
+#include <cob_generic_can/CanMsg.h>
+//-----------------------------------------------
+
+/**
+ * File layout of a CAN trace: a CanTraceHeader followed by CanTraceRecord's in the order
+ * the frames passed the interface. All values are in host byte order.
+ * The header is updated after every record, so the trace stays readable if the recording process dies.
+ * \ingroup DriversCanModul
+ */
+struct CanTraceHeader
+{
+	char cMagic[8];
+	uint32_t iVersion;
+	uint32_t iRecordSize;
+	uint64_t iNumRecords;
+	uint64_t iReserved;
+};
+
+struct CanTraceRecord
+{
+	enum Direction { RX = 0, TX = 1 };
+
+	/// receive time of the driver (if available) resp. send time, nanoseconds since the epoch
+	int64_t iTimeStampNSec;
+	uint32_t iID;
+	uint8_t iLen;
+	uint8_t iDir;
+	uint8_t bPad[2];
+	uint8_t bDat[8];
+};
+
+typedef char CanTraceRecordSizeCheck[(sizeof(CanTraceRecord) == 24) ? 1 : -1];
+typedef char CanTraceHeaderSizeCheck[(sizeof(CanTraceHeader) == 32) ? 1 : -1];
+
+/**
+ * Appends frames to a trace file. The file is grown in chunks and memory-mapped,
+ * so writing a record is a copy to memory without a system call.
+ * The object is not thread-safe.
+ * \ingroup DriversCanModul
+ */
+class CanTraceWriter
+{
+public:
+	CanTraceWriter();
+	~CanTraceWriter();
+
+	/**
+	 * Creates (or truncates) the trace file.
+	 */
+	bool open(const std::string& sFileName);
+
+	/**
+	 * Truncates the file to the records written and closes it.
+	 */
+	void close();
+
+	bool isOpen() { return m_pHeader != NULL; }
+
+	/**
+	 * Appends a frame.
+	 * @param iDir CanTraceRecord::RX or CanTraceRecord::TX
+	 * @param lSec, lNSec time stamp of the frame
+	 */
+	bool write(const CanMsg& CMsg, int iDir, long lSec, long lNSec);
+
+	uint64_t getNumRecords() { return (m_pHeader != NULL) ? m_pHeader->iNumRecords : 0; }
+
+private:
+	// maps a larger part of the file, caller checks m_iFd
+	bool grow();
+
+	int m_iFd;
+	size_t m_iMapSize;
+	CanTraceHeader* m_pHeader;
+	CanTraceRecord* m_pRecords;
+	uint64_t m_iMaxRecords;
+};
+
+/**
+ * Read access to a trace file (memory-mapped, read-only).
+ * \ingroup DriversCanModul
+ */
+class CanTraceReader
+{
+public:
+	CanTraceReader();
+	~CanTraceReader();
+
+	bool open(const std::string& sFileName);
+	void close();
+
+	uint64_t getNumRecords() { return m_iNumRecords; }
+
+	/**
+	 * Direct access to the records, valid until close().
+	 */
+	const CanTraceRecord& getRecord(uint64_t i) { return m_pRecords[i]; }
+
+	/**
+	 * Converts a record to a CanMsg including the time stamp.
+	 */
+	static void toCanMsg(const CanTraceRecord& Rec, CanMsg* pCMsg);
+
+private:
+	int m_iFd;
+	size_t m_iMapSize;
+	void* m_pMap;
+	const CanTraceRecord* m_pRecords;
+	uint64_t m_iNumRecords;
+};
+//-----------------------------------------------
+#endif
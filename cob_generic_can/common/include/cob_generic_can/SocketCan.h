@@ -42,14 +42,18 @@
 #ifndef SOCKETCAN_INCLUDEDEF_H
 #define SOCKETCAN_INCLUDEDEF_H
 //-----------------------------------------------
-#include <boost/shared_ptr.hpp>
+#include <vector>
+#include <sys/socket.h>
+#include <linux/can.h>
 
 #include <cob_generic_can/CanItf.h>
-#include <socketcan_interface/socketcan.h>
-#include <socketcan_interface/threading.h>
-#include <socketcan_interface/reader.h>
 //-----------------------------------------------
 
+/**
+ * CAN interface for Linux SocketCAN devices (e.g. can0, vcan0).
+ * Uses a raw CAN socket directly, so the identifier filter is installed in the kernel
+ * (CAN_RAW_FILTER) and every received message carries the kernel receive time (SO_TIMESTAMP).
+ */
 class SocketCan : public CanItf
 {
 public:
@@ -59,23 +63,34 @@ public:
     ~SocketCan();
     bool init_ret();
     void init();
-    bool transmitMsg ( CanMsg CMsg, bool bBlocking = true );
+    bool transmitMsg ( const CanMsg& CMsg, bool bBlocking = true );
+    int transmitMsgs ( const CanMsg* pCMsgs, size_t iNumMsgs, bool bBlocking = true );
     bool receiveMsg ( CanMsg* pCMsg );
     bool receiveMsgRetry ( CanMsg* pCMsg, int iNrOfRetry );
     bool receiveMsgTimeout ( CanMsg* pCMsg, int nMicroSecTimeout );
+    int receiveMsgs ( CanMsg* pCMsgs, size_t iMaxMsgs, int nMicroSecTimeout = 0 );
+    bool setFilter ( const std::vector<int>& viCanIDs );
     bool isObjectMode() {
         return false;
     }
 
 private:
     // --------------- Types
-    boost::shared_ptr<can::ThreadedSocketCANInterface> m_handle;
-    can::BufferedReader m_reader;
+    int m_iSocket;
+    std::vector<struct can_filter> m_vFilter;
+
+    // headers for sendmmsg(), kept to avoid allocations per burst
+    std::vector<struct mmsghdr> m_vTxHdr;
+    std::vector<struct iovec> m_vTxIov;
 
     bool m_bInitialized;
     const char* p_cDevice;
 
-    void print_error ( const can::State& state );
+    /**
+     * Waits at most nMicroSecTimeout for a message and reads it including its timestamp.
+     */
+    bool readFrame ( CanMsg* pCMsg, int nMicroSecTimeout );
+    bool applyFilter();
 };
 //-----------------------------------------------
 #endif
@@ -0,0 +1,196 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_generic_can
+ * Description: In-process CAN bus simulation with pluggable node simulators.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+
+#include <cob_generic_can/CanDummy.h>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+
+//-----------------------------------------------
+CanDummy::CanDummy(int iLatencyUs, int iJitterUs)
+{
+	m_iLatencyUs = iLatencyUs;
+	m_iJitterUs = iJitterUs;
+	m_iRandSeed = (unsigned int)time(NULL);
+}
+
+//-----------------------------------------------
+CanDummy::~CanDummy()
+{
+	for (unsigned int i = 0; i < m_vpNodes.size(); i++)
+		delete m_vpNodes[i];
+}
+
+//-----------------------------------------------
+void CanDummy::addNode(CanDummyNode* pNode)
+{
+	m_Mutex.lock();
+	m_vpNodes.push_back(pNode);
+	m_Mutex.unlock();
+}
+
+//-----------------------------------------------
+void CanDummy::setLatency(int iLatencyUs, int iJitterUs)
+{
+	m_Mutex.lock();
+	m_iLatencyUs = iLatencyUs;
+	m_iJitterUs = iJitterUs;
+	m_Mutex.unlock();
+}
+
+//-----------------------------------------------
+bool CanDummy::transmitMsg(const CanMsg& CMsg, bool bBlocking)
+{
+	if (addToBatch(CMsg))
+		return true;
+
+	PendingMsg Pending;
+	int iDelayUs;
+
+	m_Mutex.lock();
+
+	m_vReplies.clear();
+	for (unsigned int i = 0; i < m_vpNodes.size(); i++)
+		m_vpNodes[i]->evalMsg(CMsg, m_vReplies);
+
+	for (unsigned int i = 0; i < m_vReplies.size(); i++)
+	{
+		iDelayUs = m_iLatencyUs;
+		if (m_iJitterUs > 0)
+			iDelayUs += rand_r(&m_iRandSeed) % (m_iJitterUs + 1);
+
+		Pending.Due.SetNow();
+		Pending.Due += iDelayUs * 1e-6;
+
+		// a message can't overtake the ones already on the bus
+		if (!m_Pending.empty() && (Pending.Due < m_Pending.back().Due))
+			Pending.Due = m_Pending.back().Due;
+
+		Pending.Msg = m_vReplies[i];
+		m_Pending.push_back(Pending);
+	}
+
+	m_Mutex.unlock();
+
+	return true;
+}
+
+//-----------------------------------------------
+bool CanDummy::receiveMsg(CanMsg* pCMsg)
+{
+	return (receiveMsgs(pCMsg, 1, 0) == 1);
+}
+
+//-----------------------------------------------
+bool CanDummy::receiveMsgRetry(CanMsg* pCMsg, int iNrOfRetry)
+{
+	for (int i = 0; i < iNrOfRetry; i++)
+	{
+		if (receiveMsg(pCMsg))
+			return true;
+		usleep(10000);
+	}
+	return false;
+}
+
+//-----------------------------------------------
+bool CanDummy::receiveMsgTimeout(CanMsg* pCMsg, int nMicroSecTimeout)
+{
+	return (receiveMsgs(pCMsg, 1, nMicroSecTimeout) == 1);
+}
+
+//-----------------------------------------------
+int CanDummy::receiveMsgs(CanMsg* pCMsgs, size_t iMaxMsgs, int nMicroSecTimeout)
+{
+	const int iPollUs = 100;
+	int iNumMsgs;
+
+	m_Mutex.lock();
+	iNumMsgs = popDueMsgs(pCMsgs, iMaxMsgs);
+	m_Mutex.unlock();
+
+	// answers become due with time -> poll until the timeout expires
+	for (int iWaitedUs = 0; (iNumMsgs == 0) && (iMaxMsgs > 0) && (iWaitedUs < nMicroSecTimeout); iWaitedUs += iPollUs)
+	{
+		usleep(iPollUs);
+		m_Mutex.lock();
+		iNumMsgs = popDueMsgs(pCMsgs, iMaxMsgs);
+		m_Mutex.unlock();
+	}
+
+	return iNumMsgs;
+}
+
+//-----------------------------------------------
+int CanDummy::popDueMsgs(CanMsg* pCMsgs, size_t iMaxMsgs)
+{
+	TimeStamp Now;
+	size_t iNumMsgs = 0;
+	long lSec, lNSec;
+
+	Now.SetNow();
+
+	while ((iNumMsgs < iMaxMsgs) && !m_Pending.empty() && !(Now < m_Pending.front().Due))
+	{
+		// stamped with the simulated arrival time like a driver timestamps in its receive interrupt
+		m_Pending.front().Due.getTimeStamp(lSec, lNSec);
+		pCMsgs[iNumMsgs] = m_Pending.front().Msg;
+		pCMsgs[iNumMsgs].setTimeStamp(lSec, lNSec);
+		m_Pending.pop_front();
+		iNumMsgs++;
+	}
+
+	return (int)iNumMsgs;
+}
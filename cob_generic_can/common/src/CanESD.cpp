@@ -52,6 +52,7 @@
  ****************************************************************/
 
 // general includes
+#include <algorithm>
 
 // Headers provided by other cob-packages
 #include <cob_generic_can/CanESD.h>
@@ -141,14 +142,16 @@ void CanESD::initIntern()
  * @param CMsg Structure containing the CAN message.
  * @return true on success, false on failure.
  */
-bool CanESD::transmitMsg(CanMsg CMsg, bool bBlocking)
+bool CanESD::transmitMsg(const CanMsg& CMsg, bool bBlocking)
 {
+	if (addToBatch(CMsg))
+		return true;
+
 	CMSG NTCANMsg;
 	NTCANMsg.id = CMsg.m_iID;
 	NTCANMsg.len = CMsg.m_iLen;
 
-	for(int i=0; i<8; i++)
-		NTCANMsg.data[i] = CMsg.getAt(i);
+	memcpy(NTCANMsg.data, CMsg.getData(), 8);
 
 	int ret;
 	int32_t len;
@@ -166,6 +169,12 @@ bool CanESD::transmitMsg(CanMsg CMsg, bool bBlocking)
 		std::cout << "error in CANESD::transmitMsg: " << GetErrorStr(ret) << std::endl;
 		bRet = false;
 	}
+	else if( len < 1 )
+	{
+		// non-blocking and TX queue full
+		std::cout << "error in CANESD::transmitMsg: TX queue full" << std::endl;
+		bRet = false;
+	}
 
 	m_LastID = (int)NTCANMsg.data[0];
 
@@ -173,6 +182,62 @@ bool CanESD::transmitMsg(CanMsg CMsg, bool bBlocking)
 	return bRet;
 }
 
+//-----------------------------------------------
+/**
+ * Transmit several messages with one call of the driver.
+ * @return number of messages sent.
+ */
+int CanESD::transmitMsgs(const CanMsg* pCMsgs, size_t iNumMsgs, bool bBlocking)
+{
+	const size_t iChunkSize = 64;
+	CMSG NTCANMsgs[iChunkSize];
+	size_t iNumSent = 0;
+	int ret;
+
+	if (isBatching())
+		return CanItf::transmitMsgs(pCMsgs, iNumMsgs, bBlocking);
+
+	while( iNumSent < iNumMsgs )
+	{
+		int32_t iRequested = (int32_t)std::min<size_t>(iChunkSize, iNumMsgs - iNumSent);
+		int32_t len = iRequested;
+
+		for(int i=0; i<iRequested; i++)
+		{
+			NTCANMsgs[i].id = pCMsgs[iNumSent + i].m_iID;
+			NTCANMsgs[i].len = pCMsgs[iNumSent + i].m_iLen;
+			memcpy(NTCANMsgs[i].data, pCMsgs[iNumSent + i].getData(), 8);
+		}
+
+		if (bBlocking)
+			ret = canWrite(m_Handle, NTCANMsgs, &len, NULL);
+		else
+			ret = canSend(m_Handle, NTCANMsgs, &len);
+
+		if( ret != NTCAN_SUCCESS)
+		{
+			std::cout << "error in CANESD::transmitMsgs: " << GetErrorStr(ret) << std::endl;
+			break;
+		}
+
+		// in non-blocking mode canSend() returns NTCAN_SUCCESS with fewer (or no) messages sent if the TX queue is full
+		if( len > 0 )
+		{
+			iNumSent += len;
+			m_LastID = (int)NTCANMsgs[len - 1].data[0];
+		}
+
+		if( len < iRequested )
+		{
+			std::cout << "error in CANESD::transmitMsgs: TX queue full, " << iNumSent << " of " << iNumMsgs << " messages sent" << std::endl;
+			break;
+		}
+	}
+
+	m_bIsTXError = (iNumSent < iNumMsgs);
+	return (int)iNumSent;
+}
+
 //-----------------------------------------------
 bool CanESD::receiveMsgRetry(CanMsg* pCMsg, int iNrOfRetry)
 {
@@ -305,6 +370,98 @@ bool CanESD::receiveMsgTimeout(CanMsg* pCMsg, int nMicroSecTimeout)
     return false;
 }
 
+//-----------------------------------------------
+/**
+ * Reads all pending messages with as few canTake() calls as possible.
+ * canTake() fills up to len messages per call, so the driver FIFO is drained in chunks.
+ * In object mode the ids to poll are given by the caller -> use the generic implementation.
+ */
+int CanESD::receiveMsgs(CanMsg* pCMsgs, size_t iMaxMsgs, int nMicroSecTimeout)
+{
+	const int32_t iChunkSize = 64;
+	CMSG NTCANMsgs[iChunkSize];
+	size_t iNumMsgs = 0;
+	int32_t len;
+	int ret;
+
+	if( isObjectMode() )
+		return CanItf::receiveMsgs(pCMsgs, iMaxMsgs, nMicroSecTimeout);
+
+	// canTake() does not block -> poll until the first message arrives or the timeout expires
+	int iWaitedUs = 0;
+	while(iNumMsgs < iMaxMsgs)
+	{
+		int32_t iRequested = (int32_t)std::min<size_t>(iChunkSize, iMaxMsgs - iNumMsgs);
+		len = iRequested;
+		ret = canTake(m_Handle, NTCANMsgs, &len);
+
+		if( ret != NTCAN_SUCCESS )
+		{
+			std::cout << "error in CANESD::receiveMsgs: " << GetErrorStr(ret) << std::endl;
+			break;
+		}
+
+		for(int i=0; i<len; i++)
+		{
+			CanMsg& msg = pCMsgs[iNumMsgs++];
+			msg.m_iID = NTCANMsgs[i].id;
+			msg.m_iLen = NTCANMsgs[i].len;
+			msg.set(NTCANMsgs[i].data[0], NTCANMsgs[i].data[1], NTCANMsgs[i].data[2], NTCANMsgs[i].data[3],
+				NTCANMsgs[i].data[4], NTCANMsgs[i].data[5], NTCANMsgs[i].data[6], NTCANMsgs[i].data[7]);
+
+			if( NTCANMsgs[i].msg_lost != 0 )
+				std::cout << (int)(NTCANMsgs[i].msg_lost) << " messages lost!" << std::endl;
+		}
+
+		if( (len == 0) && (iNumMsgs == 0) && (iWaitedUs < nMicroSecTimeout) )
+		{
+			Sleep(1);
+			iWaitedUs += 1000;
+		}
+		else if( len < iRequested )
+		{
+			// fifo is empty (or timeout expired)
+			break;
+		}
+	}
+
+	return (int)iNumMsgs;
+}
+
+//-----------------------------------------------
+/**
+ * Replaces the identifiers registered by initIntern() (all 11-bit identifiers)
+ * by the given ones, so the driver discards messages of other nodes.
+ * An empty list registers all identifiers again.
+ */
+bool CanESD::setFilter(const std::vector<int>& viCanIDs)
+{
+	int iRet;
+	bool bRet = true;
+
+	for( int i=0; i<=0x7FF; ++i )
+		canIdDelete( m_Handle, i );
+
+	if( viCanIDs.empty() )
+	{
+		for( int i=0; i<=0x7FF; ++i )
+			canIdAdd( m_Handle, i );
+		return false;
+	}
+
+	for( unsigned int i=0; i<viCanIDs.size(); ++i )
+	{
+		iRet = canIdAdd( m_Handle, viCanIDs[i] );
+		if(iRet != NTCAN_SUCCESS)
+		{
+			std::cout << "error in CANESD::setFilter: " << GetErrorStr(iRet) << std::endl;
+			bRet = false;
+		}
+	}
+
+	return bRet;
+}
+
 /**
  * Add a group of CAN identifier to the handle, so it can be received.
  * The identifiers are generated by inverting the id and adding each value between 0 and 7
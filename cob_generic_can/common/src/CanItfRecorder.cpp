@@ -0,0 +1,190 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_generic_can
+ * Description: Records the frames of a CAN interface to a trace file.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+
+#include <cob_generic_can/CanItfRecorder.h>
+#include <cob_utilities/TimeStamp.h>
+
+//-----------------------------------------------
+CanItfRecorder::CanItfRecorder(CanItf* pCanItf)
+{
+	m_pCanItf = pCanItf;
+}
+
+//-----------------------------------------------
+CanItfRecorder::~CanItfRecorder()
+{
+	close();
+	delete m_pCanItf;
+}
+
+//-----------------------------------------------
+bool CanItfRecorder::open(const std::string& sFileName)
+{
+	bool bRet;
+
+	m_Mutex.lock();
+	bRet = m_Writer.open(sFileName);
+	m_Mutex.unlock();
+
+	return bRet;
+}
+
+//-----------------------------------------------
+void CanItfRecorder::close()
+{
+	m_Mutex.lock();
+	m_Writer.close();
+	m_Mutex.unlock();
+}
+
+//-----------------------------------------------
+bool CanItfRecorder::transmitMsg(const CanMsg& CMsg, bool bBlocking)
+{
+	if (addToBatch(CMsg))
+		return true;
+
+	if (!m_pCanItf->transmitMsg(CMsg, bBlocking))
+		return false;
+
+	record(&CMsg, 1, CanTraceRecord::TX);
+
+	return true;
+}
+
+//-----------------------------------------------
+int CanItfRecorder::transmitMsgs(const CanMsg* pCMsgs, size_t iNumMsgs, bool bBlocking)
+{
+	int iNumSent;
+
+	if (isBatching())
+		return CanItf::transmitMsgs(pCMsgs, iNumMsgs, bBlocking);
+
+	iNumSent = m_pCanItf->transmitMsgs(pCMsgs, iNumMsgs, bBlocking);
+	record(pCMsgs, iNumSent, CanTraceRecord::TX);
+
+	return iNumSent;
+}
+
+//-----------------------------------------------
+bool CanItfRecorder::receiveMsg(CanMsg* pCMsg)
+{
+	bool bRet = m_pCanItf->receiveMsg(pCMsg);
+
+	if (bRet)
+		record(pCMsg, 1, CanTraceRecord::RX);
+
+	return bRet;
+}
+
+//-----------------------------------------------
+bool CanItfRecorder::receiveMsgRetry(CanMsg* pCMsg, int iNrOfRetry)
+{
+	bool bRet = m_pCanItf->receiveMsgRetry(pCMsg, iNrOfRetry);
+
+	if (bRet)
+		record(pCMsg, 1, CanTraceRecord::RX);
+
+	return bRet;
+}
+
+//-----------------------------------------------
+bool CanItfRecorder::receiveMsgTimeout(CanMsg* pCMsg, int nMicroSecTimeout)
+{
+	bool bRet = m_pCanItf->receiveMsgTimeout(pCMsg, nMicroSecTimeout);
+
+	if (bRet)
+		record(pCMsg, 1, CanTraceRecord::RX);
+
+	return bRet;
+}
+
+//-----------------------------------------------
+int CanItfRecorder::receiveMsgs(CanMsg* pCMsgs, size_t iMaxMsgs, int nMicroSecTimeout)
+{
+	int iNumMsgs = m_pCanItf->receiveMsgs(pCMsgs, iMaxMsgs, nMicroSecTimeout);
+
+	if (iNumMsgs > 0)
+		record(pCMsgs, iNumMsgs, CanTraceRecord::RX);
+
+	return iNumMsgs;
+}
+
+//-----------------------------------------------
+void CanItfRecorder::record(const CanMsg* pCMsgs, int iNumMsgs, int iDir)
+{
+	TimeStamp Now;
+	long lNowSec, lNowNSec;
+	long lSec, lNSec;
+
+	Now.SetNow();
+	Now.getTimeStamp(lNowSec, lNowNSec);
+
+	m_Mutex.lock();
+
+	for (int i = 0; i < iNumMsgs; i++)
+	{
+		if ((iDir == CanTraceRecord::RX) && pCMsgs[i].hasTimeStamp())
+			pCMsgs[i].getTimeStamp(lSec, lNSec);
+		else
+		{
+			lSec = lNowSec;
+			lNSec = lNowNSec;
+		}
+
+		m_Writer.write(pCMsgs[i], iDir, lSec, lNSec);
+	}
+
+	m_Mutex.unlock();
+}
@@ -0,0 +1,247 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_generic_can
+ * Description: CAN interface replaying a recorded trace.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+
+#include <cob_generic_can/CanItfReplay.h>
+#include <unistd.h>
+
+//-----------------------------------------------
+static const uint32_t c_iSyncID = 0x80;
+
+//-----------------------------------------------
+CanItfReplay::CanItfReplay()
+{
+	m_bRealTime = false;
+	m_iNextRecord = 0;
+	m_iNumFramesReplayed = 0;
+	m_iLastRecordNSec = 0;
+	m_bStarted = false;
+	m_iFirstRecordNSec = 0;
+	m_bCycleDelivered = false;
+}
+
+//-----------------------------------------------
+bool CanItfReplay::open(const std::string& sFileName, bool bRealTime)
+{
+	bool bRet;
+
+	m_Mutex.lock();
+
+	bRet = m_Reader.open(sFileName);
+	m_bRealTime = bRealTime;
+	m_iNextRecord = 0;
+	m_iNumFramesReplayed = 0;
+	m_bStarted = false;
+	m_bCycleDelivered = false;
+	m_iFirstRecordNSec = (m_Reader.getNumRecords() > 0) ? m_Reader.getRecord(0).iTimeStampNSec : 0;
+	m_iLastRecordNSec = m_iFirstRecordNSec;
+
+	m_Mutex.unlock();
+
+	return bRet;
+}
+
+//-----------------------------------------------
+bool CanItfReplay::isFinished()
+{
+	bool bFinished;
+
+	m_Mutex.lock();
+	bFinished = (m_iNextRecord >= m_Reader.getNumRecords());
+	m_Mutex.unlock();
+
+	return bFinished;
+}
+
+//-----------------------------------------------
+unsigned long CanItfReplay::getNumFramesReplayed()
+{
+	unsigned long iNumFrames;
+
+	m_Mutex.lock();
+	iNumFrames = m_iNumFramesReplayed;
+	m_Mutex.unlock();
+
+	return iNumFrames;
+}
+
+//-----------------------------------------------
+double CanItfReplay::getDurationS()
+{
+	double dDurationS = 0;
+
+	m_Mutex.lock();
+	if (m_Reader.getNumRecords() > 0)
+		dDurationS = (m_Reader.getRecord(m_Reader.getNumRecords() - 1).iTimeStampNSec - m_iFirstRecordNSec) * 1e-9;
+	m_Mutex.unlock();
+
+	return dDurationS;
+}
+
+//-----------------------------------------------
+double CanItfReplay::getReplayTimeS()
+{
+	double dTimeS;
+
+	m_Mutex.lock();
+	dTimeS = (m_iLastRecordNSec - m_iFirstRecordNSec) * 1e-9;
+	m_Mutex.unlock();
+
+	return dTimeS;
+}
+
+//-----------------------------------------------
+bool CanItfReplay::transmitMsg(const CanMsg& CMsg, bool bBlocking)
+{
+	// the answers are in the trace already
+	return true;
+}
+
+//-----------------------------------------------
+bool CanItfReplay::receiveMsg(CanMsg* pCMsg)
+{
+	return (receiveMsgs(pCMsg, 1, 0) == 1);
+}
+
+//-----------------------------------------------
+bool CanItfReplay::receiveMsgRetry(CanMsg* pCMsg, int iNrOfRetry)
+{
+	for (int i = 0; i < iNrOfRetry; i++)
+	{
+		if (receiveMsg(pCMsg))
+			return true;
+		usleep(10000);
+	}
+	return false;
+}
+
+//-----------------------------------------------
+bool CanItfReplay::receiveMsgTimeout(CanMsg* pCMsg, int nMicroSecTimeout)
+{
+	return (receiveMsgs(pCMsg, 1, nMicroSecTimeout) == 1);
+}
+
+//-----------------------------------------------
+int CanItfReplay::receiveMsgs(CanMsg* pCMsgs, size_t iMaxMsgs, int nMicroSecTimeout)
+{
+	const int iPollUs = 100;
+	int iNumMsgs;
+
+	m_Mutex.lock();
+	iNumMsgs = popDueMsgs(pCMsgs, iMaxMsgs);
+	m_Mutex.unlock();
+
+	// in real-time mode frames become due with time -> poll until the timeout expires
+	for (int iWaitedUs = 0; m_bRealTime && (iNumMsgs == 0) && (iMaxMsgs > 0) && (iWaitedUs < nMicroSecTimeout); iWaitedUs += iPollUs)
+	{
+		usleep(iPollUs);
+		m_Mutex.lock();
+		iNumMsgs = popDueMsgs(pCMsgs, iMaxMsgs);
+		m_Mutex.unlock();
+	}
+
+	return iNumMsgs;
+}
+
+//-----------------------------------------------
+int CanItfReplay::popDueMsgs(CanMsg* pCMsgs, size_t iMaxMsgs)
+{
+	TimeStamp Now;
+	int64_t iReplayNSec = 0;
+	size_t iNumMsgs = 0;
+
+	if (m_bRealTime)
+	{
+		Now.SetNow();
+		if (!m_bStarted)
+		{
+			m_StartTime = Now;
+			m_bStarted = true;
+		}
+		iReplayNSec = m_iFirstRecordNSec + (int64_t)((Now - m_StartTime) * 1e9);
+	}
+
+	while ((iNumMsgs < iMaxMsgs) && (m_iNextRecord < m_Reader.getNumRecords()))
+	{
+		const CanTraceRecord& Rec = m_Reader.getRecord(m_iNextRecord);
+
+		if (m_bRealTime)
+		{
+			if (Rec.iTimeStampNSec > iReplayNSec)
+				break;
+		}
+		else if ((Rec.iID == c_iSyncID) && m_bCycleDelivered)
+		{
+			// end of the recorded cycle, the next call continues behind the SYNC
+			m_bCycleDelivered = false;
+			m_iNextRecord++;
+			break;
+		}
+
+		m_iNextRecord++;
+
+		// sent frames (SYNC, commands) are only needed for the timing
+		if (Rec.iDir != CanTraceRecord::RX)
+			continue;
+
+		CanTraceReader::toCanMsg(Rec, &pCMsgs[iNumMsgs]);
+		m_iLastRecordNSec = Rec.iTimeStampNSec;
+		iNumMsgs++;
+		m_bCycleDelivered = true;
+	}
+
+	m_iNumFramesReplayed += iNumMsgs;
+
+	return (int)iNumMsgs;
+}
@@ -0,0 +1,385 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_generic_can
+ * Description: Bus load and latency statistics of a CAN interface.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+
+#include <cob_generic_can/CanItfStats.h>
+#include <limits>
+
+//-----------------------------------------------
+// bits of a standard data frame without bit stuffing: SOF, identifier, control, CRC, ACK, EOF, intermission
+static const int c_iFrameOverheadBits = 47;
+
+// upper limits of the latency histogram bins, the last bin is unbounded
+static const double c_dLatencyBinUpperS[CanItfStats::c_iNumLatencyBins - 1] =
+	{ 0.0001, 0.0002, 0.0005, 0.001, 0.002, 0.005, 0.01, 0.02, 0.05 };
+
+//-----------------------------------------------
+CanItfStats::CanItfStats(CanItf* pCanItf, int iBitRate)
+{
+	m_pCanItf = pCanItf;
+	m_iBitRate = iBitRate;
+
+	m_iNumTxFrames = 0;
+	m_iNumRxFrames = 0;
+	m_iNumTxBytes = 0;
+	m_iNumRxBytes = 0;
+	m_iNumBusBits = 0;
+	m_iNumTxFailed = 0;
+
+	m_LastStats.SetNow();
+	m_iLastTxFrames = 0;
+	m_iLastRxFrames = 0;
+	m_iLastTxBytes = 0;
+	m_iLastRxBytes = 0;
+	m_iLastBusBits = 0;
+
+	m_vviResponseIDs.resize(c_iNumCanIDs);
+	m_viResponseChannel.assign(c_iNumCanIDs, -1);
+	m_vRequestTime.resize(c_iNumCanIDs);
+	m_vbRequestPending.assign(c_iNumCanIDs, false);
+}
+
+//-----------------------------------------------
+CanItfStats::~CanItfStats()
+{
+	delete m_pCanItf;
+}
+
+//-----------------------------------------------
+int CanItfStats::baudrateValToBitRate(int iBaudrateVal)
+{
+	switch (iBaudrateVal)
+	{
+		case CANITFBAUD_1M:
+			return 1000000;
+		case CANITFBAUD_500K:
+			return 500000;
+		case CANITFBAUD_250K:
+			return 250000;
+		case CANITFBAUD_125K:
+			return 125000;
+		case CANITFBAUD_50K:
+			return 50000;
+		case CANITFBAUD_20K:
+			return 20000;
+		case CANITFBAUD_10K:
+			return 10000;
+		default:
+			return 0;
+	}
+}
+
+//-----------------------------------------------
+double CanItfStats::getLatencyBinUpperS(int iBin)
+{
+	if ((iBin >= 0) && (iBin < c_iNumLatencyBins - 1))
+		return c_dLatencyBinUpperS[iBin];
+
+	return std::numeric_limits<double>::infinity();
+}
+
+//-----------------------------------------------
+int CanItfStats::addLatencyChannel(const std::string& sName)
+{
+	LatencyHistogram Hist;
+	int iChannel;
+
+	Hist.sName = sName;
+	Hist.iNumSamples = 0;
+	Hist.dMinS = 0;
+	Hist.dMaxS = 0;
+	Hist.dSumS = 0;
+	Hist.viBins.assign(c_iNumLatencyBins, 0);
+
+	m_Mutex.lock();
+	m_vLatency.push_back(Hist);
+	iChannel = (int)m_vLatency.size() - 1;
+	m_Mutex.unlock();
+
+	return iChannel;
+}
+
+//-----------------------------------------------
+void CanItfStats::addRequestResponse(int iChannel, int iRequestID, int iResponseID)
+{
+	if ((iRequestID < 0) || (iRequestID >= c_iNumCanIDs) || (iResponseID < 0) || (iResponseID >= c_iNumCanIDs))
+	{
+		std::cout << "CanItfStats::addRequestResponse(): invalid CAN identifier " << iRequestID << " / " << iResponseID << std::endl;
+		return;
+	}
+
+	m_Mutex.lock();
+	m_vviResponseIDs[iRequestID].push_back(iResponseID);
+	m_viResponseChannel[iResponseID] = iChannel;
+	m_Mutex.unlock();
+}
+
+//-----------------------------------------------
+void CanItfStats::getStats(Stats& stats)
+{
+	TimeStamp Now;
+
+	Now.SetNow();
+
+	m_Mutex.lock();
+
+	stats.dPeriodS = Now - m_LastStats;
+	if (stats.dPeriodS > 0)
+	{
+		stats.dTxFramesPerS = (m_iNumTxFrames - m_iLastTxFrames) / stats.dPeriodS;
+		stats.dRxFramesPerS = (m_iNumRxFrames - m_iLastRxFrames) / stats.dPeriodS;
+		stats.dTxBytesPerS = (m_iNumTxBytes - m_iLastTxBytes) / stats.dPeriodS;
+		stats.dRxBytesPerS = (m_iNumRxBytes - m_iLastRxBytes) / stats.dPeriodS;
+	}
+	else
+	{
+		stats.dTxFramesPerS = 0;
+		stats.dRxFramesPerS = 0;
+		stats.dTxBytesPerS = 0;
+		stats.dRxBytesPerS = 0;
+	}
+
+	if ((stats.dPeriodS > 0) && (m_iBitRate > 0))
+		stats.dBusLoadPercent = 100.0 * (m_iNumBusBits - m_iLastBusBits) / (stats.dPeriodS * m_iBitRate);
+	else
+		stats.dBusLoadPercent = 0;
+
+	stats.iNumTxFrames = m_iNumTxFrames;
+	stats.iNumRxFrames = m_iNumRxFrames;
+	stats.iNumTxErrors = m_iNumTxFailed + m_pCanItf->getNumTxErrors();
+	stats.iNumRxOverruns = m_pCanItf->getNumRxOverruns();
+	stats.vLatency = m_vLatency;
+
+	m_LastStats = Now;
+	m_iLastTxFrames = m_iNumTxFrames;
+	m_iLastRxFrames = m_iNumRxFrames;
+	m_iLastTxBytes = m_iNumTxBytes;
+	m_iLastRxBytes = m_iNumRxBytes;
+	m_iLastBusBits = m_iNumBusBits;
+
+	m_Mutex.unlock();
+}
+
+//-----------------------------------------------
+bool CanItfStats::transmitMsg(const CanMsg& CMsg, bool bBlocking)
+{
+	bool bRet;
+
+	if (addToBatch(CMsg))
+		return true;
+
+	bRet = m_pCanItf->transmitMsg(CMsg, bBlocking);
+	countTx(&CMsg, bRet ? 1 : 0, bRet ? 0 : 1);
+
+	return bRet;
+}
+
+//-----------------------------------------------
+int CanItfStats::transmitMsgs(const CanMsg* pCMsgs, size_t iNumMsgs, bool bBlocking)
+{
+	int iNumSent;
+
+	if (isBatching())
+		return CanItf::transmitMsgs(pCMsgs, iNumMsgs, bBlocking);
+
+	iNumSent = m_pCanItf->transmitMsgs(pCMsgs, iNumMsgs, bBlocking);
+	countTx(pCMsgs, iNumSent, (int)iNumMsgs - iNumSent);
+
+	return iNumSent;
+}
+
+//-----------------------------------------------
+bool CanItfStats::receiveMsg(CanMsg* pCMsg)
+{
+	bool bRet = m_pCanItf->receiveMsg(pCMsg);
+
+	if (bRet)
+		countRx(pCMsg, 1);
+
+	return bRet;
+}
+
+//-----------------------------------------------
+bool CanItfStats::receiveMsgRetry(CanMsg* pCMsg, int iNrOfRetry)
+{
+	bool bRet = m_pCanItf->receiveMsgRetry(pCMsg, iNrOfRetry);
+
+	if (bRet)
+		countRx(pCMsg, 1);
+
+	return bRet;
+}
+
+//-----------------------------------------------
+bool CanItfStats::receiveMsgTimeout(CanMsg* pCMsg, int nMicroSecTimeout)
+{
+	bool bRet = m_pCanItf->receiveMsgTimeout(pCMsg, nMicroSecTimeout);
+
+	if (bRet)
+		countRx(pCMsg, 1);
+
+	return bRet;
+}
+
+//-----------------------------------------------
+int CanItfStats::receiveMsgs(CanMsg* pCMsgs, size_t iMaxMsgs, int nMicroSecTimeout)
+{
+	int iNumMsgs = m_pCanItf->receiveMsgs(pCMsgs, iMaxMsgs, nMicroSecTimeout);
+
+	if (iNumMsgs > 0)
+		countRx(pCMsgs, iNumMsgs);
+
+	return iNumMsgs;
+}
+
+//-----------------------------------------------
+unsigned long CanItfStats::getNumTxErrors()
+{
+	unsigned long iNumTxErrors;
+
+	m_Mutex.lock();
+	iNumTxErrors = m_iNumTxFailed;
+	m_Mutex.unlock();
+
+	return iNumTxErrors + m_pCanItf->getNumTxErrors();
+}
+
+//-----------------------------------------------
+void CanItfStats::countTx(const CanMsg* pCMsgs, int iNumMsgs, int iNumFailed)
+{
+	TimeStamp Now;
+	int iID;
+
+	Now.SetNow();
+
+	m_Mutex.lock();
+
+	m_iNumTxFailed += iNumFailed;
+
+	for (int i = 0; i < iNumMsgs; i++)
+	{
+		m_iNumTxFrames++;
+		m_iNumTxBytes += pCMsgs[i].getLength();
+		m_iNumBusBits += c_iFrameOverheadBits + 8 * pCMsgs[i].getLength();
+
+		// start the latency measurement of the expected responses
+		iID = pCMsgs[i].getID();
+		if ((iID < 0) || (iID >= c_iNumCanIDs))
+			continue;
+
+		for (unsigned int j = 0; j < m_vviResponseIDs[iID].size(); j++)
+		{
+			m_vRequestTime[m_vviResponseIDs[iID][j]] = Now;
+			m_vbRequestPending[m_vviResponseIDs[iID][j]] = true;
+		}
+	}
+
+	m_Mutex.unlock();
+}
+
+//-----------------------------------------------
+void CanItfStats::countRx(const CanMsg* pCMsgs, int iNumMsgs)
+{
+	TimeStamp Now, RecTime;
+	long lSec, lNSec;
+	double dLatencyS;
+	int iID;
+	int iBin;
+
+	Now.SetNow();
+
+	m_Mutex.lock();
+
+	for (int i = 0; i < iNumMsgs; i++)
+	{
+		m_iNumRxFrames++;
+		m_iNumRxBytes += pCMsgs[i].getLength();
+		m_iNumBusBits += c_iFrameOverheadBits + 8 * pCMsgs[i].getLength();
+
+		iID = pCMsgs[i].getID();
+		if ((iID < 0) || (iID >= c_iNumCanIDs) || !m_vbRequestPending[iID])
+			continue;
+
+		// the first response after the request counts, use the receive time of the driver if available
+		m_vbRequestPending[iID] = false;
+		if (pCMsgs[i].hasTimeStamp())
+		{
+			pCMsgs[i].getTimeStamp(lSec, lNSec);
+			RecTime.setTimeStamp(lSec, lNSec);
+		}
+		else
+			RecTime = Now;
+
+		dLatencyS = RecTime - m_vRequestTime[iID];
+		if (dLatencyS < 0)
+			dLatencyS = 0;
+
+		LatencyHistogram& Hist = m_vLatency[m_viResponseChannel[iID]];
+		if ((Hist.iNumSamples == 0) || (dLatencyS < Hist.dMinS))
+			Hist.dMinS = dLatencyS;
+		if ((Hist.iNumSamples == 0) || (dLatencyS > Hist.dMaxS))
+			Hist.dMaxS = dLatencyS;
+		Hist.iNumSamples++;
+		Hist.dSumS += dLatencyS;
+
+		for (iBin = 0; iBin < c_iNumLatencyBins - 1; iBin++)
+		{
+			if (dLatencyS <= c_dLatencyBinUpperS[iBin])
+				break;
+		}
+		Hist.viBins[iBin]++;
+	}
+
+	m_Mutex.unlock();
+}
@@ -0,0 +1,269 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_generic_can
+ * Description: CAN interface decorator running the bus I/O in its own thread
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#include <cob_generic_can/CanItfThread.h>
+#include <cob_utilities/TimeStamp.h>
+#include <cerrno>
+#include <cstring>
+#include <sched.h>
+#include <unistd.h>
+
+//-----------------------------------------------
+CanItfThread::CanItfThread(CanItf* pCanItf, int iPriority, int iQueueSize, int iRxTimeoutUs)
+	: m_TxQueue(iQueueSize), m_RxQueue(iQueueSize)
+{
+	m_pCanItf = pCanItf;
+	m_iPriority = iPriority;
+	m_iRxTimeoutUs = iRxTimeoutUs;
+	m_bRunning = false;
+	m_iNumRxOverruns = 0;
+	m_iNumTxErrors = 0;
+	m_vRxBuf.resize(64);
+	m_vTxBuf.resize(64);
+}
+
+//-----------------------------------------------
+CanItfThread::~CanItfThread()
+{
+	stop();
+	delete m_pCanItf;
+}
+
+//-----------------------------------------------
+bool CanItfThread::init_ret()
+{
+	if (!m_pCanItf->init_ret())
+		return false;
+
+	return start();
+}
+
+//-----------------------------------------------
+void CanItfThread::init()
+{
+	m_pCanItf->init();
+	start();
+}
+
+//-----------------------------------------------
+bool CanItfThread::start()
+{
+	pthread_attr_t attr;
+	int iRet;
+
+	if (m_bRunning)
+		return true;
+
+	m_bRunning = true;
+
+	pthread_attr_init(&attr);
+	if (m_iPriority > 0)
+	{
+		sched_param param;
+		param.sched_priority = m_iPriority;
+		pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+		pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+		pthread_attr_setschedparam(&attr, &param);
+	}
+
+	iRet = pthread_create(&m_hThread, &attr, &CanItfThread::threadFunc, this);
+
+	if ((iRet == EPERM) && (m_iPriority > 0))
+	{
+		// no permission for real-time scheduling -> fall back to default scheduler
+		std::cout << "CanItfThread::start(): no permission for SCHED_FIFO priority " << m_iPriority
+			<< ", starting I/O thread with default scheduler" << std::endl;
+		pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+		iRet = pthread_create(&m_hThread, &attr, &CanItfThread::threadFunc, this);
+	}
+	pthread_attr_destroy(&attr);
+
+	if (iRet != 0)
+	{
+		std::cout << "CanItfThread::start(): could not create I/O thread: " << strerror(iRet) << std::endl;
+		m_bRunning = false;
+		return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------
+void CanItfThread::stop()
+{
+	if (!m_bRunning)
+		return;
+
+	m_bRunning = false;
+	pthread_join(m_hThread, NULL);
+}
+
+//-----------------------------------------------
+bool CanItfThread::transmitMsg(const CanMsg& CMsg, bool bBlocking)
+{
+	if (addToBatch(CMsg))
+		return true;
+
+	bool bRet;
+
+	m_TxMutex.lock();
+	bRet = m_TxQueue.push(CMsg);
+	m_TxMutex.unlock();
+
+	return bRet;
+}
+
+//-----------------------------------------------
+int CanItfThread::transmitMsgs(const CanMsg* pCMsgs, size_t iNumMsgs, bool bBlocking)
+{
+	size_t iNumQueued;
+
+	if (isBatching())
+		return CanItf::transmitMsgs(pCMsgs, iNumMsgs, bBlocking);
+
+	// the I/O thread sees all messages of the burst at once
+	m_TxMutex.lock();
+	iNumQueued = m_TxQueue.push(pCMsgs, iNumMsgs);
+	m_TxMutex.unlock();
+
+	return (int)iNumQueued;
+}
+
+//-----------------------------------------------
+bool CanItfThread::receiveMsg(CanMsg* pCMsg)
+{
+	bool bRet;
+
+	m_RxMutex.lock();
+	bRet = m_RxQueue.pop(*pCMsg);
+	m_RxMutex.unlock();
+
+	return bRet;
+}
+
+//-----------------------------------------------
+bool CanItfThread::receiveMsgRetry(CanMsg* pCMsg, int iNrOfRetry)
+{
+	for (int i = 0; i < iNrOfRetry; i++)
+	{
+		if (receiveMsg(pCMsg))
+			return true;
+		usleep(10000);
+	}
+	return false;
+}
+
+//-----------------------------------------------
+bool CanItfThread::receiveMsgTimeout(CanMsg* pCMsg, int nMicroSecTimeout)
+{
+	return (receiveMsgs(pCMsg, 1, nMicroSecTimeout) == 1);
+}
+
+//-----------------------------------------------
+int CanItfThread::receiveMsgs(CanMsg* pCMsgs, size_t iMaxMsgs, int nMicroSecTimeout)
+{
+	const int iPollUs = 100;
+	size_t iNumMsgs;
+
+	m_RxMutex.lock();
+	iNumMsgs = m_RxQueue.pop(pCMsgs, iMaxMsgs);
+
+	// the queue is filled by the I/O thread -> poll it until the timeout expires
+	for (int iWaitedUs = 0; (iNumMsgs == 0) && (iMaxMsgs > 0) && (iWaitedUs < nMicroSecTimeout); iWaitedUs += iPollUs)
+	{
+		usleep(iPollUs);
+		iNumMsgs = m_RxQueue.pop(pCMsgs, iMaxMsgs);
+	}
+	m_RxMutex.unlock();
+
+	return (int)iNumMsgs;
+}
+
+//-----------------------------------------------
+void* CanItfThread::threadFunc(void* pArg)
+{
+	((CanItfThread*)pArg)->run();
+	return NULL;
+}
+
+//-----------------------------------------------
+void CanItfThread::run()
+{
+	TimeStamp StartRead, EndRead;
+	int iNumMsgs;
+
+	while (m_bRunning)
+	{
+		// send everything queued since the last cycle, bursts in one call
+		while ((iNumMsgs = m_TxQueue.pop(&m_vTxBuf[0], m_vTxBuf.size())) > 0)
+		{
+			m_iNumTxErrors += iNumMsgs - m_pCanItf->transmitMsgs(&m_vTxBuf[0], iNumMsgs, true);
+		}
+
+		// wait a short time for new messages and hand them over to the user
+		StartRead.SetNow();
+		iNumMsgs = m_pCanItf->receiveMsgs(&m_vRxBuf[0], m_vRxBuf.size(), m_iRxTimeoutUs);
+		EndRead.SetNow();
+
+		for (int i = 0; i < iNumMsgs; i++)
+		{
+			if (!m_RxQueue.push(m_vRxBuf[i]))
+				m_iNumRxOverruns++;
+		}
+
+		// interfaces without blocking read return immediately -> don't burn the cpu
+		if ((iNumMsgs == 0) && m_TxQueue.empty() && ((EndRead - StartRead) * 1e6 < 0.5 * m_iRxTimeoutUs))
+			usleep(m_iRxTimeoutUs);
+	}
+}
@@ -150,8 +150,11 @@ void CanPeakSys::init()
 }
 
 //-------------------------------------------
-bool CanPeakSys::transmitMsg(CanMsg CMsg, bool bBlocking)
+bool CanPeakSys::transmitMsg(const CanMsg& CMsg, bool bBlocking)
 {
+	if (addToBatch(CMsg))
+		return true;
+
 	TPCANMsg TPCMsg;
 	bool bRet = true;
 
@@ -161,8 +164,7 @@ bool CanPeakSys::transmitMsg(CanMsg CMsg, bool bBlocking)
 	TPCMsg.LEN = CMsg.m_iLen;
 	TPCMsg.ID = CMsg.m_iID;
 	TPCMsg.MSGTYPE = CMsg.m_iType;
-	for(int i=0; i<8; i++)
-		TPCMsg.DATA[i] = CMsg.getAt(i);
+	memcpy(TPCMsg.DATA, CMsg.getData(), 8);
 
 	// write msg
 	int iRet;
@@ -138,8 +138,11 @@ void CANPeakSysUSB::init()
 }
 
 //-------------------------------------------
-bool CANPeakSysUSB::transmitMsg(CanMsg CMsg, bool bBlocking)
+bool CANPeakSysUSB::transmitMsg(const CanMsg& CMsg, bool bBlocking)
 {
+        if (addToBatch(CMsg))
+                return true;
+
         TPCANMsg TPCMsg;
         bool bRet = true;
 
@@ -149,8 +152,7 @@ bool CANPeakSysUSB::transmitMsg(CanMsg CMsg, bool bBlocking)
         TPCMsg.LEN = CMsg.getLength();
         TPCMsg.ID = CMsg.getID();
         TPCMsg.MSGTYPE = CMsg.getType();
-        for(int i=0; i<8; i++)
-                TPCMsg.DATA[i] = CMsg.getAt(i);
+        memcpy(TPCMsg.DATA, CMsg.getData(), 8);
 
         //TODO Hier stürtzt die Base ab.. verwende libpcan.h pcan.h um Fehler auszulesen, diagnostizieren, ausgeben und CAN_INIT erneut aufzurufen = neustart can-hardware.
 
@@ -311,6 +313,43 @@ bool CANPeakSysUSB::receiveMsgTimeout(CanMsg* pCMsg, int nMicroSecTimeout)
     return bRet;
 }
 
+//-------------------------------------------
+int CANPeakSysUSB::receiveMsgs(CanMsg* pCMsgs, size_t iMaxMsgs, int nMicroSecTimeout)
+{
+        TPCANRdMsg TPCMsg;
+        size_t iNumMsgs = 0;
+        int iRet = CAN_ERR_OK;
+
+        if (m_bInitialized == false) return 0;
+
+        while (iNumMsgs < iMaxMsgs)
+        {
+                // wait only for the first message, afterwards just drain the driver queue
+                iRet = LINUX_CAN_Read_Timeout(m_handle, &TPCMsg, (iNumMsgs == 0) ? nMicroSecTimeout : 0);
+
+                if (iRet != CAN_ERR_OK)
+                {
+                        if( (iRet & (~CAN_ERR_QRCVEMPTY)) != 0) //no"empty-queue"-status
+                                std::cout << "CANPeakSysUSB::receiveMsgs, CAN_STATUS: " << iRet << std::endl;
+                        break;
+                }
+
+                //catch status messages, these could be further processed in overlying software to identify and handle CAN errors
+                if( TPCMsg.Msg.MSGTYPE == MSGTYPE_STATUS ) {
+                        std::cout << "CANPeakSysUSB::receiveMsgs, status message catched:\nData is (CAN_ERROR_...) " << TPCMsg.Msg.DATA[3] << std::endl;
+                        continue;
+                }
+
+                CanMsg& msg = pCMsgs[iNumMsgs++];
+                msg.setID(TPCMsg.Msg.ID);
+                msg.setLength(TPCMsg.Msg.LEN);
+                msg.set(TPCMsg.Msg.DATA[0], TPCMsg.Msg.DATA[1], TPCMsg.Msg.DATA[2], TPCMsg.Msg.DATA[3],
+                        TPCMsg.Msg.DATA[4], TPCMsg.Msg.DATA[5], TPCMsg.Msg.DATA[6], TPCMsg.Msg.DATA[7]);
+        }
+
+        return (int)iNumMsgs;
+}
+
 bool CANPeakSysUSB::initCAN() {
         int ret = CAN_ERR_OK;
         bool bRet = true;
@@ -0,0 +1,282 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_generic_can
+ * Description: Binary memory-mapped trace of CAN frames.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+
+#include <cob_generic_can/CanTrace.h>
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <iostream>
+
+//-----------------------------------------------
+static const char c_cTraceMagic[8] = { 'C', 'O', 'B', 'C', 'A', 'N', 'T', 'R' };
+static const uint32_t c_iTraceVersion = 1;
+// the file is grown by this number of records (1.5 MB)
+static const uint64_t c_iTraceChunkRecords = 65536;
+
+//-----------------------------------------------
+CanTraceWriter::CanTraceWriter()
+{
+	m_iFd = -1;
+	m_iMapSize = 0;
+	m_pHeader = NULL;
+	m_pRecords = NULL;
+	m_iMaxRecords = 0;
+}
+
+//-----------------------------------------------
+CanTraceWriter::~CanTraceWriter()
+{
+	close();
+}
+
+//-----------------------------------------------
+bool CanTraceWriter::open(const std::string& sFileName)
+{
+	close();
+
+	m_iFd = ::open(sFileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (m_iFd < 0)
+	{
+		std::cout << "CanTraceWriter::open(): cannot create " << sFileName << std::endl;
+		return false;
+	}
+
+	if (!grow())
+	{
+		std::cout << "CanTraceWriter::open(): cannot map " << sFileName << std::endl;
+		::close(m_iFd);
+		m_iFd = -1;
+		return false;
+	}
+
+	memcpy(m_pHeader->cMagic, c_cTraceMagic, sizeof(c_cTraceMagic));
+	m_pHeader->iVersion = c_iTraceVersion;
+	m_pHeader->iRecordSize = sizeof(CanTraceRecord);
+	m_pHeader->iNumRecords = 0;
+	m_pHeader->iReserved = 0;
+
+	return true;
+}
+
+//-----------------------------------------------
+void CanTraceWriter::close()
+{
+	off_t iSize;
+
+	if (m_pHeader != NULL)
+	{
+		iSize = sizeof(CanTraceHeader) + m_pHeader->iNumRecords * sizeof(CanTraceRecord);
+		munmap(m_pHeader, m_iMapSize);
+		if (ftruncate(m_iFd, iSize) != 0)
+			std::cout << "CanTraceWriter::close(): cannot truncate the trace" << std::endl;
+	}
+	if (m_iFd >= 0)
+		::close(m_iFd);
+
+	m_iFd = -1;
+	m_iMapSize = 0;
+	m_pHeader = NULL;
+	m_pRecords = NULL;
+	m_iMaxRecords = 0;
+}
+
+//-----------------------------------------------
+bool CanTraceWriter::grow()
+{
+	uint64_t iMaxRecords = m_iMaxRecords + c_iTraceChunkRecords;
+	size_t iMapSize = sizeof(CanTraceHeader) + iMaxRecords * sizeof(CanTraceRecord);
+	void* pMap;
+
+	if (ftruncate(m_iFd, iMapSize) != 0)
+		return false;
+
+	pMap = mmap(NULL, iMapSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_iFd, 0);
+	if (pMap == MAP_FAILED)
+		return false;
+
+	if (m_pHeader != NULL)
+		munmap(m_pHeader, m_iMapSize);
+
+	m_iMapSize = iMapSize;
+	m_pHeader = (CanTraceHeader*)pMap;
+	m_pRecords = (CanTraceRecord*)(m_pHeader + 1);
+	m_iMaxRecords = iMaxRecords;
+
+	return true;
+}
+
+//-----------------------------------------------
+bool CanTraceWriter::write(const CanMsg& CMsg, int iDir, long lSec, long lNSec)
+{
+	CanTraceRecord* pRec;
+
+	if (m_pHeader == NULL)
+		return false;
+
+	if ((m_pHeader->iNumRecords == m_iMaxRecords) && !grow())
+	{
+		std::cout << "CanTraceWriter::write(): cannot grow the trace, closing it" << std::endl;
+		close();
+		return false;
+	}
+
+	pRec = &m_pRecords[m_pHeader->iNumRecords];
+	pRec->iTimeStampNSec = (int64_t)lSec * 1000000000LL + lNSec;
+	pRec->iID = CMsg.getID();
+	pRec->iLen = CMsg.getLength();
+	pRec->iDir = iDir;
+	pRec->bPad[0] = 0;
+	pRec->bPad[1] = 0;
+	memcpy(pRec->bDat, CMsg.getData(), 8);
+
+	// publish the record by counting it
+	m_pHeader->iNumRecords++;
+
+	return true;
+}
+
+//-----------------------------------------------
+CanTraceReader::CanTraceReader()
+{
+	m_iFd = -1;
+	m_iMapSize = 0;
+	m_pMap = NULL;
+	m_pRecords = NULL;
+	m_iNumRecords = 0;
+}
+
+//-----------------------------------------------
+CanTraceReader::~CanTraceReader()
+{
+	close();
+}
+
+//-----------------------------------------------
+bool CanTraceReader::open(const std::string& sFileName)
+{
+	struct stat FileStat;
+	const CanTraceHeader* pHeader;
+	uint64_t iNumRecordsInFile;
+
+	close();
+
+	m_iFd = ::open(sFileName.c_str(), O_RDONLY);
+	if (m_iFd < 0)
+	{
+		std::cout << "CanTraceReader::open(): cannot open " << sFileName << std::endl;
+		return false;
+	}
+
+	if ((fstat(m_iFd, &FileStat) != 0) || (FileStat.st_size < (off_t)sizeof(CanTraceHeader)))
+	{
+		std::cout << "CanTraceReader::open(): " << sFileName << " is no CAN trace" << std::endl;
+		close();
+		return false;
+	}
+
+	m_iMapSize = FileStat.st_size;
+	m_pMap = mmap(NULL, m_iMapSize, PROT_READ, MAP_PRIVATE, m_iFd, 0);
+	if (m_pMap == MAP_FAILED)
+	{
+		std::cout << "CanTraceReader::open(): cannot map " << sFileName << std::endl;
+		m_pMap = NULL;
+		close();
+		return false;
+	}
+
+	pHeader = (const CanTraceHeader*)m_pMap;
+	if ((memcmp(pHeader->cMagic, c_cTraceMagic, sizeof(c_cTraceMagic)) != 0)
+		|| (pHeader->iVersion != c_iTraceVersion) || (pHeader->iRecordSize != sizeof(CanTraceRecord)))
+	{
+		std::cout << "CanTraceReader::open(): " << sFileName << " is no CAN trace of version " << c_iTraceVersion << std::endl;
+		close();
+		return false;
+	}
+
+	// the file of an aborted recording is larger than the records written
+	iNumRecordsInFile = (m_iMapSize - sizeof(CanTraceHeader)) / sizeof(CanTraceRecord);
+	m_iNumRecords = (pHeader->iNumRecords < iNumRecordsInFile) ? pHeader->iNumRecords : iNumRecordsInFile;
+	m_pRecords = (const CanTraceRecord*)(pHeader + 1);
+
+	return true;
+}
+
+//-----------------------------------------------
+void CanTraceReader::close()
+{
+	if (m_pMap != NULL)
+		munmap(m_pMap, m_iMapSize);
+	if (m_iFd >= 0)
+		::close(m_iFd);
+
+	m_iFd = -1;
+	m_iMapSize = 0;
+	m_pMap = NULL;
+	m_pRecords = NULL;
+	m_iNumRecords = 0;
+}
+
+//-----------------------------------------------
+void CanTraceReader::toCanMsg(const CanTraceRecord& Rec, CanMsg* pCMsg)
+{
+	pCMsg->setID(Rec.iID);
+	pCMsg->setLength(Rec.iLen);
+	pCMsg->setType(0);
+	pCMsg->setData(Rec.bDat);
+	pCMsg->setTimeStamp(Rec.iTimeStampNSec / 1000000000LL, Rec.iTimeStampNSec % 1000000000LL);
+}
@@ -46,51 +46,92 @@
 #include <stdlib.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <linux/can/raw.h>
+#include <poll.h>
 #include <fcntl.h>
 #include <unistd.h>
 
+// CanMsg is sent and received without conversion, see CanMsg.h
+typedef char CanMsgFrameSizeCheck[(sizeof(struct can_frame) == CanMsg::c_iFrameSize) ? 1 : -1];
+
 SocketCan::SocketCan(const char* device, int baudrate)
 {
     m_bInitialized = false;
+    m_iSocket = -1;
 
     p_cDevice = device;
-    m_handle.reset(new can::ThreadedSocketCANInterface());
 }
 
 SocketCan::SocketCan(const char* device)
 {
     m_bInitialized = false;
+    m_iSocket = -1;
 
     p_cDevice = device;
-    m_handle.reset(new can::ThreadedSocketCANInterface());
 }
 
 //-----------------------------------------------
 SocketCan::~SocketCan()
 {
-    if (m_bInitialized)
+    if (m_iSocket >= 0)
     {
-        m_handle->shutdown();
+        close(m_iSocket);
     }
 }
 
 //-----------------------------------------------
 bool SocketCan::init_ret()
 {
-    bool ret = true;
-    if (!m_handle->init(p_cDevice, false))
+    struct ifreq ifr;
+    struct sockaddr_can addr;
+    int iOn = 1;
+
+    m_iSocket = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (m_iSocket < 0)
+    {
+        std::cout << "ERROR: SocketCan::init_ret(): could not create socket: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, p_cDevice, IFNAMSIZ - 1);
+    if (ioctl(m_iSocket, SIOCGIFINDEX, &ifr) < 0)
+    {
+        std::cout << "ERROR: SocketCan::init_ret(): unknown device " << p_cDevice << ": " << strerror(errno) << std::endl;
+        close(m_iSocket);
+        m_iSocket = -1;
+        return false;
+    }
+
+    // receive time of every message is measured by the kernel
+    if (setsockopt(m_iSocket, SOL_SOCKET, SO_TIMESTAMP, &iOn, sizeof(iOn)) < 0)
     {
-        print_error(m_handle->getState());
-        ret = false;
+        std::cout << "WARNING: SocketCan::init_ret(): no receive timestamps: " << strerror(errno) << std::endl;
     }
-    else
+
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(m_iSocket, (struct sockaddr*)&addr, sizeof(addr)) < 0)
     {
-        m_reader.listen((boost::shared_ptr<can::CommInterface>) m_handle);
-        m_bInitialized = true;
-        bool bRet = true;
-        ret = true;
+        std::cout << "ERROR: SocketCan::init_ret(): could not bind to " << p_cDevice << ": " << strerror(errno) << std::endl;
+        close(m_iSocket);
+        m_iSocket = -1;
+        return false;
     }
-    return ret;
+
+    m_bInitialized = true;
+
+    // install the filter set before init
+    if (!m_vFilter.empty())
+    {
+        applyFilter();
+    }
+
+    return true;
 }
 
 //-----------------------------------------------
@@ -105,37 +146,73 @@ void SocketCan::init()
 
 
 //-------------------------------------------
-bool SocketCan::transmitMsg(CanMsg CMsg, bool bBlocking)
+bool SocketCan::transmitMsg(const CanMsg& CMsg, bool bBlocking)
 {
-    can::Header header(CMsg.getID(), false, false, false);
-    can::Frame message(header, CMsg.getLength());
-    for (int i = 0; i < CMsg.getLength(); i++)
+    if (addToBatch(CMsg))
     {
-        message.data[i] = CMsg.getAt(i);
+        return true;
     }
-    return m_handle->send(message);
+
+    if (!m_bInitialized)
+    {
+        return false;
+    }
+
+    // CanMsg starts with the layout of struct can_frame -> hand it to the kernel as it is
+    return (send(m_iSocket, CMsg.getFrame(), sizeof(struct can_frame), bBlocking ? 0 : MSG_DONTWAIT) == sizeof(struct can_frame));
 }
 
 //-------------------------------------------
-bool SocketCan::receiveMsg(CanMsg* pCMsg)
+int SocketCan::transmitMsgs(const CanMsg* pCMsgs, size_t iNumMsgs, bool bBlocking)
 {
+    size_t iNumSent = 0;
+    int iRet;
+
     if (!m_bInitialized)
     {
-        return false;
+        return 0;
     }
 
-    bool bRet = false;
-    can::Frame frame;
+    if (isBatching())
+    {
+        return CanItf::transmitMsgs(pCMsgs, iNumMsgs, bBlocking);
+    }
 
-    if (m_reader.read(&frame, boost::chrono::seconds(1)))
+    m_vTxHdr.resize(iNumMsgs);
+    m_vTxIov.resize(iNumMsgs);
+    for (size_t i = 0; i < iNumMsgs; i++)
     {
-        pCMsg->setID(frame.id);
-        pCMsg->setLength(frame.dlc);
-        pCMsg->set(frame.data[0], frame.data[1], frame.data[2], frame.data[3],
-                   frame.data[4], frame.data[5], frame.data[6], frame.data[7]);
-        bRet = true;
+        m_vTxIov[i].iov_base = const_cast<void*>(pCMsgs[i].getFrame());
+        m_vTxIov[i].iov_len = sizeof(struct can_frame);
+
+        memset(&m_vTxHdr[i], 0, sizeof(struct mmsghdr));
+        m_vTxHdr[i].msg_hdr.msg_iov = &m_vTxIov[i];
+        m_vTxHdr[i].msg_hdr.msg_iovlen = 1;
     }
-    return bRet;
+
+    // all frames with one syscall, sendmmsg may stop early if the tx queue is full
+    while (iNumSent < iNumMsgs)
+    {
+        iRet = sendmmsg(m_iSocket, &m_vTxHdr[iNumSent], iNumMsgs - iNumSent, bBlocking ? 0 : MSG_DONTWAIT);
+        if (iRet <= 0)
+        {
+            break;
+        }
+        iNumSent += iRet;
+    }
+
+    return (int)iNumSent;
+}
+
+//-------------------------------------------
+bool SocketCan::receiveMsg(CanMsg* pCMsg)
+{
+    if (!m_bInitialized)
+    {
+        return false;
+    }
+
+    return readFrame(pCMsg, 1000000);
 }
 
 //-------------------------------------------
@@ -146,18 +223,13 @@ bool SocketCan::receiveMsgRetry(CanMsg* pCMsg, int iNrOfRetry)
         return false;
     }
 
-    can::Frame frame;
     bool bRet = false;
     int i = 0;
 
     do
     {
-        if (m_reader.read(&frame, boost::chrono::milliseconds(10)))
-        { 
-            pCMsg->setID(frame.id);
-            pCMsg->setLength(frame.dlc);
-            pCMsg->set(frame.data[0], frame.data[1], frame.data[2], frame.data[3],
-                       frame.data[4], frame.data[5], frame.data[6], frame.data[7]);
+        if (readFrame(pCMsg, 10000))
+        {
             bRet = true;
             break;
         }
@@ -175,23 +247,139 @@ bool SocketCan::receiveMsgTimeout(CanMsg* pCMsg, int nMicroSecTimeout)
         return false;
     }
 
-    bool bRet = false;
-    can::Frame frame;
+    return readFrame(pCMsg, nMicroSecTimeout);
+}
 
-    if (m_reader.read(&frame, boost::chrono::microseconds(nMicroSecTimeout)))
+//-------------------------------------------
+int SocketCan::receiveMsgs(CanMsg* pCMsgs, size_t iMaxMsgs, int nMicroSecTimeout)
+{
+    if (!m_bInitialized || iMaxMsgs == 0)
     {
-        pCMsg->setID(frame.id);
-        pCMsg->setLength(frame.dlc);
-        pCMsg->set(frame.data[0], frame.data[1], frame.data[2], frame.data[3], frame.data[4], frame.data[5], frame.data[6], frame.data[7]);
-        bRet = true;
+        return 0;
     }
-    return bRet;
+
+    size_t iNumMsgs = 0;
+
+    // only the first read may wait, afterwards drain what is already in the socket buffer
+    if (!readFrame(&pCMsgs[0], nMicroSecTimeout))
+    {
+        return 0;
+    }
+    iNumMsgs++;
+
+    while (iNumMsgs < iMaxMsgs && readFrame(&pCMsgs[iNumMsgs], 0))
+    {
+        iNumMsgs++;
+    }
+
+    return (int)iNumMsgs;
 }
 
-void SocketCan::print_error(const can::State& state)
+//-------------------------------------------
+bool SocketCan::setFilter(const std::vector<int>& viCanIDs)
 {
-    std::string err;
-    std::cout << "ERROR: state=" << std::endl;
-    m_handle->translateError(state.internal_error, err);
-    std::cout << "ERROR: state=" << state.driver_state << " internal_error=" << state.internal_error << "('" << err << "') asio: " << state.error_code << std::endl;
+    m_vFilter.resize(viCanIDs.size());
+    for (unsigned int i = 0; i < viCanIDs.size(); i++)
+    {
+        // exact match of standard data frames
+        m_vFilter[i].can_id = viCanIDs[i];
+        m_vFilter[i].can_mask = CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG;
+    }
+
+    if (!m_bInitialized)
+    {
+        // installed by init_ret()
+        return !m_vFilter.empty();
+    }
+
+    return applyFilter();
+}
+
+//-------------------------------------------
+bool SocketCan::applyFilter()
+{
+    struct can_filter AcceptAll;
+    int iRet;
+
+    if (m_vFilter.empty())
+    {
+        AcceptAll.can_id = 0;
+        AcceptAll.can_mask = 0;
+        setsockopt(m_iSocket, SOL_CAN_RAW, CAN_RAW_FILTER, &AcceptAll, sizeof(AcceptAll));
+        return false;
+    }
+
+    iRet = setsockopt(m_iSocket, SOL_CAN_RAW, CAN_RAW_FILTER, &m_vFilter[0], m_vFilter.size() * sizeof(struct can_filter));
+    if (iRet < 0)
+    {
+        std::cout << "ERROR: SocketCan::setFilter(): could not set CAN_RAW_FILTER: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------
+bool SocketCan::readFrame(CanMsg* pCMsg, int nMicroSecTimeout)
+{
+    struct iovec iov;
+    struct msghdr msg;
+    struct cmsghdr* pCmsg;
+    struct timeval tv;
+    char cCtrl[CMSG_SPACE(sizeof(struct timeval))];
+    ssize_t iNumBytes;
+
+    if (nMicroSecTimeout > 0)
+    {
+        struct pollfd pfd;
+        struct timespec timeout;
+
+        pfd.fd = m_iSocket;
+        pfd.events = POLLIN;
+        timeout.tv_sec = nMicroSecTimeout / 1000000;
+        timeout.tv_nsec = (nMicroSecTimeout % 1000000) * 1000;
+
+        if (ppoll(&pfd, 1, &timeout, NULL) <= 0)
+        {
+            return false;
+        }
+    }
+
+    while (true)
+    {
+        // the kernel writes the frame directly into the message
+        iov.iov_base = pCMsg->getFrame();
+        iov.iov_len = sizeof(struct can_frame);
+
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = cCtrl;
+        msg.msg_controllen = sizeof(cCtrl);
+
+        iNumBytes = recvmsg(m_iSocket, &msg, MSG_DONTWAIT);
+        if (iNumBytes < (ssize_t)sizeof(struct can_frame))
+        {
+            return false;
+        }
+
+        // only standard data frames are handled by CanMsg
+        if ((pCMsg->m_iID & (CAN_EFF_FLAG | CAN_RTR_FLAG | CAN_ERR_FLAG)) == 0)
+        {
+            break;
+        }
+    }
+
+    pCMsg->setTimeStamp(0, 0);
+
+    for (pCmsg = CMSG_FIRSTHDR(&msg); pCmsg != NULL; pCmsg = CMSG_NXTHDR(&msg, pCmsg))
+    {
+        if ((pCmsg->cmsg_level == SOL_SOCKET) && (pCmsg->cmsg_type == SO_TIMESTAMP))
+        {
+            memcpy(&tv, CMSG_DATA(pCmsg), sizeof(tv));
+            pCMsg->setTimeStamp(tv.tv_sec, tv.tv_usec * 1000);
+        }
+    }
+
+    return true;
 }
@@ -0,0 +1,370 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_generic_can
+ * Description: Microbenchmark of the CanMsg transmit and receive paths.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#include <linux/can.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include <cob_generic_can/CanDummy.h>
+#include <cob_utilities/TimeStamp.h>
+
+//-----------------------------------------------
+static void printUsage()
+{
+	std::cout << "usage: cob_generic_can_bench_can_msg [options]" << std::endl
+		<< "  Compares the frames per second of the CanMsg before the can_frame layout (old) and of the current one (new)." << std::endl
+		<< "  copy:     a backend copies the message into the driver structure (struct can_frame) and back," << std::endl
+		<< "            old: passed by value and copied byte by byte via getAt()/set(), new: const reference and memcpy()" << std::endl
+		<< "  CanDummy: burst of frames transmitted to a CanDummy with a node answering each frame, answers received in bulk," << std::endl
+		<< "            old: the messages are converted like above at the interface, new: passed through" << std::endl
+		<< "  --burst <n>   frames per burst (default 16)" << std::endl
+		<< "  --repeat <n>  bursts (default 100000)" << std::endl;
+}
+
+//-----------------------------------------------
+/**
+ * CanMsg as it was before it got the can_frame layout (reference of the old path).
+ */
+class CanMsgOld
+{
+public:
+	typedef unsigned char BYTE;
+	int m_iID;
+	int m_iLen;
+	int m_iType;
+
+protected:
+	BYTE m_bDat[8];
+
+public:
+	CanMsgOld()
+	{
+		m_iID = 0;
+		m_iLen = 8;
+		m_iType = 0x00;
+	}
+
+	void set(BYTE Data0=0, BYTE Data1=0, BYTE Data2=0, BYTE Data3=0, BYTE Data4=0, BYTE Data5=0, BYTE Data6=0, BYTE Data7=0)
+	{
+		m_bDat[0] = Data0;
+		m_bDat[1] = Data1;
+		m_bDat[2] = Data2;
+		m_bDat[3] = Data3;
+		m_bDat[4] = Data4;
+		m_bDat[5] = Data5;
+		m_bDat[6] = Data6;
+		m_bDat[7] = Data7;
+	}
+
+	int getAt(int iNr)
+	{
+		return m_bDat[iNr];
+	}
+
+	int getID()
+	{
+		return m_iID;
+	}
+
+	void setID(int id)
+	{
+		if( (0 <= id) && (id <= 2047) )
+			m_iID = id;
+	}
+
+	int getLength()
+	{
+		return m_iLen;
+	}
+
+	void setLength(int len)
+	{
+		if( (0 <= len) && (len <= 8) )
+			m_iLen = len;
+	}
+};
+
+//-----------------------------------------------
+// backend of the old interface: message by value, copied into the driver structure byte by byte
+class FrameSinkOld
+{
+public:
+	virtual ~FrameSinkOld() {}
+	virtual bool transmitMsg(CanMsgOld CMsg, bool bBlocking = true) = 0;
+	virtual bool receiveMsg(CanMsgOld* pCMsg) = 0;
+};
+
+class FrameSinkOldImpl : public FrameSinkOld
+{
+public:
+	struct can_frame m_Frame;
+
+	bool transmitMsg(CanMsgOld CMsg, bool bBlocking)
+	{
+		m_Frame.can_id = CMsg.getID();
+		m_Frame.can_dlc = CMsg.getLength();
+		for (int i = 0; i < 8; i++)
+			m_Frame.data[i] = CMsg.getAt(i);
+		return true;
+	}
+
+	bool receiveMsg(CanMsgOld* pCMsg)
+	{
+		pCMsg->setID(m_Frame.can_id);
+		pCMsg->setLength(m_Frame.can_dlc);
+		pCMsg->set(m_Frame.data[0], m_Frame.data[1], m_Frame.data[2], m_Frame.data[3],
+			m_Frame.data[4], m_Frame.data[5], m_Frame.data[6], m_Frame.data[7]);
+		return true;
+	}
+};
+
+// backend of the current interface: message by const reference, copied with memcpy()
+class FrameSinkNew
+{
+public:
+	virtual ~FrameSinkNew() {}
+	virtual bool transmitMsg(const CanMsg& CMsg, bool bBlocking = true) = 0;
+	virtual bool receiveMsg(CanMsg* pCMsg) = 0;
+};
+
+class FrameSinkNewImpl : public FrameSinkNew
+{
+public:
+	struct can_frame m_Frame;
+
+	bool transmitMsg(const CanMsg& CMsg, bool bBlocking)
+	{
+		memcpy(&m_Frame, CMsg.getFrame(), sizeof(m_Frame));
+		return true;
+	}
+
+	bool receiveMsg(CanMsg* pCMsg)
+	{
+		memcpy(pCMsg->getFrame(), &m_Frame, sizeof(m_Frame));
+		return true;
+	}
+};
+
+//-----------------------------------------------
+// simulated node answering each frame with the same data on ID + 0x80 (like a drive answering on its TxPDO)
+class EchoNode : public CanDummyNode
+{
+public:
+	void evalMsg(const CanMsg& CMsg, std::vector<CanMsg>& vReplies)
+	{
+		vReplies.push_back(CMsg);
+		vReplies.back().m_iID = (CMsg.m_iID + 0x80) & 0x7FF;
+	}
+};
+
+// the old CanMsg at a CanDummy: converted byte by byte on the way in and out, like the backends did
+class CanDummyOld
+{
+public:
+	CanDummyOld(CanDummy* pCanDummy) : m_pCanDummy(pCanDummy) {}
+
+	bool transmitMsg(CanMsgOld CMsg, bool bBlocking = true)
+	{
+		CanMsg Msg;
+		Msg.setID(CMsg.getID());
+		Msg.setLength(CMsg.getLength());
+		for (int i = 0; i < 8; i++)
+			Msg.setAt(CMsg.getAt(i), i);
+		return m_pCanDummy->transmitMsg(Msg, bBlocking);
+	}
+
+	int receiveMsgs(CanMsgOld* pCMsgs, size_t iMaxMsgs)
+	{
+		int iNumMsgs = m_pCanDummy->receiveMsgs(m_Buf, std::min(iMaxMsgs, (size_t)c_iBufSize));
+		for (int i = 0; i < iNumMsgs; i++)
+		{
+			const CanMsg::BYTE* pDat = m_Buf[i].getData();
+			pCMsgs[i].setID(m_Buf[i].getID());
+			pCMsgs[i].setLength(m_Buf[i].getLength());
+			pCMsgs[i].set(pDat[0], pDat[1], pDat[2], pDat[3], pDat[4], pDat[5], pDat[6], pDat[7]);
+		}
+		return iNumMsgs;
+	}
+
+private:
+	static const int c_iBufSize = 64;
+	CanDummy* m_pCanDummy;
+	CanMsg m_Buf[c_iBufSize];
+};
+
+//-----------------------------------------------
+static void printResult(const char* sName, const char* sPath, long iNumFrames, double dTimeS)
+{
+	printf("%-9s %-4s %12.0f frames/s %8.1f ns/frame\n", sName, sPath, iNumFrames / dTimeS, 1e9 * dTimeS / iNumFrames);
+}
+
+//-----------------------------------------------
+int main(int argc, char** argv)
+{
+	int iBurst = 16;
+	int iRepeat = 100000;
+
+	for (int i = 1; i < argc; i++)
+	{
+		bool bValue = (i + 1 < argc);
+
+		if (bValue && (strcmp(argv[i], "--burst") == 0))
+			iBurst = atoi(argv[++i]);
+		else if (bValue && (strcmp(argv[i], "--repeat") == 0))
+			iRepeat = atoi(argv[++i]);
+		else
+		{
+			printUsage();
+			return 1;
+		}
+	}
+	if ((iBurst < 1) || (iBurst > 64) || (iRepeat < 1))
+	{
+		printUsage();
+		return 1;
+	}
+
+	const long iNumFrames = (long)iBurst * iRepeat;
+	std::vector<CanMsgOld> vOld(iBurst);
+	std::vector<CanMsg> vNew(iBurst);
+	TimeStamp Start, End;
+	long iSum = 0;
+
+	for (int i = 0; i < iBurst; i++)
+	{
+		vOld[i].setID(0x201 + i);
+		vOld[i].set(i, 1, 2, 3, 4, 5, 6, 7);
+		vNew[i].setID(0x201 + i);
+		vNew[i].set(i, 1, 2, 3, 4, 5, 6, 7);
+	}
+
+	printf("# %d frames per burst, %d bursts\n", iBurst, iRepeat);
+
+	// copy into the driver structure and back
+	{
+		FrameSinkOld* pOld = new FrameSinkOldImpl;
+		FrameSinkNew* pNew = new FrameSinkNewImpl;
+		CanMsgOld MsgOld;
+		CanMsg MsgNew;
+
+		Start.SetNow();
+		for (int r = 0; r < iRepeat; r++)
+		{
+			for (int i = 0; i < iBurst; i++)
+			{
+				pOld->transmitMsg(vOld[i]);
+				pOld->receiveMsg(&MsgOld);
+				iSum += MsgOld.getAt(0);
+			}
+		}
+		End.SetNow();
+		printResult("copy", "old", iNumFrames, End - Start);
+
+		Start.SetNow();
+		for (int r = 0; r < iRepeat; r++)
+		{
+			for (int i = 0; i < iBurst; i++)
+			{
+				pNew->transmitMsg(vNew[i]);
+				pNew->receiveMsg(&MsgNew);
+				iSum += MsgNew.getAt(0);
+			}
+		}
+		End.SetNow();
+		printResult("copy", "new", iNumFrames, End - Start);
+
+		delete pOld;
+		delete pNew;
+	}
+
+	// round trip through CanDummy
+	{
+		CanDummy Dummy;
+		CanDummyOld DummyOld(&Dummy);
+		std::vector<CanMsgOld> vRxOld(iBurst);
+		std::vector<CanMsg> vRxNew(iBurst);
+
+		Dummy.addNode(new EchoNode);
+
+		Start.SetNow();
+		for (int r = 0; r < iRepeat; r++)
+		{
+			for (int i = 0; i < iBurst; i++)
+				DummyOld.transmitMsg(vOld[i]);
+			iSum += DummyOld.receiveMsgs(&vRxOld[0], iBurst);
+		}
+		End.SetNow();
+		printResult("CanDummy", "old", iNumFrames, End - Start);
+
+		Start.SetNow();
+		for (int r = 0; r < iRepeat; r++)
+		{
+			for (int i = 0; i < iBurst; i++)
+				Dummy.transmitMsg(vNew[i]);
+			iSum += Dummy.receiveMsgs(&vRxNew[0], iBurst);
+		}
+		End.SetNow();
+		printResult("CanDummy", "new", iNumFrames, End - Start);
+	}
+
+	// keeps the loops from being optimized away
+	if (iSum == 12345)
+		std::cout << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,168 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_undercarriage_ctrl
+ * Description: Integrates the odometry of the undercarriage and propagates its covariance
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+#ifndef OdometryIntegrator_INCLUDEDEF_H
+#define OdometryIntegrator_INCLUDEDEF_H
+
+/**
+ * Integrates the platform velocity calculated by the direct kinematics to the odometric pose
+ * and propagates the covariance of the pose.
+ * Each sample carries the time stamp of the wheel measurement it was calculated from. Between two samples
+ * the mean of their twists is taken as constant and integrated with the exact exponential on SE(2),
+ * so the pose does not depend on the rate the samples come in.
+ * Samples arriving out of order are sorted into a short history and the pose is recalculated from there,
+ * duplicates and samples older than the history are dropped.
+ * All values in m, rad and s; velocities in the robot frame, pose in the odometry frame.
+ */
+class OdometryIntegrator
+{
+public:
+	/// Number of samples kept to sort in samples arriving out of order.
+	static const int c_iSizeHistory = 32;
+
+	/**
+	 * Noise model of the odometry.
+	 */
+	struct ParamType
+	{
+		/// variance of the travelled distance per travelled distance in m^2/m (along the motion)
+		double dVarLinPerM;
+		/// variance of the heading per turned angle in rad^2/rad
+		double dVarRotPerRad;
+		/// variance of the heading per travelled distance in rad^2/m
+		double dVarRotPerM;
+		/// correlation time of the velocity errors estimated from the wheel slip in s
+		double dSlipCorrTimeS;
+	};
+
+	/**
+	 * Pose, twist and covariance after the last sample.
+	 */
+	struct PoseType
+	{
+		double dStampS;
+		double dXM;
+		double dYM;
+		double dThetaRad;
+		double dVelXMS;
+		double dVelYMS;
+		double dRotRadS;
+		/// variance of each of the linear velocities and of the rotational rate
+		double dVarVelM2S2;
+		double dVarRotRad2S2;
+		/// covariance of (x, y, theta)
+		double dCov[3][3];
+	};
+
+	OdometryIntegrator();
+
+	void setParam(const ParamType& Param);
+	const ParamType& getParam() const { return m_Param; }
+
+	/**
+	 * Sets the pose and its covariance to zero and clears the history.
+	 */
+	void reset();
+
+	/**
+	 * Adds the platform velocity calculated from the wheel measurement at time dStampS.
+	 * @param dVarVelM2S2 variance of each of the linear velocities in (m/s)^2
+	 * @param dVarRotRad2S2 variance of the rotational rate in (rad/s)^2
+	 * @return true if the pose has been updated, false if the sample has been dropped
+	 */
+	bool addSample(double dStampS, double dVelXMS, double dVelYMS, double dRotRadS,
+		double dVarVelM2S2, double dVarRotRad2S2);
+
+	const PoseType& getPose() const { return m_Pose; }
+
+	/// Number of samples dropped because they are older than the history.
+	int getNumDropped() const { return m_iNumDropped; }
+	/// Number of samples dropped because a sample with the same time stamp exists.
+	int getNumDuplicates() const { return m_iNumDuplicates; }
+	/// Number of samples sorted into the history.
+	int getNumReordered() const { return m_iNumReordered; }
+
+private:
+	struct SampleType
+	{
+		double dStampS;
+		double dVelXMS, dVelYMS, dRotRadS;
+		double dVarVelM2S2, dVarRotRad2S2;
+		// pose and covariance after integration up to this sample
+		double dXM, dYM, dThetaRad;
+		double dCov[3][3];
+	};
+
+	ParamType m_Param;
+	PoseType m_Pose;
+
+	// ring buffer, m_iFirst is the oldest sample
+	SampleType m_History[c_iSizeHistory];
+	int m_iFirst;
+	int m_iNumSamples;
+
+	int m_iNumDropped;
+	int m_iNumDuplicates;
+	int m_iNumReordered;
+	int m_iNumDroppedInRow;
+
+	SampleType& sample(int i) { return m_History[(m_iFirst + i) % c_iSizeHistory]; }
+
+	// integrates from the pose of Prev to Next and stores the result in Next
+	void integrate(const SampleType& Prev, SampleType& Next) const;
+
+	// copies the newest sample to m_Pose
+	void updatePose();
+};
+
+#endif
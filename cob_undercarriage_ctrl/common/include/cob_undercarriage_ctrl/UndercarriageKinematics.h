@@ -0,0 +1,720 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_undercarriage_ctrl
+ * Description: Kinematics and steering control of an undercarriage with N steered wheels.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+#ifndef UndercarriageKinematics_INCLUDEDEF_H
+#define UndercarriageKinematics_INCLUDEDEF_H
+
+#include <cmath>
+#include <cob_utilities/MathSup.h>
+
+/**
+ * Interface of the kinematics core, UndercarriageCtrlGeom uses it to dispatch
+ * to the implementation for the configured number of wheels.
+ * All arrays passed to or returned by the interface have one value per wheel.
+ */
+class UndercarriageKinematicsItf
+{
+public:
+	/// Largest number of wheels create() has an implementation for.
+	static const int c_iMaxNumWheels = 8;
+
+	/**
+	 * Parameters common to all wheels.
+	 */
+	struct ParamType
+	{
+		int iRadiusWheelMM;
+		int iDistSteerAxisToDriveWheelMM;
+
+		double dMaxDriveRateRadpS;
+		double dMaxSteerRateRadpS;
+		double dCmdRateS;
+
+		/** ------- Position Controller Steer Wheels -------
+		 * Impedance-Ctrlr Prms
+		 *  -> model Stiffness via Spring-Damper-Modell
+		 *  -> only oriented at impedance-ctrl (no forces commanded)
+		 *  dSpring	Spring-constant (elasticity)
+		 *  dDamp	Damping coefficient (also prop. for Velocity Feedforward)
+		 *  dVirtM	Virtual Mass of Spring-Damper System
+		 *  dDPhiMax	maximum angular velocity (cut-off)
+		 *  dDDPhiMax	maximum angular acceleration (cut-off)
+		 */
+		double dSpring, dDamp, dVirtM, dDPhiMax, dDDPhiMax;
+	};
+
+	virtual ~UndercarriageKinematicsItf() {}
+
+	/**
+	 * Creates the kinematics for iNumWheels wheels (2..c_iMaxNumWheels).
+	 * @return NULL if the number of wheels is not supported
+	 */
+	static UndercarriageKinematicsItf* create(int iNumWheels);
+
+	/**
+	 * Returns a copy of the kinematics including the controller states.
+	 */
+	virtual UndercarriageKinematicsItf* clone() const = 0;
+
+	virtual int getNumWheels() const = 0;
+
+	virtual void setParam(const ParamType& Param) = 0;
+	virtual const ParamType& getParam() const = 0;
+
+	/**
+	 * Sets position of the steering axis of a wheel, coupling between steering and drive
+	 * and the neutral position of the steering. Call init() after all wheels are set.
+	 */
+	virtual void setWheel(int iWheel, double dXPosMM, double dYPosMM, double dSteerDriveCoupling, double dNeutralPosRad) = 0;
+
+	/**
+	 * Calculates the values derived from the parameters and resets the steering to the neutral positions.
+	 */
+	virtual void init() = 0;
+
+	/**
+	 * Sets the measured values of the wheels and calculates the direct kinematics.
+	 */
+	virtual void setActualWheelValues(const double* pdVelGearDriveRadS, const double* pdVelGearSteerRadS,
+		const double* pdDltAngGearDriveRad, const double* pdAngGearSteerRad) = 0;
+
+	/**
+	 * Sets the desired platform velocity, calculates the inverse kinematics and chooses
+	 * the steering angle (of the two possible) for each wheel.
+	 */
+	virtual void setDesiredPltfVelocity(double dCmdVelLongMMS, double dCmdVelLatMMS, double dCmdRotRobRadS, double dCmdRotVelRadS) = 0;
+
+	virtual void getDesiredPltfVelocity(double& dCmdVelLongMMS, double& dCmdVelLatMMS, double& dCmdRotRobRadS, double& dCmdRotVelRadS) const = 0;
+
+	/**
+	 * Calculates the inverse kinematics for the desired platform velocity.
+	 */
+	virtual void calcInverse() = 0;
+
+	/**
+	 * Returns the first alternative of the inverse kinematics (without controller).
+	 */
+	virtual void getTarget1(double* pdVelGearDriveRadS, double* pdAngGearSteerRad) const = 0;
+
+	/**
+	 * Performs one discrete control step of the steering angles.
+	 */
+	virtual void calcControlStep() = 0;
+
+	/**
+	 * Returns the set point values of the last control step.
+	 */
+	virtual void getCmd(double* pdVelGearDriveRadS, double* pdVelGearSteerRadS, double* pdAngGearSteerRad) const = 0;
+
+	/**
+	 * Returns the platform velocity calculated by the direct kinematics.
+	 */
+	virtual void getActualPltfVelocity(double& dVelLongMMS, double& dVelLatMMS, double& dRotRobRadS, double& dRotVelRadS) const = 0;
+
+	/**
+	 * Returns the variance of the platform velocity calculated by the direct kinematics,
+	 * estimated from the deviation of the measured wheel velocities from a rigid platform motion (wheel slip).
+	 * @param dVarVelMMS2 variance of each of the linear velocities in (mm/s)^2
+	 * @param dVarRotRadS2 variance of the rotational rate in (rad/s)^2
+	 */
+	virtual void getActualPltfVelocityVariance(double& dVarVelMMS2, double& dVarRotRadS2) const = 0;
+
+	/**
+	 * Resets the controller states and sets the velocity commands to zero (emergency stop).
+	 */
+	virtual void resetCtrl() = 0;
+};
+
+/**
+ * Kinematics core for N wheels. The state is kept in fixed-size arrays, one per quantity,
+ * so the loops over the wheels have a trip count known at compile time.
+ */
+template<int N>
+class UndercarriageKinematics : public UndercarriageKinematicsItf
+{
+public:
+	UndercarriageKinematics()
+	{
+		m_dVelLongMMS = 0;
+		m_dVelLatMMS = 0;
+		m_dRotRobRadS = 0;
+		m_dRotVelRadS = 0;
+		m_dVarVelMMS2 = 0;
+		m_dVarRotRadS2 = 0;
+
+		m_dCmdVelLongMMS = 0;
+		m_dCmdVelLatMMS = 0;
+		m_dCmdRotRobRadS = 0;
+		m_dCmdRotVelRadS = 0;
+
+		m_dInvRadiusWheelMM = 1;
+
+		m_Param.iRadiusWheelMM = 1;
+		m_Param.iDistSteerAxisToDriveWheelMM = 0;
+		m_Param.dMaxDriveRateRadpS = 0;
+		m_Param.dMaxSteerRateRadpS = 0;
+		m_Param.dCmdRateS = 0;
+		m_Param.dSpring = 10.0;
+		m_Param.dDamp = 2.5;
+		m_Param.dVirtM = 0.1;
+		m_Param.dDPhiMax = 12.0;
+		m_Param.dDDPhiMax = 100.0;
+
+		for(int i = 0; i < N; i++)
+		{
+			m_Meas.dVelGearDriveRadS[i] = 0;
+			m_Meas.dVelGearSteerRadS[i] = 0;
+			m_Meas.dDltAngGearDriveRad[i] = 0;
+			m_Meas.dAngGearSteerRad[i] = 0;
+
+			m_Cmd.dVelGearDriveRadS[i] = 0;
+			m_Cmd.dVelGearSteerRadS[i] = 0;
+			m_Cmd.dAngGearSteerRad[i] = 0;
+
+			m_Target.dAngGearSteer1Rad[i] = 0;
+			m_Target.dVelGearDrive1RadS[i] = 0;
+			m_Target.dAngGearSteer2Rad[i] = 0;
+			m_Target.dVelGearDrive2RadS[i] = 0;
+			m_Target.dAngGearSteerRad[i] = 0;
+			m_Target.dVelGearDriveRadS[i] = 0;
+
+			m_Wheel.dXPosMM[i] = 0;
+			m_Wheel.dYPosMM[i] = 0;
+			m_Wheel.dDistMM[i] = 0;
+			m_Wheel.dAngRad[i] = 0;
+
+			m_ExWheel.dXPosMM[i] = 0;
+			m_ExWheel.dYPosMM[i] = 0;
+			m_ExWheel.dDistMM[i] = 0;
+			m_ExWheel.dAngRad[i] = 0;
+
+			m_WheelPrms.dNeutralPosRad[i] = 0;
+			m_WheelPrms.dSteerDriveCoupling[i] = 0;
+			m_WheelPrms.dFactorVel[i] = 0;
+
+			m_Ctrl.dDeltaPhi[i] = 0;
+			m_Ctrl.dVelCmd[i] = 0;
+		}
+	}
+
+	UndercarriageKinematicsItf* clone() const { return new UndercarriageKinematics<N>(*this); }
+
+	int getNumWheels() const { return N; }
+
+	void setParam(const ParamType& Param) { m_Param = Param; }
+	const ParamType& getParam() const { return m_Param; }
+
+	void setWheel(int iWheel, double dXPosMM, double dYPosMM, double dSteerDriveCoupling, double dNeutralPosRad)
+	{
+		m_Wheel.dXPosMM[iWheel] = dXPosMM;
+		m_Wheel.dYPosMM[iWheel] = dYPosMM;
+		m_WheelPrms.dSteerDriveCoupling[iWheel] = dSteerDriveCoupling;
+		m_WheelPrms.dNeutralPosRad[iWheel] = dNeutralPosRad;
+	}
+
+	void init()
+	{
+		for(int i = 0; i < N; i++)
+		{
+			// provisorial --> skip interpolation
+			m_Cmd.dAngGearSteerRad[i] = m_WheelPrms.dNeutralPosRad[i];
+			// also Init choosen Target angle
+			m_Target.dAngGearSteerRad[i] = m_WheelPrms.dNeutralPosRad[i];
+
+			// calculate polar coords of Wheel Axis in robot coordinate frame
+			m_Wheel.dDistMM[i] = sqrt( (m_Wheel.dXPosMM[i] * m_Wheel.dXPosMM[i]) + (m_Wheel.dYPosMM[i] * m_Wheel.dYPosMM[i]) );
+			m_Wheel.dAngRad[i] = MathSup::atan4quad(m_Wheel.dXPosMM[i], m_Wheel.dYPosMM[i]);
+
+			// calculate compensation factor for velocity
+			m_WheelPrms.dFactorVel[i] = - m_WheelPrms.dSteerDriveCoupling[i]
+				+ (double(m_Param.iDistSteerAxisToDriveWheelMM) / double(m_Param.iRadiusWheelMM));
+		}
+
+		m_dInvRadiusWheelMM = 1.0 / (double)m_Param.iRadiusWheelMM;
+
+		// Calculate exact position of wheels in cart. and polar coords in robot coordinate frame
+		calcExWheelPos();
+	}
+
+	void setActualWheelValues(const double* pdVelGearDriveRadS, const double* pdVelGearSteerRadS,
+		const double* pdDltAngGearDriveRad, const double* pdAngGearSteerRad)
+	{
+		for(int i = 0; i < N; i++)
+		{
+			m_Meas.dVelGearDriveRadS[i] = pdVelGearDriveRadS[i];
+			m_Meas.dVelGearSteerRadS[i] = pdVelGearSteerRadS[i];
+			m_Meas.dDltAngGearDriveRad[i] = pdDltAngGearDriveRad[i];
+			m_Meas.dAngGearSteerRad[i] = pdAngGearSteerRad[i];
+		}
+
+		// calc exact Wheel Positions (taking into account lever arm)
+		calcExWheelPos();
+
+		// Peform calculation of direct kinematics (approx.) based on corrected Wheel Positions
+		calcDirect();
+	}
+
+	void setDesiredPltfVelocity(double dCmdVelLongMMS, double dCmdVelLatMMS, double dCmdRotRobRadS, double dCmdRotVelRadS)
+	{
+		// declare auxiliary variables
+		double dCurrentPosWheelRAD;
+		double dtempDeltaPhi1RAD, dtempDeltaPhi2RAD;	// difference between possible steering angels and current steering angle
+		double dtempDeltaPhiCmd1RAD, dtempDeltaPhiCmd2RAD;	// difference between possible steering angels and last target steering angle
+		double dtempWeightedDelta1RAD, dtempWeightedDelta2RAD; // weighted Summ of the two distance values
+
+		m_dCmdVelLongMMS = dCmdVelLongMMS;
+		m_dCmdVelLatMMS = dCmdVelLatMMS;
+		m_dCmdRotRobRadS = dCmdRotRobRadS;
+		m_dCmdRotVelRadS = dCmdRotVelRadS;
+
+		calcInverse();
+
+		// determine optimal Pltf-Configuration
+		for(int i = 0; i < N; i++)
+		{
+			// Normalize Actual Wheel Position before calculation
+			dCurrentPosWheelRAD = m_Meas.dAngGearSteerRad[i];
+			MathSup::normalizePi(dCurrentPosWheelRAD);
+
+			// Calculate differences between current config to possible set-points
+			dtempDeltaPhi1RAD = m_Target.dAngGearSteer1Rad[i] - dCurrentPosWheelRAD;
+			dtempDeltaPhi2RAD = m_Target.dAngGearSteer2Rad[i] - dCurrentPosWheelRAD;
+			MathSup::normalizePi(dtempDeltaPhi1RAD);
+			MathSup::normalizePi(dtempDeltaPhi2RAD);
+			// Calculate differences between last steering target to possible set-points
+			dtempDeltaPhiCmd1RAD = m_Target.dAngGearSteer1Rad[i] - m_Target.dAngGearSteerRad[i];
+			dtempDeltaPhiCmd2RAD = m_Target.dAngGearSteer2Rad[i] - m_Target.dAngGearSteerRad[i];
+			MathSup::normalizePi(dtempDeltaPhiCmd1RAD);
+			MathSup::normalizePi(dtempDeltaPhiCmd2RAD);
+
+			// "fitness criteria" to choose optimal set point:
+			// 1st which set point is closest to current config
+			//     but: avoid permanent switching (if next target is about PI/2 from current config)
+			// 2nd which set point is closest to last set point
+			dtempWeightedDelta1RAD = 0.6*fabs(dtempDeltaPhi1RAD) + 0.4*fabs(dtempDeltaPhiCmd1RAD);
+			dtempWeightedDelta2RAD = 0.6*fabs(dtempDeltaPhi2RAD) + 0.4*fabs(dtempDeltaPhiCmd2RAD);
+
+			// check which set point "minimizes fitness criteria"
+			if (dtempWeightedDelta1RAD <= dtempWeightedDelta2RAD)
+			{
+				// Target1 is "optimal"
+				m_Target.dVelGearDriveRadS[i] = m_Target.dVelGearDrive1RadS[i];
+				m_Target.dAngGearSteerRad[i] = m_Target.dAngGearSteer1Rad[i];
+			}
+			else
+			{
+				// Target2 is "optimal"
+				m_Target.dVelGearDriveRadS[i] = m_Target.dVelGearDrive2RadS[i];
+				m_Target.dAngGearSteerRad[i] = m_Target.dAngGearSteer2Rad[i];
+			}
+		}
+	}
+
+	void getDesiredPltfVelocity(double& dCmdVelLongMMS, double& dCmdVelLatMMS, double& dCmdRotRobRadS, double& dCmdRotVelRadS) const
+	{
+		dCmdVelLongMMS = m_dCmdVelLongMMS;
+		dCmdVelLatMMS = m_dCmdVelLatMMS;
+		dCmdRotRobRadS = m_dCmdRotRobRadS;
+		dCmdRotVelRadS = m_dCmdRotVelRadS;
+	}
+
+	void calcInverse()
+	{
+		// help variable to store velocities of the steering axis in mm/s
+		double dtempAxVelXRobMMS, dtempAxVelYRobMMS;
+		double dtempAngRad;
+		double dCmdVelLongMMS = m_dCmdVelLongMMS;
+		double dCmdVelLatMMS = m_dCmdVelLatMMS;
+		double dCmdRotRobRadS = m_dCmdRotRobRadS;
+		double dInvRadiusWheelMM = m_dInvRadiusWheelMM;
+
+		// check if zero movement commanded -> keep orientation of wheels, set wheel velocity to zero
+		if(isZeroCmd())
+		{
+			for(int i = 0; i < N; i++)
+			{
+				m_Target.dAngGearSteer1Rad[i] = m_Meas.dAngGearSteerRad[i];
+				m_Target.dVelGearDrive1RadS[i] = 0.0;
+				m_Target.dAngGearSteer2Rad[i] = m_Meas.dAngGearSteerRad[i];
+				m_Target.dVelGearDrive2RadS[i] = 0.0;
+			}
+			return;
+		}
+
+		// calculate sets of possible Steering Angle // Drive-Velocity combinations
+		// (branchless loop body, so the compiler can process several wheels at once)
+		for(int i = 0; i < N; i++)
+		{
+			// calculate velocity and direction of single wheel motion
+			// Translational Portion plus Rotational Portion (Dist * -sin(Ang) = -YPos, Dist * cos(Ang) = XPos)
+			dtempAxVelXRobMMS = dCmdVelLongMMS - dCmdRotRobRadS * m_ExWheel.dYPosMM[i];
+			dtempAxVelYRobMMS = dCmdVelLatMMS + dCmdRotRobRadS * m_ExWheel.dXPosMM[i];
+
+			// calculate resulting steering angle
+			// Wheel has to move in direction of resulting velocity vector of steering axis
+			dtempAngRad = MathSup::atan2Fast(dtempAxVelYRobMMS, dtempAxVelXRobMMS);
+			m_Target.dAngGearSteer1Rad[i] = dtempAngRad;
+			// calculate corresponding angle in opposite direction (+180 degree, normalized to ]-pi,pi])
+			m_Target.dAngGearSteer2Rad[i] = (dtempAngRad > 0.0) ? dtempAngRad - MathSup::PI : dtempAngRad + MathSup::PI;
+
+			// calculate absolute value of rotational rate of driving wheels in rad/s
+			m_Target.dVelGearDrive1RadS[i] = sqrt( (dtempAxVelXRobMMS * dtempAxVelXRobMMS) +
+				(dtempAxVelYRobMMS * dtempAxVelYRobMMS) ) * dInvRadiusWheelMM;
+			// now adapt to direction (forward/backward) of wheel
+			m_Target.dVelGearDrive2RadS[i] = - m_Target.dVelGearDrive1RadS[i];
+		}
+	}
+
+	void getTarget1(double* pdVelGearDriveRadS, double* pdAngGearSteerRad) const
+	{
+		for(int i = 0; i < N; i++)
+		{
+			pdVelGearDriveRadS[i] = m_Target.dVelGearDrive1RadS[i];
+			pdAngGearSteerRad[i] = m_Target.dAngGearSteer1Rad[i];
+		}
+	}
+
+	void calcControlStep()
+	{
+		// declare auxilliary variables
+		double dCurrentPosWheelRAD;
+		double dDeltaPhi;
+		double dForceDamp, dForceProp, dAccCmd, dVelCmdInt; // PI- and Impedance-Ctrl
+
+		// check if zero movement commanded -> keep orientation of wheels, set steer velocity to zero
+		if(isZeroCmd())
+		{
+			for(int i = 0; i < N; i++)
+			{
+				m_Cmd.dVelGearDriveRadS[i] = 0.0;
+				m_Cmd.dVelGearSteerRadS[i] = 0.0;
+
+				// set internal states of controller to zero
+				m_Ctrl.dDeltaPhi[i] = 0.0;
+				m_Ctrl.dVelCmd[i] = 0.0;
+			}
+			return;
+		}
+
+		for(int i = 0; i < N; i++)
+		{
+			// provisorial --> skip interpolation and always take Target
+			m_Cmd.dVelGearDriveRadS[i] = m_Target.dVelGearDriveRadS[i];
+			m_Cmd.dAngGearSteerRad[i] = m_Target.dAngGearSteerRad[i];
+
+			// Normalize Actual Wheel Position before calculation
+			dCurrentPosWheelRAD = m_Meas.dAngGearSteerRad[i];
+			MathSup::normalizePi(dCurrentPosWheelRAD);
+			dDeltaPhi = m_Cmd.dAngGearSteerRad[i] - dCurrentPosWheelRAD;
+			MathSup::normalizePi(dDeltaPhi);
+
+			// Impedance-Ctrl
+			// Calculate resulting desired forces, velocities
+			dForceDamp = - m_Param.dDamp * m_Ctrl.dVelCmd[i];
+			dForceProp = m_Param.dSpring * dDeltaPhi;
+			dAccCmd = (dForceDamp + dForceProp) / m_Param.dVirtM;
+			if (dAccCmd > m_Param.dDDPhiMax)
+			{
+				dAccCmd = m_Param.dDDPhiMax;
+			}
+			else if (dAccCmd < -m_Param.dDDPhiMax)
+			{
+				dAccCmd = -m_Param.dDDPhiMax;
+			}
+			dVelCmdInt = m_Ctrl.dVelCmd[i] + m_Param.dCmdRateS * dAccCmd;
+			if (dVelCmdInt > m_Param.dDPhiMax)
+			{
+				dVelCmdInt = m_Param.dDPhiMax;
+			}
+			else if (dVelCmdInt < -m_Param.dDPhiMax)
+			{
+				dVelCmdInt = -m_Param.dDPhiMax;
+			}
+			// Store internal ctrlr-states
+			m_Ctrl.dDeltaPhi[i] = dDeltaPhi;
+			m_Ctrl.dVelCmd[i] = dVelCmdInt;
+			// set outputs
+			m_Cmd.dVelGearSteerRadS[i] = dVelCmdInt;
+
+			// Check if Steeringvelocity overgo maximum allowed rates.
+			if(fabs(m_Cmd.dVelGearSteerRadS[i]) > m_Param.dMaxSteerRateRadpS)
+			{
+				if (m_Cmd.dVelGearSteerRadS[i] > 0)
+					m_Cmd.dVelGearSteerRadS[i] = m_Param.dMaxSteerRateRadpS;
+				else
+					m_Cmd.dVelGearSteerRadS[i] = -m_Param.dMaxSteerRateRadpS;
+			}
+
+			// Correct Driving-Wheel-Velocity, because of coupling and axis-offset
+			m_Cmd.dVelGearDriveRadS[i] += m_Cmd.dVelGearSteerRadS[i] * m_WheelPrms.dFactorVel[i];
+		}
+	}
+
+	void getCmd(double* pdVelGearDriveRadS, double* pdVelGearSteerRadS, double* pdAngGearSteerRad) const
+	{
+		for(int i = 0; i < N; i++)
+		{
+			pdVelGearDriveRadS[i] = m_Cmd.dVelGearDriveRadS[i];
+			pdVelGearSteerRadS[i] = m_Cmd.dVelGearSteerRadS[i];
+			pdAngGearSteerRad[i] = m_Cmd.dAngGearSteerRad[i];
+		}
+	}
+
+	void getActualPltfVelocity(double& dVelLongMMS, double& dVelLatMMS, double& dRotRobRadS, double& dRotVelRadS) const
+	{
+		dVelLongMMS = m_dVelLongMMS;
+		dVelLatMMS = m_dVelLatMMS;
+		dRotRobRadS = m_dRotRobRadS;
+		dRotVelRadS = m_dRotVelRadS;
+	}
+
+	void getActualPltfVelocityVariance(double& dVarVelMMS2, double& dVarRotRadS2) const
+	{
+		dVarVelMMS2 = m_dVarVelMMS2;
+		dVarRotRadS2 = m_dVarRotRadS2;
+	}
+
+	void resetCtrl()
+	{
+		for(int i = 0; i < N; i++)
+		{
+			// Steermodules
+			m_Ctrl.dDeltaPhi[i] = 0.0;
+			m_Ctrl.dVelCmd[i] = 0.0;
+			// Outputs
+			m_Cmd.dVelGearDriveRadS[i] = 0.0;
+			m_Cmd.dVelGearSteerRadS[i] = 0.0;
+		}
+	}
+
+private:
+	bool isZeroCmd() const
+	{
+		return (m_dCmdVelLongMMS == 0) && (m_dCmdVelLatMMS == 0) && (m_dCmdRotRobRadS == 0) && (m_dCmdRotVelRadS == 0);
+	}
+
+	// calculate Exact Wheel Position in robot coordinates
+	// Note: the inverse kinematics only needs the cartesian position, which already is the lever arm
+	// of the rotational portion, so the polar coords are not calculated here each cycle
+	void calcExWheelPos()
+	{
+		for(int i = 0; i < N; i++)
+		{
+			// calculate current geometry of robot (exact wheel position, taking into account steering offset of wheels)
+			m_ExWheel.dXPosMM[i] = m_Wheel.dXPosMM[i] + m_Param.iDistSteerAxisToDriveWheelMM * sin(m_Meas.dAngGearSteerRad[i]);
+			m_ExWheel.dYPosMM[i] = m_Wheel.dYPosMM[i] - m_Param.iDistSteerAxisToDriveWheelMM * cos(m_Meas.dAngGearSteerRad[i]);
+		}
+	}
+
+	// calculate direct kinematics
+	void calcDirect()
+	{
+		double dtempVelXRobMMS = 0;	// Robot-Velocity in x-Direction (longitudinal) in mm/s (in Robot-Coordinateframe)
+		double dtempVelYRobMMS = 0;	// Robot-Velocity in y-Direction (lateral) in mm/s (in Robot-Coordinateframe)
+		double dtempRotRobRADPS = 0;	// Robot-Rotation-Rate in rad/s (in Robot-Coordinateframe)
+		double dtempDiffXMM;		// Difference in X-Coordinate of two wheels in mm
+		double dtempDiffYMM;		// Difference in Y-Coordinate of two wheels in mm
+		double dtempRelPhiWheelsRAD;	// Angle between axis of two wheels w.r.t the X-Axis of the Robot-Coordinate-System in rad
+		double dtempRelDistWheelsMM;	// distance of two wheels in mm
+		double dtempRelPhiWheel1RAD;	// Steering Angle of (im math. pos. direction) first Wheel w.r.t. the linking axis of the two wheels
+		double dtempRelPhiWheel2RAD;	// Steering Angle of (im math. pos. direction) second Wheel w.r.t. the linking axis of the two wheels
+		double dtempVelWheelMMS[N];	// Wheel-Velocities (all Wheels) in mm/s
+		double dtempCosSteer[N], dtempSinSteer[N];	// direction of the Wheel-Velocities
+		double dtempResX, dtempResY;	// deviation of a Wheel-Velocity from the rigid platform motion in mm/s
+		double dtempSumRes2 = 0, dtempSumDist2 = 0;
+		double dtempVarWheel;
+		int j;
+
+		// calculate corrected wheel velocities
+		for(int i = 0; i < N; i++)
+		{
+			// calc effective Driving-Velocity
+			dtempVelWheelMMS[i] = m_Param.iRadiusWheelMM * (m_Meas.dVelGearDriveRadS[i] - m_WheelPrms.dFactorVel[i] * m_Meas.dVelGearSteerRadS[i]);
+		}
+
+		// calculate rotational rate of robot and current "virtual" axis between all wheels
+		// (the last axis links the last and the first wheel)
+		for(int i = 0; i < N; i++)
+		{
+			j = (i + 1 < N) ? i + 1 : 0;
+
+			// calc Parameters (Dist,Phi) of virtual linking axis of the two considered wheels
+			dtempDiffXMM = m_ExWheel.dXPosMM[j] - m_ExWheel.dXPosMM[i];
+			dtempDiffYMM = m_ExWheel.dYPosMM[j] - m_ExWheel.dYPosMM[i];
+			dtempRelDistWheelsMM = sqrt( dtempDiffXMM*dtempDiffXMM + dtempDiffYMM*dtempDiffYMM );
+			dtempRelPhiWheelsRAD = MathSup::atan4quad( dtempDiffYMM, dtempDiffXMM );
+
+			// transform velocity of wheels into relative coordinate frame of linking axes -> subtract angles
+			dtempRelPhiWheel1RAD = m_Meas.dAngGearSteerRad[i] - dtempRelPhiWheelsRAD;
+			dtempRelPhiWheel2RAD = m_Meas.dAngGearSteerRad[j] - dtempRelPhiWheelsRAD;
+
+			dtempRotRobRADPS += (dtempVelWheelMMS[j] * sin(dtempRelPhiWheel2RAD) - dtempVelWheelMMS[i] * sin(dtempRelPhiWheel1RAD))/dtempRelDistWheelsMM;
+		}
+
+		// calculate linear velocity of robot
+		for(int i = 0; i < N; i++)
+		{
+			dtempCosSteer[i] = cos(m_Meas.dAngGearSteerRad[i]);
+			dtempSinSteer[i] = sin(m_Meas.dAngGearSteerRad[i]);
+			dtempVelXRobMMS += dtempVelWheelMMS[i]*dtempCosSteer[i];
+			dtempVelYRobMMS += dtempVelWheelMMS[i]*dtempSinSteer[i];
+		}
+
+		// assign rotational velocities for output
+		m_dRotRobRadS = dtempRotRobRADPS/N;
+		m_dRotVelRadS = 0; // currently not used to represent 3rd degree of freedom -> set to zero
+
+		// assign linear velocity of robot for output
+		m_dVelLongMMS = dtempVelXRobMMS/N;
+		m_dVelLatMMS = dtempVelYRobMMS/N;
+
+		// estimate wheel slip: residual of the Wheel-Velocities to the velocities
+		// the calculated platform motion causes at the wheels (2N measured values, 3 fitted)
+		for(int i = 0; i < N; i++)
+		{
+			dtempResX = dtempVelWheelMMS[i]*dtempCosSteer[i] - (m_dVelLongMMS - m_dRotRobRadS * m_ExWheel.dYPosMM[i]);
+			dtempResY = dtempVelWheelMMS[i]*dtempSinSteer[i] - (m_dVelLatMMS + m_dRotRobRadS * m_ExWheel.dXPosMM[i]);
+			dtempSumRes2 += dtempResX*dtempResX + dtempResY*dtempResY;
+			dtempSumDist2 += m_ExWheel.dXPosMM[i]*m_ExWheel.dXPosMM[i] + m_ExWheel.dYPosMM[i]*m_ExWheel.dYPosMM[i];
+		}
+		dtempVarWheel = dtempSumRes2 / (2*N - 3);
+
+		// variance of the mean over the wheels and of the rotation about the center
+		m_dVarVelMMS2 = dtempVarWheel / N;
+		m_dVarRotRadS2 = (dtempSumDist2 > 0) ? dtempVarWheel / dtempSumDist2 : 0;
+	}
+
+	ParamType m_Param;
+
+	// Actual Values for PltfMovement (calculated from Actual Wheelspeeds)
+	double m_dVelLongMMS;
+	double m_dVelLatMMS;
+	double m_dRotRobRadS;
+	double m_dRotVelRadS;
+	// Variance of the actual values (wheel slip)
+	double m_dVarVelMMS2;
+	double m_dVarRotRadS2;
+
+	// Desired Pltf-Movement
+	double m_dCmdVelLongMMS;
+	double m_dCmdVelLatMMS;
+	double m_dCmdRotRobRadS;
+	double m_dCmdRotVelRadS;
+
+	// 1 / RadiusWheel, calculated in init()
+	double m_dInvRadiusWheelMM;
+
+	// Actual Wheelspeed (read from Motor-Ctrls)
+	struct
+	{
+		double dVelGearDriveRadS[N];
+		double dVelGearSteerRadS[N];
+		double dDltAngGearDriveRad[N];
+		double dAngGearSteerRad[N];
+	} m_Meas;
+
+	// Desired Wheelspeeds set to ELMO-Ctrl's (calculated from desired Pltf-Movement)
+	struct
+	{
+		double dVelGearDriveRadS[N];
+		double dVelGearSteerRadS[N];
+		double dAngGearSteerRad[N];
+	} m_Cmd;
+
+	// Target Wheelspeed and -angle (calculated from desired Pltf-Movement with Inverse without controle!)
+	// This Values might not be valid (to high step response in steering rate, ...) for commanding the drives
+	struct
+	{
+		double dAngGearSteer1Rad[N]; // alternativ 1 for steering angle
+		double dVelGearDrive1RadS[N];
+		double dAngGearSteer2Rad[N]; // alternativ 2 for steering angle (+/- PI)
+		double dVelGearDrive2RadS[N];
+		double dAngGearSteerRad[N]; // choosen alternativ for steering angle
+		double dVelGearDriveRadS[N];
+	} m_Target;
+
+	/** Position of the Wheels' Steering Axis' (m_Wheel) and of the Wheels' itself (m_ExWheel)
+	 *  in cartesian (X/Y) and polar (Dist/Ang) coordinates
+	 *  relative to robot coordinate System
+	 *  (polar coords are only calculated for m_Wheel)
+	 */
+	struct WheelPosType
+	{
+		double dXPosMM[N];
+		double dYPosMM[N];
+		double dDistMM[N];
+		double dAngRad[N];
+	};
+	WheelPosType m_Wheel;
+	WheelPosType m_ExWheel;
+
+	struct
+	{
+		double dNeutralPosRad[N];
+		double dSteerDriveCoupling[N];
+		/** Factor between steering motion and steering induced motion of drive wheels
+		 *  subtract from Drive-Wheel Vel to get effective Drive Velocity (Direct Kinematics)
+		 *  add to Drive-Wheel Vel (Inverse Kinematics) to account for coupling when commanding velos
+		 */
+		double dFactorVel[N];
+	} m_WheelPrms;
+
+	// internal controller states: previous commanded deltaPhi e(k-1) and previous commanded velocity u(k-1)
+	struct
+	{
+		double dDeltaPhi[N];
+		double dVelCmd[N];
+	} m_Ctrl;
+};
+
+#endif
@@ -0,0 +1,263 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_undercarriage_ctrl
+ * Description: Integrates the odometry of the undercarriage and propagates its covariance
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+#include <cob_undercarriage_ctrl/OdometryIntegrator.h>
+#include <cmath>
+#include <cob_utilities/MathSup.h>
+
+// Constructor
+OdometryIntegrator::OdometryIntegrator()
+{
+	m_Param.dVarLinPerM = 1e-3;
+	m_Param.dVarRotPerRad = 1e-3;
+	m_Param.dVarRotPerM = 1e-3;
+	m_Param.dSlipCorrTimeS = 0.1;
+
+	reset();
+}
+
+// Set noise model
+void OdometryIntegrator::setParam(const ParamType& Param)
+{
+	m_Param = Param;
+}
+
+// Set pose and covariance to zero and clear history
+void OdometryIntegrator::reset()
+{
+	m_Pose.dStampS = 0;
+	m_Pose.dXM = 0;
+	m_Pose.dYM = 0;
+	m_Pose.dThetaRad = 0;
+	m_Pose.dVelXMS = 0;
+	m_Pose.dVelYMS = 0;
+	m_Pose.dRotRadS = 0;
+	m_Pose.dVarVelM2S2 = 0;
+	m_Pose.dVarRotRad2S2 = 0;
+	for(int i = 0; i < 3; i++)
+		for(int j = 0; j < 3; j++)
+			m_Pose.dCov[i][j] = 0;
+
+	m_iFirst = 0;
+	m_iNumSamples = 0;
+
+	m_iNumDropped = 0;
+	m_iNumDuplicates = 0;
+	m_iNumReordered = 0;
+	m_iNumDroppedInRow = 0;
+}
+
+// Add velocity sample and integrate pose
+bool OdometryIntegrator::addSample(double dStampS, double dVelXMS, double dVelYMS, double dRotRadS,
+	double dVarVelM2S2, double dVarRotRad2S2)
+{
+	SampleType New;
+	int iPos;
+
+	New.dStampS = dStampS;
+	New.dVelXMS = dVelXMS;
+	New.dVelYMS = dVelYMS;
+	New.dRotRadS = dRotRadS;
+	New.dVarVelM2S2 = dVarVelM2S2;
+	New.dVarRotRad2S2 = dVarRotRad2S2;
+
+	// first sample (or the clock jumped back further than the history reaches):
+	// start the history at the current pose
+	if( (m_iNumSamples == 0) || (m_iNumDroppedInRow > c_iSizeHistory) )
+	{
+		New.dXM = m_Pose.dXM;
+		New.dYM = m_Pose.dYM;
+		New.dThetaRad = m_Pose.dThetaRad;
+		for(int i = 0; i < 3; i++)
+			for(int j = 0; j < 3; j++)
+				New.dCov[i][j] = m_Pose.dCov[i][j];
+
+		m_iFirst = 0;
+		m_iNumSamples = 1;
+		m_iNumDroppedInRow = 0;
+		m_History[0] = New;
+		updatePose();
+		return true;
+	}
+
+	// find position in history (usually behind the newest sample)
+	iPos = m_iNumSamples;
+	while( (iPos > 0) && (sample(iPos - 1).dStampS >= dStampS) )
+		iPos--;
+
+	if( (iPos < m_iNumSamples) && (sample(iPos).dStampS == dStampS) )
+	{
+		m_iNumDuplicates++;
+		return false;
+	}
+	// older than the history; with a full history the oldest sample is dropped below,
+	// so a sample behind it would have no sample to integrate from
+	if( (iPos == 0) || ((iPos == 1) && (m_iNumSamples == c_iSizeHistory)) )
+	{
+		m_iNumDropped++;
+		m_iNumDroppedInRow++;
+		return false;
+	}
+	m_iNumDroppedInRow = 0;
+
+	// history full -> drop oldest sample
+	if(m_iNumSamples == c_iSizeHistory)
+	{
+		m_iFirst = (m_iFirst + 1) % c_iSizeHistory;
+		m_iNumSamples--;
+		iPos--;
+	}
+
+	if(iPos < m_iNumSamples)
+	{
+		// sort in and shift the newer samples
+		m_iNumReordered++;
+		for(int i = m_iNumSamples; i > iPos; i--)
+			sample(i) = sample(i - 1);
+	}
+	sample(iPos) = New;
+	m_iNumSamples++;
+
+	// integrate from the sample before up to the newest one
+	for(int i = iPos; i < m_iNumSamples; i++)
+		integrate(sample(i - 1), sample(i));
+
+	updatePose();
+	return true;
+}
+
+// Integrate mean twist of two samples on SE(2) and propagate covariance
+void OdometryIntegrator::integrate(const SampleType& Prev, SampleType& Next) const
+{
+	double dDtS = Next.dStampS - Prev.dStampS;
+	double dVelXMS = (Prev.dVelXMS + Next.dVelXMS) / 2.0;
+	double dVelYMS = (Prev.dVelYMS + Next.dVelYMS) / 2.0;
+	double dRotRadS = (Prev.dRotRadS + Next.dRotRadS) / 2.0;
+	double dVarVelM2S2 = (Prev.dVarVelM2S2 + Next.dVarVelM2S2) / 2.0;
+	double dVarRotRad2S2 = (Prev.dVarRotRad2S2 + Next.dVarRotRad2S2) / 2.0;
+	double dDltTheta = dRotRadS * dDtS;
+	double dSinC, dCosC;	// sin(a)/a and (1-cos(a))/a
+	double dDltXRob, dDltYRob, dDltXM, dDltYM, dDistM;
+	double dCosTheta = cos(Prev.dThetaRad);
+	double dSinTheta = sin(Prev.dThetaRad);
+	double dQLin, dQRot, dQDir;
+	double F[3][3], FP[3][3];
+
+	// exponential map of the twist, series expansion for small angles
+	if(fabs(dDltTheta) < 1e-4)
+	{
+		dSinC = 1.0 - dDltTheta*dDltTheta / 6.0;
+		dCosC = dDltTheta / 2.0 - dDltTheta*dDltTheta*dDltTheta / 24.0;
+	}
+	else
+	{
+		dSinC = sin(dDltTheta) / dDltTheta;
+		dCosC = (1.0 - cos(dDltTheta)) / dDltTheta;
+	}
+	dDltXRob = (dSinC * dVelXMS - dCosC * dVelYMS) * dDtS;
+	dDltYRob = (dCosC * dVelXMS + dSinC * dVelYMS) * dDtS;
+
+	dDltXM = dCosTheta * dDltXRob - dSinTheta * dDltYRob;
+	dDltYM = dSinTheta * dDltXRob + dCosTheta * dDltYRob;
+	dDistM = sqrt(dDltXM*dDltXM + dDltYM*dDltYM);
+
+	Next.dXM = Prev.dXM + dDltXM;
+	Next.dYM = Prev.dYM + dDltYM;
+	Next.dThetaRad = Prev.dThetaRad + dDltTheta;
+	MathSup::normalizePi(Next.dThetaRad);
+
+	// P' = F P F^T + Q, F is the jacobian of the pose update with respect to the previous pose
+	F[0][0] = 1; F[0][1] = 0; F[0][2] = -dDltYM;
+	F[1][0] = 0; F[1][1] = 1; F[1][2] = dDltXM;
+	F[2][0] = 0; F[2][1] = 0; F[2][2] = 1;
+	for(int i = 0; i < 3; i++)
+		for(int j = 0; j < 3; j++)
+			FP[i][j] = F[i][0] * Prev.dCov[0][j] + F[i][1] * Prev.dCov[1][j] + F[i][2] * Prev.dCov[2][j];
+	for(int i = 0; i < 3; i++)
+		for(int j = 0; j < 3; j++)
+			Next.dCov[i][j] = FP[i][0] * F[j][0] + FP[i][1] * F[j][1] + FP[i][2] * F[j][2];
+
+	// process noise: proportional to the travelled distance and turned angle plus the wheel slip,
+	// the slip is integrated as velocity noise of correlation time dSlipCorrTimeS.
+	// Both grow linearly with the integrated interval, so splitting it up does not change the result
+	dQLin = 2.0 * m_Param.dSlipCorrTimeS * dVarVelM2S2 * dDtS;
+	dQRot = m_Param.dVarRotPerRad * fabs(dDltTheta) + m_Param.dVarRotPerM * dDistM
+		+ 2.0 * m_Param.dSlipCorrTimeS * dVarRotRad2S2 * dDtS;
+	// the distance error acts along the direction of motion only
+	dQDir = (dDistM > 0) ? m_Param.dVarLinPerM / dDistM : 0;
+
+	Next.dCov[0][0] += dQLin + dQDir * dDltXM * dDltXM;
+	Next.dCov[0][1] += dQDir * dDltXM * dDltYM;
+	Next.dCov[1][0] += dQDir * dDltXM * dDltYM;
+	Next.dCov[1][1] += dQLin + dQDir * dDltYM * dDltYM;
+	Next.dCov[2][2] += dQRot;
+}
+
+// Copy newest sample to output
+void OdometryIntegrator::updatePose()
+{
+	const SampleType& Newest = sample(m_iNumSamples - 1);
+
+	m_Pose.dStampS = Newest.dStampS;
+	m_Pose.dXM = Newest.dXM;
+	m_Pose.dYM = Newest.dYM;
+	m_Pose.dThetaRad = Newest.dThetaRad;
+	m_Pose.dVelXMS = Newest.dVelXMS;
+	m_Pose.dVelYMS = Newest.dVelYMS;
+	m_Pose.dRotRadS = Newest.dRotRadS;
+	m_Pose.dVarVelM2S2 = Newest.dVarVelM2S2;
+	m_Pose.dVarRotRad2S2 = Newest.dVarRotRad2S2;
+	for(int i = 0; i < 3; i++)
+		for(int j = 0; j < 3; j++)
+			m_Pose.dCov[i][j] = Newest.dCov[i][j];
+}
@@ -0,0 +1,341 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_undercarriage_ctrl
+ * Description: Microbenchmark of the inverse kinematics and the control step of the undercarriage.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#include <cob_utilities/MathSup.h>
+#include <cob_undercarriage_ctrl/UndercarriageKinematics.h>
+
+//-----------------------------------------------
+// time stamp counter on x86, nanoseconds otherwise
+#if defined(__i386__) || defined(__x86_64__)
+static const char* c_sUnit = "cycles";
+static inline unsigned long long readCounter()
+{
+	return __rdtsc();
+}
+#else
+static const char* c_sUnit = "ns";
+static inline unsigned long long readCounter()
+{
+	timespec Time;
+	clock_gettime(CLOCK_MONOTONIC, &Time);
+	return Time.tv_sec * 1000000000ULL + Time.tv_nsec;
+}
+#endif
+
+//-----------------------------------------------
+static void printUsage()
+{
+	std::cout << "usage: cob_undercarriage_ctrl_bench_kinematics [--steps <n>] [<NumberOfWheels> ...]" << std::endl
+		<< "  Measures the " << c_sUnit << " per step of calcInverse() and of a full control step" << std::endl
+		<< "  (measurement, command, calcControlStep(), getCmd()) for the given numbers of wheels (default 4 8)." << std::endl
+		<< "  calcInverse() is compared with the previous implementation (sin/cos of the polar wheel angle," << std::endl
+		<< "  atan4quad, normalizePi), which also calculated the polar coords of the wheels in each measurement step." << std::endl
+		<< "  The cost of reading the counter is measured separately and subtracted." << std::endl;
+}
+
+//-----------------------------------------------
+static double random(double dMax)
+{
+	return dMax * (2.0 * rand() / RAND_MAX - 1.0);
+}
+
+//-----------------------------------------------
+// geometry of the bench, see setup()
+static const double c_dWheelCircleMM = 300.0;
+static const int c_iRadiusWheelMM = 80;
+static const int c_iDistSteerAxisToDriveWheelMM = 10;
+
+static double wheelAngRad(int iWheel, int iNumWheels)
+{
+	return 2.0 * MathSup::PI * iWheel / iNumWheels + 0.25 * MathSup::PI;
+}
+
+//-----------------------------------------------
+/**
+ * Inverse kinematics as it was before the branchless loop (reference).
+ * Works on the exact wheel positions of the current steering angles like UndercarriageKinematics.
+ */
+class PrevInverse
+{
+public:
+	PrevInverse(int iNumWheels)
+	{
+		m_iNumWheels = iNumWheels;
+		for (int i = 0; i < iNumWheels; i++)
+		{
+			m_dXPosMM[i] = c_dWheelCircleMM * cos(wheelAngRad(i, iNumWheels));
+			m_dYPosMM[i] = c_dWheelCircleMM * sin(wheelAngRad(i, iNumWheels));
+		}
+	}
+
+	// exact wheel positions, calculated in each measurement step (also by the current implementation)
+	void calcExWheelPos(const double* pdAngGearSteerRad)
+	{
+		for (int i = 0; i < m_iNumWheels; i++)
+		{
+			m_dExXPosMM[i] = m_dXPosMM[i] + c_iDistSteerAxisToDriveWheelMM * sin(pdAngGearSteerRad[i]);
+			m_dExYPosMM[i] = m_dYPosMM[i] - c_iDistSteerAxisToDriveWheelMM * cos(pdAngGearSteerRad[i]);
+		}
+	}
+
+	// polar coords of the exact wheel positions, calculated in each measurement step (dropped)
+	void calcExWheelPolar()
+	{
+		for (int i = 0; i < m_iNumWheels; i++)
+		{
+			m_dExDistMM[i] = sqrt( (m_dExXPosMM[i] * m_dExXPosMM[i]) + (m_dExYPosMM[i] * m_dExYPosMM[i]) );
+			m_dExAngRad[i] = MathSup::atan4quad( m_dExYPosMM[i], m_dExXPosMM[i]);
+		}
+	}
+
+	void calcInverse(double dCmdVelLongMMS, double dCmdVelLatMMS, double dCmdRotRobRadS)
+	{
+		double dtempAxVelXRobMMS, dtempAxVelYRobMMS;
+
+		for (int i = 0; i < m_iNumWheels; i++)
+		{
+			// Translational Portion
+			dtempAxVelXRobMMS = dCmdVelLongMMS;
+			dtempAxVelYRobMMS = dCmdVelLatMMS;
+			// Rotational Portion
+			dtempAxVelXRobMMS += dCmdRotRobRadS * m_dExDistMM[i] * -sin(m_dExAngRad[i]);
+			dtempAxVelYRobMMS += dCmdRotRobRadS * m_dExDistMM[i] * cos(m_dExAngRad[i]);
+
+			m_dAngGearSteer1Rad[i] = MathSup::atan4quad(dtempAxVelYRobMMS, dtempAxVelXRobMMS);
+			m_dAngGearSteer2Rad[i] = m_dAngGearSteer1Rad[i] + MathSup::PI;
+			MathSup::normalizePi(m_dAngGearSteer2Rad[i]);
+
+			m_dVelGearDrive1RadS[i] = sqrt( (dtempAxVelXRobMMS * dtempAxVelXRobMMS) +
+				(dtempAxVelYRobMMS * dtempAxVelYRobMMS) ) / (double)c_iRadiusWheelMM;
+			m_dVelGearDrive2RadS[i] = - m_dVelGearDrive1RadS[i];
+		}
+	}
+
+	int m_iNumWheels;
+	double m_dXPosMM[UndercarriageKinematicsItf::c_iMaxNumWheels], m_dYPosMM[UndercarriageKinematicsItf::c_iMaxNumWheels];
+	double m_dExXPosMM[UndercarriageKinematicsItf::c_iMaxNumWheels], m_dExYPosMM[UndercarriageKinematicsItf::c_iMaxNumWheels];
+	double m_dExDistMM[UndercarriageKinematicsItf::c_iMaxNumWheels], m_dExAngRad[UndercarriageKinematicsItf::c_iMaxNumWheels];
+	double m_dAngGearSteer1Rad[UndercarriageKinematicsItf::c_iMaxNumWheels], m_dAngGearSteer2Rad[UndercarriageKinematicsItf::c_iMaxNumWheels];
+	double m_dVelGearDrive1RadS[UndercarriageKinematicsItf::c_iMaxNumWheels], m_dVelGearDrive2RadS[UndercarriageKinematicsItf::c_iMaxNumWheels];
+};
+
+//-----------------------------------------------
+// wheels on a circle of 300 mm, geometry and controller of Care-O-bot 3
+static void setup(UndercarriageKinematicsItf* pKinematics)
+{
+	const int iNumWheels = pKinematics->getNumWheels();
+	UndercarriageKinematicsItf::ParamType Prms = pKinematics->getParam();
+
+	Prms.iRadiusWheelMM = c_iRadiusWheelMM;
+	Prms.iDistSteerAxisToDriveWheelMM = c_iDistSteerAxisToDriveWheelMM;
+	Prms.dMaxDriveRateRadpS = 18;
+	Prms.dMaxSteerRateRadpS = 12;
+	Prms.dCmdRateS = 0.01;
+	Prms.dSpring = 10.0;
+	Prms.dDamp = 2.5;
+	Prms.dVirtM = 0.1;
+	Prms.dDPhiMax = 12.0;
+	Prms.dDDPhiMax = 100.0;
+	pKinematics->setParam(Prms);
+
+	for (int i = 0; i < iNumWheels; i++)
+	{
+		double dAngRad = wheelAngRad(i, iNumWheels);
+		pKinematics->setWheel(i, c_dWheelCircleMM * cos(dAngRad), c_dWheelCircleMM * sin(dAngRad), -0.5, 0.0);
+	}
+	pKinematics->init();
+}
+
+//-----------------------------------------------
+// cost of reading the counter twice
+static unsigned long long measureOverhead()
+{
+	unsigned long long iMin = (unsigned long long)-1;
+
+	for (int k = 0; k < 10000; k++)
+	{
+		unsigned long long iStart = readCounter();
+		unsigned long long iEnd = readCounter();
+		if (iEnd - iStart < iMin)
+			iMin = iEnd - iStart;
+	}
+	return iMin;
+}
+
+//-----------------------------------------------
+static void bench(int iNumWheels, int iNumSteps, unsigned long long iOverhead)
+{
+	UndercarriageKinematicsItf* pKinematics = UndercarriageKinematicsItf::create(iNumWheels);
+	if (pKinematics == NULL)
+	{
+		std::cout << "NumberOfWheels = " << iNumWheels << " is not supported (2.." << UndercarriageKinematicsItf::c_iMaxNumWheels << ")" << std::endl;
+		return;
+	}
+	setup(pKinematics);
+
+	PrevInverse Prev(iNumWheels);
+	std::vector<double> vdVelDrive(iNumWheels, 1.0), vdVelSteer(iNumWheels, 0.0);
+	std::vector<double> vdDltAngDrive(iNumWheels, 0.01), vdAngSteer(iNumWheels, 0.0);
+	std::vector<double> vdCmdVelDrive(iNumWheels), vdCmdVelSteer(iNumWheels), vdCmdAngSteer(iNumWheels);
+	unsigned long long iSumInverse = 0, iSumStep = 0, iSumPrevInverse = 0, iSumPrevPolar = 0;
+	double dMaxDevSteerRad = 0, dMaxDevDriveRadS = 0;
+	double dSum = 0;
+
+	srand(1);
+	for (int k = 0; k < iNumSteps; k++)
+	{
+		double dVelLong = random(500), dVelLat = random(500), dRot = random(1.0);
+		unsigned long long iStart;
+
+		for (int i = 0; i < iNumWheels; i++)
+			vdAngSteer[i] = random(3.0);
+
+		// inverse kinematics of the command set before
+		pKinematics->setActualWheelValues(&vdVelDrive[0], &vdVelSteer[0], &vdDltAngDrive[0], &vdAngSteer[0]);
+		pKinematics->setDesiredPltfVelocity(dVelLong, dVelLat, dRot, 0);
+		iStart = readCounter();
+		pKinematics->calcInverse();
+		iSumInverse += readCounter() - iStart;
+		pKinematics->getTarget1(&vdCmdVelDrive[0], &vdCmdAngSteer[0]);
+		dSum += vdCmdAngSteer[0];
+
+		// previous implementation of the same step
+		Prev.calcExWheelPos(&vdAngSteer[0]);
+		iStart = readCounter();
+		Prev.calcExWheelPolar();
+		iSumPrevPolar += readCounter() - iStart;
+		iStart = readCounter();
+		Prev.calcInverse(dVelLong, dVelLat, dRot);
+		iSumPrevInverse += readCounter() - iStart;
+		for (int i = 0; i < iNumWheels; i++)
+		{
+			double dDevSteerRad = Prev.m_dAngGearSteer1Rad[i] - vdCmdAngSteer[i];
+			MathSup::normalizePi(dDevSteerRad);
+			dMaxDevSteerRad = std::max(dMaxDevSteerRad, fabs(dDevSteerRad));
+			dMaxDevDriveRadS = std::max(dMaxDevDriveRadS, fabs(Prev.m_dVelGearDrive1RadS[i] - vdCmdVelDrive[i]));
+		}
+
+		// full control step as done by UndercarriageCtrlGeom
+		iStart = readCounter();
+		pKinematics->setActualWheelValues(&vdVelDrive[0], &vdVelSteer[0], &vdDltAngDrive[0], &vdAngSteer[0]);
+		pKinematics->setDesiredPltfVelocity(dVelLong, dVelLat, dRot, 0);
+		pKinematics->calcControlStep();
+		pKinematics->getCmd(&vdCmdVelDrive[0], &vdCmdVelSteer[0], &vdCmdAngSteer[0]);
+		iSumStep += readCounter() - iStart;
+		dSum += vdCmdVelSteer[0];
+	}
+	delete pKinematics;
+
+	// keeps the calculation from being optimized away
+	if (dSum == 1.2345)
+		std::cout << std::endl;
+
+	printf("%d wheels: calcInverse %7.1f %s/step (previous %7.1f, plus %7.1f for the polar coords per measurement),"
+		" control step %7.1f %s/step\n", iNumWheels,
+		(double)iSumInverse / iNumSteps - iOverhead, c_sUnit, (double)iSumPrevInverse / iNumSteps - iOverhead,
+		(double)iSumPrevPolar / iNumSteps - iOverhead, (double)iSumStep / iNumSteps - iOverhead, c_sUnit);
+	printf("%d wheels: largest deviation from the previous implementation: steering %.2e rad, drive %.2e rad/s\n",
+		iNumWheels, dMaxDevSteerRad, dMaxDevDriveRadS);
+}
+
+//-----------------------------------------------
+int main(int argc, char** argv)
+{
+	std::vector<int> viNumWheels;
+	int iNumSteps = 200000;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--steps") == 0) && (i + 1 < argc))
+			iNumSteps = atoi(argv[++i]);
+		else if (argv[i][0] == '-')
+		{
+			printUsage();
+			return 1;
+		}
+		else
+			viNumWheels.push_back(atoi(argv[i]));
+	}
+	if (iNumSteps < 1)
+	{
+		printUsage();
+		return 1;
+	}
+	if (viNumWheels.empty())
+	{
+		viNumWheels.push_back(4);
+		viNumWheels.push_back(8);
+	}
+
+	unsigned long long iOverhead = measureOverhead();
+	printf("# reading the counter costs %llu %s\n", iOverhead, c_sUnit);
+
+	for (unsigned int i = 0; i < viNumWheels.size(); i++)
+		bench(viNumWheels[i], iNumSteps, iOverhead);
+
+	return 0;
+}
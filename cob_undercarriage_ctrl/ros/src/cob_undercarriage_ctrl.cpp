@@ -58,9 +58,18 @@
 
 // standard includes
 #include <math.h>
+#include <algorithm>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
 
 // ROS includes
 #include <ros/ros.h>
+#include <ros/callback_queue.h>
 
 // ROS message includes
 #include <diagnostic_msgs/DiagnosticStatus.h>
@@ -72,10 +81,36 @@
 #include <control_msgs/JointTrajectoryControllerState.h>
 
 // external includes
+#include <boost/atomic.hpp>
 #include <cob_undercarriage_ctrl/UndercarriageCtrlGeom.h>
+#include <cob_undercarriage_ctrl/OdometryIntegrator.h>
 #include <cob_utilities/IniFile.h>
+#include <cob_utilities/SeqLock.h>
 //#include <cob_utilities/MathSup.h>
 
+//##########################
+//#### helper functions ####
+
+// seconds on the monotonic clock (not affected by setting the system time)
+static double MonotonicNowS()
+{
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static void TimespecAddNS(timespec & t, long long delta_ns)
+{
+  delta_ns += t.tv_nsec;
+  t.tv_sec += (time_t)(delta_ns / 1000000000LL);
+  t.tv_nsec = (long)(delta_ns % 1000000000LL);
+}
+
+static long long TimespecDiffNS(const timespec & a, const timespec & b)
+{
+  return (long long)(a.tv_sec - b.tv_sec) * 1000000000LL + (a.tv_nsec - b.tv_nsec);
+}
+
 //####################
 //#### node class ####
 class NodeClass
@@ -111,16 +146,78 @@ class NodeClass
     std::string sIniDirectory;
     bool is_initialized_bool_;			// flag wether node is already up and running
     bool broadcast_tf_;			// flag wether to broadcast the tf from odom to base_link
-    int drive_chain_diagnostic_;		// flag whether base drive chain is operating normal
-    ros::Time last_time_;				// time Stamp for last odometry measurement
+    boost::atomic<int> drive_chain_diagnostic_;	// flag whether base drive chain is operating normal
     ros::Time joint_state_odom_stamp_;	// time stamp of joint states used for current odometry calc
     double sample_time_, timeout_;
-    double x_rob_m_, y_rob_m_, theta_rob_rad_; // accumulated motion of robot since startup
+    OdometryIntegrator odom_integrator_;	// accumulated motion of robot since startup
     int iwatchdog_;
-    double 	vel_x_rob_last_, vel_y_rob_last_, vel_theta_rob_last_; //save velocities for better odom calculation
     double max_vel_trans_, max_vel_rot_;
 
-    int m_iNumJoints;
+    int m_iNumJoints;			// joint 2*i is the drive, joint 2*i+1 the steer of wheel i
+    int num_wheels_;
+    std::vector<std::string> drive_joint_names_, steer_joint_names_;	// joint names per wheel
+
+    // buffers and messages of the control cycle, sized once in the constructor
+    // so that no memory is allocated per control step
+    std::vector<double> drive_jointvel_cmds_rads_, steer_jointvel_cmds_rads_, steer_jointang_cmds_rad_;
+    std::vector<double> drive_joint_ang_rad_, drive_joint_vel_rads_;
+    std::vector<double> steer_joint_ang_rad_, steer_joint_vel_rads_;
+    control_msgs::JointTrajectoryControllerState joint_state_cmd_;		// joint cmds of the control step
+    control_msgs::JointTrajectoryControllerState joint_state_zero_cmd_;	// zero joint cmds sent as heartbeat
+    geometry_msgs::TransformStamped odom_tf_;
+    nav_msgs::Odometry odom_top_;
+
+    // control thread (parameter ctrl_thread): the controller runs in a thread of its own at ctrl_rate
+    // instead of timer_ctrl_step_. Twist cmds and joint states are received on input_queue_ by a spinner
+    // of their own and handed over to the control thread via lock-free slots (latest value only),
+    // the joint cmds are published by a separate thread.
+    static const int c_iMaxNumWheels = UndercarriageKinematicsItf::c_iMaxNumWheels;
+    static const int c_iMaxNumJoints = 2 * UndercarriageKinematicsItf::c_iMaxNumWheels;
+
+    struct PltfCmdType
+    {
+      double vx_mms, vy_mms, w_rads;
+      double stamp_s;	// receive time on the monotonic clock, for the watchdog
+    };
+
+    struct WheelStateType
+    {
+      double drive_vel_rads[c_iMaxNumWheels], steer_vel_rads[c_iMaxNumWheels];
+      double drive_ang_rad[c_iMaxNumWheels], steer_ang_rad[c_iMaxNumWheels];
+    };
+
+    struct JointCmdType
+    {
+      ros::Time stamp;
+      double positions[c_iMaxNumJoints], velocities[c_iMaxNumJoints];
+    };
+
+    // timing of the control thread, collected over about one second
+    struct CtrlLoopStatsType
+    {
+      int num_cycles;
+      double latency_mean_us, latency_std_us, latency_max_us;	// wake-up time after the scheduled time
+      double step_mean_us, step_max_us;				// execution time of a control step
+      unsigned int overruns;					// cycles which were skipped since the thread woke up too late
+      unsigned int overruns_total;
+    };
+
+    bool ctrl_thread_;
+    double ctrl_rate_;
+    int ctrl_thread_priority_;			// SCHED_FIFO priority of the control thread, 0: normal scheduling
+    ros::NodeHandle n_input_;
+    ros::CallbackQueue input_queue_;
+    ros::AsyncSpinner * input_spinner_;
+    ros::Timer timer_ctrl_stats_;
+    pthread_t ctrl_thread_handle_, pub_thread_handle_;
+    boost::atomic<bool> ctrl_thread_running_;
+    sem_t pub_sem_;				// posted by the control thread for each new joint cmd
+    SeqLock<PltfCmdType> pltf_cmd_slot_;
+    SeqLock<WheelStateType> wheel_state_slot_;
+    SeqLock<JointCmdType> joint_cmd_slot_;
+    SeqLock<CtrlLoopStatsType> ctrl_stats_slot_;
+    boost::atomic<bool> em_stop_active_;
+    UndercarriageCtrlGeom * ucar_odom_;	// direct kinematics for the odometry (a copy of ucar_ctrl_ if ctrl_thread_)
 
     diagnostic_msgs::DiagnosticStatus diagnostic_status_lookup_; // used to access defines for warning levels
 
@@ -131,18 +228,48 @@ class NodeClass
       is_initialized_bool_ = false;
       broadcast_tf_ = true;
       iwatchdog_ = 0;
-      last_time_ = ros::Time::now();
+      m_iNumJoints = 0;
+      num_wheels_ = 0;
       sample_time_ = 0.020;
-      x_rob_m_ = 0.0;
-      y_rob_m_ = 0.0;
-      theta_rob_rad_ = 0.0;
-      vel_x_rob_last_ = 0.0;
-      vel_y_rob_last_ = 0.0;
-      vel_theta_rob_last_ = 0.0;
+      ctrl_thread_ = false;
+      ctrl_rate_ = 1.0 / sample_time_;
+      ctrl_thread_priority_ = 0;
+      input_spinner_ = NULL;
+      ctrl_thread_running_ = false;
+      em_stop_active_ = false;
       // set status of drive chain to WARN by default
       drive_chain_diagnostic_ = diagnostic_status_lookup_.OK; //WARN; <- THATS FOR DEBUGGING ONLY!
 
       // Parameters are set within the launch file
+      // optionally run the controller in a thread of its own at a higher rate
+      if (n.hasParam("ctrl_thread"))
+      {
+        n.getParam("ctrl_thread", ctrl_thread_);
+      }
+      if (ctrl_thread_)
+      {
+        if (n.hasParam("ctrl_rate"))
+        {
+          n.getParam("ctrl_rate", ctrl_rate_);
+          ROS_INFO("Control rate loaded from Parameter-Server is: %fHz", ctrl_rate_);
+        }
+        else
+        {
+          ROS_WARN("No parameter ctrl_rate on Parameter-Server. Using default: 250Hz");
+          ctrl_rate_ = 250.0;
+        }
+        if ( (ctrl_rate_ < 50.0) || (ctrl_rate_ > 1000.0) )
+        {
+          ctrl_rate_ = std::min(std::max(ctrl_rate_, 50.0), 1000.0);
+          ROS_WARN("ctrl_rate out of range [50Hz, 1000Hz]. Setting ctrl_rate to %fHz", ctrl_rate_);
+        }
+        if (n.hasParam("ctrl_thread_priority"))
+        {
+          n.getParam("ctrl_thread_priority", ctrl_thread_priority_);
+        }
+        sample_time_ = 1.0 / ctrl_rate_;
+      }
+
       // read in timeout for watchdog stopping the controller.
       if (n.hasParam("timeout"))
       {
@@ -197,11 +324,104 @@ class NodeClass
         n.getParam("broadcast_tf", broadcast_tf_);
       }
 
+      // noise model of the odometry (variances per m travelled / rad turned, correlation time of wheel slip)
+      OdometryIntegrator::ParamType odom_param = odom_integrator_.getParam();
+      if (n.hasParam("odom_var_lin_per_m"))
+      {
+        n.getParam("odom_var_lin_per_m", odom_param.dVarLinPerM);
+      }
+      if (n.hasParam("odom_var_rot_per_rad"))
+      {
+        n.getParam("odom_var_rot_per_rad", odom_param.dVarRotPerRad);
+      }
+      if (n.hasParam("odom_var_rot_per_m"))
+      {
+        n.getParam("odom_var_rot_per_m", odom_param.dVarRotPerM);
+      }
+      if (n.hasParam("odom_slip_corr_time"))
+      {
+        n.getParam("odom_slip_corr_time", odom_param.dSlipCorrTimeS);
+      }
+      odom_integrator_.setParam(odom_param);
+
       IniFile iniFile;
       iniFile.SetFileName(sIniDirectory + "Platform.ini", "PltfHardwareCoB3.h");
       iniFile.GetKeyInt("Config", "NumberOfMotors", &m_iNumJoints, true);
 
-      ucar_ctrl_ = new UndercarriageCtrlGeom(sIniDirectory);
+      try
+      {
+        ucar_ctrl_ = new UndercarriageCtrlGeom(sIniDirectory);
+      }
+      catch (const std::runtime_error& e)
+      {
+        ROS_FATAL("Undercarriage control initialization failed: %s", e.what());
+        throw;
+      }
+      ucar_odom_ = ucar_ctrl_;
+
+      // each wheel has a drive and a steer joint
+      num_wheels_ = ucar_ctrl_->GetNumberOfWheels();
+      if (m_iNumJoints != 2 * num_wheels_)
+      {
+        ROS_FATAL("NumberOfMotors (%d) in Platform.ini does not match 2 * NumberOfWheels (%d)", m_iNumJoints, num_wheels_);
+        throw std::runtime_error("NumberOfMotors does not match the number of wheels, check ini-Files!");
+      }
+
+      // names of the wheels, the joints are <wheel>_caster_r_wheel_joint (drive) and <wheel>_caster_rotation_joint (steer)
+      std::vector<std::string> wheel_names;
+      if (n.hasParam("wheel_names"))
+      {
+        n.getParam("wheel_names", wheel_names);
+        if ((int)wheel_names.size() != num_wheels_)
+        {
+          ROS_FATAL("Parameter wheel_names has %d entries, the platform has %d wheels", (int)wheel_names.size(), num_wheels_);
+          throw std::runtime_error("Parameter wheel_names does not match the number of wheels!");
+        }
+      }
+      else if (num_wheels_ == 4)
+      {
+        wheel_names.push_back("fl");
+        wheel_names.push_back("bl");
+        wheel_names.push_back("br");
+        wheel_names.push_back("fr");
+      }
+      else
+      {
+        for(int i = 0; i < num_wheels_; i++)
+        {
+          char name[16];
+          snprintf(name, sizeof(name), "wheel%d", i + 1);
+          wheel_names.push_back(name);
+        }
+        ROS_WARN("No parameter wheel_names on Parameter-Server. Using default: wheel1 .. wheel%d", num_wheels_);
+      }
+      for(int i = 0; i < num_wheels_; i++)
+      {
+        drive_joint_names_.push_back(wheel_names[i] + "_caster_r_wheel_joint");
+        steer_joint_names_.push_back(wheel_names[i] + "_caster_rotation_joint");
+      }
+
+      // preallocate buffers of the control cycle
+      drive_jointvel_cmds_rads_.assign(num_wheels_, 0.0);
+      steer_jointvel_cmds_rads_.assign(num_wheels_, 0.0);
+      steer_jointang_cmds_rad_.assign(num_wheels_, 0.0);
+      drive_joint_ang_rad_.assign(num_wheels_, 0.0);
+      drive_joint_vel_rads_.assign(num_wheels_, 0.0);
+      steer_joint_ang_rad_.assign(num_wheels_, 0.0);
+      steer_joint_vel_rads_.assign(num_wheels_, 0.0);
+
+      // preallocate messages, only data and stamps are updated per cycle
+      InitJointCmdMsg(joint_state_cmd_);
+      InitJointCmdMsg(joint_state_zero_cmd_);
+      odom_tf_.header.frame_id = "/odom_combined";
+      odom_tf_.child_frame_id = "/base_footprint";
+      odom_top_.header.frame_id = "/odom_combined";
+      odom_top_.child_frame_id = "/base_footprint";
+      for(int i = 0; i < 6; i++)
+      {
+        odom_top_.pose.covariance[i*6+i] = 0.1;
+        odom_top_.twist.covariance[6*i+i] = 0.1;
+      }
 
 
       // implementation of topics
@@ -212,27 +432,36 @@ class NodeClass
       topic_pub_odometry_ = n.advertise<nav_msgs::Odometry>("odometry", 1);
 
       // subscribed topics
-      topic_sub_CMD_pltf_twist_ = n.subscribe("command", 1, &NodeClass::topicCallbackTwistCmd, this);
+      // (inputs of the control thread are received on input_queue_, so they don't wait for the other callbacks)
+      n_input_.setCallbackQueue(&input_queue_);
+      ros::NodeHandle & n_ctrl_input = ctrl_thread_ ? n_input_ : n;
+      topic_sub_CMD_pltf_twist_ = n_ctrl_input.subscribe("command", 1, &NodeClass::topicCallbackTwistCmd, this);
       topic_sub_EM_stop_state_ = n.subscribe("/emergency_stop_state", 1, &NodeClass::topicCallbackEMStop, this);
       topic_sub_drive_diagnostic_ = n.subscribe("diagnostic", 1, &NodeClass::topicCallbackDiagnostic, this);
 
 
 
       //topic_sub_joint_states_ = n.subscribe("/joint_states", 1, &NodeClass::topicCallbackJointStates, this);
-      topic_sub_joint_controller_states_ = n.subscribe("state", 1, &NodeClass::topicCallbackJointControllerStates, this);
+      topic_sub_joint_controller_states_ = n_ctrl_input.subscribe("state", 1, &NodeClass::topicCallbackJointControllerStates, this);
 
       // diagnostics
       updater_.setHardwareID(ros::this_node::getName());
       updater_.add("initialization", this, &NodeClass::diag_init);
 
       //set up timer to cyclically call controller-step
-      timer_ctrl_step_ = n.createTimer(ros::Duration(sample_time_), &NodeClass::timerCallbackCtrlStep, this);
+      //(the control thread is started by StartCtrlThread() once the controller is initialized)
+      if (!ctrl_thread_)
+        timer_ctrl_step_ = n.createTimer(ros::Duration(sample_time_), &NodeClass::timerCallbackCtrlStep, this);
 
     }
 
     // Destructor
     ~NodeClass()
     {
+      StopCtrlThread();
+
+      if (ucar_odom_ != ucar_ctrl_)
+        delete ucar_odom_;
     }
 
     void diag_init(diagnostic_updater::DiagnosticStatusWrapper &stat)
@@ -244,6 +473,31 @@ class NodeClass
       stat.add("Initialized", is_initialized_bool_);
     }
 
+    void diag_ctrl_loop(diagnostic_updater::DiagnosticStatusWrapper &stat)
+    {
+      CtrlLoopStatsType stats;
+
+      if (ctrl_stats_slot_.read(stats) == 0)
+      {
+        stat.summary(diagnostic_msgs::DiagnosticStatus::WARN, "no statistics yet");
+        return;
+      }
+
+      if (stats.overruns > 0)
+        stat.summary(diagnostic_msgs::DiagnosticStatus::WARN, "control cycles skipped");
+      else
+        stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "");
+      stat.add("Rate [Hz]", ctrl_rate_);
+      stat.add("Cycles", stats.num_cycles);
+      stat.add("Latency mean [us]", stats.latency_mean_us);
+      stat.add("Latency std dev [us]", stats.latency_std_us);
+      stat.add("Latency max [us]", stats.latency_max_us);
+      stat.add("Step time mean [us]", stats.step_mean_us);
+      stat.add("Step time max [us]", stats.step_max_us);
+      stat.add("Skipped cycles", stats.overruns);
+      stat.add("Skipped cycles total", stats.overruns_total);
+    }
+
     // Listen for Pltf Cmds
     void topicCallbackTwistCmd(const geometry_msgs::Twist::ConstPtr& msg)
     {
@@ -254,7 +508,10 @@ class NodeClass
         iwatchdog_ = 0;
         ROS_FATAL("Received NaN-value in Twist message. Stopping the robot.");
         // force platform velocity commands to zero;
-        ucar_ctrl_->SetDesiredPltfVelocity(0.0, 0.0, 0.0, 0.0);
+        if (ctrl_thread_)
+          WritePltfCmd(0.0, 0.0, 0.0);
+        else
+          ucar_ctrl_->SetDesiredPltfVelocity(0.0, 0.0, 0.0, 0.0);
         ROS_DEBUG("Forced platform velocity commands to zero");
         return;
       }
@@ -292,6 +549,13 @@ class NodeClass
 
       iwatchdog_ = 0;
 
+      // the control thread checks the state of the drive chain itself
+      if (ctrl_thread_)
+      {
+        WritePltfCmd(vx_cmd_mms, vy_cmd_mms, w_cmd_rads);
+        return;
+      }
+
       // only process if controller is already initialized
       if (is_initialized_bool_ && drive_chain_diagnostic_==diagnostic_status_lookup_.OK)
       {
@@ -318,6 +582,13 @@ class NodeClass
       int EM_state;
       EM_state = msg->emergency_state;
 
+      // the control thread applies the EM flag itself
+      if (ctrl_thread_)
+      {
+        em_stop_active_ = (EM_state != msg->EMFREE);
+        return;
+      }
+
       if (EM_state == msg->EMFREE)
       {
         // Reset EM flag in Ctrlr
@@ -346,34 +617,8 @@ class NodeClass
     // Listens for status of underlying hardware (base drive chain)
     void topicCallbackDiagnostic(const diagnostic_msgs::DiagnosticStatus::ConstPtr& msg)
     {
-      control_msgs::JointTrajectoryControllerState joint_state_cmd;
-
-      // prepare joint_cmds for heartbeat (compose header)
-      joint_state_cmd.header.stamp = ros::Time::now();
-      //joint_state_cmd.header.frame_id = frame_id; //Where to get this id from?
-      // ToDo: configure over Config-File (number of motors) and Msg
-      // assign right size to JointState data containers
-      //joint_state_cmd.set_name_size(m_iNumMotors);
-      joint_state_cmd.desired.positions.resize(m_iNumJoints);
-      joint_state_cmd.desired.velocities.resize(m_iNumJoints);
-      //joint_state_cmd.desired.effort.resize(m_iNumJoints);
-      joint_state_cmd.joint_names.push_back("fl_caster_r_wheel_joint");
-      joint_state_cmd.joint_names.push_back("fl_caster_rotation_joint");
-      joint_state_cmd.joint_names.push_back("bl_caster_r_wheel_joint");
-      joint_state_cmd.joint_names.push_back("bl_caster_rotation_joint");
-      joint_state_cmd.joint_names.push_back("br_caster_r_wheel_joint");
-      joint_state_cmd.joint_names.push_back("br_caster_rotation_joint");
-      joint_state_cmd.joint_names.push_back("fr_caster_r_wheel_joint");
-      joint_state_cmd.joint_names.push_back("fr_caster_rotation_joint");
-      joint_state_cmd.joint_names.resize(m_iNumJoints);
-
-      // compose jointcmds
-      for(int i=0; i<m_iNumJoints; i++)
-      {
-        joint_state_cmd.desired.positions[i] = 0.0;
-        joint_state_cmd.desired.velocities[i] = 0.0;
-        //joint_state_cmd.desired.effort[i] = 0.0;
-      }
+      // prepare joint_cmds for heartbeat (compose header), data is zero from InitJointCmdMsg
+      joint_state_zero_cmd_.header.stamp = ros::Time::now();
 
       // set status of underlying drive chain to member variable
       drive_chain_diagnostic_ = msg->level;
@@ -387,13 +632,17 @@ class NodeClass
           // halt controller
           ROS_DEBUG("drive chain not availlable: halt Controller");
 
-          // Set EM flag to Ctrlr (resets internal states)
-          ucar_ctrl_->setEMStopActive(true);
+          // (the control thread halts itself on drive_chain_diagnostic_)
+          if (!ctrl_thread_)
+          {
+            // Set EM flag to Ctrlr (resets internal states)
+            ucar_ctrl_->setEMStopActive(true);
 
-          // Set desired value for Plattform Velocity to zero (setpoint setting)
-          ucar_ctrl_->SetDesiredPltfVelocity( 0.0, 0.0, 0.0, 0.0);
-          // ToDo: last value (0.0) is not used anymore --> remove from interface
-          ROS_DEBUG("Forced platform-velocity cmds to zero");
+            // Set desired value for Plattform Velocity to zero (setpoint setting)
+            ucar_ctrl_->SetDesiredPltfVelocity( 0.0, 0.0, 0.0, 0.0);
+            // ToDo: last value (0.0) is not used anymore --> remove from interface
+            ROS_DEBUG("Forced platform-velocity cmds to zero");
+          }
 
           // if is not Initializing
           if (drive_chain_diagnostic_ != diagnostic_status_lookup_.WARN)
@@ -410,91 +659,63 @@ class NodeClass
         if(drive_chain_diagnostic_ != diagnostic_status_lookup_.WARN)
         {
           // publish zero-vel. jointcmds to avoid Watchdogs stopping ctrlr
-          topic_pub_controller_joint_command_.publish(joint_state_cmd);
+          topic_pub_controller_joint_command_.publish(joint_state_zero_cmd_);
         }
       }
     }
 
     void topicCallbackJointControllerStates(const control_msgs::JointTrajectoryControllerState::ConstPtr& msg) {
       int num_joints;
-      int iter_k, iter_j;
-      std::vector<double> drive_joint_ang_rad, drive_joint_vel_rads, drive_joint_effort_NM;
-      std::vector<double> steer_joint_ang_rad, steer_joint_vel_rads, steer_joint_effort_NM;
 
       joint_state_odom_stamp_ = msg->header.stamp;
 
-      // copy configuration into vector classes
+      // copy configuration into the preallocated buffers
       num_joints = msg->joint_names.size();
       // drive joints
-      drive_joint_ang_rad.assign(m_iNumJoints, 0.0);
-      drive_joint_vel_rads.assign(m_iNumJoints, 0.0);
-      drive_joint_effort_NM.assign(m_iNumJoints, 0.0);
+      std::fill(drive_joint_ang_rad_.begin(), drive_joint_ang_rad_.end(), 0.0);
+      std::fill(drive_joint_vel_rads_.begin(), drive_joint_vel_rads_.end(), 0.0);
       // steer joints
-      steer_joint_ang_rad.assign(m_iNumJoints, 0.0);
-      steer_joint_vel_rads.assign(m_iNumJoints, 0.0);
-      steer_joint_effort_NM.assign(m_iNumJoints, 0.0);
-
-      // init iterators
-      iter_k = 0;
-      iter_j = 0;
+      std::fill(steer_joint_ang_rad_.begin(), steer_joint_ang_rad_.end(), 0.0);
+      std::fill(steer_joint_vel_rads_.begin(), steer_joint_vel_rads_.end(), 0.0);
 
       for(int i = 0; i < num_joints; i++)
       {
         // associate inputs to according steer and drive joints
-        // ToDo: specify this globally (Prms-File or config-File or via msg-def.)
-        if(msg->joint_names[i] ==  "fl_caster_r_wheel_joint")
-        {
-          drive_joint_ang_rad[0] = msg->actual.positions[i];
-          drive_joint_vel_rads[0] = msg->actual.velocities[i];
-          //drive_joint_effort_NM[0] = msg->effort[i];
-        }
-        if(msg->joint_names[i] ==  "bl_caster_r_wheel_joint")
-        {
-          drive_joint_ang_rad[1] = msg->actual.positions[i];
-          drive_joint_vel_rads[1] = msg->actual.velocities[i];
-          //drive_joint_effort_NM[1] = msg->effort[i];
-        }
-        if(msg->joint_names[i] ==  "br_caster_r_wheel_joint")
-        {
-          drive_joint_ang_rad[2] = msg->actual.positions[i];
-          drive_joint_vel_rads[2] = msg->actual.velocities[i];
-          //drive_joint_effort_NM[2] = msg->effort[i];
-        }
-        if(msg->joint_names[i] ==  "fr_caster_r_wheel_joint")
-        {
-          drive_joint_ang_rad[3] = msg->actual.positions[i];
-          drive_joint_vel_rads[3] = msg->actual.velocities[i];
-          //drive_joint_effort_NM[3] = msg->effort[i];
-        }
-        if(msg->joint_names[i] ==  "fl_caster_rotation_joint")
-        {
-          steer_joint_ang_rad[0] = msg->actual.positions[i];
-          steer_joint_vel_rads[0] = msg->actual.velocities[i];
-          //steer_joint_effort_NM[0] = msg->effort[i];
-        }
-        if(msg->joint_names[i] ==  "bl_caster_rotation_joint")
-        {
-          steer_joint_ang_rad[1] = msg->actual.positions[i];
-          steer_joint_vel_rads[1] = msg->actual.velocities[i];
-          //steer_joint_effort_NM[1] = msg->effort[i];
-        }
-        if(msg->joint_names[i] ==  "br_caster_rotation_joint")
-        {
-          steer_joint_ang_rad[2] = msg->actual.positions[i];
-          steer_joint_vel_rads[2] = msg->actual.velocities[i];
-          //steer_joint_effort_NM[2] = msg->effort[i];
-        }
-        if(msg->joint_names[i] ==  "fr_caster_rotation_joint")
+        for(int j = 0; j < num_wheels_; j++)
         {
-          steer_joint_ang_rad[3] = msg->actual.positions[i];
-          steer_joint_vel_rads[3] = msg->actual.velocities[i];
-          //steer_joint_effort_NM[3] = msg->effort[i];
+          if(msg->joint_names[i] == drive_joint_names_[j])
+          {
+            drive_joint_ang_rad_[j] = msg->actual.positions[i];
+            drive_joint_vel_rads_[j] = msg->actual.velocities[i];
+            break;
+          }
+          if(msg->joint_names[i] == steer_joint_names_[j])
+          {
+            steer_joint_ang_rad_[j] = msg->actual.positions[i];
+            steer_joint_vel_rads_[j] = msg->actual.velocities[i];
+            break;
+          }
         }
       }
 
       // Set measured Wheel Velocities and Angles to Controler Class (implements inverse kinematic)
-      ucar_ctrl_->SetActualWheelValues(drive_joint_vel_rads, steer_joint_vel_rads,
-          drive_joint_ang_rad, steer_joint_ang_rad);
+      // (ucar_odom_ is ucar_ctrl_ unless the controller runs in the control thread)
+      ucar_odom_->SetActualWheelValues(&drive_joint_vel_rads_[0], &steer_joint_vel_rads_[0],
+          &drive_joint_ang_rad_[0], &steer_joint_ang_rad_[0]);
+
+      // hand over to the control thread
+      if (ctrl_thread_)
+      {
+        WheelStateType wheel_state;
+        for(int i = 0; i < num_wheels_; i++)
+        {
+          wheel_state.drive_vel_rads[i] = drive_joint_vel_rads_[i];
+          wheel_state.steer_vel_rads[i] = steer_joint_vel_rads_[i];
+          wheel_state.drive_ang_rad[i] = drive_joint_ang_rad_[i];
+          wheel_state.steer_ang_rad[i] = steer_joint_ang_rad_[i];
+        }
+        wheel_state_slot_.write(wheel_state);
+      }
 
 
       // calculate odometry every time
@@ -506,11 +727,56 @@ class NodeClass
       CalcCtrlStep();
     }
 
+    void timerCallbackCtrlStats(const ros::TimerEvent& e) {
+      CtrlLoopStatsType stats;
+
+      if (ctrl_stats_slot_.read(stats) != 0)
+      {
+        ROS_DEBUG("Control loop: latency mean=%.1fus std=%.1fus max=%.1fus, step mean=%.1fus max=%.1fus, skipped=%u",
+            stats.latency_mean_us, stats.latency_std_us, stats.latency_max_us, stats.step_mean_us, stats.step_max_us, stats.overruns);
+      }
+      updater_.update();
+    }
+
+    // hands a platform cmd over to the control thread
+    void WritePltfCmd(double vx_cmd_mms, double vy_cmd_mms, double w_cmd_rads) {
+      PltfCmdType cmd;
+
+      cmd.vx_mms = vx_cmd_mms;
+      cmd.vy_mms = vy_cmd_mms;
+      cmd.w_rads = w_cmd_rads;
+      cmd.stamp_s = MonotonicNowS();
+      pltf_cmd_slot_.write(cmd);
+    }
+
+    static void * CtrlThreadFunc(void * arg) {
+      ((NodeClass *)arg)->CtrlThreadRun();
+      return NULL;
+    }
+
+    static void * PubThreadFunc(void * arg) {
+      ((NodeClass *)arg)->PubThreadRun();
+      return NULL;
+    }
+
     // other function declarations
+    // sets joint names and sizes of a joint cmd msg, data is set to zero
+    void InitJointCmdMsg(control_msgs::JointTrajectoryControllerState & joint_state_cmd);
     // Initializes controller
     bool InitCtrl();
     // perform one control step, calculate inverse kinematics and publish updated joint cmd's (if no EMStop occurred)
     void CalcCtrlStep();
+    // gets the cmds of the control step and composes the joint cmds (zero if the watchdog expired)
+    void CalcJointCmds(bool watchdog_ok, double * positions, double * velocities);
+    // starts the control thread, the publishing thread and the spinner of the inputs (if ctrl_thread_)
+    bool StartCtrlThread();
+    void StopCtrlThread();
+    // scheduling loop of the control thread
+    void CtrlThreadRun();
+    // one step of the control thread: apply inputs, control step, hand over joint cmds
+    void CtrlThreadStep(unsigned int & wheel_state_seq, unsigned int & pltf_cmd_seq, bool & halted);
+    // publishes the joint cmds of the control thread
+    void PubThreadRun();
     // acquires the current undercarriage configuration from base_drive_chain
     // calculates odometry from current measurement values and publishes it via an odometry topic and the tf broadcaster
     void UpdateOdometry();
@@ -531,17 +797,24 @@ int main(int argc, char** argv)
   nodeClass.is_initialized_bool_ = true;
 
   if( nodeClass.is_initialized_bool_ ) {
-    nodeClass.last_time_ = ros::Time::now();
     ROS_INFO("Undercarriage control successfully initialized.");
   } else {
     ROS_FATAL("Undercarriage control initialization failed!");
     throw std::runtime_error("Undercarriage control initialization failed, check ini-Files!");
   }
 
+  // optionally run the controller in a thread of its own
+  if( !nodeClass.StartCtrlThread() ) {
+    ROS_FATAL("Undercarriage control thread could not be started!");
+    throw std::runtime_error("Undercarriage control thread could not be started!");
+  }
+
   /*
      CALLBACKS being executed are:
      - actual motor values -> calculating direct kinematics and doing odometry (topicCallbackJointControllerStates)
      - timer callback -> calculate controller step at a rate of sample_time_ (timerCallbackCtrlStep)
+       or, if ctrl_thread is set, the control thread at ctrl_rate (CtrlThreadRun), whose inputs
+       (command, state) are received by a spinner thread of their own
      - other topic callbacks (diagnostics, command, em_stop_state)
      */
   ros::spin();
@@ -552,13 +825,26 @@ int main(int argc, char** argv)
 //##################################
 //#### function implementations ####
 
+// sets joint names and sizes of a joint cmd msg, data is set to zero
+void NodeClass::InitJointCmdMsg(control_msgs::JointTrajectoryControllerState & joint_state_cmd)
+{
+  //joint_state_cmd.header.frame_id = frame_id; //Where to get this id from?
+  // assign right size to JointState data containers
+  joint_state_cmd.desired.positions.assign(m_iNumJoints, 0.0);
+  joint_state_cmd.desired.velocities.assign(m_iNumJoints, 0.0);
+  //joint_state_cmd.effort.assign(m_iNumJoints, 0.0);
+  joint_state_cmd.joint_names.clear();
+  for(int i = 0; i < num_wheels_; i++)
+  {
+    joint_state_cmd.joint_names.push_back(drive_joint_names_[i]);
+    joint_state_cmd.joint_names.push_back(steer_joint_names_[i]);
+  }
+}
+
 // perform one control step, calculate inverse kinematics and publish updated joint cmd's (if no EMStop occurred)
+// Note: works on the preallocated buffers and joint_state_cmd_, no memory is allocated here
 void NodeClass::CalcCtrlStep()
 {
-  double vx_cmd_ms, vy_cmd_ms, w_cmd_rads, dummy;
-  std::vector<double> drive_jointvel_cmds_rads, steer_jointvel_cmds_rads, steer_jointang_cmds_rad;
-  control_msgs::JointTrajectoryControllerState joint_state_cmd;
-  int j, k;
   iwatchdog_ += 1;
 
   // if controller is initialized and underlying hardware is operating normal
@@ -568,88 +854,309 @@ void NodeClass::CalcCtrlStep()
     // Note: topicCallbackDiagnostic checks whether drives are operating nominal.
     //       -> if warning or errors are issued target velocity is set to zero
 
-    // perform one control step,
-    // get the resulting cmd's for the wheel velocities and -angles from the controller class
-    // and output the achievable pltf velocity-cmds (if velocity limits where exceeded)
-    ucar_ctrl_->GetNewCtrlStateSteerDriveSetValues(drive_jointvel_cmds_rads,  steer_jointvel_cmds_rads, steer_jointang_cmds_rad, vx_cmd_ms, vy_cmd_ms, w_cmd_rads, dummy);
-    // ToDo: adapt interface of controller class --> remove last values (not used anymore)
+    // compose jointcmds
+    // compose header
+    // (names and sizes are set once by InitJointCmdMsg)
+    joint_state_cmd_.header.stamp = ros::Time::now();
+
+    // compose data body
+    CalcJointCmds(iwatchdog_ < (int) std::floor(timeout_/sample_time_),
+        &joint_state_cmd_.desired.positions[0], &joint_state_cmd_.desired.velocities[0]);
+
+    // publish jointcmds
+    topic_pub_controller_joint_command_.publish(joint_state_cmd_);
+  }
+
+}
 
-    // if drives not operating nominal -> force commands to zero
-    if(drive_chain_diagnostic_ != diagnostic_status_lookup_.OK)
+// gets the cmds of the control step and composes the joint cmds (m_iNumJoints elements each)
+void NodeClass::CalcJointCmds(bool watchdog_ok, double * positions, double * velocities)
+{
+  double vx_cmd_ms, vy_cmd_ms, w_cmd_rads, dummy;
+
+  // perform one control step,
+  // get the resulting cmd's for the wheel velocities and -angles from the controller class
+  // and output the achievable pltf velocity-cmds (if velocity limits where exceeded)
+  ucar_ctrl_->GetNewCtrlStateSteerDriveSetValues(&drive_jointvel_cmds_rads_[0], &steer_jointvel_cmds_rads_[0], &steer_jointang_cmds_rad_[0], vx_cmd_ms, vy_cmd_ms, w_cmd_rads, dummy);
+  // ToDo: adapt interface of controller class --> remove last values (not used anymore)
+
+  // if drives not operating nominal -> force commands to zero
+  if(drive_chain_diagnostic_ != diagnostic_status_lookup_.OK)
+  {
+    std::fill(steer_jointang_cmds_rad_.begin(), steer_jointang_cmds_rad_.end(), 0.0);
+    std::fill(steer_jointvel_cmds_rads_.begin(), steer_jointvel_cmds_rads_.end(), 0.0);
+  }
+
+  // convert variables to SI-Units
+  vx_cmd_ms = vx_cmd_ms/1000.0;
+  vy_cmd_ms = vy_cmd_ms/1000.0;
+
+  // joint 2*i is the drive, joint 2*i+1 the steer of wheel i (see InitJointCmdMsg)
+  for(int i = 0; i < num_wheels_; i++)
+  {
+    if(watchdog_ok)
+    {
+      positions[2*i] = 0.0;
+      velocities[2*i] = drive_jointvel_cmds_rads_[i];
+      positions[2*i+1] = steer_jointang_cmds_rad_[i];
+      velocities[2*i+1] = steer_jointvel_cmds_rads_[i];
+    }
+    else
     {
-      steer_jointang_cmds_rad.assign(m_iNumJoints, 0.0);
-      steer_jointvel_cmds_rads.assign(m_iNumJoints, 0.0);
+      positions[2*i] = 0.0;
+      velocities[2*i] = 0.0;
+      positions[2*i+1] = 0.0;
+      velocities[2*i+1] = 0.0;
     }
+  }
+}
 
-    // convert variables to SI-Units
-    vx_cmd_ms = vx_cmd_ms/1000.0;
-    vy_cmd_ms = vy_cmd_ms/1000.0;
+// starts the control thread, the publishing thread and the spinner of the inputs
+bool NodeClass::StartCtrlThread()
+{
+  pthread_attr_t attr;
+  sched_param param;
+  int ret;
 
-    // compose jointcmds
-    // compose header
-    joint_state_cmd.header.stamp = ros::Time::now();
-    //joint_state_cmd.header.frame_id = frame_id; //Where to get this id from?
-    // ToDo: configure over Config-File (number of motors) and Msg
-    // assign right size to JointState data containers
-    //joint_state_cmd.set_name_size(m_iNumMotors);
-    joint_state_cmd.desired.positions.resize(m_iNumJoints);
-    joint_state_cmd.desired.velocities.resize(m_iNumJoints);
-    //joint_state_cmd.effort.resize(m_iNumJoints);
-    joint_state_cmd.joint_names.push_back("fl_caster_r_wheel_joint");
-    joint_state_cmd.joint_names.push_back("fl_caster_rotation_joint");
-    joint_state_cmd.joint_names.push_back("bl_caster_r_wheel_joint");
-    joint_state_cmd.joint_names.push_back("bl_caster_rotation_joint");
-    joint_state_cmd.joint_names.push_back("br_caster_r_wheel_joint");
-    joint_state_cmd.joint_names.push_back("br_caster_rotation_joint");
-    joint_state_cmd.joint_names.push_back("fr_caster_r_wheel_joint");
-    joint_state_cmd.joint_names.push_back("fr_caster_rotation_joint");
-    joint_state_cmd.joint_names.resize(m_iNumJoints);
+  if (!ctrl_thread_)
+    return true;
 
-    // compose data body
-    j = 0;
-    k = 0;
-    for(int i = 0; i<m_iNumJoints; i++)
+  // the controller integrates with the rate of the thread
+  ucar_ctrl_->SetCmdRate(1.0 / ctrl_rate_);
+  // the odometry is calculated in the thread of the inputs, it gets its own copy of the kinematics
+  ucar_odom_ = new UndercarriageCtrlGeom(*ucar_ctrl_);
+
+  if (sem_init(&pub_sem_, 0, 0) != 0)
+  {
+    ROS_ERROR("Could not create semaphore of the control thread: %s", strerror(errno));
+    return false;
+  }
+
+  ctrl_thread_running_ = true;
+
+  ret = pthread_create(&pub_thread_handle_, NULL, &NodeClass::PubThreadFunc, this);
+  if (ret != 0)
+  {
+    ROS_ERROR("Could not create publishing thread: %s", strerror(ret));
+    ctrl_thread_running_ = false;
+    sem_destroy(&pub_sem_);
+    return false;
+  }
+
+  pthread_attr_init(&attr);
+  if (ctrl_thread_priority_ > 0)
+  {
+    param.sched_priority = ctrl_thread_priority_;
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &param);
+  }
+  ret = pthread_create(&ctrl_thread_handle_, &attr, &NodeClass::CtrlThreadFunc, this);
+  if ((ret == EPERM) && (ctrl_thread_priority_ > 0))
+  {
+    ROS_WARN("No permission for SCHED_FIFO priority %d, control thread runs with normal priority", ctrl_thread_priority_);
+    ret = pthread_create(&ctrl_thread_handle_, NULL, &NodeClass::CtrlThreadFunc, this);
+  }
+  pthread_attr_destroy(&attr);
+  if (ret != 0)
+  {
+    ROS_ERROR("Could not create control thread: %s", strerror(ret));
+    ctrl_thread_running_ = false;
+    sem_post(&pub_sem_);
+    pthread_join(pub_thread_handle_, NULL);
+    sem_destroy(&pub_sem_);
+    return false;
+  }
+
+  input_spinner_ = new ros::AsyncSpinner(1, &input_queue_);
+  input_spinner_->start();
+
+  updater_.add("control loop", this, &NodeClass::diag_ctrl_loop);
+  timer_ctrl_stats_ = n.createTimer(ros::Duration(1.0), &NodeClass::timerCallbackCtrlStats, this);
+
+  ROS_INFO("Control thread running at %fHz", ctrl_rate_);
+  return true;
+}
+
+// stops the threads started by StartCtrlThread
+void NodeClass::StopCtrlThread()
+{
+  if (!ctrl_thread_running_)
+    return;
+
+  if (input_spinner_ != NULL)
+  {
+    input_spinner_->stop();
+    delete input_spinner_;
+    input_spinner_ = NULL;
+  }
+
+  ctrl_thread_running_ = false;
+  pthread_join(ctrl_thread_handle_, NULL);
+  sem_post(&pub_sem_);
+  pthread_join(pub_thread_handle_, NULL);
+  sem_destroy(&pub_sem_);
+}
+
+// scheduling loop of the control thread
+// The cycles are scheduled on absolute times of the monotonic clock, so the period doesn't drift
+// with the execution time. If the thread wakes up more than a period too late, the missed cycles
+// are skipped (and counted) instead of being run in a burst.
+void NodeClass::CtrlThreadRun()
+{
+  timespec next, now, done;
+  long long period_ns, latency_ns, step_ns, missed;
+  unsigned int wheel_state_seq = 0, pltf_cmd_seq = 0;
+  bool halted = false;
+  CtrlLoopStatsType stats;
+  double latency_sum = 0.0, latency_sum_sq = 0.0, step_sum = 0.0;
+  int window;
+
+  period_ns = (long long)(1e9 / ctrl_rate_ + 0.5);
+  window = (int)(ctrl_rate_ + 0.5);
+
+  stats.overruns_total = 0;
+  stats.num_cycles = 0;
+
+  clock_gettime(CLOCK_MONOTONIC, &next);
+
+  while (ctrl_thread_running_)
+  {
+    if (stats.num_cycles == 0)
     {
-      if(iwatchdog_ < (int) std::floor(timeout_/sample_time_) )
-      {
-        // for steering motors
-        if( i == 1 || i == 3 || i == 5 || i == 7) // ToDo: specify this via the Msg
-        {
-          joint_state_cmd.desired.positions[i] = steer_jointang_cmds_rad[j];
-          joint_state_cmd.desired.velocities[i] = steer_jointvel_cmds_rads[j];
-          //joint_state_cmd.effort[i] = 0.0;
-          j = j + 1;
-        }
-        else
-        {
-          joint_state_cmd.desired.positions[i] = 0.0;
-          joint_state_cmd.desired.velocities[i] = drive_jointvel_cmds_rads[k];
-          //joint_state_cmd.effort[i] = 0.0;
-          k = k + 1;
-        }
-      }
-      else
-      {
-        joint_state_cmd.desired.positions[i] = 0.0;
-        joint_state_cmd.desired.velocities[i] = 0.0;
-        //joint_state_cmd.effort[i] = 0.0;
-      }
+      latency_sum = 0.0;
+      latency_sum_sq = 0.0;
+      step_sum = 0.0;
+      stats.latency_max_us = 0.0;
+      stats.step_max_us = 0.0;
+      stats.overruns = 0;
     }
 
-    // publish jointcmds
-    topic_pub_controller_joint_command_.publish(joint_state_cmd);
+    TimespecAddNS(next, period_ns);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR) {}
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    latency_ns = TimespecDiffNS(now, next);
+    if (latency_ns >= period_ns)
+    {
+      missed = latency_ns / period_ns;
+      stats.overruns += (unsigned int)missed;
+      stats.overruns_total += (unsigned int)missed;
+      TimespecAddNS(next, missed * period_ns);
+    }
+
+    CtrlThreadStep(wheel_state_seq, pltf_cmd_seq, halted);
+
+    clock_gettime(CLOCK_MONOTONIC, &done);
+    step_ns = TimespecDiffNS(done, now);
+
+    // statistics
+    latency_sum += latency_ns * 1e-3;
+    latency_sum_sq += (latency_ns * 1e-3) * (latency_ns * 1e-3);
+    stats.latency_max_us = std::max(stats.latency_max_us, latency_ns * 1e-3);
+    step_sum += step_ns * 1e-3;
+    stats.step_max_us = std::max(stats.step_max_us, step_ns * 1e-3);
+    stats.num_cycles++;
+
+    if (stats.num_cycles >= window)
+    {
+      stats.latency_mean_us = latency_sum / stats.num_cycles;
+      stats.latency_std_us = sqrt(std::max(latency_sum_sq / stats.num_cycles - stats.latency_mean_us * stats.latency_mean_us, 0.0));
+      stats.step_mean_us = step_sum / stats.num_cycles;
+      ctrl_stats_slot_.write(stats);
+      stats.num_cycles = 0;
+    }
+  }
+}
+
+// one step of the control thread: apply the latest inputs, control step, hand over the joint cmds
+void NodeClass::CtrlThreadStep(unsigned int & wheel_state_seq, unsigned int & pltf_cmd_seq, bool & halted)
+{
+  WheelStateType wheel_state;
+  PltfCmdType pltf_cmd;
+  JointCmdType joint_cmd;
+  unsigned int seq;
+  bool halt, drive_chain_ok;
+
+  drive_chain_ok = (drive_chain_diagnostic_ == diagnostic_status_lookup_.OK);
+
+  // measured wheel values (only if new ones arrived)
+  seq = wheel_state_slot_.read(wheel_state);
+  if (seq != wheel_state_seq)
+  {
+    wheel_state_seq = seq;
+    ucar_ctrl_->SetActualWheelValues(wheel_state.drive_vel_rads, wheel_state.steer_vel_rads,
+        wheel_state.drive_ang_rad, wheel_state.steer_ang_rad);
   }
 
+  // new platform cmd -> set point (zero if the drive chain is not operating normal)
+  seq = pltf_cmd_slot_.read(pltf_cmd);
+  if (seq != pltf_cmd_seq)
+  {
+    pltf_cmd_seq = seq;
+    if (drive_chain_ok)
+      ucar_ctrl_->SetDesiredPltfVelocity(pltf_cmd.vx_mms, pltf_cmd.vy_mms, pltf_cmd.w_rads, 0.0);
+    else
+      ucar_ctrl_->SetDesiredPltfVelocity(0.0, 0.0, 0.0, 0.0);
+  }
+
+  // halt controller on EM-Stop or if the drive chain is not operating normal
+  halt = em_stop_active_ || !drive_chain_ok;
+  if (halt && !halted)
+  {
+    ROS_DEBUG("Undercarriage Controller stopped due to EM-Stop or drive chain state");
+    ucar_ctrl_->SetDesiredPltfVelocity(0.0, 0.0, 0.0, 0.0);
+    ucar_ctrl_->setEMStopActive(true);
+  }
+  else if (!halt && halted)
+  {
+    ROS_DEBUG("Undercarriage Controller EM-Stop released");
+    ucar_ctrl_->setEMStopActive(false);
+  }
+  halted = halt;
+
+  // control step, zero joint cmds if no platform cmd arrived within timeout_
+  CalcJointCmds((pltf_cmd_seq != 0) && (MonotonicNowS() - pltf_cmd.stamp_s < timeout_),
+      joint_cmd.positions, joint_cmd.velocities);
+  joint_cmd.stamp = ros::Time::now();
+
+  // publishing is done by the publishing thread
+  joint_cmd_slot_.write(joint_cmd);
+  sem_post(&pub_sem_);
+}
+
+// publishes the joint cmds of the control thread
+void NodeClass::PubThreadRun()
+{
+  JointCmdType joint_cmd;
+
+  while (true)
+  {
+    while ((sem_wait(&pub_sem_) != 0) && (errno == EINTR)) {}
+    if (!ctrl_thread_running_)
+      break;
+
+    // if publishing took longer than a control cycle, only the latest joint cmds are published
+    while (sem_trywait(&pub_sem_) == 0) {}
+
+    joint_cmd_slot_.read(joint_cmd);
+
+    joint_state_cmd_.header.stamp = joint_cmd.stamp;
+    std::copy(joint_cmd.positions, joint_cmd.positions + m_iNumJoints, joint_state_cmd_.desired.positions.begin());
+    std::copy(joint_cmd.velocities, joint_cmd.velocities + m_iNumJoints, joint_state_cmd_.desired.velocities.begin());
+
+    topic_pub_controller_joint_command_.publish(joint_state_cmd_);
+  }
 }
 
 // calculates odometry from current measurement values
 // and publishes it via an odometry topic and the tf broadcaster
 void NodeClass::UpdateOdometry()
 {
-  double vel_x_rob_ms, vel_y_rob_ms, vel_rob_ms, rot_rob_rads, delta_x_rob_m, delta_y_rob_m, delta_theta_rob_rad;
+  double vel_x_rob_ms, vel_y_rob_ms, rot_rob_rads, delta_x_rob_m, delta_y_rob_m, delta_theta_rob_rad;
+  double var_vel_m2s2, var_rot_rad2s2;
   double dummy1, dummy2;
-  double dt;
-  ros::Time current_time;
+  ros::Time stamp;
 
   // if drive chain already initialized process joint data
   //if (drive_chain_diagnostic_ != diagnostic_status_lookup_.OK)
@@ -659,92 +1166,92 @@ void NodeClass::UpdateOdometry()
     // !Careful! Controller internally calculates with mm instead of m
     // ToDo: change internal calculation to SI-Units
     // ToDo: last values are not used anymore --> remove from interface
-    ucar_ctrl_->GetActualPltfVelocity(delta_x_rob_m, delta_y_rob_m, delta_theta_rob_rad, dummy1,
+    ucar_odom_->GetActualPltfVelocity(delta_x_rob_m, delta_y_rob_m, delta_theta_rob_rad, dummy1,
         vel_x_rob_ms, vel_y_rob_ms, rot_rob_rads, dummy2);
+    ucar_odom_->GetActualPltfVelocityVariance(var_vel_m2s2, var_rot_rad2s2);
 
     // convert variables to SI-Units
     vel_x_rob_ms = vel_x_rob_ms/1000.0;
     vel_y_rob_ms = vel_y_rob_ms/1000.0;
-    delta_x_rob_m = delta_x_rob_m/1000.0;
-    delta_y_rob_m = delta_y_rob_m/1000.0;
+    var_vel_m2s2 = var_vel_m2s2/1.0e6;
 
-    ROS_DEBUG("Odmonetry delta is: x=%f, y=%f, th=%f", delta_x_rob_m, delta_y_rob_m, rot_rob_rads);
+    ROS_DEBUG("Odometry velocity is: x=%f, y=%f, th=%f", vel_x_rob_ms, vel_y_rob_ms, rot_rob_rads);
   }
   else
   {
-    // otherwise set data (velocity and pose-delta) to zero
+    // otherwise set data (velocity and variance) to zero
     vel_x_rob_ms = 0.0;
     vel_y_rob_ms = 0.0;
-    delta_x_rob_m = 0.0;
-    delta_y_rob_m = 0.0;
+    rot_rob_rads = 0.0;
+    var_vel_m2s2 = 0.0;
+    var_rot_rad2s2 = 0.0;
   }
 
-  // calc odometry (from startup)
-  // get time since last odometry-measurement
-  current_time = ros::Time::now();
-  dt = current_time.toSec() - last_time_.toSec();
-  last_time_ = current_time;
-  vel_rob_ms = sqrt(vel_x_rob_ms*vel_x_rob_ms + vel_y_rob_ms*vel_y_rob_ms);
-
-  // calculation from ROS odom publisher tutorial http://www.ros.org/wiki/navigation/Tutorials/RobotSetup/Odom, using now midpoint integration
-  x_rob_m_ = x_rob_m_ + ((vel_x_rob_ms+vel_x_rob_last_)/2.0 * cos(theta_rob_rad_) - (vel_y_rob_ms+vel_y_rob_last_)/2.0 * sin(theta_rob_rad_)) * dt;
-  y_rob_m_ = y_rob_m_ + ((vel_x_rob_ms+vel_x_rob_last_)/2.0 * sin(theta_rob_rad_) + (vel_y_rob_ms+vel_y_rob_last_)/2.0 * cos(theta_rob_rad_)) * dt;
-  theta_rob_rad_ = theta_rob_rad_ + rot_rob_rads * dt;
-  //theta_rob_rad_ = theta_rob_rad_ + (rot_rob_rads+vel_theta_rob_last_)/2.0 * dt;
-
-  vel_x_rob_last_ = vel_x_rob_ms;
-  vel_y_rob_last_ = vel_y_rob_ms;
-  vel_theta_rob_last_ = rot_rob_rads;
-
+  // integrate odometry (from startup) at the time the joint states were measured,
+  // samples arriving out of order are sorted in, duplicates are not published again
+  stamp = joint_state_odom_stamp_;
+  if (stamp.isZero())
+  {
+    stamp = ros::Time::now();
+  }
+  if (!odom_integrator_.addSample(stamp.toSec(), vel_x_rob_ms, vel_y_rob_ms, rot_rob_rads, var_vel_m2s2, var_rot_rad2s2))
+  {
+    ROS_DEBUG("Odometry sample at %f dropped (duplicate or too old)", stamp.toSec());
+    return;
+  }
+  const OdometryIntegrator::PoseType& pose = odom_integrator_.getPose();
+  stamp.fromSec(pose.dStampS);
 
   // format data for compatibility with tf-package and standard odometry msg
   // generate quaternion for rotation
-  geometry_msgs::Quaternion odom_quat = tf::createQuaternionMsgFromYaw(theta_rob_rad_);
+  geometry_msgs::Quaternion odom_quat = tf::createQuaternionMsgFromYaw(pose.dThetaRad);
 
   if (broadcast_tf_ == true)
   {
     // compose and publish transform for tf package
-    geometry_msgs::TransformStamped odom_tf;
-    // compose header
-    odom_tf.header.stamp = joint_state_odom_stamp_;
-    odom_tf.header.frame_id = "/odom_combined";
-    odom_tf.child_frame_id = "/base_footprint";
+    // compose header (frame ids are set in the constructor)
+    odom_tf_.header.stamp = stamp;
     // compose data container
-    odom_tf.transform.translation.x = x_rob_m_;
-    odom_tf.transform.translation.y = y_rob_m_;
-    odom_tf.transform.translation.z = 0.0;
-    odom_tf.transform.rotation = odom_quat;
+    odom_tf_.transform.translation.x = pose.dXM;
+    odom_tf_.transform.translation.y = pose.dYM;
+    odom_tf_.transform.translation.z = 0.0;
+    odom_tf_.transform.rotation = odom_quat;
 
     // publish the transform (for debugging, conflicts with robot-pose-ekf)
-    tf_broadcast_odometry_.sendTransform(odom_tf);
+    tf_broadcast_odometry_.sendTransform(odom_tf_);
   }
 
   // compose and publish odometry message as topic
-  nav_msgs::Odometry odom_top;
-  // compose header
-  odom_top.header.stamp = joint_state_odom_stamp_;
-  odom_top.header.frame_id = "/odom_combined";
-  odom_top.child_frame_id = "/base_footprint";
+  // compose header (frame ids and covariances of the unused dimensions are set in the constructor)
+  odom_top_.header.stamp = stamp;
   // compose pose of robot
-  odom_top.pose.pose.position.x = x_rob_m_;
-  odom_top.pose.pose.position.y = y_rob_m_;
-  odom_top.pose.pose.position.z = 0.0;
-  odom_top.pose.pose.orientation = odom_quat;
-  for(int i = 0; i < 6; i++)
-    odom_top.pose.covariance[i*6+i] = 0.1;
+  odom_top_.pose.pose.position.x = pose.dXM;
+  odom_top_.pose.pose.position.y = pose.dYM;
+  odom_top_.pose.pose.position.z = 0.0;
+  odom_top_.pose.pose.orientation = odom_quat;
+  // covariance of x, y and yaw (rows/cols 0, 1 and 5 of the 6x6 matrix)
+  const int cov_idx[3] = {0, 1, 5};
+  for(int i = 0; i < 3; i++)
+  {
+    for(int j = 0; j < 3; j++)
+    {
+      odom_top_.pose.covariance[cov_idx[i]*6+cov_idx[j]] = pose.dCov[i][j];
+    }
+  }
 
   // compose twist of robot
-  odom_top.twist.twist.linear.x = vel_x_rob_ms;
-  odom_top.twist.twist.linear.y = vel_y_rob_ms;
-  odom_top.twist.twist.linear.z = 0.0;
-  odom_top.twist.twist.angular.x = 0.0;
-  odom_top.twist.twist.angular.y = 0.0;
-  odom_top.twist.twist.angular.z = rot_rob_rads;
-  for(int i = 0; i < 6; i++)
-    odom_top.twist.covariance[6*i+i] = 0.1;
+  odom_top_.twist.twist.linear.x = pose.dVelXMS;
+  odom_top_.twist.twist.linear.y = pose.dVelYMS;
+  odom_top_.twist.twist.linear.z = 0.0;
+  odom_top_.twist.twist.angular.x = 0.0;
+  odom_top_.twist.twist.angular.y = 0.0;
+  odom_top_.twist.twist.angular.z = pose.dRotRadS;
+  odom_top_.twist.covariance[0] = pose.dVarVelM2S2;
+  odom_top_.twist.covariance[7] = pose.dVarVelM2S2;
+  odom_top_.twist.covariance[35] = pose.dVarRotRad2S2;
 
   // publish odometry msg
-  topic_pub_odometry_.publish(odom_top);
+  topic_pub_odometry_.publish(odom_top_);
 }
 
 
@@ -0,0 +1,177 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_undercarriage_ctrl
+ * Description: Checks that the control cycle of the undercarriage does not allocate memory.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <cob_undercarriage_ctrl/UndercarriageCtrlGeom.h>
+
+//-----------------------------------------------
+// counts the allocations of the test while g_bCountAllocs is set,
+// operator new of libstdc++ allocates with malloc, so the hook counts it as well
+extern "C" void* __libc_malloc(size_t iSize);
+extern "C" void* __libc_calloc(size_t iNum, size_t iSize);
+extern "C" void* __libc_realloc(void* p, size_t iSize);
+
+static bool g_bCountAllocs = false;
+static int g_iNumAllocs = 0;
+
+extern "C" void* malloc(size_t iSize)
+{
+	if (g_bCountAllocs)
+		g_iNumAllocs++;
+	return __libc_malloc(iSize);
+}
+
+extern "C" void* calloc(size_t iNum, size_t iSize)
+{
+	if (g_bCountAllocs)
+		g_iNumAllocs++;
+	return __libc_calloc(iNum, iSize);
+}
+
+extern "C" void* realloc(void* p, size_t iSize)
+{
+	if (g_bCountAllocs)
+		g_iNumAllocs++;
+	return __libc_realloc(p, iSize);
+}
+
+static void startCounting()
+{
+	g_iNumAllocs = 0;
+	g_bCountAllocs = true;
+}
+
+static int stopCounting()
+{
+	g_bCountAllocs = false;
+	return g_iNumAllocs;
+}
+
+//-----------------------------------------------
+// ini files next to this file
+static std::string getIniDirectory()
+{
+	std::string sFile = __FILE__;
+	return sFile.substr(0, sFile.find_last_of('/') + 1) + "ini/";
+}
+
+//-----------------------------------------------
+// volatile, so the compiler doesn't remove the allocation of the vector
+static std::vector<double>* volatile g_pvdValues;
+
+TEST(Allocation, HookCountsAllocations)
+{
+	startCounting();
+	g_pvdValues = new std::vector<double>(8);
+	delete g_pvdValues;
+	EXPECT_EQ(2, stopCounting());
+}
+
+//-----------------------------------------------
+// one step of the control cycle of the node: measurement in, odometry and command out
+TEST(Allocation, ControlStepDoesNotAllocate)
+{
+	const int c_iNumSteps = 1000;
+	UndercarriageCtrlGeom Ctrl(getIniDirectory());
+	Ctrl.InitUndercarriageCtrl();
+
+	const int iNumWheels = Ctrl.GetNumberOfWheels();
+	std::vector<double> vdVelDrive(iNumWheels, 0.2), vdVelSteer(iNumWheels, 0.0);
+	std::vector<double> vdDltAngDrive(iNumWheels, 0.002), vdAngSteer(iNumWheels, 0.1);
+	std::vector<double> vdCmdVelDrive(iNumWheels), vdCmdVelSteer(iNumWheels), vdCmdAngSteer(iNumWheels);
+	double dDltLong, dDltLat, dDltRotRob, dDltRotVel;
+	double dVelLong, dVelLat, dRotRob, dRotVel;
+	double dVarVel, dVarRot;
+
+	for (int k = 0; k < c_iNumSteps; k++)
+	{
+		vdAngSteer[1] = 0.3 * sin(k * 0.02);
+		vdVelSteer[1] = 0.006 * cos(k * 0.02);
+
+		startCounting();
+
+		// measurement
+		if (k % 2 == 0)
+			Ctrl.SetActualWheelValues(&vdVelDrive[0], &vdVelSteer[0], &vdDltAngDrive[0], &vdAngSteer[0]);
+		else
+			Ctrl.SetActualWheelValues(vdVelDrive, vdVelSteer, vdDltAngDrive, vdAngSteer);
+		Ctrl.GetActualPltfVelocity(dDltLong, dDltLat, dDltRotRob, dDltRotVel, dVelLong, dVelLat, dRotRob, dRotVel);
+		Ctrl.GetActualPltfVelocityVariance(dVarVel, dVarRot);
+
+		// command
+		Ctrl.SetDesiredPltfVelocity(300 * sin(k * 0.01), 200 * cos(k * 0.013), 0.3 * sin(k * 0.007), 0);
+		if (k % 2 == 0)
+			Ctrl.GetNewCtrlStateSteerDriveSetValues(&vdCmdVelDrive[0], &vdCmdVelSteer[0], &vdCmdAngSteer[0],
+				dVelLong, dVelLat, dRotRob, dRotVel);
+		else
+			Ctrl.GetNewCtrlStateSteerDriveSetValues(vdCmdVelDrive, vdCmdVelSteer, vdCmdAngSteer,
+				dVelLong, dVelLat, dRotRob, dRotVel);
+		Ctrl.GetSteerDriveSetValues(&vdCmdVelDrive[0], &vdCmdAngSteer[0]);
+
+		ASSERT_EQ(0, stopCounting()) << "step " << k;
+	}
+}
+
+//-----------------------------------------------
+int main(int argc, char** argv)
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
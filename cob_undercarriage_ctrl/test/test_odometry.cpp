@@ -0,0 +1,260 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_undercarriage_ctrl
+ * Description: Tests of the odometry integration.
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <cob_undercarriage_ctrl/OdometryIntegrator.h>
+
+//-----------------------------------------------
+// twist measured at a time stamp
+struct Sample
+{
+	double dStampS;
+	double dVelXMS, dVelYMS, dRotRadS;
+};
+
+static const double c_dVarVel = 1e-4;
+static const double c_dVarRot = 1e-4;
+
+// samples every 10 ms of a varying twist
+static std::vector<Sample> createSamples(int iNumSamples)
+{
+	std::vector<Sample> vSamples(iNumSamples);
+
+	for (int k = 0; k < iNumSamples; k++)
+	{
+		double t = 100.0 + 0.01 * k;
+		vSamples[k].dStampS = t;
+		vSamples[k].dVelXMS = 0.5 + 0.3 * sin(t);
+		vSamples[k].dVelYMS = 0.1 * cos(2.0 * t);
+		vSamples[k].dRotRadS = 0.4 * sin(0.5 * t);
+	}
+	return vSamples;
+}
+
+static bool add(OdometryIntegrator& Odom, const Sample& S)
+{
+	return Odom.addSample(S.dStampS, S.dVelXMS, S.dVelYMS, S.dRotRadS, c_dVarVel, c_dVarRot);
+}
+
+static void expectSamePose(const OdometryIntegrator::PoseType& Pose, const OdometryIntegrator::PoseType& Ref)
+{
+	EXPECT_EQ(Ref.dStampS, Pose.dStampS);
+	EXPECT_NEAR(Ref.dXM, Pose.dXM, 1e-12);
+	EXPECT_NEAR(Ref.dYM, Pose.dYM, 1e-12);
+	EXPECT_NEAR(Ref.dThetaRad, Pose.dThetaRad, 1e-12);
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			EXPECT_NEAR(Ref.dCov[i][j], Pose.dCov[i][j], 1e-15);
+}
+
+//-----------------------------------------------
+// constant twist: the pose follows the circular arc exactly
+TEST(OdometryIntegrator, OrderedConstantTwist)
+{
+	const double dVelMS = 0.5, dRotRadS = 0.2;
+	OdometryIntegrator Odom;
+
+	for (int k = 0; k <= 200; k++)
+		EXPECT_TRUE(Odom.addSample(0.01 * k, dVelMS, 0.0, dRotRadS, c_dVarVel, c_dVarRot));
+
+	const OdometryIntegrator::PoseType& Pose = Odom.getPose();
+	double dTheta = dRotRadS * 2.0;
+	EXPECT_NEAR(2.0, Pose.dStampS, 1e-12);
+	EXPECT_NEAR(dVelMS / dRotRadS * sin(dTheta), Pose.dXM, 1e-9);
+	EXPECT_NEAR(dVelMS / dRotRadS * (1.0 - cos(dTheta)), Pose.dYM, 1e-9);
+	EXPECT_NEAR(dTheta, Pose.dThetaRad, 1e-9);
+
+	// the covariance grows with the travelled distance
+	EXPECT_GT(Pose.dCov[0][0], 0.0);
+	EXPECT_GT(Pose.dCov[2][2], 0.0);
+	EXPECT_EQ(0, Odom.getNumDropped());
+	EXPECT_EQ(0, Odom.getNumReordered());
+}
+
+//-----------------------------------------------
+// samples shuffled within blocks shorter than the history give the pose of the ordered samples
+TEST(OdometryIntegrator, Shuffled)
+{
+	const int c_iBlock = 8;
+	std::vector<Sample> vSamples = createSamples(400);
+	std::vector<Sample> vShuffled = vSamples;
+	OdometryIntegrator Ordered, Shuffled;
+
+	srand(1);
+	for (unsigned int iBlock = 0; iBlock + c_iBlock <= vShuffled.size(); iBlock += c_iBlock)
+	{
+		for (int i = c_iBlock - 1; i > 0; i--)
+			std::swap(vShuffled[iBlock + i], vShuffled[iBlock + rand() % (i + 1)]);
+	}
+	// the first sample starts the integration
+	for (unsigned int i = 1; i < vShuffled.size(); i++)
+	{
+		if (vShuffled[i].dStampS == vSamples[0].dStampS)
+			std::swap(vShuffled[0], vShuffled[i]);
+	}
+
+	for (unsigned int i = 0; i < vSamples.size(); i++)
+	{
+		EXPECT_TRUE(add(Ordered, vSamples[i]));
+		EXPECT_TRUE(add(Shuffled, vShuffled[i]));
+	}
+
+	expectSamePose(Shuffled.getPose(), Ordered.getPose());
+	EXPECT_GT(Shuffled.getNumReordered(), 0);
+	EXPECT_EQ(0, Shuffled.getNumDropped());
+	EXPECT_EQ(0, Shuffled.getNumDuplicates());
+}
+
+//-----------------------------------------------
+TEST(OdometryIntegrator, Duplicates)
+{
+	std::vector<Sample> vSamples = createSamples(50);
+	OdometryIntegrator Odom;
+
+	for (unsigned int i = 0; i < vSamples.size(); i++)
+		add(Odom, vSamples[i]);
+	OdometryIntegrator::PoseType Pose = Odom.getPose();
+
+	// the newest and an older sample again, with a different twist
+	Sample Newest = vSamples.back();
+	Sample Older = vSamples[vSamples.size() - 5];
+	Newest.dVelXMS += 1.0;
+	Older.dRotRadS += 1.0;
+	EXPECT_FALSE(add(Odom, Newest));
+	EXPECT_FALSE(add(Odom, Older));
+
+	expectSamePose(Odom.getPose(), Pose);
+	EXPECT_EQ(2, Odom.getNumDuplicates());
+	EXPECT_EQ(0, Odom.getNumReordered());
+}
+
+//-----------------------------------------------
+// late samples with a full history
+TEST(OdometryIntegrator, HistoryOverflow)
+{
+	const int c_iNumSamples = OdometryIntegrator::c_iSizeHistory + 8;
+	std::vector<Sample> vSamples = createSamples(c_iNumSamples);
+	OdometryIntegrator Odom;
+
+	for (unsigned int i = 0; i < vSamples.size(); i++)
+		add(Odom, vSamples[i]);
+	OdometryIntegrator::PoseType Pose = Odom.getPose();
+
+	// the history holds the newest c_iSizeHistory samples
+	const int iOldest = c_iNumSamples - OdometryIntegrator::c_iSizeHistory;
+	Sample Late = vSamples[iOldest];
+
+	// older than the history
+	Late.dStampS = vSamples[iOldest].dStampS - 0.005;
+	EXPECT_FALSE(add(Odom, Late));
+	// between the oldest two, the oldest one would be dropped to make room
+	Late.dStampS = vSamples[iOldest].dStampS + 0.005;
+	EXPECT_FALSE(add(Odom, Late));
+
+	expectSamePose(Odom.getPose(), Pose);
+	EXPECT_EQ(2, Odom.getNumDropped());
+
+	// between the second and third oldest: sorted in, same pose as if it had arrived in order
+	Late.dStampS = vSamples[iOldest + 1].dStampS + 0.005;
+	EXPECT_TRUE(add(Odom, Late));
+	EXPECT_EQ(1, Odom.getNumReordered());
+
+	OdometryIntegrator Ordered;
+	for (int i = 0; i < c_iNumSamples; i++)
+	{
+		add(Ordered, vSamples[i]);
+		if (i == iOldest + 1)
+			add(Ordered, Late);
+	}
+	expectSamePose(Odom.getPose(), Ordered.getPose());
+}
+
+//-----------------------------------------------
+// after more than a history of too old samples (the clock jumped back) the integration restarts
+TEST(OdometryIntegrator, ClockJumpBack)
+{
+	std::vector<Sample> vSamples = createSamples(50);
+	OdometryIntegrator Odom;
+
+	for (unsigned int i = 0; i < vSamples.size(); i++)
+		add(Odom, vSamples[i]);
+	OdometryIntegrator::PoseType Pose = Odom.getPose();
+
+	Sample Old = vSamples[0];
+	for (int i = 0; i < OdometryIntegrator::c_iSizeHistory + 1; i++)
+	{
+		Old.dStampS = 10.0 + 0.01 * i;
+		EXPECT_FALSE(add(Odom, Old));
+	}
+	Old.dStampS += 0.01;
+	EXPECT_TRUE(add(Odom, Old));
+
+	// continues from the pose before the jump
+	EXPECT_EQ(Old.dStampS, Odom.getPose().dStampS);
+	EXPECT_EQ(Pose.dXM, Odom.getPose().dXM);
+	EXPECT_EQ(Pose.dYM, Odom.getPose().dYM);
+	EXPECT_EQ(Pose.dThetaRad, Odom.getPose().dThetaRad);
+}
+
+//-----------------------------------------------
+int main(int argc, char** argv)
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
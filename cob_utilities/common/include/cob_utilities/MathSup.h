@@ -197,6 +197,36 @@ public:
 		return result;
 	}
 
+	/**
+	 * Fast arcus tangens of y/x in the interval ]-pi,pi], same conventions as atan4quad()
+	 * (atan2Fast(0,0) = 0, atan2Fast(0,x<0) = pi).
+	 * Uses a minimax polynomial of degree 13 on [0,1] and octant reduction,
+	 * the absolute error is below 2.5e-7 rad.
+	 * Contains no branches, so loops over arrays can be vectorized by the compiler.
+	 */
+	static double atan2Fast(double y, double x)
+	{
+		double dAbsX = fabs(x);
+		double dAbsY = fabs(y);
+		double dMax = (dAbsX > dAbsY) ? dAbsX : dAbsY;
+		double dMin = (dAbsX > dAbsY) ? dAbsY : dAbsX;
+		// avoid 0/0 for x = y = 0, result is 0 then
+		double dT = dMin / ((dMax > 0.0) ? dMax : 1.0);
+		double dT2 = dT * dT;
+		double dResult;
+
+		dResult = dT * (0.99999611154957091 + dT2 * (-0.3331736805474933 + dT2 * (0.19807815564989179
+			+ dT2 * (-0.13233342095574629 + dT2 * (0.079623672365616585 + dT2 * (-0.033604220565024996
+			+ dT2 * 0.0068117932908732517))))));
+
+		// undo octant reduction
+		dResult = (dAbsY > dAbsX) ? HALF_PI - dResult : dResult;
+		dResult = (x < 0.0) ? PI - dResult : dResult;
+		dResult = (y < 0.0) ? -dResult : dResult;
+
+		return dResult;
+	}
+
 
 	/**
 	 * Calculates the euclidean distance of two points.
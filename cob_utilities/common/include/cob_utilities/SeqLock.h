@@ -0,0 +1,122 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_utilities
+ * Description: sequence lock for single writer, multiple reader data
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#ifndef SEQLOCK_INCLUDEDEF_H
+#define SEQLOCK_INCLUDEDEF_H
+//-----------------------------------------------
+#include <boost/atomic.hpp>
+//-----------------------------------------------
+
+/**
+ * Sequence lock: one writer publishes a value, any number of readers copy it
+ * without blocking the writer. The writer makes the sequence counter odd while
+ * it changes the value, a reader retries if the counter was odd or changed during its copy.
+ * T has to be a plain struct (no pointers to memory owned by it), since a reader may copy a half written value
+ * before it detects the change and retries.
+ */
+template<class T>
+class SeqLock
+{
+public:
+	SeqLock() : m_iSeq(0), m_Value() {}
+
+	/**
+	 * Publishes a new value. Must not be called by more than one thread at the same time.
+	 */
+	void write(const T& Value)
+	{
+		unsigned int iSeq = m_iSeq.load(boost::memory_order_relaxed);
+
+		m_iSeq.store(iSeq + 1, boost::memory_order_relaxed);
+		boost::atomic_thread_fence(boost::memory_order_release);
+
+		m_Value = Value;
+
+		m_iSeq.store(iSeq + 2, boost::memory_order_release);
+	}
+
+	/**
+	 * Copies the last published value.
+	 * @return number of values published so far (0 if Value is still the default)
+	 */
+	unsigned int read(T& Value) const
+	{
+		unsigned int iSeq1, iSeq2;
+
+		do
+		{
+			iSeq1 = m_iSeq.load(boost::memory_order_acquire);
+			if ((iSeq1 & 1) != 0)
+				continue;
+
+			Value = m_Value;
+
+			boost::atomic_thread_fence(boost::memory_order_acquire);
+			iSeq2 = m_iSeq.load(boost::memory_order_relaxed);
+		}
+		while (((iSeq1 & 1) != 0) || (iSeq1 != iSeq2));
+
+		return iSeq1 / 2;
+	}
+
+private:
+	boost::atomic<unsigned int> m_iSeq;
+	T m_Value;
+
+	// not copyable
+	SeqLock(const SeqLock&);
+	SeqLock& operator=(const SeqLock&);
+};
+//-----------------------------------------------
+#endif
@@ -0,0 +1,136 @@
+/****************************************************************
+ *
+ * Copyright (c) 2026
+ *
+ * Fraunhofer Institute for Manufacturing Engineering
+ * and Automation (IPA)
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Project name: care-o-bot
+ * ROS stack name: cob_driver
+ * ROS package name: cob_utilities
+ * Description: Checks the error bound of MathSup::atan2Fast().
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Author: Matthias Gruhler, email:mig@ipa.fhg.de
+ * Supervised by: Christian Connette, email:christian.connette@ipa.fhg.de
+ *
+ * Date of creation: Oct 2026
+ * ToDo:
+ *
+ * +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Fraunhofer Institute for Manufacturing
+ *       Engineering and Automation (IPA) nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License LGPL as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License LGPL for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License LGPL along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****************************************************************/
+
+
+#include <math.h>
+
+#include <gtest/gtest.h>
+
+#include <cob_utilities/MathSup.h>
+
+//-----------------------------------------------
+// documented bound of the absolute error
+static const double c_dMaxErrorRad = 2.5e-7;
+
+// difference of two angles in ]-pi,pi]
+static double angleError(double dAngRad, double dRefRad)
+{
+	double dDiff = dAngRad - dRefRad;
+	MathSup::normalizePi(dDiff);
+	return fabs(dDiff);
+}
+
+//-----------------------------------------------
+// dense grid including the axes and the diagonals
+TEST(Atan2Fast, ErrorOnGrid)
+{
+	double dMaxError = 0;
+
+	for (int i = -400; i <= 400; i++)
+	{
+		for (int j = -400; j <= 400; j++)
+		{
+			double y = i * 0.37;
+			double x = j * 0.37;
+			if ((x == 0) && (y == 0))
+				continue;
+
+			double dError = angleError(MathSup::atan2Fast(y, x), atan2(y, x));
+			if (dError > dMaxError)
+				dMaxError = dError;
+		}
+	}
+	EXPECT_LT(dMaxError, c_dMaxErrorRad);
+}
+
+//-----------------------------------------------
+// fine steps of the angle, the error of the polynomial is largest inside the octants
+TEST(Atan2Fast, ErrorOnCircle)
+{
+	const int c_iNumSteps = 1000000;
+	double dMaxError = 0;
+
+	for (int k = 0; k < c_iNumSteps; k++)
+	{
+		double dAngRad = -MathSup::PI + 2.0 * MathSup::PI * (k + 0.5) / c_iNumSteps;
+		double dError = angleError(MathSup::atan2Fast(sin(dAngRad), cos(dAngRad)), dAngRad);
+		if (dError > dMaxError)
+			dMaxError = dError;
+	}
+	EXPECT_LT(dMaxError, c_dMaxErrorRad);
+}
+
+//-----------------------------------------------
+TEST(Atan2Fast, SpecialValues)
+{
+	EXPECT_EQ(0.0, MathSup::atan2Fast(0.0, 0.0));
+	EXPECT_EQ(0.0, MathSup::atan2Fast(0.0, 1.0));
+	// the interval is ]-pi,pi], like atan4quad()
+	EXPECT_EQ(MathSup::PI, MathSup::atan2Fast(0.0, -1.0));
+	EXPECT_EQ(MathSup::PI, MathSup::atan2Fast(-0.0, -1.0));
+	EXPECT_EQ(MathSup::HALF_PI, MathSup::atan2Fast(1.0, 0.0));
+	EXPECT_EQ(-MathSup::HALF_PI, MathSup::atan2Fast(-1.0, 0.0));
+	EXPECT_NEAR(0.25 * MathSup::PI, MathSup::atan2Fast(1.0, 1.0), c_dMaxErrorRad);
+	EXPECT_NEAR(-0.75 * MathSup::PI, MathSup::atan2Fast(-1.0, -1.0), c_dMaxErrorRad);
+
+	// independent of the magnitude
+	EXPECT_NEAR(atan2(3.0, -4.0), MathSup::atan2Fast(3e-300, -4e-300), c_dMaxErrorRad);
+	EXPECT_NEAR(atan2(3.0, -4.0), MathSup::atan2Fast(3e300, -4e300), c_dMaxErrorRad);
+}
+
+//-----------------------------------------------
+int main(int argc, char** argv)
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}